@@ -0,0 +1,69 @@
+# Compare a kernel_bench report with the stored baseline of the same board.
+#
+#   cmake -DBENCH_RESULT=<run.json> -DBENCH_BASELINE=<baseline.json>
+#         [-DBENCH_TOLERANCE_PCT=5] [-DBENCH_SLACK=2] -P bench_compare.cmake
+#
+# A metric regresses when its median exceeds the baseline median by more
+# than BENCH_TOLERANCE_PCT percent plus BENCH_SLACK units. Any regression,
+# a baseline metric missing from the run, or a missing baseline fails.
+
+cmake_minimum_required(VERSION 3.19)   # string(JSON)
+
+if(NOT DEFINED BENCH_TOLERANCE_PCT)
+    set(BENCH_TOLERANCE_PCT 5)
+endif()
+if(NOT DEFINED BENCH_SLACK)
+    set(BENCH_SLACK 2)
+endif()
+
+if(NOT EXISTS "${BENCH_BASELINE}")
+    message(FATAL_ERROR "no baseline at ${BENCH_BASELINE}; nothing to compare this run with.\n"
+                        "Record one with the bench_baseline target and commit it.")
+endif()
+
+file(READ "${BENCH_RESULT}" BENCH_RUN)
+file(READ "${BENCH_BASELINE}" BENCH_BASE)
+
+string(JSON BENCH_RUN_UNIT GET "${BENCH_RUN}" unit)
+string(JSON BENCH_BASE_UNIT GET "${BENCH_BASE}" unit)
+if(NOT BENCH_RUN_UNIT STREQUAL BENCH_BASE_UNIT)
+    message(FATAL_ERROR "unit mismatch: run in ${BENCH_RUN_UNIT}, baseline in ${BENCH_BASE_UNIT}")
+endif()
+
+# Code placement (flash or .ramfunc); a baseline of the other placement
+# turns the comparison into a before/after of KERNEL_RAMFUNC
+string(JSON BENCH_RUN_CODE ERROR_VARIABLE BENCH_ERROR GET "${BENCH_RUN}" code)
+string(JSON BENCH_BASE_CODE ERROR_VARIABLE BENCH_ERROR GET "${BENCH_BASE}" code)
+if(NOT BENCH_RUN_CODE STREQUAL BENCH_BASE_CODE)
+    message("code placement: ${BENCH_RUN_CODE} (baseline ${BENCH_BASE_CODE})")
+endif()
+
+set(BENCH_FAILURES "")
+string(JSON BENCH_COUNT LENGTH "${BENCH_BASE}" results)
+math(EXPR BENCH_LAST "${BENCH_COUNT} - 1")
+
+foreach(BENCH_INDEX RANGE ${BENCH_LAST})
+    string(JSON BENCH_NAME MEMBER "${BENCH_BASE}" results ${BENCH_INDEX})
+    string(JSON BENCH_BASE_MEDIAN GET "${BENCH_BASE}" results ${BENCH_NAME} median)
+    string(JSON BENCH_RUN_MEDIAN ERROR_VARIABLE BENCH_ERROR GET "${BENCH_RUN}" results ${BENCH_NAME} median)
+
+    if(BENCH_ERROR)
+        list(APPEND BENCH_FAILURES "${BENCH_NAME}: missing from this run")
+        continue()
+    endif()
+
+    math(EXPR BENCH_LIMIT "${BENCH_BASE_MEDIAN} * (100 + ${BENCH_TOLERANCE_PCT}) / 100 + ${BENCH_SLACK}")
+    if(BENCH_RUN_MEDIAN GREATER BENCH_LIMIT)
+        set(BENCH_VERDICT "REGRESSION")
+        list(APPEND BENCH_FAILURES
+             "${BENCH_NAME}: ${BENCH_RUN_MEDIAN} > ${BENCH_LIMIT} (baseline ${BENCH_BASE_MEDIAN})")
+    else()
+        set(BENCH_VERDICT "ok")
+    endif()
+    message("${BENCH_NAME}: ${BENCH_RUN_MEDIAN} ${BENCH_RUN_UNIT} (baseline ${BENCH_BASE_MEDIAN}) ${BENCH_VERDICT}")
+endforeach()
+
+if(BENCH_FAILURES)
+    list(JOIN BENCH_FAILURES "\n  " BENCH_REPORT)
+    message(FATAL_ERROR "kernel benchmark regressions:\n  ${BENCH_REPORT}")
+endif()
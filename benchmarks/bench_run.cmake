@@ -0,0 +1,37 @@
+# Run the kernel benchmark and store the JSON document it prints.
+#
+#   cmake "-DBENCH_COMMAND=<program;args...>" -DBENCH_OUTPUT=<file.json> -P bench_run.cmake
+#
+# Anything around the JSON object (emulator chatter) is dropped.
+
+cmake_minimum_required(VERSION 3.19)   # string(JSON)
+
+if(NOT BENCH_COMMAND OR NOT BENCH_OUTPUT)
+    message(FATAL_ERROR "BENCH_COMMAND and BENCH_OUTPUT are required")
+endif()
+
+execute_process(
+    COMMAND ${BENCH_COMMAND}
+    OUTPUT_VARIABLE BENCH_STDOUT
+    ERROR_VARIABLE BENCH_STDERR
+    RESULT_VARIABLE BENCH_STATUS
+)
+if(NOT BENCH_STATUS EQUAL 0)
+    message(FATAL_ERROR "kernel_bench failed (${BENCH_STATUS})\n${BENCH_STDOUT}\n${BENCH_STDERR}")
+endif()
+
+string(FIND "${BENCH_STDOUT}" "{" BENCH_BEGIN)
+string(FIND "${BENCH_STDOUT}" "}" BENCH_END REVERSE)
+if(BENCH_BEGIN EQUAL -1 OR BENCH_END LESS BENCH_BEGIN)
+    message(FATAL_ERROR "kernel_bench printed no JSON\n${BENCH_STDOUT}\n${BENCH_STDERR}")
+endif()
+math(EXPR BENCH_LENGTH "${BENCH_END} - ${BENCH_BEGIN} + 1")
+string(SUBSTRING "${BENCH_STDOUT}" ${BENCH_BEGIN} ${BENCH_LENGTH} BENCH_JSON)
+
+string(JSON BENCH_RESULT_COUNT ERROR_VARIABLE BENCH_ERROR LENGTH "${BENCH_JSON}" results)
+if(BENCH_ERROR OR BENCH_RESULT_COUNT EQUAL 0)
+    message(FATAL_ERROR "kernel_bench output is not a valid report: ${BENCH_ERROR}\n${BENCH_JSON}")
+endif()
+
+file(WRITE "${BENCH_OUTPUT}" "${BENCH_JSON}\n")
+message("${BENCH_JSON}")
@@ -0,0 +1,560 @@
+/**
+ * @file kernel_bench.c
+ * @brief Kernel microbenchmarks, reported as one JSON document on stdout
+ *
+ * Measured with the port's cycle counter (DWT or SysTick cycles on
+ * Cortex-M, nanoseconds on the host):
+ *   - critical_section             vKernelEnterCritical() + vKernelExitCritical()
+ *   - irq_mask                     ulHalDisableInterrupts() + vHalRestoreInterrupts():
+ *                                  BASEPRI on Cortex-M, the tick signal mask on the host
+ *   - irq_mask_primask             the same with PRIMASK (cpsid i), the mask the
+ *                                  BASEPRI scheme replaced (Cortex-M only)
+ *   - task_create                  xTaskCreatePeriodic()
+ *   - scheduler_decision_best/worst vSchedulerGetNextTask() with the highest /
+ *                                  only the lowest priority level ready
+ *   - tick_<n>                     vSystemTickHandler() with n tasks, no release
+ *   - tick_release_<n>             vSystemTickHandler() releasing all n tasks
+ *   - context_switch               vContextSwitch() between two running tasks
+ *   - isr_to_task                  tick period start to the first instruction
+ *                                  of the task that tick released
+ *
+ * The first group runs from main() with interrupts masked and calls into
+ * the kernel directly; context_switch and isr_to_task need the scheduler
+ * running. Counter overhead is subtracted from the paired readings.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef BENCH_BOARD
+#define BENCH_BOARD                 "unknown"
+#endif
+#ifndef BENCH_UNIT
+#define BENCH_UNIT                  "cycles"
+#endif
+
+/* Where the kernel hot paths run from (KERNEL_RAMFUNC) */
+#if !defined(__arm__)
+#define BENCH_CODE                  "host"
+#elif PERIODRTOS_RAMFUNC
+#define BENCH_CODE                  "ramfunc"
+#else
+#define BENCH_CODE                  "flash"
+#endif
+
+#define BENCH_SAMPLES               64      /* Samples per metric */
+#define BENCH_MAX_SAMPLES           128
+#define BENCH_MAX_RESULTS           24
+#define BENCH_TASKS                 10      /* MAX_TASKS less slot 0 and idle */
+#define BENCH_PERIOD_BASE           1000    /* No release during tick_<n> */
+
+/* Runtime benchmark periods; the latency task must have the highest priority */
+#define BENCH_LATENCY_PERIOD        2
+#define BENCH_PONG_PERIOD           3
+#define BENCH_PING_PERIOD           5
+#define BENCH_REPORT_PERIOD         20
+
+typedef struct {
+    const char *pcName;
+    uint32_t ulMin;
+    uint32_t ulMedian;
+    uint32_t ulMax;
+    uint32_t ulSamples;
+} BenchResult_t;
+
+/* External variables */
+extern TaskControlBlock_t xTaskList[MAX_TASKS];
+
+/* Results */
+static BenchResult_t xResults[BENCH_MAX_RESULTS];
+static uint32_t ulResultCount = 0;
+static uint32_t ulCounterOverhead = 0;
+
+/* Sample buffers */
+static uint32_t ulSamples[BENCH_MAX_SAMPLES];
+static uint32_t ulSampleCount = 0;
+static uint32_t ulLatencySamples[BENCH_SAMPLES];
+static volatile uint32_t ulLatencyCount = 0;
+
+/* Context switch ping-pong */
+static TaskHandle_t xPingHandle = NULL;
+static TaskHandle_t xPongHandle = NULL;
+static volatile uint32_t ulSwitchStart = 0;
+static volatile bool bSwitchDone = false;
+
+/* JSON output */
+static char pcReport[2048];
+
+/* Internal function prototypes */
+static void vBenchReset(void);
+static void vBenchTaskNop(void *pvParameters);
+static void vBenchSample(uint32_t ulStart, uint32_t ulEnd);
+static void vBenchRecord(const char *pcName, uint32_t *pulSamples, uint32_t ulCount);
+static void vBenchCounterOverhead(void);
+static void vBenchCriticalSections(void);
+static void vBenchTaskCreate(void);
+static void vBenchSchedulerDecision(void);
+static void vBenchTick(uint32_t ulTasks, const char *pcIdleName, const char *pcReleaseName);
+static void vLatencyTask(void *pvParameters);
+static void vPongTask(void *pvParameters);
+static void vPingTask(void *pvParameters);
+static void vReportTask(void *pvParameters);
+static uint32_t ulAppend(uint32_t ulOffset, const char *pcText);
+static uint32_t ulAppendU32(uint32_t ulOffset, uint32_t ulValue);
+
+/**
+ * @brief Main function
+ */
+int main(void)
+{
+    uint32_t ulState;
+
+    /* Initialize board */
+    vBoardInit();
+    vCycleCounterInit();
+
+    /* Direct kernel calls: the tick must not run in between */
+    ulState = ulHalDisableInterrupts();
+
+    vBenchCounterOverhead();
+    vBenchCriticalSections();
+    vBenchTaskCreate();
+    vBenchSchedulerDecision();
+    vBenchTick(1, "tick_1", "tick_release_1");
+    vBenchTick(2, "tick_2", "tick_release_2");
+    vBenchTick(4, "tick_4", "tick_release_4");
+    vBenchTick(8, "tick_8", "tick_release_8");
+    vBenchTick(10, "tick_10", "tick_release_10");
+
+    /* Runtime benchmarks; nothing is in the ready list until the scheduler starts */
+    vBenchReset();
+    if (xTaskCreatePeriodic(vLatencyTask, "Latency", DEFAULT_STACK_SIZE, NULL,
+                            BENCH_LATENCY_PERIOD, BENCH_LATENCY_PERIOD) == NULL ||
+        (xPongHandle = xTaskCreatePeriodic(vPongTask, "Pong", DEFAULT_STACK_SIZE, NULL,
+                                           BENCH_PONG_PERIOD, BENCH_PONG_PERIOD)) == NULL ||
+        (xPingHandle = xTaskCreatePeriodic(vPingTask, "Ping", DEFAULT_STACK_SIZE, NULL,
+                                           BENCH_PING_PERIOD, BENCH_PING_PERIOD)) == NULL ||
+        xTaskCreatePeriodic(vReportTask, "Report", MAX_STACK_SIZE, NULL,
+                            BENCH_REPORT_PERIOD, BENCH_REPORT_PERIOD) == NULL) {
+        vBoardExit(2);
+    }
+
+    vHalRestoreInterrupts(ulState);
+
+    /* Start the scheduler */
+    vTaskStartScheduler();
+
+    /* Should never reach here */
+    vBoardExit(2);
+    return 2;
+}
+
+/**
+ * @brief Idle task - spin until a release preempts it
+ */
+void vIdleTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    while (1) {
+        vTaskYield();
+    }
+}
+
+/**
+ * @brief Forget every task, including stale ready-list entries
+ */
+static void vBenchReset(void)
+{
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        if (xTaskList[i].pxTaskCode != NULL) {
+            vRemoveTaskFromReadyList((TaskHandle_t)&xTaskList[i]);
+        }
+    }
+    vKernelInit();
+}
+
+static void vBenchTaskNop(void *pvParameters)
+{
+    (void)pvParameters;
+}
+
+/**
+ * @brief Add one paired reading, less the counter's own cost
+ */
+static void vBenchSample(uint32_t ulStart, uint32_t ulEnd)
+{
+    uint32_t ulElapsed = ulEnd - ulStart;
+
+    if (ulSampleCount < BENCH_MAX_SAMPLES) {
+        ulSamples[ulSampleCount++] = (ulElapsed > ulCounterOverhead) ? ulElapsed - ulCounterOverhead : 0;
+    }
+}
+
+/**
+ * @brief Sort the samples and store min / median / max under pcName
+ */
+static void vBenchRecord(const char *pcName, uint32_t *pulSamples, uint32_t ulCount)
+{
+    BenchResult_t *pxResult;
+
+    if (ulResultCount >= BENCH_MAX_RESULTS || ulCount == 0) {
+        return;
+    }
+
+    for (uint32_t i = 1; i < ulCount; i++) {
+        uint32_t ulValue = pulSamples[i];
+        uint32_t j = i;
+
+        while (j > 0 && pulSamples[j - 1] > ulValue) {
+            pulSamples[j] = pulSamples[j - 1];
+            j--;
+        }
+        pulSamples[j] = ulValue;
+    }
+
+    pxResult = &xResults[ulResultCount++];
+    pxResult->pcName = pcName;
+    pxResult->ulMin = pulSamples[0];
+    pxResult->ulMedian = pulSamples[ulCount / 2];
+    pxResult->ulMax = pulSamples[ulCount - 1];
+    pxResult->ulSamples = ulCount;
+}
+
+/**
+ * @brief Cost of two back-to-back counter reads (subtracted from paired samples)
+ */
+static void vBenchCounterOverhead(void)
+{
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t ulStart = ulGetCycleCounter();
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        ulSamples[ulSampleCount++] = ulEnd - ulStart;
+    }
+    vBenchRecord("cycle_counter_overhead", ulSamples, ulSampleCount);
+    ulCounterOverhead = xResults[ulResultCount - 1].ulMin;
+}
+
+/**
+ * @brief Enter/leave pairs of the kernel critical section and the interrupt masks
+ *
+ * Called with the HAL mask already held, so these are the nested costs;
+ * the outermost vKernelEnterCritical() also saves the mask state.
+ */
+static void vBenchCriticalSections(void)
+{
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t ulStart = ulGetCycleCounter();
+        vKernelEnterCritical();
+        vKernelExitCritical();
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        vBenchSample(ulStart, ulEnd);
+    }
+    vBenchRecord("critical_section", ulSamples, ulSampleCount);
+
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t ulStart = ulGetCycleCounter();
+        uint32_t ulState = ulHalDisableInterrupts();
+        vHalRestoreInterrupts(ulState);
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        vBenchSample(ulStart, ulEnd);
+    }
+    vBenchRecord("irq_mask", ulSamples, ulSampleCount);
+
+#if defined(__arm__)
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t ulStart = ulGetCycleCounter();
+        uint32_t ulState;
+
+        __asm volatile ("mrs %0, primask\n"
+                        "cpsid i" : "=r" (ulState) : : "memory");
+        __asm volatile ("msr primask, %0" : : "r" (ulState) : "memory");
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        vBenchSample(ulStart, ulEnd);
+    }
+    vBenchRecord("irq_mask_primask", ulSamples, ulSampleCount);
+#endif
+}
+
+/**
+ * @brief xTaskCreatePeriodic() into an empty kernel, BENCH_TASKS at a time
+ */
+static void vBenchTaskCreate(void)
+{
+    ulSampleCount = 0;
+    while (ulSampleCount + BENCH_TASKS <= BENCH_MAX_SAMPLES && ulSampleCount < BENCH_SAMPLES) {
+        vBenchReset();
+        for (uint32_t i = 0; i < BENCH_TASKS; i++) {
+            uint32_t ulStart = ulGetCycleCounter();
+            TaskHandle_t xTask = xTaskCreatePeriodic(vBenchTaskNop, "Bench", DEFAULT_STACK_SIZE, NULL,
+                                                     BENCH_PERIOD_BASE + i, BENCH_PERIOD_BASE + i);
+            uint32_t ulEnd = ulGetCycleCounter();
+
+            if (xTask == NULL) {
+                vBoardExit(2);
+            }
+            vBenchSample(ulStart, ulEnd);
+        }
+    }
+    vBenchRecord("task_create", ulSamples, ulSampleCount);
+}
+
+/**
+ * @brief Ready-list scan with the top level ready, then with only the bottom one
+ */
+static void vBenchSchedulerDecision(void)
+{
+    TaskHandle_t pxTasks[BENCH_TASKS];
+    TaskHandle_t xLowest = NULL;
+
+    vBenchReset();
+    for (uint32_t i = 0; i < BENCH_TASKS; i++) {
+        pxTasks[i] = xTaskCreatePeriodic(vBenchTaskNop, "Bench", DEFAULT_STACK_SIZE, NULL,
+                                         BENCH_PERIOD_BASE + i, BENCH_PERIOD_BASE + i);
+        if (pxTasks[i] == NULL) {
+            vBoardExit(2);
+        }
+    }
+    vSchedulerInit();
+
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t ulStart = ulGetCycleCounter();
+        (void)vSchedulerGetNextTask();
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        vBenchSample(ulStart, ulEnd);
+    }
+    vBenchRecord("scheduler_decision_best", ulSamples, ulSampleCount);
+
+    /* Longest period, lowest priority */
+    for (uint32_t i = 0; i < BENCH_TASKS; i++) {
+        if (xLowest == NULL ||
+            ((TaskControlBlock_t *)pxTasks[i])->ulPriority > ((TaskControlBlock_t *)xLowest)->ulPriority) {
+            xLowest = pxTasks[i];
+        }
+    }
+    for (uint32_t i = 0; i < BENCH_TASKS; i++) {
+        if (pxTasks[i] != xLowest) {
+            vRemoveTaskFromReadyList(pxTasks[i]);
+        }
+    }
+
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t ulStart = ulGetCycleCounter();
+        (void)vSchedulerGetNextTask();
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        vBenchSample(ulStart, ulEnd);
+    }
+    vBenchRecord("scheduler_decision_worst", ulSamples, ulSampleCount);
+}
+
+/**
+ * @brief Tick handler cost with ulTasks tasks, without and with releases
+ *
+ * The highest priority task is made current so that no tick preempts it
+ * (that path is what isr_to_task measures).
+ */
+static void vBenchTick(uint32_t ulTasks, const char *pcIdleName, const char *pcReleaseName)
+{
+    TaskHandle_t pxTasks[BENCH_TASKS];
+    TaskHandle_t xTop;
+
+    vBenchReset();
+    for (uint32_t i = 0; i < ulTasks; i++) {
+        pxTasks[i] = xTaskCreatePeriodic(vBenchTaskNop, "Bench", DEFAULT_STACK_SIZE, NULL,
+                                         BENCH_PERIOD_BASE + i, BENCH_PERIOD_BASE + i);
+        if (pxTasks[i] == NULL) {
+            vBoardExit(2);
+        }
+    }
+    vSchedulerInit();
+    xTop = vSchedulerGetNextTask();
+    vSetCurrentTask(xTop);
+
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t ulStart = ulGetCycleCounter();
+        vSystemTickHandler();
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        vBenchSample(ulStart, ulEnd);
+    }
+    vBenchRecord(pcIdleName, ulSamples, ulSampleCount);
+
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        /* Every task finished its job and is due at the next tick */
+        for (uint32_t t = 0; t < ulTasks; t++) {
+            TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)pxTasks[t];
+
+            vRemoveTaskFromReadyList(pxTasks[t]);
+            pxTCB->eCurrentState = TASK_STATE_BLOCKED;
+            pxTCB->ulReleaseTime = ulGetSystemTick() + 1;
+        }
+        vSetCurrentTask(xTop);
+
+        uint32_t ulStart = ulGetCycleCounter();
+        vSystemTickHandler();
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        vBenchSample(ulStart, ulEnd);
+    }
+    vBenchRecord(pcReleaseName, ulSamples, ulSampleCount);
+}
+
+/**
+ * @brief Highest priority: sample how far into the tick period its job starts
+ *
+ * Only once the ping-pong is over, so the tick was never held off by it.
+ */
+static void vLatencyTask(void *pvParameters)
+{
+    uint32_t ulElapsed = ulGetTickElapsedCycles();
+
+    (void)pvParameters;
+
+    if (bSwitchDone && ulLatencyCount < BENCH_SAMPLES) {
+        ulLatencySamples[ulLatencyCount++] = ulElapsed;
+    }
+}
+
+/**
+ * @brief Drives the ping-pong with the tick masked throughout
+ *
+ * The current task is updated before each switch as vStartContextSwitch()
+ * would; a fresh Ping starts in TaskWrapper, which reads it.
+ */
+static void vPongTask(void *pvParameters)
+{
+    uint32_t ulState;
+
+    (void)pvParameters;
+
+    if (bSwitchDone) {
+        return;
+    }
+
+    ulState = ulHalDisableInterrupts();
+    ulSampleCount = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES / 2; i++) {
+        vSetCurrentTask(xPingHandle);
+        ulSwitchStart = ulGetCycleCounter();
+        vContextSwitch(xPongHandle, xPingHandle);
+
+        /* Ping -> Pong */
+        vBenchSample(ulSwitchStart, ulGetCycleCounter());
+    }
+    bSwitchDone = true;
+    vHalRestoreInterrupts(ulState);
+}
+
+/**
+ * @brief Bounces straight back to Pong until the ping-pong is over
+ */
+static void vPingTask(void *pvParameters)
+{
+    bool bFresh = true;
+
+    (void)pvParameters;
+
+    /* The host port starts a fresh task with the tick live */
+    (void)ulHalDisableInterrupts();
+
+    while (!bSwitchDone) {
+        /* Pong -> Ping; the first one started a fresh task and is not counted */
+        uint32_t ulEnd = ulGetCycleCounter();
+
+        if (!bFresh) {
+            vBenchSample(ulSwitchStart, ulEnd);
+        }
+        bFresh = false;
+
+        vSetCurrentTask(xPongHandle);
+        ulSwitchStart = ulGetCycleCounter();
+        vContextSwitch(xPingHandle, xPongHandle);
+    }
+
+    /* Resumed by the scheduler after Pong finished */
+    vHalRestoreInterrupts(0);
+}
+
+/**
+ * @brief Publish everything once the runtime samples are in, then exit
+ */
+static void vReportTask(void *pvParameters)
+{
+    uint32_t ulOffset = 0;
+
+    (void)pvParameters;
+
+    if (!bSwitchDone || ulLatencyCount < BENCH_SAMPLES) {
+        return;
+    }
+
+    /* Ping-pong samples are still in the shared buffer */
+    vBenchRecord("context_switch", ulSamples, ulSampleCount);
+    vBenchRecord("isr_to_task", ulLatencySamples, ulLatencyCount);
+
+    ulOffset = ulAppend(ulOffset, "{\n  \"board\": \"" BENCH_BOARD "\",\n  \"unit\": \"" BENCH_UNIT "\",\n");
+    ulOffset = ulAppend(ulOffset, "  \"code\": \"" BENCH_CODE "\",\n");
+    ulOffset = ulAppend(ulOffset, "  \"results\": {\n");
+    for (uint32_t i = 0; i < ulResultCount; i++) {
+        ulOffset = ulAppend(ulOffset, "    \"");
+        ulOffset = ulAppend(ulOffset, xResults[i].pcName);
+        ulOffset = ulAppend(ulOffset, "\": { \"min\": ");
+        ulOffset = ulAppendU32(ulOffset, xResults[i].ulMin);
+        ulOffset = ulAppend(ulOffset, ", \"median\": ");
+        ulOffset = ulAppendU32(ulOffset, xResults[i].ulMedian);
+        ulOffset = ulAppend(ulOffset, ", \"max\": ");
+        ulOffset = ulAppendU32(ulOffset, xResults[i].ulMax);
+        ulOffset = ulAppend(ulOffset, ", \"samples\": ");
+        ulOffset = ulAppendU32(ulOffset, xResults[i].ulSamples);
+        ulOffset = ulAppend(ulOffset, (i + 1 < ulResultCount) ? " },\n" : " }\n");
+    }
+    ulOffset = ulAppend(ulOffset, "  }\n}\n");
+
+    fwrite(pcReport, 1, ulOffset, stdout);
+    fflush(stdout);
+
+    vBoardExit(0);
+}
+
+/* Hand-rolled formatting: printf needs more stack than a task has */
+static uint32_t ulAppend(uint32_t ulOffset, const char *pcText)
+{
+    while (*pcText != '\0' && ulOffset < sizeof(pcReport) - 1) {
+        pcReport[ulOffset++] = *pcText++;
+    }
+    pcReport[ulOffset] = '\0';
+    return ulOffset;
+}
+
+static uint32_t ulAppendU32(uint32_t ulOffset, uint32_t ulValue)
+{
+    char pcDigits[11];
+    uint32_t ulLength = 0;
+
+    do {
+        pcDigits[ulLength++] = (char)('0' + ulValue % 10);
+        ulValue /= 10;
+    } while (ulValue != 0);
+
+    while (ulLength > 0 && ulOffset < sizeof(pcReport) - 1) {
+        pcReport[ulOffset++] = pcDigits[--ulLength];
+    }
+    pcReport[ulOffset] = '\0';
+    return ulOffset;
+}
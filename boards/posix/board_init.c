@@ -0,0 +1,161 @@
+/**
+ * @file board_init.c
+ * @brief Host (POSIX) board initialization and LED stubs
+ *
+ * The LEDs only exist as a bit mask. Set PERIODRTOS_LED_TRACE=1 to get one
+ * line per LED change on stderr, stamped with the kernel tick.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BOARD_LED_COUNT     8
+
+/* Nominal clock of the single profile: the host cycle counter counts ns */
+#define BOARD_CLOCK_HZ      1000000000UL
+
+/* LED state, bit n == LED n */
+static volatile uint32_t ulLedState = 0;
+static bool bLedTrace = false;
+
+/* Internal function prototypes */
+static void vLedTrace(uint32_t ulLed);
+
+/**
+ * @brief Initialize the host board
+ */
+void vBoardInit(void)
+{
+    const char *pcTrace = getenv("PERIODRTOS_LED_TRACE");
+
+    bLedTrace = (pcTrace != NULL && pcTrace[0] != '\0' && pcTrace[0] != '0');
+
+    /* Nothing to clock on the host */
+    vConfigureSystemClock();
+
+    /* Initialize GPIO for LEDs */
+    vInitGPIO();
+
+    /* Tick signal first: telemetry masks it around its bookkeeping */
+    vSystickInit();
+
+#if ENABLE_TELEMETRY_UART
+    /* Telemetry stream goes to PERIODRTOS_TELEMETRY_OUT */
+    vTelemetryInit();
+#endif
+
+    /* Initialize kernel */
+    vKernelInit();
+}
+
+/**
+ * @brief System clock configuration (no-op on the host)
+ */
+void vConfigureSystemClock(void)
+{
+}
+
+/**
+ * @brief One clock profile; the host runs at whatever speed it runs
+ */
+uint32_t ulClockProfileCount(void)
+{
+    return 1;
+}
+
+/**
+ * @brief SYSCLK of a profile in Hz, 0 if out of range
+ */
+uint32_t ulClockProfileHz(uint32_t ulProfile)
+{
+    return (ulProfile == 0) ? BOARD_CLOCK_HZ : 0;
+}
+
+/**
+ * @brief Profile the host is running from
+ */
+uint32_t ulClockGetProfile(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Nothing to switch; only profile 0 exists
+ */
+bool bClockSetProfile(uint32_t ulProfile)
+{
+    return ulProfile == 0;
+}
+
+/**
+ * @brief Initialize LED state
+ */
+void vInitGPIO(void)
+{
+    ulLedState = 0;
+}
+
+/**
+ * @brief Turn on LED
+ */
+void vLedOn(uint32_t ulLed)
+{
+    if (ulLed < BOARD_LED_COUNT) {
+        ulLedState |= (1UL << ulLed);
+        vLedTrace(ulLed);
+    }
+}
+
+/**
+ * @brief Turn off LED
+ */
+void vLedOff(uint32_t ulLed)
+{
+    if (ulLed < BOARD_LED_COUNT) {
+        ulLedState &= ~(1UL << ulLed);
+        vLedTrace(ulLed);
+    }
+}
+
+/**
+ * @brief Toggle LED
+ */
+void vLedToggle(uint32_t ulLed)
+{
+    if (ulLed < BOARD_LED_COUNT) {
+        ulLedState ^= (1UL << ulLed);
+        vLedTrace(ulLed);
+    }
+}
+
+/**
+ * @brief End the program (test and benchmark applications)
+ */
+void vBoardExit(int iStatus)
+{
+    fflush(stdout);
+    exit(iStatus);
+}
+
+/**
+ * @brief Report an LED change (write() only, tasks may be preempted anywhere)
+ */
+static void vLedTrace(uint32_t ulLed)
+{
+    char pcLine[48];
+    int iLength;
+
+    if (!bLedTrace) {
+        return;
+    }
+
+    iLength = snprintf(pcLine, sizeof(pcLine), "%lu LED%lu %s\n",
+                       (unsigned long)ulGetSystemTick(), (unsigned long)ulLed,
+                       (ulLedState & (1UL << ulLed)) ? "on" : "off");
+    if (iLength > 0) {
+        (void)!write(STDERR_FILENO, pcLine, (size_t)iLength);
+    }
+}
@@ -0,0 +1,533 @@
+/**
+ * @file port.c
+ * @brief POSIX host port: ucontext task switching and a signal-driven tick
+ *
+ * Every TCB slot owns a ucontext_t and host stacks to run on; the kernel's
+ * ulStackMemory is still carved up and canary-checked but never executed on.
+ * The tick is SIGALRM from ITIMER_REAL, or SIGVTALRM from ITIMER_VIRTUAL so
+ * that time only advances while the process is on a CPU. "Interrupts
+ * disabled" means both tick signals are blocked.
+ *
+ * Environment:
+ *   PERIODRTOS_CLOCK=real|virtual    tick source (default real)
+ *   PERIODRTOS_TICK_US=<n>           host microseconds per tick (default 1000)
+ *   PERIODRTOS_RUN_MS=<n>            stop after n ticks, print a report, exit
+ *   PERIODRTOS_TELEMETRY_OUT=<path>  file receiving the telemetry UART stream
+ *
+ * The profiler samples on SIGPROF from ITIMER_PROF. It is not a tick
+ * signal, so like the Cortex-M TIM2 interrupt it also lands inside kernel
+ * critical sections.
+ */
+
+#define _GNU_SOURCE
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include "heap.h"
+#include <ucontext.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#endif
+
+/* Host stack per task instance; generous so sanitizers and printf fit */
+#define PORT_HOST_STACK_SIZE    (256 * 1024)
+
+/* Region handed to the TLSF heap; glibc's malloc stays in place on the host */
+#define PORT_HEAP_SIZE          (64 * 1024)
+
+/* External variables */
+extern TaskControlBlock_t xTaskList[MAX_TASKS];
+extern uint32_t ulSystemTick;
+
+/* External function prototypes */
+extern void TaskWrapper(void);
+extern void vGetTaskInfo(TaskHandle_t xTask, char *pcBuffer, uint32_t ulBufferSize);
+extern void vGetSystemInfo(char *pcBuffer, uint32_t ulBufferSize);
+
+/* Task contexts, indexed by TCB slot */
+static ucontext_t xTaskContext[MAX_TASKS];
+static uint8_t ucHostStack[MAX_TASKS][2][PORT_HOST_STACK_SIZE] __attribute__((aligned(16)));
+static uint8_t ucHostStackIndex[MAX_TASKS];
+static ucontext_t xMainContext;
+
+/* Kernel heap region */
+static uint8_t ucHostHeap[PORT_HEAP_SIZE] __attribute__((aligned(16)));
+
+/* Tick source */
+static sigset_t xTickSignals;
+static int iTickSignal = SIGALRM;
+static int iTickTimer = ITIMER_REAL;
+static clockid_t xRunTimeClock = CLOCK_MONOTONIC;
+static uint32_t ulTickPeriodUs = 1000000 / SYSTICK_FREQ_HZ;
+static uint32_t ulRunLimit = 0;
+static volatile uint64_t ullLastTickNs = 0;    /* Run-time clock at the last tick */
+static volatile sig_atomic_t bPortStarted = 0;
+
+/* Telemetry "UART" */
+static int iUartFd = -1;
+static volatile sig_atomic_t bUartTxPending = 0;
+
+/* Internal function prototypes */
+static void vTickSignalHandler(int iSignal);
+static void vProfileSignalHandler(int iSignal, siginfo_t *pxInfo, void *pvContext);
+static void vPortTaskEntry(void);
+static ucontext_t *pxPrepareFreshContext(TaskControlBlock_t *pxTCB);
+static void vPortSetTimer(uint32_t ulPeriodUs);
+static void vPortReport(void);
+static uint64_t ullReadClockNs(clockid_t xClock);
+static uint32_t ulEnvToU32(const char *pcName, uint32_t ulDefault);
+
+/**
+ * @brief Configure the tick source (the timer is armed when the first task starts)
+ */
+void vSystickInit(void)
+{
+    struct sigaction xAction;
+    const char *pcClock = getenv("PERIODRTOS_CLOCK");
+
+    if (pcClock != NULL && strcmp(pcClock, "virtual") == 0) {
+        iTickSignal = SIGVTALRM;
+        iTickTimer = ITIMER_VIRTUAL;
+        xRunTimeClock = CLOCK_PROCESS_CPUTIME_ID;
+    }
+    ulTickPeriodUs = ulEnvToU32("PERIODRTOS_TICK_US", 1000000 / SYSTICK_FREQ_HZ);
+    if (ulTickPeriodUs == 0) {
+        ulTickPeriodUs = 1;
+    }
+    ulRunLimit = ulEnvToU32("PERIODRTOS_RUN_MS", 0);
+
+    sigemptyset(&xTickSignals);
+    sigaddset(&xTickSignals, SIGALRM);
+    sigaddset(&xTickSignals, SIGVTALRM);
+
+    memset(&xAction, 0, sizeof(xAction));
+    xAction.sa_handler = vTickSignalHandler;
+    xAction.sa_mask = xTickSignals;
+    xAction.sa_flags = SA_RESTART;
+    sigaction(iTickSignal, &xAction, NULL);
+
+    ullLastTickNs = ullReadClockNs(xRunTimeClock);
+}
+
+/**
+ * @brief Tick "interrupt"
+ */
+static void vTickSignalHandler(int iSignal)
+{
+    (void)iSignal;
+
+    if (!bPortStarted) {
+        return;
+    }
+
+    /* DMA completion has the lowest priority; deliver it first so the tick can preempt */
+    if (bUartTxPending) {
+        bUartTxPending = 0;
+        vTelemetryTxComplete();
+    }
+
+    if (ulRunLimit != 0 && ulSystemTick >= ulRunLimit) {
+        /* Abandon the running task and finish on the main stack */
+        vPortSetTimer(0);
+        bPortStarted = 0;
+        setcontext(&xMainContext);
+    }
+
+    /* Right before ulSystemTick advances, so the run-time counter cannot step back */
+    ullLastTickNs = ullReadClockNs(xRunTimeClock);
+    vSystemTickHandler();
+}
+
+/**
+ * @brief Start the first task; returns only when PERIODRTOS_RUN_MS expires
+ */
+void vInitialContextSwitch(TaskHandle_t xNext)
+{
+    ucontext_t *pxNextContext;
+
+    sigprocmask(SIG_BLOCK, &xTickSignals, NULL);
+
+    pxNextContext = pxPrepareFreshContext((TaskControlBlock_t *)xNext);
+
+    bPortStarted = 1;
+    vPortSetTimer(ulTickPeriodUs);
+
+    swapcontext(&xMainContext, pxNextContext);
+
+    /* Run limit reached */
+    vPortReport();
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Switch from the current to the next task
+ *
+ * Mirrors context_switch.S: a current task whose instance finished
+ * (taskFlags == 1) is not saved, and a fresh next task starts in TaskWrapper.
+ */
+void vContextSwitch(TaskHandle_t xCurrent, TaskHandle_t xNext)
+{
+    TaskControlBlock_t *pxCurrent = (TaskControlBlock_t *)xCurrent;
+    TaskControlBlock_t *pxNext = (TaskControlBlock_t *)xNext;
+    ucontext_t *pxNextContext;
+    sigset_t xPrevious;
+
+    /* Saved contexts always have the tick blocked; each restores its own mask */
+    sigprocmask(SIG_BLOCK, &xTickSignals, &xPrevious);
+
+    if (pxNext->taskFlags == 1) {
+        pxNextContext = pxPrepareFreshContext(pxNext);
+    } else {
+        pxNextContext = &xTaskContext[pxNext - xTaskList];
+    }
+
+    if (pxCurrent->taskFlags == 1) {
+        setcontext(pxNextContext);
+    } else {
+        swapcontext(&xTaskContext[pxCurrent - xTaskList], pxNextContext);
+    }
+
+    sigprocmask(SIG_SETMASK, &xPrevious, NULL);
+}
+
+/**
+ * @brief PendSV is not used on the host; switches happen synchronously
+ */
+void vTriggerContextSwitch(void)
+{
+}
+
+/**
+ * @brief Build a context that enters TaskWrapper on a clean host stack
+ *
+ * Two stacks alternate per slot because a task restarting its own instance
+ * is still running on the previous one. Stacks are static because this
+ * runs from the tick handler, where malloc() is off limits.
+ */
+static ucontext_t *pxPrepareFreshContext(TaskControlBlock_t *pxTCB)
+{
+    uint32_t ulSlot = (uint32_t)(pxTCB - xTaskList);
+    ucontext_t *pxContext = &xTaskContext[ulSlot];
+    uint8_t ucIndex = ucHostStackIndex[ulSlot] ^ 1;
+
+    ucHostStackIndex[ulSlot] = ucIndex;
+
+#if defined(__SANITIZE_ADDRESS__)
+    /* Frames of an abandoned instance never unwound; drop their redzones */
+    ASAN_UNPOISON_MEMORY_REGION(ucHostStack[ulSlot][ucIndex], PORT_HOST_STACK_SIZE);
+#endif
+
+    getcontext(pxContext);
+    pxContext->uc_stack.ss_sp = ucHostStack[ulSlot][ucIndex];
+    pxContext->uc_stack.ss_size = PORT_HOST_STACK_SIZE;
+    pxContext->uc_link = NULL;
+    makecontext(pxContext, vPortTaskEntry, 0);
+
+    return pxContext;
+}
+
+/**
+ * @brief First code of every task instance on the host
+ */
+static void vPortTaskEntry(void)
+{
+    /* Equivalent of returning from the switch: the tick is live again */
+    sigprocmask(SIG_UNBLOCK, &xTickSignals, NULL);
+
+    /* TaskWrapper only returns if the idle task finished and is re-selected */
+    for (;;) {
+        TaskWrapper();
+    }
+}
+
+/**
+ * @brief Arm (or with 0, stop) the periodic tick timer
+ */
+static void vPortSetTimer(uint32_t ulPeriodUs)
+{
+    struct itimerval xTimer;
+
+    xTimer.it_interval.tv_sec = ulPeriodUs / 1000000;
+    xTimer.it_interval.tv_usec = ulPeriodUs % 1000000;
+    xTimer.it_value = xTimer.it_interval;
+    setitimer(iTickTimer, &xTimer, NULL);
+}
+
+/**
+ * @brief Free-running microsecond counter for run-time accounting
+ *
+ * Kernel ticks plus the host time since the last tick was delivered,
+ * scaled so one tick period reads as one kernel tick. The fraction stays
+ * below one tick, so the counter follows ulSystemTick (a late or
+ * coalesced signal delays it rather than letting it run ahead) and never
+ * steps back when a masked tick is finally delivered.
+ */
+uint32_t ulGetRunTimeCounter(void)
+{
+    volatile uint32_t *pulTick = &ulSystemTick;
+    uint32_t ulTick;
+    uint64_t ullSinceTickNs;
+    uint64_t ullTickNs = (uint64_t)ulTickPeriodUs * 1000;
+
+    /* Re-read if the tick signal ran in between */
+    do {
+        ulTick = *pulTick;
+        ullSinceTickNs = ullReadClockNs(xRunTimeClock) - ullLastTickNs;
+    } while (ulTick != *pulTick);
+
+    if (ullSinceTickNs >= ullTickNs) {
+        ullSinceTickNs = ullTickNs - 1;
+    }
+    return ulTick * (1000000 / SYSTICK_FREQ_HZ) +
+           (uint32_t)(ullSinceTickNs * (1000000 / SYSTICK_FREQ_HZ) / ullTickNs);
+}
+
+/**
+ * @brief Microseconds since the current tick period began
+ *
+ * Host time since the last tick was delivered, scaled like
+ * ulGetRunTimeCounter(). A tick signal that a critical section holds back
+ * counts one period, as a pending SysTick does on Cortex-M, so the result
+ * then lies in the following period instead of stopping short of it.
+ */
+uint32_t ulGetTickElapsedUs(void)
+{
+    sigset_t xPending;
+    uint64_t ullTickNs = (uint64_t)ulTickPeriodUs * 1000;
+    uint64_t ullSinceTickNs = ullReadClockNs(xRunTimeClock) - ullLastTickNs;
+    uint64_t ullLimitNs = ullTickNs - 1;
+
+    sigpending(&xPending);
+    if (bPortStarted && sigismember(&xPending, iTickSignal)) {
+        ullLimitNs += ullTickNs;
+        if (ullSinceTickNs < ullTickNs) {
+            ullSinceTickNs = ullTickNs;
+        }
+    }
+    if (ullSinceTickNs > ullLimitNs) {
+        ullSinceTickNs = ullLimitNs;
+    }
+    return (uint32_t)(ullSinceTickNs * (1000000 / SYSTICK_FREQ_HZ) / ullTickNs);
+}
+
+/**
+ * @brief Nothing to start; the host clock always runs
+ */
+void vCycleCounterInit(void)
+{
+}
+
+/**
+ * @brief Host "cycle" counter in nanoseconds of the run-time clock
+ */
+uint32_t ulGetCycleCounter(void)
+{
+    return (uint32_t)ullReadClockNs(xRunTimeClock);
+}
+
+/**
+ * @brief Nanoseconds since the current tick period began
+ */
+uint32_t ulGetTickElapsedCycles(void)
+{
+    struct itimerval xTimer;
+    uint64_t ullRemainingUs;
+
+    getitimer(iTickTimer, &xTimer);
+    ullRemainingUs = (uint64_t)xTimer.it_value.tv_sec * 1000000 + (uint64_t)xTimer.it_value.tv_usec;
+    if (ullRemainingUs > ulTickPeriodUs) {
+        ullRemainingUs = ulTickPeriodUs;
+    }
+    return (uint32_t)((ulTickPeriodUs - ullRemainingUs) * 1000);
+}
+
+/**
+ * @brief Block the tick, returning 1 if it was already blocked
+ */
+uint32_t ulHalDisableInterrupts(void)
+{
+    sigset_t xPrevious;
+
+    sigprocmask(SIG_BLOCK, &xTickSignals, &xPrevious);
+    return sigismember(&xPrevious, iTickSignal) ? 1 : 0;
+}
+
+/**
+ * @brief Restore the state saved by ulHalDisableInterrupts()
+ */
+void vHalRestoreInterrupts(uint32_t ulState)
+{
+    if (ulState == 0) {
+        sigprocmask(SIG_UNBLOCK, &xTickSignals, NULL);
+    }
+}
+
+/**
+ * @brief Profiler "interrupt": sample the PC the signal interrupted
+ *
+ * x86-64 has no link register, so its samples carry the PC only. The host
+ * cannot tell the tick handler from a critical section, so
+ * PROFILE_SAMPLE_HANDLER is never set here.
+ */
+static void vProfileSignalHandler(int iSignal, siginfo_t *pxInfo, void *pvContext)
+{
+    const ucontext_t *pxContext = (const ucontext_t *)pvContext;
+
+    (void)iSignal;
+    (void)pxInfo;
+
+#if defined(__x86_64__)
+    vProfilerSample((uintptr_t)pxContext->uc_mcontext.gregs[REG_RIP], 0, 0);
+#elif defined(__aarch64__)
+    vProfilerSample((uintptr_t)pxContext->uc_mcontext.pc,
+                    (uintptr_t)pxContext->uc_mcontext.regs[30], PROFILE_SAMPLE_LR);
+#else
+    (void)pxContext;
+#endif
+}
+
+/**
+ * @brief Start or retune the sampling signal
+ */
+void vProfilerTimerStart(uint32_t ulSampleHz)
+{
+    struct sigaction xAction;
+    struct itimerval xTimer;
+    uint32_t ulPeriodUs = 1000000 / ulSampleHz;
+
+    memset(&xAction, 0, sizeof(xAction));
+    xAction.sa_sigaction = vProfileSignalHandler;
+    sigemptyset(&xAction.sa_mask);
+    xAction.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigaction(SIGPROF, &xAction, NULL);
+
+    if (ulPeriodUs == 0) {
+        ulPeriodUs = 1;
+    }
+    xTimer.it_interval.tv_sec = ulPeriodUs / 1000000;
+    xTimer.it_interval.tv_usec = ulPeriodUs % 1000000;
+    xTimer.it_value = xTimer.it_interval;
+    setitimer(ITIMER_PROF, &xTimer, NULL);
+}
+
+/**
+ * @brief Stop the sampling signal
+ */
+void vProfilerTimerStop(void)
+{
+    struct itimerval xTimer;
+
+    memset(&xTimer, 0, sizeof(xTimer));
+    setitimer(ITIMER_PROF, &xTimer, NULL);
+}
+
+/**
+ * @brief Nothing to follow; host time does not scale with a core clock
+ */
+void vProfilerTimerClockChanged(void)
+{
+}
+
+/**
+ * @brief Heap region for the TLSF allocator
+ */
+void vBoardHeapRegion(void **ppvStart, size_t *pxSize)
+{
+    *ppvStart = ucHostHeap;
+    *pxSize = sizeof(ucHostHeap);
+}
+
+/**
+ * @brief Open the telemetry sink named by PERIODRTOS_TELEMETRY_OUT
+ */
+void vUartDmaInit(uint32_t ulBaudRate)
+{
+    const char *pcPath = getenv("PERIODRTOS_TELEMETRY_OUT");
+
+    (void)ulBaudRate;
+
+    if (pcPath != NULL && pcPath[0] != '\0') {
+        iUartFd = open(pcPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+}
+
+/**
+ * @brief Write a transfer out; its completion "interrupt" fires on the next tick
+ */
+void vUartDmaStart(const uint8_t *pucData, uint32_t ulLength)
+{
+    while (iUartFd >= 0 && ulLength > 0) {
+        ssize_t lWritten = write(iUartFd, pucData, ulLength);
+
+        if (lWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        pucData += lWritten;
+        ulLength -= (uint32_t)lWritten;
+    }
+
+    bUartTxPending = 1;
+}
+
+/**
+ * @brief Print system and task statistics at the end of a timed run
+ */
+static void vPortReport(void)
+{
+    char pcBuffer[512];
+    uint32_t ulMisses = 0;
+
+    vGetSystemInfo(pcBuffer, sizeof(pcBuffer));
+    printf("%s", pcBuffer);
+
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        TaskControlBlock_t *pxTCB = &xTaskList[i];
+
+        if (pxTCB->pxTaskCode == NULL) {
+            continue;
+        }
+        ulMisses += pxTaskDetail(pxTCB)->ulDeadlineMissCount;
+        pcBuffer[0] = '\0';    /* The idle task (ID 0) is not reported */
+        vGetTaskInfo((TaskHandle_t)pxTCB, pcBuffer, sizeof(pcBuffer));
+        printf("%s", pcBuffer);
+    }
+
+    printf("Ran %lu ticks, %lu deadline misses\n",
+           (unsigned long)ulSystemTick, (unsigned long)ulMisses);
+    fflush(stdout);
+
+    if (iUartFd >= 0) {
+        close(iUartFd);
+    }
+}
+
+static uint64_t ullReadClockNs(clockid_t xClock)
+{
+    struct timespec xNow;
+
+    clock_gettime(xClock, &xNow);
+    return (uint64_t)xNow.tv_sec * 1000000000ULL + (uint64_t)xNow.tv_nsec;
+}
+
+static uint32_t ulEnvToU32(const char *pcName, uint32_t ulDefault)
+{
+    const char *pcValue = getenv(pcName);
+
+    if (pcValue == NULL || pcValue[0] == '\0') {
+        return ulDefault;
+    }
+    return (uint32_t)strtoul(pcValue, NULL, 0);
+}
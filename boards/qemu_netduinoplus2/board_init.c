@@ -0,0 +1,162 @@
+/**
+ * @file board_init.c
+ * @brief QEMU netduinoplus2 (STM32F405, Cortex-M4F) board for emulated runs
+ *
+ * Runs the STM32F303 image (same flash/RAM origins and core peripherals)
+ * under qemu-system-arm -M netduinoplus2. Only the Cortex-M core is used:
+ * the console and exit go through semihosting, LEDs are a bit mask and the
+ * telemetry "UART" discards frames. QEMU has no DWT, so the cycle counter is
+ * derived from SysTick (PERIODRTOS_CYCLE_COUNTER_SYSTICK), which follows the
+ * virtual clock and is deterministic with -icount.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "semihosting.h"
+#include "stm32f303xx.h"
+
+/* SYSCLK of QEMU's STM32F405 model */
+#define QEMU_SYSCLK_HZ      168000000UL
+
+#define BOARD_LED_COUNT     8
+
+/* External variables */
+extern uint32_t SystemCoreClock;
+
+/* LED state, bit n == LED n */
+static volatile uint32_t ulLedState = 0;
+
+/**
+ * @brief Initialize the emulated board
+ */
+void vBoardInit(void)
+{
+    /* Watchdog and clock registers are unimplemented (RAZ/WI) in QEMU */
+    SystemInit();
+
+    /* SysTick counts the emulated SYSCLK */
+    vConfigureSystemClock();
+
+    /* Initialize GPIO for LEDs */
+    vInitGPIO();
+
+#if ENABLE_TELEMETRY_UART
+    vTelemetryInit();
+#endif
+
+    /* Initialize Systick */
+    vSystickInit();
+
+    /* Initialize kernel */
+    vKernelInit();
+}
+
+/**
+ * @brief No LED hardware; keep the state only
+ */
+void vInitGPIO(void)
+{
+    ulLedState = 0;
+}
+
+/**
+ * @brief Turn on LED
+ */
+void vLedOn(uint32_t ulLed)
+{
+    if (ulLed < BOARD_LED_COUNT) {
+        ulLedState |= (1UL << ulLed);
+    }
+}
+
+/**
+ * @brief Turn off LED
+ */
+void vLedOff(uint32_t ulLed)
+{
+    if (ulLed < BOARD_LED_COUNT) {
+        ulLedState &= ~(1UL << ulLed);
+    }
+}
+
+/**
+ * @brief Toggle LED
+ */
+void vLedToggle(uint32_t ulLed)
+{
+    if (ulLed < BOARD_LED_COUNT) {
+        ulLedState ^= (1UL << ulLed);
+    }
+}
+
+/**
+ * @brief Leave QEMU with the given exit status
+ */
+void vBoardExit(int iStatus)
+{
+    vSemihostingExit(iStatus);
+}
+
+/**
+ * @brief One clock profile: the model's fixed SYSCLK
+ */
+uint32_t ulClockProfileCount(void)
+{
+    return 1;
+}
+
+/**
+ * @brief SYSCLK of a profile in Hz, 0 if out of range
+ */
+uint32_t ulClockProfileHz(uint32_t ulProfile)
+{
+    return (ulProfile == 0) ? QEMU_SYSCLK_HZ : 0;
+}
+
+/**
+ * @brief Profile the core is running from
+ */
+uint32_t ulClockGetProfile(void)
+{
+    return 0;
+}
+
+/**
+ * @brief RCC is not modelled; only publish the clock
+ */
+bool bClockSetProfile(uint32_t ulProfile)
+{
+    if (ulProfile != 0) {
+        return false;
+    }
+
+    SystemCoreClock = QEMU_SYSCLK_HZ;
+    vSystemClockChanged();
+    return true;
+}
+
+/**
+ * @brief Telemetry has no UART here; frames are discarded
+ */
+void vUartDmaInit(uint32_t ulBaudRate)
+{
+    (void)ulBaudRate;
+}
+
+/**
+ * @brief "Transmit" instantly so the transport never stalls
+ */
+void vUartDmaStart(const uint8_t *pucData, uint32_t ulLength)
+{
+    (void)pucData;
+    (void)ulLength;
+
+    vTelemetryTxComplete();
+}
+
+/**
+ * @brief No baud rate to follow
+ */
+void vUartDmaClockChanged(void)
+{
+}
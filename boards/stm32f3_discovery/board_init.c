@@ -4,6 +4,7 @@
  */
 
 #include "periodRTOS.h"
+#include "telemetry.h"
 #include "stm32f303xx.h"
 
 /* External variables */
@@ -17,11 +18,16 @@ void vBoardInit(void)
     /* Enable system clock */
     SystemInit();
     
-    /* Keep default HSI at 8MHz for F3 for now */
+    /* Fastest clock profile: 72 MHz from HSE bypass, else 64 MHz from HSI */
     vConfigureSystemClock();
     
     /* Initialize GPIO for LEDs */
     vInitGPIO();
+
+#if ENABLE_TELEMETRY_UART
+    /* USART1 + DMA telemetry transport */
+    vTelemetryInit();
+#endif
     
     /* Initialize Systick */
     vSystickInit();
@@ -30,7 +36,7 @@ void vBoardInit(void)
     vKernelInit();
 }
 
-/* vConfigureSystemClock is now implemented in src/hal/stm32_hal.c */
+/* vConfigureSystemClock is implemented in src/hal/stm32_hal.c, profiles in clock.c */
 
 /**
  * @brief Initialize GPIO for LEDs
@@ -105,3 +111,18 @@ void vLedToggle(uint32_t ulLed)
         case 7: GPIOE->ODR ^= GPIO_ODR_OD15; break;
     }
 }
+
+/**
+ * @brief Stop the application (test and benchmark applications)
+ *
+ * There is nothing to return to on the board: mask interrupts and sleep.
+ */
+void vBoardExit(int iStatus)
+{
+    (void)iStatus;
+    
+    (void)ulHalDisableInterrupts();
+    for (;;) {
+        __asm volatile ("wfi");
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * @file clock.c
+ * @brief STM32F3 Discovery clock profiles
+ *
+ * Up to 64 MHz the PLL runs from HSI/2. 72 MHz needs the 8 MHz clock the
+ * ST-LINK drives into OSC_IN (HSE bypass); without it that profile fails
+ * and the board stays on the next slower one. Flash needs one wait state
+ * per 24 MHz, APB1 is limited to 36 MHz and APB2 (USART1) runs at SYSCLK.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "stm32f303xx.h"
+
+/* Ready-flag polls before an oscillator or the PLL is given up on */
+#define CLOCK_READY_TIMEOUT     50000
+
+typedef struct {
+    uint32_t ulHz;                   /* SYSCLK */
+    uint32_t ulPllSource;            /* RCC_CFGR_PLLSRC_* */
+    uint32_t ulPllMul;               /* PLL multiplier, 0 = HSI without PLL */
+    uint32_t ulLatency;              /* Flash wait states */
+    uint32_t ulApb1;                 /* RCC_CFGR_PPRE1_* */
+} ClockProfile_t;
+
+static const ClockProfile_t xClockProfiles[] = {
+    {  8000000UL, RCC_CFGR_PLLSRC_HSI_DIV2,    0, 0, RCC_CFGR_PPRE1_DIV1 },
+    { 16000000UL, RCC_CFGR_PLLSRC_HSI_DIV2,    4, 0, RCC_CFGR_PPRE1_DIV1 },
+    { 24000000UL, RCC_CFGR_PLLSRC_HSI_DIV2,    6, 0, RCC_CFGR_PPRE1_DIV1 },
+    { 32000000UL, RCC_CFGR_PLLSRC_HSI_DIV2,    8, 1, RCC_CFGR_PPRE1_DIV1 },
+    { 48000000UL, RCC_CFGR_PLLSRC_HSI_DIV2,   12, 1, RCC_CFGR_PPRE1_DIV2 },
+    { 64000000UL, RCC_CFGR_PLLSRC_HSI_DIV2,   16, 2, RCC_CFGR_PPRE1_DIV2 },
+    { 72000000UL, RCC_CFGR_PLLSRC_HSE_PREDIV,  9, 2, RCC_CFGR_PPRE1_DIV2 },
+};
+#define CLOCK_PROFILE_COUNT     (sizeof(xClockProfiles) / sizeof(xClockProfiles[0]))
+
+/* Reset state: HSI, no PLL */
+static uint32_t ulCurrentProfile = 0;
+static bool bHseMissing = false;
+
+/* Internal function prototypes */
+static bool bWaitFor(volatile uint32_t *pulRegister, uint32_t ulMask, uint32_t ulValue);
+static void vSetFlashLatency(uint32_t ulLatency);
+
+/**
+ * @brief Number of clock profiles
+ */
+uint32_t ulClockProfileCount(void)
+{
+    return CLOCK_PROFILE_COUNT;
+}
+
+/**
+ * @brief SYSCLK of a profile in Hz, 0 if out of range
+ */
+uint32_t ulClockProfileHz(uint32_t ulProfile)
+{
+    return (ulProfile < CLOCK_PROFILE_COUNT) ? xClockProfiles[ulProfile].ulHz : 0;
+}
+
+/**
+ * @brief Profile the core is running from
+ */
+uint32_t ulClockGetProfile(void)
+{
+    return ulCurrentProfile;
+}
+
+/**
+ * @brief Switch SYSCLK to a profile
+ *
+ * SYSCLK is parked on HSI while the PLL is reprogrammed, with interrupts
+ * masked for the PLL lock time (well under a tick). If the oscillator or
+ * the PLL does not come up the core is left on HSI (profile 0) and false
+ * is returned; an absent HSE is remembered so it is not waited on again.
+ */
+bool bClockSetProfile(uint32_t ulProfile)
+{
+    const ClockProfile_t *pxProfile;
+    uint32_t ulState;
+    bool bLocked = true;
+
+    if (ulProfile >= CLOCK_PROFILE_COUNT) {
+        return false;
+    }
+    pxProfile = &xClockProfiles[ulProfile];
+    if (pxProfile->ulPllSource == RCC_CFGR_PLLSRC_HSE_PREDIV && pxProfile->ulPllMul != 0 && bHseMissing) {
+        return false;
+    }
+
+    ulState = ulHalDisableInterrupts();
+
+    /* Enough wait states for the faster of the old and new clock */
+    if (pxProfile->ulLatency > (FLASH->ACR & FLASH_ACR_LATENCY_Msk)) {
+        vSetFlashLatency(pxProfile->ulLatency);
+    }
+
+    /* Run from HSI while the PLL is off */
+    RCC->CR |= RCC_CR_HSION;
+    (void)bWaitFor(&RCC->CR, RCC_CR_HSIRDY, RCC_CR_HSIRDY);
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW_Msk) | RCC_CFGR_SW_HSI;
+    (void)bWaitFor(&RCC->CFGR, RCC_CFGR_SWS_Msk, RCC_CFGR_SWS_HSI);
+    RCC->CR &= ~RCC_CR_PLLON;
+    (void)bWaitFor(&RCC->CR, RCC_CR_PLLRDY, 0);
+
+    if (pxProfile->ulPllMul != 0) {
+        if (pxProfile->ulPllSource == RCC_CFGR_PLLSRC_HSE_PREDIV) {
+            RCC->CR |= RCC_CR_HSEBYP | RCC_CR_HSEON;
+            bLocked = bWaitFor(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY);
+            bHseMissing = !bLocked;
+        }
+        if (bLocked) {
+            RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_PLLSRC_Msk | RCC_CFGR_PLLMUL_Msk | RCC_CFGR_HPRE_Msk |
+                                       RCC_CFGR_PPRE1_Msk | RCC_CFGR_PPRE2_Msk)) |
+                        pxProfile->ulPllSource | RCC_CFGR_PLLMUL(pxProfile->ulPllMul) |
+                        RCC_CFGR_HPRE_DIV1 | pxProfile->ulApb1 | RCC_CFGR_PPRE2_DIV1;
+            RCC->CR |= RCC_CR_PLLON;
+            bLocked = bWaitFor(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY);
+        }
+        if (bLocked) {
+            RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW_Msk) | RCC_CFGR_SW_PLL;
+            bLocked = bWaitFor(&RCC->CFGR, RCC_CFGR_SWS_Msk, RCC_CFGR_SWS_PLL);
+        }
+        if (!bLocked) {
+            RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW_Msk) | RCC_CFGR_SW_HSI;
+            RCC->CR &= ~RCC_CR_PLLON;
+            ulProfile = 0;
+            pxProfile = &xClockProfiles[0];
+        }
+    }
+    if (pxProfile->ulPllMul == 0) {
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE_Msk | RCC_CFGR_PPRE1_Msk | RCC_CFGR_PPRE2_Msk)) |
+                    RCC_CFGR_HPRE_DIV1 | pxProfile->ulApb1 | RCC_CFGR_PPRE2_DIV1;
+    }
+
+    /* HSEBYP is only writable with HSE off */
+    if (pxProfile->ulPllMul == 0 || pxProfile->ulPllSource != RCC_CFGR_PLLSRC_HSE_PREDIV) {
+        RCC->CR &= ~RCC_CR_HSEON;
+        RCC->CR &= ~RCC_CR_HSEBYP;
+    }
+
+    /* Drop surplus wait states once the clock is slower */
+    vSetFlashLatency(pxProfile->ulLatency);
+
+    ulCurrentProfile = ulProfile;
+    SystemCoreClock = pxProfile->ulHz;
+    vSystemClockChanged();
+
+    vHalRestoreInterrupts(ulState);
+    return bLocked;
+}
+
+/**
+ * @brief Poll until (*pulRegister & ulMask) == ulValue or the timeout expires
+ */
+static bool bWaitFor(volatile uint32_t *pulRegister, uint32_t ulMask, uint32_t ulValue)
+{
+    for (uint32_t i = 0; i < CLOCK_READY_TIMEOUT; i++) {
+        if ((*pulRegister & ulMask) == ulValue) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Program flash wait states with the prefetch buffer on
+ */
+static void vSetFlashLatency(uint32_t ulLatency)
+{
+    FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY_Msk) | FLASH_ACR_PRFTBE |
+                 (ulLatency << FLASH_ACR_LATENCY_Pos);
+
+    /* The new setting must be in effect before the clock changes */
+    while ((FLASH->ACR & FLASH_ACR_LATENCY_Msk) != (ulLatency << FLASH_ACR_LATENCY_Pos)) {
+    }
+}
@@ -17,6 +17,8 @@
 void Reset_Handler(void);
 void DefaultHandler(void);
 void TIM2_Handler (void) __attribute__ ((weak));
+void DMA1_Channel4_IRQHandler (void) __attribute__ ((weak, alias ("DefaultHandler")));
+void TIM2_IRQHandler (void) __attribute__ ((weak, alias ("DefaultHandler")));
 void SysTick_Handler (void) __attribute__ ((weak));
 void NMI_Handler (void) __attribute__ ((weak));
 void PendSV_Handler (void) __attribute__ ((weak));
@@ -26,8 +28,13 @@ void HardFaultHandler(void);
 extern unsigned char  _sidata;
 extern unsigned char  _sdata;
 extern unsigned char  _edata;
+extern unsigned char  _siramfunc;
+extern unsigned char  _sramfunc;
+extern unsigned char  _eramfunc;
 extern unsigned char  __bss_start__;
 extern unsigned char  __bss_end__;
+extern unsigned char  _skernel_bss;
+extern unsigned char  _ekernel_bss;
 
 // Vectors is placed at the beginning of flash by the linker
 // Using the __attribute((section(".vectors"))) we can instruct
@@ -64,7 +71,7 @@ const void * Vectors[] __attribute__((section(".isr_vector"))) ={
 	DefaultHandler, 	/* DMA_CH4_5 */
 	DefaultHandler,		/* ADC_COMP */
 	DefaultHandler,  	/* TIM1_BRK_UP_TRG_COM */
-	DefaultHandler, 	/* TIM1_CC */
+	DMA1_Channel4_IRQHandler, 	/* DMA1_CH4 (F303 IRQ 14, USART1_TX) */
 	TIM2_Handler, 	    /* TIM2 */
 	DefaultHandler, 	/* TIM3 */
 	DefaultHandler, 	/* TIM6_DAC */
@@ -78,7 +85,7 @@ const void * Vectors[] __attribute__((section(".isr_vector"))) ={
 	DefaultHandler, 	/* SPI1 */
 	DefaultHandler, 	/* SPI2 */
 	DefaultHandler, 	/* USART1 */
-	DefaultHandler, 	/* USART2 */
+	TIM2_IRQHandler, 	/* TIM2 (F303 IRQ 28, profiler) */
 	DefaultHandler, 	/* RESERVED */
 	DefaultHandler, 	/* CEC */
 	DefaultHandler 		/* RESERVED */
@@ -92,8 +99,9 @@ const void * Vectors[] __attribute__((section(".isr_vector"))) ={
  * 
  * 1. Get the addresses from our linker symbols
  * 2. Copy contents of flash to sram
- * 3. Zero the .bss section
- * 4. Call main()
+ * 3. Copy the .ramfunc code to its RAM
+ * 4. Zero the .bss and .kernel_bss sections
+ * 5. Call main()
  */
 void Reset_Handler()
 {
@@ -108,6 +116,12 @@ void Reset_Handler()
 	//memcpy(dest, src, len);
 	while (len--) *(dest++) = *(src++);
 	
+	// copy the kernel hot paths (.ramfunc) to RAM before anything calls them
+	src= &_siramfunc;
+	dest= &_sramfunc;
+	len= &_eramfunc-&_sramfunc;
+	while (len--) *(dest++) = *(src++);
+
 	// zero out the uninitialized global/static variable locations
 	dest = &__bss_start__;
 	len = &__bss_end__ - &__bss_start__;
@@ -115,6 +129,11 @@ void Reset_Handler()
 	//memset(dest, 0, len);
 	while (len--) *(dest++) = 0;
 
+	// zero the kernel objects, which the board may place outside .bss
+	dest = &_skernel_bss;
+	len = &_ekernel_bss - &_skernel_bss;
+	while (len--) *(dest++) = 0;
+
 	//Jump to application
 	asm ("bl main");
 }
@@ -30,7 +30,7 @@ void vBoardInit(void)
     vKernelInit();
 }
 
-/* vConfigureSystemClock is now implemented in src/hal/stm32_hal.c */
+/* vConfigureSystemClock is implemented in src/hal/stm32_hal.c, profiles in clock.c */
 
 /**
  * @brief Initialize GPIO for LEDs
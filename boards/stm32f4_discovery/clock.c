@@ -0,0 +1,173 @@
+/**
+ * @file clock.c
+ * @brief STM32F4 Discovery clock profiles
+ *
+ * The PLL runs from the board's 8 MHz crystal with a 1 MHz VCO input
+ * (PLLM = 8). Flash wait states follow the 2.7-3.6 V table (one per
+ * 30 MHz) with the ART accelerator (prefetch, instruction and data cache)
+ * enabled; APB1 stays at or below 42 MHz and APB2 at or below 84 MHz.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "stm32f4xx.h"
+
+/* Ready-flag polls before an oscillator or the PLL is given up on */
+#define CLOCK_READY_TIMEOUT     50000
+
+#define CLOCK_HSI_HZ            16000000UL
+#define CLOCK_PLLM              8           /* 8 MHz HSE / 8 = 1 MHz VCO input */
+
+typedef struct {
+    uint32_t ulHz;                   /* SYSCLK */
+    uint32_t ulPllN;                 /* VCO multiplier, 0 = HSI without PLL */
+    uint32_t ulPllP;                 /* SYSCLK divider (2, 4, 6 or 8) */
+    uint32_t ulPllQ;                 /* 48 MHz domain divider */
+    uint32_t ulLatency;              /* Flash wait states */
+    uint32_t ulApb1;                 /* RCC_CFGR_PPRE1_* */
+    uint32_t ulApb2;                 /* RCC_CFGR_PPRE2_* */
+} ClockProfile_t;
+
+static const ClockProfile_t xClockProfiles[] = {
+    {  CLOCK_HSI_HZ,   0, 0, 0, 0, RCC_CFGR_PPRE1_DIV1, RCC_CFGR_PPRE2_DIV1 },
+    {  48000000UL, 192, 4, 4, 1, RCC_CFGR_PPRE1_DIV2, RCC_CFGR_PPRE2_DIV1 },
+    {  84000000UL, 336, 4, 7, 2, RCC_CFGR_PPRE1_DIV2, RCC_CFGR_PPRE2_DIV1 },
+    { 120000000UL, 240, 2, 5, 3, RCC_CFGR_PPRE1_DIV4, RCC_CFGR_PPRE2_DIV2 },
+    { 168000000UL, 336, 2, 7, 5, RCC_CFGR_PPRE1_DIV4, RCC_CFGR_PPRE2_DIV2 },
+};
+#define CLOCK_PROFILE_COUNT     (sizeof(xClockProfiles) / sizeof(xClockProfiles[0]))
+
+/* Reset state: HSI, no PLL */
+static uint32_t ulCurrentProfile = 0;
+static bool bHseMissing = false;
+
+/* Internal function prototypes */
+static bool bWaitFor(volatile uint32_t *pulRegister, uint32_t ulMask, uint32_t ulValue);
+static void vSetFlashLatency(uint32_t ulLatency);
+
+/**
+ * @brief Number of clock profiles
+ */
+uint32_t ulClockProfileCount(void)
+{
+    return CLOCK_PROFILE_COUNT;
+}
+
+/**
+ * @brief SYSCLK of a profile in Hz, 0 if out of range
+ */
+uint32_t ulClockProfileHz(uint32_t ulProfile)
+{
+    return (ulProfile < CLOCK_PROFILE_COUNT) ? xClockProfiles[ulProfile].ulHz : 0;
+}
+
+/**
+ * @brief Profile the core is running from
+ */
+uint32_t ulClockGetProfile(void)
+{
+    return ulCurrentProfile;
+}
+
+/**
+ * @brief Switch SYSCLK to a profile
+ *
+ * Same sequence as the F3 board: park on HSI, reprogram and relock the
+ * PLL with interrupts masked, fall back to HSI (profile 0) on failure.
+ * The regulator is left in scale 1 (reset default), which 168 MHz needs.
+ */
+bool bClockSetProfile(uint32_t ulProfile)
+{
+    const ClockProfile_t *pxProfile;
+    uint32_t ulState;
+    bool bLocked = true;
+
+    if (ulProfile >= CLOCK_PROFILE_COUNT) {
+        return false;
+    }
+    pxProfile = &xClockProfiles[ulProfile];
+    if (pxProfile->ulPllN != 0 && bHseMissing) {
+        return false;
+    }
+
+    ulState = ulHalDisableInterrupts();
+
+    if (pxProfile->ulLatency > (FLASH->ACR & FLASH_ACR_LATENCY)) {
+        vSetFlashLatency(pxProfile->ulLatency);
+    }
+
+    RCC->CR |= RCC_CR_HSION;
+    (void)bWaitFor(&RCC->CR, RCC_CR_HSIRDY, RCC_CR_HSIRDY);
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_HSI;
+    (void)bWaitFor(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_HSI);
+    RCC->CR &= ~RCC_CR_PLLON;
+    (void)bWaitFor(&RCC->CR, RCC_CR_PLLRDY, 0);
+
+    if (pxProfile->ulPllN != 0) {
+        RCC->CR |= RCC_CR_HSEON;
+        bLocked = bWaitFor(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY);
+        bHseMissing = !bLocked;
+
+        if (bLocked) {
+            RCC->PLLCFGR = RCC_PLLCFGR_PLLSRC_HSE |
+                           (CLOCK_PLLM << RCC_PLLCFGR_PLLM_Pos) |
+                           (pxProfile->ulPllN << RCC_PLLCFGR_PLLN_Pos) |
+                           (((pxProfile->ulPllP / 2) - 1) << RCC_PLLCFGR_PLLP_Pos) |
+                           (pxProfile->ulPllQ << RCC_PLLCFGR_PLLQ_Pos);
+            RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) |
+                        RCC_CFGR_HPRE_DIV1 | pxProfile->ulApb1 | pxProfile->ulApb2;
+            RCC->CR |= RCC_CR_PLLON;
+            bLocked = bWaitFor(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY);
+        }
+        if (bLocked) {
+            RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+            bLocked = bWaitFor(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_PLL);
+        }
+        if (!bLocked) {
+            RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_HSI;
+            RCC->CR &= ~RCC_CR_PLLON;
+            ulProfile = 0;
+            pxProfile = &xClockProfiles[0];
+        }
+    }
+    if (pxProfile->ulPllN == 0) {
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) |
+                    RCC_CFGR_HPRE_DIV1 | pxProfile->ulApb1 | pxProfile->ulApb2;
+        RCC->CR &= ~RCC_CR_HSEON;
+    }
+
+    vSetFlashLatency(pxProfile->ulLatency);
+
+    ulCurrentProfile = ulProfile;
+    SystemCoreClock = pxProfile->ulHz;
+    vSystemClockChanged();
+
+    vHalRestoreInterrupts(ulState);
+    return bLocked;
+}
+
+/**
+ * @brief Poll until (*pulRegister & ulMask) == ulValue or the timeout expires
+ */
+static bool bWaitFor(volatile uint32_t *pulRegister, uint32_t ulMask, uint32_t ulValue)
+{
+    for (uint32_t i = 0; i < CLOCK_READY_TIMEOUT; i++) {
+        if ((*pulRegister & ulMask) == ulValue) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Program flash wait states with the ART accelerator on
+ */
+static void vSetFlashLatency(uint32_t ulLatency)
+{
+    FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) |
+                 FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN |
+                 (ulLatency << FLASH_ACR_LATENCY_Pos);
+
+    while ((FLASH->ACR & FLASH_ACR_LATENCY) != (ulLatency << FLASH_ACR_LATENCY_Pos)) {
+    }
+}
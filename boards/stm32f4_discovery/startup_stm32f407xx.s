@@ -136,6 +136,23 @@ LoopCopyDataInit:
     cmp r4, r1
     bcc CopyDataInit
 
+    /* Copy the kernel hot paths (.ramfunc) from flash to RAM */
+    ldr r0, =_sramfunc
+    ldr r1, =_eramfunc
+    ldr r2, =_siramfunc
+    movs r3, #0
+    b LoopCopyRamfunc
+
+CopyRamfunc:
+    ldr r4, [r2, r3]
+    str r4, [r0, r3]
+    adds r3, r3, #4
+
+LoopCopyRamfunc:
+    adds r4, r0, r3
+    cmp r4, r1
+    bcc CopyRamfunc
+
     /* Zero fill BSS */
     ldr r2, =_sbss
     ldr r4, =_ebss
@@ -149,6 +166,19 @@ LoopFillZerobss:
     cmp r2, r4
     bcc FillZerobss
 
+    /* Zero fill the kernel objects (.kernel_bss, in CCM RAM) */
+    ldr r2, =_skernel_bss
+    ldr r4, =_ekernel_bss
+    movs r3, #0
+    b LoopFillZeroKernel
+
+FillZeroKernel:
+    str r3, [r2], #4
+
+LoopFillZeroKernel:
+    cmp r2, r4
+    bcc FillZeroKernel
+
     /* Call SystemInit */
     bl SystemInit
 
@@ -0,0 +1,107 @@
+# Print how much of each memory region of the linker script an image uses,
+# and which output sections use it.
+#
+#   cmake -DOBJDUMP=<objdump> -DELF=<image.elf> -DLINKER_SCRIPT=<script.ld>
+#         [-DOUTPUT=<report.txt>] -P region_report.cmake
+#
+# Sections count in the region of their run address; sections copied from
+# flash at reset (.data, .ramfunc) also count in the region they load from.
+
+cmake_minimum_required(VERSION 3.16)
+
+if(NOT OBJDUMP OR NOT ELF OR NOT LINKER_SCRIPT)
+    message(FATAL_ERROR "OBJDUMP, ELF and LINKER_SCRIPT are required")
+endif()
+
+# Regions from the MEMORY block: NAME (attributes) : ORIGIN = 0x..., LENGTH = 40K
+file(READ "${LINKER_SCRIPT}" REGION_SCRIPT)
+string(REGEX MATCH "MEMORY[ \t\r\n]*{[^}]*}" REGION_BLOCK "${REGION_SCRIPT}")
+string(REGEX MATCHALL "[A-Za-z_][A-Za-z0-9_]*[ \t]*\\([^)]*\\)[ \t]*:[ \t]*ORIGIN[ \t]*=[ \t]*0x[0-9A-Fa-f]+[ \t]*,[ \t]*LENGTH[ \t]*=[ \t]*[0-9]+[KM]?"
+       REGION_LINES "${REGION_BLOCK}")
+
+set(REGION_NAMES "")
+foreach(REGION_LINE ${REGION_LINES})
+    string(REGEX REPLACE "^([A-Za-z0-9_]+).*ORIGIN[ \t]*=[ \t]*(0x[0-9A-Fa-f]+).*LENGTH[ \t]*=[ \t]*([0-9]+)([KM]?)$"
+           "\\1;\\2;\\3;\\4" REGION_FIELDS "${REGION_LINE}")
+    list(GET REGION_FIELDS 0 REGION_NAME)
+    list(GET REGION_FIELDS 1 REGION_ORIGIN)
+    list(GET REGION_FIELDS 2 REGION_LENGTH)
+    list(GET REGION_FIELDS 3 REGION_UNIT)
+    if(REGION_UNIT STREQUAL "K")
+        math(EXPR REGION_LENGTH "${REGION_LENGTH} * 1024")
+    elseif(REGION_UNIT STREQUAL "M")
+        math(EXPR REGION_LENGTH "${REGION_LENGTH} * 1024 * 1024")
+    endif()
+    math(EXPR REGION_START_${REGION_NAME} "${REGION_ORIGIN}")
+    math(EXPR REGION_END_${REGION_NAME} "${REGION_START_${REGION_NAME}} + ${REGION_LENGTH}")
+    set(REGION_LENGTH_${REGION_NAME} ${REGION_LENGTH})
+    set(REGION_USED_${REGION_NAME} 0)
+    set(REGION_SECTIONS_${REGION_NAME} "")
+    list(APPEND REGION_NAMES ${REGION_NAME})
+endforeach()
+if(NOT REGION_NAMES)
+    message(FATAL_ERROR "no MEMORY regions in ${LINKER_SCRIPT}")
+endif()
+
+execute_process(
+    COMMAND ${OBJDUMP} -h "${ELF}"
+    OUTPUT_VARIABLE REGION_HEADERS
+    RESULT_VARIABLE REGION_STATUS
+)
+if(NOT REGION_STATUS EQUAL 0)
+    message(FATAL_ERROR "${OBJDUMP} -h ${ELF} failed (${REGION_STATUS})")
+endif()
+
+# Add a section of ulSize bytes at ulAddress to the region containing it
+function(region_account pcSection ulAddress ulSize pcNote)
+    foreach(REGION_NAME ${REGION_NAMES})
+        if(ulAddress GREATER_EQUAL REGION_START_${REGION_NAME} AND ulAddress LESS REGION_END_${REGION_NAME})
+            math(EXPR REGION_USED "${REGION_USED_${REGION_NAME}} + ${ulSize}")
+            set(REGION_USED_${REGION_NAME} ${REGION_USED} PARENT_SCOPE)
+            set(REGION_SECTIONS_${REGION_NAME} "${REGION_SECTIONS_${REGION_NAME}} ${pcSection} ${ulSize}${pcNote}," PARENT_SCOPE)
+            return()
+        endif()
+    endforeach()
+endfunction()
+
+# objdump -h: "Idx Name Size VMA LMA File-off Algn", then a line of flags
+string(REPLACE "\n" ";" REGION_HEADER_LINES "${REGION_HEADERS}")
+set(REGION_SECTION "")
+foreach(REGION_HEADER_LINE ${REGION_HEADER_LINES})
+    if(REGION_HEADER_LINE MATCHES "^ *[0-9]+ +([^ ]+) +([0-9a-fA-F]+) +([0-9a-fA-F]+) +([0-9a-fA-F]+) ")
+        set(REGION_SECTION ${CMAKE_MATCH_1})
+        math(EXPR REGION_SIZE "0x${CMAKE_MATCH_2}")
+        math(EXPR REGION_VMA "0x${CMAKE_MATCH_3}")
+        math(EXPR REGION_LMA "0x${CMAKE_MATCH_4}")
+    elseif(REGION_SECTION AND REGION_HEADER_LINE MATCHES "ALLOC")
+        if(REGION_SIZE GREATER 0)
+            region_account(${REGION_SECTION} ${REGION_VMA} ${REGION_SIZE} "")
+            if(REGION_HEADER_LINE MATCHES "LOAD" AND NOT REGION_LMA EQUAL REGION_VMA)
+                region_account(${REGION_SECTION} ${REGION_LMA} ${REGION_SIZE} " (load)")
+            endif()
+        endif()
+        set(REGION_SECTION "")
+    else()
+        set(REGION_SECTION "")
+    endif()
+endforeach()
+
+get_filename_component(REGION_IMAGE "${ELF}" NAME)
+set(REGION_REPORT "Memory regions of ${REGION_IMAGE}:\n")
+foreach(REGION_NAME ${REGION_NAMES})
+    math(EXPR REGION_PERMILLE "${REGION_USED_${REGION_NAME}} * 1000 / ${REGION_LENGTH_${REGION_NAME}}")
+    math(EXPR REGION_PERCENT "${REGION_PERMILLE} / 10")
+    math(EXPR REGION_TENTHS "${REGION_PERMILLE} % 10")
+    string(REGEX REPLACE ",$" "" REGION_LIST "${REGION_SECTIONS_${REGION_NAME}}")
+    if(REGION_LIST)
+        set(REGION_LIST ":${REGION_LIST}")
+    endif()
+    string(APPEND REGION_REPORT
+           "  ${REGION_NAME}: ${REGION_USED_${REGION_NAME}} of ${REGION_LENGTH_${REGION_NAME}} bytes"
+           " (${REGION_PERCENT}.${REGION_TENTHS}%)${REGION_LIST}\n")
+endforeach()
+
+message("${REGION_REPORT}")
+if(OUTPUT)
+    file(WRITE "${OUTPUT}" "${REGION_REPORT}")
+endif()
@@ -0,0 +1,234 @@
+# Worst-case stack depth of task entry functions from GCC call graphs
+# (-fstack-usage -fcallgraph-info=su), written as stack size constants.
+#
+#   cmake -DCALLGRAPHS=<a.c.o;b.c.o;...> -DENTRIES=<vTask1;vTask2;...>
+#         -DOUTPUT=<task_stack_sizes.h> [-DSWITCH_BYTES=<n>]
+#         [-DEXCEPTION_FRAME_BYTES=<n>] [-DISR_NESTING=<n>]
+#         [-DKNOWN_CALLS=<fn=bytes;...>] [-DHOST_STACKS=1] [-DREPORT=<report.txt>]
+#         -P stack_sizes.cmake
+#
+# CALLGRAPHS are the analysis objects; each has its .ci file beside it.
+# A task's stack must hold, at its deepest call:
+#   - its own call chain, entered from TaskWrapper;
+#   - the context switch: an exception frame, the SWITCH_BYTES the port
+#     saves and the scheduler call made on the outgoing task's stack;
+#   - ISR_NESTING interrupts stacked on top, each an exception frame plus
+#     one of the deepest *_Handler / *_IRQHandler call chains.
+# Functions without a call graph (assembly, libraries) need an entry in
+# KNOWN_CALLS; a later entry for the same name wins. A task that reaches an unknown function, an indirect call,
+# recursion or a dynamically sized frame has no bound and keeps
+# DEFAULT_STACK_SIZE. A task that needs more than MAX_STACK_SIZE fails the
+# build, unless HOST_STACKS says the port runs tasks on stacks of its own:
+# then it is reported and given MAX_STACK_SIZE. The header is only
+# rewritten when its content changes.
+
+cmake_minimum_required(VERSION 3.16)
+
+if(NOT CALLGRAPHS OR NOT OUTPUT)
+    message(FATAL_ERROR "CALLGRAPHS and OUTPUT are required")
+endif()
+foreach(STACK_DEFAULT SWITCH_BYTES EXCEPTION_FRAME_BYTES ISR_NESTING HOST_STACKS)
+    if(NOT DEFINED ${STACK_DEFAULT})
+        set(${STACK_DEFAULT} 0)
+    endif()
+endforeach()
+
+# Nodes "title" with "N bytes (static)" are defined functions; edges are calls
+set(STACK_FUNCTIONS "")
+foreach(STACK_OBJECT IN LISTS CALLGRAPHS)
+    string(REGEX REPLACE "\\.o(bj)?$" ".ci" STACK_GRAPH "${STACK_OBJECT}")
+    if(NOT EXISTS "${STACK_GRAPH}")
+        message(FATAL_ERROR "No call graph ${STACK_GRAPH}")
+    endif()
+    file(STRINGS "${STACK_GRAPH}" STACK_LINES)
+    foreach(STACK_LINE IN LISTS STACK_LINES)
+        if(STACK_LINE MATCHES "^node: { title: \"([^\"]+)\" label: \"[^\"]*\\\\n([0-9]+) bytes \\(([a-z,]+)\\)\"")
+            set(STACK_NAME "${CMAKE_MATCH_1}")
+            set(STACK_BYTES ${CMAKE_MATCH_2})
+            if(NOT CMAKE_MATCH_3 STREQUAL "static")
+                set(STACK_DYNAMIC_${STACK_NAME} TRUE)
+            endif()
+            set(STACK_FRAME_${STACK_NAME} ${STACK_BYTES})
+            list(APPEND STACK_FUNCTIONS "${STACK_NAME}")
+            # Static functions are titled <file>:<name>; entries may use the name
+            if(STACK_NAME MATCHES ":([A-Za-z_][A-Za-z0-9_]*)$")
+                list(APPEND STACK_LOCAL_${CMAKE_MATCH_1} "${STACK_NAME}")
+            endif()
+        elseif(STACK_LINE MATCHES "^edge: { sourcename: \"([^\"]+)\" targetname: \"([^\"]+)\"")
+            list(APPEND STACK_CALLS_${CMAKE_MATCH_1} "${CMAKE_MATCH_2}")
+        endif()
+    endforeach()
+endforeach()
+list(REMOVE_DUPLICATES STACK_FUNCTIONS)
+
+foreach(STACK_KNOWN IN LISTS KNOWN_CALLS)
+    if(NOT STACK_KNOWN MATCHES "^([A-Za-z_][A-Za-z0-9_.]*)=([0-9]+)$")
+        message(FATAL_ERROR "KNOWN_CALLS entry '${STACK_KNOWN}' is not name=bytes")
+    endif()
+    set(STACK_DEPTH_${CMAKE_MATCH_1} ${CMAKE_MATCH_2})
+endforeach()
+
+# Deepest call chain from pcFunction, memoized in STACK_DEPTH_<name>;
+# STACK_UNBOUNDED_<name> names the first reason there is no bound
+function(stack_depth pcFunction)
+    if(DEFINED STACK_DEPTH_${pcFunction} OR DEFINED STACK_UNBOUNDED_${pcFunction})
+        return()
+    endif()
+    if(pcFunction STREQUAL "__indirect_call")
+        set(STACK_UNBOUNDED_${pcFunction} "an indirect call" PARENT_SCOPE)
+        return()
+    endif()
+    if(NOT DEFINED STACK_FRAME_${pcFunction})
+        set(STACK_UNBOUNDED_${pcFunction} "${pcFunction}() without a call graph" PARENT_SCOPE)
+        return()
+    endif()
+    if(STACK_DYNAMIC_${pcFunction})
+        set(STACK_UNBOUNDED_${pcFunction} "the dynamic frame of ${pcFunction}()" PARENT_SCOPE)
+        return()
+    endif()
+
+    set(STACK_VISITING_${pcFunction} TRUE)
+    set(ulDeepest 0)
+    foreach(pcCallee IN LISTS STACK_CALLS_${pcFunction})
+        if(STACK_VISITING_${pcCallee})
+            set(STACK_UNBOUNDED_${pcFunction} "recursion through ${pcCallee}()" PARENT_SCOPE)
+            return()
+        endif()
+        stack_depth(${pcCallee})
+        if(DEFINED STACK_UNBOUNDED_${pcCallee})
+            set(STACK_UNBOUNDED_${pcCallee} "${STACK_UNBOUNDED_${pcCallee}}" PARENT_SCOPE)
+            set(STACK_UNBOUNDED_${pcFunction} "${STACK_UNBOUNDED_${pcCallee}}" PARENT_SCOPE)
+            return()
+        endif()
+        set(STACK_DEPTH_${pcCallee} ${STACK_DEPTH_${pcCallee}} PARENT_SCOPE)
+        if(STACK_DEPTH_${pcCallee} GREATER ulDeepest)
+            set(ulDeepest ${STACK_DEPTH_${pcCallee}})
+        endif()
+    endforeach()
+    math(EXPR ulDepth "${STACK_FRAME_${pcFunction}} + ${ulDeepest}")
+    set(STACK_DEPTH_${pcFunction} ${ulDepth} PARENT_SCOPE)
+endfunction()
+
+# Code that runs on every task stack: the wrapper, the switch, the handlers.
+# If any of it has no bound, STACK_PORT_UNBOUNDED says why and no task has one.
+
+# TaskWrapper calls the entry indirectly; its other calls run at its own depth
+set(STACK_WRAPPER_FRAME 0)
+set(STACK_WRAPPER_DEPTH 0)
+if(DEFINED STACK_FRAME_TaskWrapper)
+    set(STACK_WRAPPER_FRAME ${STACK_FRAME_TaskWrapper})
+    set(STACK_WRAPPER_DEPTH ${STACK_FRAME_TaskWrapper})
+    list(REMOVE_ITEM STACK_CALLS_TaskWrapper "__indirect_call")
+    foreach(STACK_CALLEE IN LISTS STACK_CALLS_TaskWrapper)
+        stack_depth(${STACK_CALLEE})
+        if(DEFINED STACK_UNBOUNDED_${STACK_CALLEE})
+            set(STACK_PORT_UNBOUNDED "TaskWrapper reaches ${STACK_UNBOUNDED_${STACK_CALLEE}}")
+            break()
+        endif()
+        math(EXPR STACK_CANDIDATE "${STACK_FRAME_TaskWrapper} + ${STACK_DEPTH_${STACK_CALLEE}}")
+        if(STACK_CANDIDATE GREATER STACK_WRAPPER_DEPTH)
+            set(STACK_WRAPPER_DEPTH ${STACK_CANDIDATE})
+        endif()
+    endforeach()
+endif()
+
+# Context switch on the outgoing task's stack
+set(STACK_SCHEDULER 0)
+if(DEFINED STACK_FRAME_vSchedulerGetNextTask)
+    stack_depth(vSchedulerGetNextTask)
+    if(DEFINED STACK_UNBOUNDED_vSchedulerGetNextTask)
+        set(STACK_PORT_UNBOUNDED "vSchedulerGetNextTask reaches ${STACK_UNBOUNDED_vSchedulerGetNextTask}")
+    else()
+        set(STACK_SCHEDULER ${STACK_DEPTH_vSchedulerGetNextTask})
+    endif()
+endif()
+math(EXPR STACK_SWITCH "${EXCEPTION_FRAME_BYTES} + ${SWITCH_BYTES} + ${STACK_SCHEDULER}")
+
+# Interrupts: the ISR_NESTING deepest handlers, each with its exception frame
+set(STACK_HANDLER_DEPTHS "")
+foreach(STACK_FUNCTION IN LISTS STACK_FUNCTIONS)
+    if(STACK_FUNCTION MATCHES "_(IRQ)?Handler$")
+        stack_depth(${STACK_FUNCTION})
+        if(DEFINED STACK_UNBOUNDED_${STACK_FUNCTION})
+            set(STACK_PORT_UNBOUNDED "${STACK_FUNCTION} reaches ${STACK_UNBOUNDED_${STACK_FUNCTION}}")
+            continue()
+        endif()
+        # Zero-padded so the string sort is numeric
+        string(LENGTH "${STACK_DEPTH_${STACK_FUNCTION}}" STACK_DIGITS)
+        math(EXPR STACK_PAD "10 - ${STACK_DIGITS}")
+        string(REPEAT "0" ${STACK_PAD} STACK_ZEROS)
+        list(APPEND STACK_HANDLER_DEPTHS "${STACK_ZEROS}${STACK_DEPTH_${STACK_FUNCTION}}")
+    endif()
+endforeach()
+list(SORT STACK_HANDLER_DEPTHS ORDER DESCENDING)
+set(STACK_ISR 0)
+foreach(STACK_LEVEL RANGE 1 ${ISR_NESTING})
+    if(ISR_NESTING EQUAL 0)
+        break()
+    endif()
+    set(STACK_HANDLER 0)
+    if(STACK_HANDLER_DEPTHS)
+        list(POP_FRONT STACK_HANDLER_DEPTHS STACK_HANDLER)
+        string(REGEX REPLACE "^0+([0-9])" "\\1" STACK_HANDLER "${STACK_HANDLER}")
+    endif()
+    math(EXPR STACK_ISR "${STACK_ISR} + ${EXCEPTION_FRAME_BYTES} + ${STACK_HANDLER}")
+endforeach()
+
+set(STACK_HEADER "/* Generated by cmake/stack_sizes.cmake from the call graph, do not edit */\n\n")
+string(APPEND STACK_HEADER "#ifndef TASK_STACK_SIZES_H\n#define TASK_STACK_SIZES_H\n\n")
+string(APPEND STACK_HEADER "/* Context switch ${STACK_SWITCH} bytes, ${ISR_NESTING} nested interrupts ${STACK_ISR} bytes */\n")
+set(STACK_REPORT "Task stacks (call chain + switch ${STACK_SWITCH} + interrupts ${STACK_ISR} bytes):\n")
+foreach(STACK_ENTRY IN LISTS ENTRIES)
+    set(STACK_FUNCTION "${STACK_ENTRY}")
+    if(NOT DEFINED STACK_FRAME_${STACK_ENTRY} AND DEFINED STACK_LOCAL_${STACK_ENTRY})
+        list(LENGTH STACK_LOCAL_${STACK_ENTRY} STACK_MATCHES)
+        if(STACK_MATCHES GREATER 1)
+            message(FATAL_ERROR "${STACK_ENTRY} is static in several files: ${STACK_LOCAL_${STACK_ENTRY}}")
+        endif()
+        set(STACK_FUNCTION "${STACK_LOCAL_${STACK_ENTRY}}")
+    endif()
+    stack_depth(${STACK_FUNCTION})
+    if(DEFINED STACK_UNBOUNDED_${STACK_FUNCTION})
+        set(STACK_UNBOUNDED_${STACK_ENTRY} "${STACK_UNBOUNDED_${STACK_FUNCTION}}")
+    else()
+        set(STACK_DEPTH_${STACK_ENTRY} ${STACK_DEPTH_${STACK_FUNCTION}})
+    endif()
+    # Every task pays for the wrapper, the switch and the interrupts
+    if(DEFINED STACK_PORT_UNBOUNDED AND NOT DEFINED STACK_UNBOUNDED_${STACK_ENTRY})
+        set(STACK_UNBOUNDED_${STACK_ENTRY} "${STACK_PORT_UNBOUNDED}")
+    endif()
+    if(DEFINED STACK_UNBOUNDED_${STACK_ENTRY})
+        string(APPEND STACK_HEADER "#define STACK_SIZE_${STACK_ENTRY} DEFAULT_STACK_SIZE /* unbounded: ${STACK_UNBOUNDED_${STACK_ENTRY}} */\n")
+        string(APPEND STACK_REPORT "  ${STACK_ENTRY}: unbounded (${STACK_UNBOUNDED_${STACK_ENTRY}}), DEFAULT_STACK_SIZE\n")
+        message(WARNING "${STACK_ENTRY}: no stack bound, ${STACK_UNBOUNDED_${STACK_ENTRY}}")
+        continue()
+    endif()
+    math(EXPR STACK_TASK "${STACK_WRAPPER_FRAME} + ${STACK_DEPTH_${STACK_ENTRY}}")
+    if(STACK_WRAPPER_DEPTH GREATER STACK_TASK)
+        set(STACK_TASK ${STACK_WRAPPER_DEPTH})
+    endif()
+    # Stacks are 8-byte aligned (AAPCS), so sizes are whole double words
+    math(EXPR STACK_SIZE "(${STACK_TASK} + ${STACK_SWITCH} + ${STACK_ISR} + 7) / 8 * 8")
+    string(APPEND STACK_HEADER "#define STACK_SIZE_${STACK_ENTRY} ${STACK_SIZE} /* call chain ${STACK_TASK} */\n")
+    string(APPEND STACK_HEADER "#if STACK_SIZE_${STACK_ENTRY} > MAX_STACK_SIZE\n")
+    if(HOST_STACKS)
+        string(APPEND STACK_HEADER "#undef STACK_SIZE_${STACK_ENTRY} /* runs on the port's host stack */\n")
+        string(APPEND STACK_HEADER "#define STACK_SIZE_${STACK_ENTRY} MAX_STACK_SIZE\n#endif\n")
+    else()
+        string(APPEND STACK_HEADER "#error \"${STACK_ENTRY} needs more than MAX_STACK_SIZE\"\n#endif\n")
+    endif()
+    string(APPEND STACK_REPORT "  ${STACK_ENTRY}: ${STACK_SIZE} bytes (call chain ${STACK_TASK})\n")
+endforeach()
+string(APPEND STACK_HEADER "\n#endif /* TASK_STACK_SIZES_H */\n")
+
+message("${STACK_REPORT}")
+if(REPORT)
+    file(WRITE "${REPORT}" "${STACK_REPORT}")
+endif()
+
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" STACK_PREVIOUS)
+endif()
+if(NOT STACK_PREVIOUS STREQUAL STACK_HEADER)
+    file(WRITE "${OUTPUT}" "${STACK_HEADER}")
+endif()
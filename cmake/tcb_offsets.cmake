@@ -0,0 +1,30 @@
+# Turn the "->NAME value" markers of the compiled tcb_offsets.c into a header.
+#
+#   cmake -DINPUT=<tcb_offsets.s> -DOUTPUT=<tcb_offsets.h> -P tcb_offsets.cmake
+#
+# Immediates print as #8 (ARM) or $8 (x86); the prefix is dropped. The
+# header is only rewritten when its content changes.
+
+if(NOT INPUT OR NOT OUTPUT)
+    message(FATAL_ERROR "INPUT and OUTPUT are required")
+endif()
+
+file(STRINGS "${INPUT}" TCB_MARKERS REGEX "->[A-Z_]+ [#$]?-?[0-9]+")
+if(NOT TCB_MARKERS)
+    message(FATAL_ERROR "No offset markers in ${INPUT}")
+endif()
+
+set(TCB_HEADER "/* Generated from src/kernel/tcb_offsets.c, do not edit */\n\n")
+string(APPEND TCB_HEADER "#ifndef TCB_OFFSETS_H\n#define TCB_OFFSETS_H\n\n")
+foreach(TCB_MARKER IN LISTS TCB_MARKERS)
+    string(REGEX REPLACE ".*->([A-Z_]+) [#$]?(-?[0-9]+).*" "#define \\1 \\2" TCB_DEFINE "${TCB_MARKER}")
+    string(APPEND TCB_HEADER "${TCB_DEFINE}\n")
+endforeach()
+string(APPEND TCB_HEADER "\n#endif /* TCB_OFFSETS_H */\n")
+
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" TCB_PREVIOUS)
+endif()
+if(NOT TCB_PREVIOUS STREQUAL TCB_HEADER)
+    file(WRITE "${OUTPUT}" "${TCB_HEADER}")
+endif()
@@ -4,7 +4,8 @@
  */
 
 #include "periodRTOS.h"
-#include "stm32f303xx.h"
+#include "telemetry.h"
+#include "profiler.h"
 
 #define NULL 0
 
@@ -19,6 +20,12 @@ static void vTask2(void *pvParameters);
 static void vTask3(void *pvParameters);
 //static void vIdleTask(void *pvParameters);
 
+/* Shared stack pool for exactly the stacks main() creates */
+TASK_STACK_POOL(TASK_STACK_SIZE(vIdleTask),
+                STACK_POOL_WORDS(TASK_STACK_SIZE(vTask1)) +
+                STACK_POOL_WORDS(TASK_STACK_SIZE(vTask2)) +
+                STACK_POOL_WORDS(TASK_STACK_SIZE(vTask3)));
+
 /**
  * @brief Task 1 - High frequency task (100ms period)
  */
@@ -78,7 +85,7 @@ static void vTask2(void *pvParameters)
 static void vTask3(void *pvParameters)
 {
     uint32_t ulTask3Counter = 0;
-    char pcBuffer[256];
+    static const char pcHeartbeat[] = "Task3: publishing snapshot\n";
     
     while (1) {
         /* Task 3 work - toggle LED 2 */
@@ -89,18 +96,18 @@ static void vTask3(void *pvParameters)
         
         ulTask3Counter++;
         
-        /* Print task information every 10 iterations */
+        /* Publish task information every 10 iterations */
         if (ulTask3Counter % 10 == 0) {
-            //vGetTaskInfo(xTask1Handle, pcBuffer, sizeof(pcBuffer));
-            /* In a real system, this would be sent via UART */
-            
-            //vGetTaskInfo(xTask2Handle, pcBuffer, sizeof(pcBuffer));
-            /* In a real system, this would be sent via UART */
-            
-            //vGetTaskInfo(xTask3Handle, pcBuffer, sizeof(pcBuffer));
-            /* In a real system, this would be sent via UART */
+            /* Non-blocking: frames are queued for the UART DMA */
+            bTelemetrySend(TELEMETRY_CHANNEL_LOG, pcHeartbeat, sizeof(pcHeartbeat) - 1);
+            bTelemetrySendSnapshot();
         }
 
+#if ENABLE_PROFILER
+        /* Drain the sample ring once a period, before it fills */
+        bProfilerFlush();
+#endif
+
         vLedOff(2);
         
         /* Yield to other tasks */
@@ -152,17 +159,17 @@ int main(void)
     /* Initialize board */
     vBoardInit();
     
-    /* Create periodic tasks */
+    /* Create periodic tasks, stacks sized from their call graphs */
     xTask1Handle = xTaskCreatePeriodic(vTask1, "Task1", 
-                                      512, NULL, 
+                                      TASK_STACK_SIZE(vTask1), NULL, 
                                       100, 80);  /* 100ms period, 80ms deadline */
     
     xTask2Handle = xTaskCreatePeriodic(vTask2, "Task2", 
-                                      512, NULL, 
+                                      TASK_STACK_SIZE(vTask2), NULL, 
                                       500, 400); /* 500ms period, 400ms deadline */
     
     xTask3Handle = xTaskCreatePeriodic(vTask3, "Task3", 
-                                      512, NULL, 
+                                      TASK_STACK_SIZE(vTask3), NULL, 
                                       1000, 800); /* 1000ms period, 800ms deadline */
     
     /* Check if tasks were created successfully */
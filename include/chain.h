@@ -0,0 +1,83 @@
+/**
+ * @file chain.h
+ * @brief End-to-end latency of cause-effect task chains
+ *
+ * A chain is an ordered list of periodic tasks that pass data along, e.g.
+ * sensor -> filter -> controller -> actuator, each at its own period. The
+ * head task stamps the data it produces with vChainStamp(); every stage
+ * copies the ChainStamp_t along with the data it forwards, and the tail
+ * task hands the stamp of the data it acted on to vChainConsume().
+ *
+ * Times come from the scheduler: a stamp's origin is the release of the
+ * head job that produced the data, and the effect happens at the
+ * completion of the tail job that consumed it. At that completion the
+ * kernel records, per chain:
+ *
+ * - data age: completion minus origin, for every tail job that consumed
+ *   a stamp;
+ * - reaction latency: for the first tail job to act on a new origin,
+ *   completion minus the head release before that origin. An external
+ *   event arriving just after the earlier release is first seen by the
+ *   newer one, so this is the longest the chain took to react to it.
+ *
+ * Both are kept as a maximum and a histogram of CHAIN_HISTOGRAM_BUCKETS
+ * power-of-two buckets in microseconds. Changing a period in the chain
+ * shows up directly in these numbers, not only in per-task response times.
+ */
+
+#ifndef CHAIN_H
+#define CHAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "periodRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Chain handle - opaque pointer */
+typedef void* ChainHandle_t;
+
+/* Travels with the data from the head to the tail of a chain */
+typedef struct {
+    uint32_t ulOrigin;               /* Head job release, tick in microseconds */
+    uint32_t ulPreviousOrigin;       /* The head release before it */
+} ChainStamp_t;
+
+/* Lower bound in microseconds of histogram bucket ulBucket */
+#define CHAIN_BUCKET_LOWER_US(ulBucket) \
+    ((ulBucket) == 0 ? 0UL : (uint32_t)CHAIN_HISTOGRAM_BASE_US << ((ulBucket) - 1))
+
+/* Chain statistics, microseconds */
+typedef struct {
+    uint32_t ulSamples;              /* Tail jobs that consumed a stamp */
+    uint32_t ulReactions;            /* Of those, the first to act on an origin */
+    uint32_t ulLastAge;
+    uint32_t ulMaxAge;
+    uint32_t ulMaxReaction;
+    uint32_t ulAgeHistogram[CHAIN_HISTOGRAM_BUCKETS];
+    uint32_t ulReactionHistogram[CHAIN_HISTOGRAM_BUCKETS];
+} ChainStats_t;
+
+/* Configuration, from tasks */
+ChainHandle_t xChainCreate(const char *pcName, const TaskHandle_t *pxTasks, uint32_t ulTaskCount);
+
+/* Run time, from the chain's tasks */
+void vChainStamp(ChainHandle_t xChain, ChainStamp_t *pxStamp);
+void vChainConsume(ChainHandle_t xChain, const ChainStamp_t *pxStamp);
+
+/* Monitoring, from tasks */
+bool bChainGetStats(ChainHandle_t xChain, ChainStats_t *pxStats);
+void vChainResetStats(ChainHandle_t xChain);
+const char *pcChainGetName(ChainHandle_t xChain);
+uint32_t ulChainGetTasks(ChainHandle_t xChain, TaskHandle_t *pxTasks, uint32_t ulMax);
+
+/* Kernel hook (ENABLE_CHAINS): the current job of xTask completed */
+void vChainJobComplete(TaskHandle_t xTask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHAIN_H */
@@ -0,0 +1,60 @@
+/**
+ * @file heap.h
+ * @brief Deterministic dynamic memory for periodRTOS (TLSF allocator)
+ *
+ * Two-Level Segregated Fit: free blocks are kept in size-class lists
+ * indexed by two bitmaps, so allocation and release are a fixed number of
+ * bit scans and list operations whatever the heap's history. Each call
+ * runs with interrupts masked for that bounded time, which makes the heap
+ * safe to use from tasks and interrupt handlers alike.
+ *
+ * The region comes from vBoardHeapRegion(): the RAM between .bss and the
+ * main stack reserve on Cortex-M, a static array on the host. On Cortex-M
+ * malloc()/free() and friends (including newlib's reentrant variants and
+ * the aligned allocators) are routed here. Payloads are aligned to
+ * max_align_t.
+ */
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Heap statistics */
+typedef struct {
+    uint32_t ulTotalBytes;           /* Managed region, excluding control data */
+    uint32_t ulUsedBytes;            /* Allocated blocks including headers */
+    uint32_t ulPeakUsedBytes;        /* Highest ulUsedBytes since initialization */
+    uint32_t ulFreeBytes;            /* Free blocks including headers */
+    uint32_t ulLargestFreeBlock;     /* Largest single allocation possible now */
+    uint32_t ulFreeBlocks;           /* Number of free blocks */
+    uint32_t ulAllocations;          /* Successful allocations */
+    uint32_t ulFrees;                /* Blocks released */
+    uint32_t ulFailures;             /* Requests that could not be satisfied */
+    uint32_t ulFragmentation;        /* 100 * (1 - largest free / free), percent */
+} HeapStats_t;
+
+/* Allocation */
+void *pvHeapAlloc(size_t xSize);
+void *pvHeapAllocAligned(size_t xAlign, size_t xSize);
+void *pvHeapCalloc(size_t xCount, size_t xSize);
+void *pvHeapRealloc(void *pv, size_t xSize);
+void vHeapFree(void *pv);
+
+/* Statistics */
+void vHeapGetStats(HeapStats_t *pxStats);
+
+/* Region (board-specific); the heap initializes itself on first use */
+void vBoardHeapRegion(void **ppvStart, size_t *pxSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEAP_H */
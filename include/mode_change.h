@@ -0,0 +1,66 @@
+/**
+ * @file mode_change.h
+ * @brief Named task-set modes and run-time mode changes for periodRTOS
+ *
+ * A mode names the periodic tasks that run in it; tasks outside the
+ * current mode stay suspended. All tasks are created up front and ranked
+ * once by vSchedulerInit(), so every task keeps its precomputed Rate
+ * Monotonic priority in every mode and a mode change never re-runs the
+ * ranking.
+ *
+ * Mode changes follow the idle-time protocol:
+ *   1. bModeRequest() records the target; nothing changes yet.
+ *   2. At each tick, tasks leaving the mode are suspended as soon as their
+ *      current job has finished; they are not released again. Tasks in
+ *      both modes keep running with their phasing.
+ *   3. At the first tick at which no periodic job is pending (the processor
+ *      has gone idle), the change completes: tasks entering the mode are
+ *      released at that tick.
+ * Old and new jobs therefore never overlap, so each mode only has to be
+ * schedulable on its own. The latency is at most the old mode's busy
+ * period plus one tick (ulModeTransitionBound()); vModeGetStats() reports
+ * what was measured.
+ */
+
+#ifndef MODE_CHANGE_H
+#define MODE_CHANGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "periodRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODE_NONE               UINT32_MAX
+
+typedef struct {
+    uint32_t ulCurrentMode;          /* MODE_NONE without modes */
+    uint32_t ulPendingMode;          /* MODE_NONE unless a change is in progress */
+    uint32_t ulTransitions;
+    uint32_t ulLastLatencyTicks;     /* Request to completion */
+    uint32_t ulMaxLatencyTicks;
+    uint32_t ulLastLatencyCycles;    /* ulGetCycleCounter() units */
+    uint32_t ulMaxLatencyCycles;
+} ModeStats_t;
+
+/* Configuration, before vTaskStartScheduler() */
+bool bModeDefine(uint32_t ulMode, const char *pcName, const TaskHandle_t *pxTasks, uint32_t ulCount);
+
+/* Run time, from tasks or interrupts */
+bool bModeRequest(uint32_t ulMode);
+uint32_t ulModeGetCurrent(void);
+const char *pcModeGetName(uint32_t ulMode);
+uint32_t ulModeTransitionBound(uint32_t ulFrom);
+void vModeGetStats(ModeStats_t *pxStats);
+
+/* Kernel hooks (ENABLE_MODE_CHANGE) */
+void vModeStart(void);
+void vModeTick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODE_CHANGE_H */
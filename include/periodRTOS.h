@@ -22,61 +22,308 @@ extern "C" {
 #define MAX_STACK_SIZE           2048
 #define MIN_STACK_SIZE           128
 
+/* Stack size of a task entry function measured at build time from its call
+ * graph (PERIODRTOS_STACK_SIZES, cmake/stack_sizes.cmake), at least
+ * MIN_STACK_SIZE; DEFAULT_STACK_SIZE in images that were not analyzed */
+#if defined(PERIODRTOS_STACK_SIZES) && !defined(PERIODRTOS_STACK_ANALYSIS)
+#include "task_stack_sizes.h"
+#define TASK_STACK_SIZE(pxTaskCode)                                                                \
+    ((STACK_SIZE_##pxTaskCode) > MIN_STACK_SIZE ? (STACK_SIZE_##pxTaskCode) : MIN_STACK_SIZE)
+#else
+#define TASK_STACK_SIZE(pxTaskCode)  DEFAULT_STACK_SIZE
+#endif
+
+/* Interrupt priorities, 0 = most urgent. Kernel critical sections mask only
+ * priorities KERNEL_MAX_SYSCALL_PRIORITY and below (numerically >=), using
+ * BASEPRI; more urgent interrupts are never delayed by the kernel and must
+ * not call kernel functions. */
+#define KERNEL_MAX_SYSCALL_PRIORITY  4   /* 1..15 on the 4 priority bits of the STM32F3 */
+
 /* System tick configuration */
 #define SYSTICK_FREQ_HZ          1000    /* 1ms tick */
-#define SYSTICK_PRIORITY         0       /* Highest priority */
+#define SYSTICK_PRIORITY         KERNEL_MAX_SYSCALL_PRIORITY /* Most urgent the kernel can mask */
+#define MAX_DELAY_TICKS          0x7FFFFFFFUL /* Longest delay; wake ticks compare modulo 2^32 */
+
+/* Load accounting */
+#define LOAD_WINDOW_MS           100     /* Utilization sample window */
+#define LOAD_EWMA_SHIFT          3       /* EWMA weight 1/8 per window */
+#define LOAD_Q16_ONE             65536UL /* 100% in Q16 fixed point */
+
+/* Stacks in the kernel's default shared pool used by xTaskCreatePeriodic()
+ * and the idle task; applications declaring all tasks with TASK_DEFINE()
+ * can shrink it to 1, or size the pool exactly with TASK_STACK_POOL() */
+#define STACK_POOL_TASKS         MAX_TASKS
 
 /* Stack Canary*/
 #define ENABLE_STACK_CANARY      true
 #define STACK_CANARY             0x00ff0a00
 
-/* Task states */
-typedef enum {
+/* Telemetry transport (USART1 + DMA, see telemetry.h) */
+#define ENABLE_TELEMETRY_UART    true
+
+/* Real-time frequency scaling (see rtdvs.c); off runs at the fastest profile */
+#define ENABLE_RTDVS             false
+#define RTDVS_OVERLOAD_LOAD      ((LOAD_Q16_ONE * 95) / 100) /* Smoothed load that raises the clock */
+#define RTDVS_HOLD_TICKS         1000    /* Quiet ticks before dropping back */
+
+/* Time-triggered dispatch from a generated table (see tt_schedule.h, tools/ttgen) */
+#define ENABLE_TIME_TRIGGERED    false
+
+/* Task-set modes and idle-time mode changes (see mode_change.h) */
+#define ENABLE_MODE_CHANGE       true
+#define MAX_MODES                4
+
+/* Software timers (see sw_timer.h); the service task takes a task slot and
+ * its period sets both its Rate Monotonic priority and its release rate */
+#define ENABLE_SOFTWARE_TIMERS   false
+#define MAX_TIMERS               16
+#define TIMER_SERVICE_PERIOD     1       /* Ticks; 1 ranks it above every task */
+#define TIMER_SERVICE_STACK_SIZE DEFAULT_STACK_SIZE
+
+/* Statistical PC sampling (see profiler.h, tools/pcprof); the sampling timer
+ * is not SysTick and sits above KERNEL_MAX_SYSCALL_PRIORITY, so critical
+ * sections are sampled where they run */
+#define ENABLE_PROFILER          false
+#define PROFILER_SAMPLE_HZ       97      /* Prime, so samples do not lock to the tick */
+#define PROFILER_RING_SAMPLES    128     /* Power of two, 12 bytes each; > rate x flush interval */
+#define PROFILER_PRIORITY        (KERNEL_MAX_SYSCALL_PRIORITY - 1)
+
+/* End-to-end latency of cause-effect task chains (see chain.h) */
+#define ENABLE_CHAINS            false
+#define MAX_CHAINS               4
+#define MAX_CHAIN_TASKS          8
+#define CHAIN_HISTOGRAM_BUCKETS  16      /* Bucket 0 is below the base, then powers of two */
+#define CHAIN_HISTOGRAM_BASE_US  1000    /* One tick */
+
+/* Task states; one byte, so the TCB keeps it in a byte of its own */
+typedef enum __attribute__((packed)) {
     TASK_STATE_READY = 0,
     TASK_STATE_RUNNING,
     TASK_STATE_BLOCKED,
     TASK_STATE_SUSPENDED,
-    TASK_STATE_DELETED
+    TASK_STATE_DELETED,
+    TASK_STATE_DELAYED               /* Job pending, blocked in vTaskDelay() */
 } TaskState_t;
 
+/* What happens to a job that misses its deadline */
+typedef enum {
+    MISS_POLICY_CONTINUE = 0,        /* Let it finish late */
+    MISS_POLICY_ABORT,               /* Discard it; the next release starts afresh */
+    MISS_POLICY_SKIP_NEXT            /* Let it finish, drop the next release */
+} MissPolicy_t;
+
 /* Task handle - opaque pointer */
 typedef void* TaskHandle_t;
 
+/* Deadline miss hook, called from the tick interrupt */
+typedef void (*DeadlineMissHook_t)(TaskHandle_t xTask);
+
 /* Task function prototype */
 typedef void (*TaskFunction_t)(void *parameters);
 
-/* Task control block structure */
+/*
+ * Task control block: only what the tick and the context switch use, so the
+ * per-tick scans over xTaskList stay within a few contiguous cache lines.
+ * Everything else lives in the task's TaskDetail_t (pxTaskDetail()).
+ * context_switch.S takes its offsets from tcb_offsets.h, which the build
+ * generates from this layout (src/kernel/tcb_offsets.c).
+ */
 typedef struct TaskControlBlock {
-    /* Stack management */
-    uint32_t *pxTopOfStack;          /* Current stack pointer +0 */
-    uint32_t *pxStackBase;               /* Base of stack +4 */
-    uint32_t *pxStackMax;               /* Max Addr (starting point) of stack +8 */
-    uint32_t ulStackSize;            /* Stack size in words +12 */
+    /* Context switch */
+    uint32_t *pxTopOfStack;          /* Current stack pointer */
+    uint32_t *pxStackMax;            /* Max Addr (starting point) of stack */
+    TaskFunction_t pxTaskCode;       /* Task function pointer */
+    
+    /* Release and deadline scans */
+    uint32_t ulReleaseTime;          /* Next release time */
+    uint32_t ulDeadlineTime;         /* Next deadline time */
+    uint32_t ulPeriod;               /* Task period in ms */
+    uint32_t ulDeadline;             /* Task deadline in ms */
+    uint32_t ulFirmHistory;          /* (m,k)-firm: bit 0 = latest job, 1 = met */
+    
+    /* Blocking delays */
+    uint32_t ulWakeTime;             /* Tick a delay ends at */
+    struct TaskControlBlock *pxNextDelayed; /* Wake-up list link */
+    
+    /* One shared word, set at creation and scheduler start; afterwards only
+     * configuration calls (bTaskSetFirmConstraint(), vTaskSetMissPolicy())
+     * change it, inside a kernel critical section. The tick reads it. */
+    uint32_t ulTaskID : 8;           /* Unique task ID, 0 for idle */
+    uint32_t ulPriority : 8;         /* Task priority (0 = highest) */
+    uint32_t ucFirmM : 6;            /* Jobs that must meet their deadline... */
+    uint32_t ucFirmK : 6;            /* ...in any ucFirmK consecutive jobs, 0 = hard */
+    uint32_t ucMissPolicy : 2;       /* MissPolicy_t */
     
-    /* Task properties */
-    TaskFunction_t pxTaskCode;       /* Task function pointer +16 */
-    uint32_t taskFlags;              /* 1 is fresh, 0 is dirty  +20*/
-    void *pvParameters;              /* Task parameters +24 */
-    uint32_t ulPeriod;               /* Task period in ms +28 */
-    uint32_t ulDeadline;             /* Task deadline in ms +32 */
-    uint32_t ulPriority;             /* Task priority (0 = highest) + 26*/
-    TaskState_t eCurrentState;       /* Current task state +40 */
+    /* Also written by the tick interrupt, each by a store of its own width:
+     * the state is a word-sized enum, the other three are single bytes, so
+     * no update read-modify-writes a neighbour */
+    TaskState_t eCurrentState;       /* Current task state */
+    uint8_t taskFlags;               /* 1 is fresh, 0 is dirty */
+    bool bDeadlineMissed;            /* The current job missed its deadline */
+    bool bSkipNextRelease;           /* Set by MISS_POLICY_SKIP_NEXT */
+} TaskControlBlock_t;
+
+/* Per-task data off the scheduling paths; xTaskDetails[i] is xTaskList[i]'s */
+typedef struct {
+    /* Stack management */
+    uint32_t *pxStackBase;           /* Base of stack */
+    uint32_t ulStackSize;            /* Stack size in words */
+    void *pvParameters;              /* Task parameters */
     
-    /* Timing information */
-    uint32_t ulReleaseTime;          /* Next release time +44*/
-    uint32_t ulDeadlineTime;         /* Next deadline time +48 */
-    uint32_t ulExecutionTime;        /* Total execution time +52 */
-    uint32_t ulLastStartTime;        /* Last start execution time +56*/
+    /* Execution time */
+    uint32_t ulExecutionTime;        /* Total execution time */
+    uint32_t ulLastStartTime;        /* Last start execution time */
     
     /* Monitoring data */
-    uint32_t ulContextSwitchCount;   /* Number of context switches +60 */
-    uint32_t ulDeadlineMissCount;    /* Number of deadline misses */
-    bool bDeadlineMissed;            /* Current deadline miss flag */
+    uint32_t ulContextSwitchCount;   /* Number of context switches */
+    uint32_t ulDeadlineMissCount;    /* Number of jobs that missed their deadline */
+    uint32_t ulSkippedJobs;          /* Releases dropped by skip-over */
+    uint32_t ulFirmViolations;       /* Jobs that ended a window with fewer than m met */
+    
+    /* Load accounting (microseconds / Q16 fractions) */
+    uint32_t ulLastSwitchInTime;     /* Run-time counter when last switched in */
+    uint32_t ulWindowRunTime;        /* Run time in the current load window */
+    uint32_t ulLoadEwma;             /* Smoothed utilization, Q16 */
+    uint32_t ulLoadPeak;             /* Highest window utilization, Q16 */
+    
+    /* Frequency scaling */
+    uint32_t ulWcet;                 /* WCET in us at the fastest clock, 0 if unknown */
+    
+    /* Cause-effect chains */
+    uint32_t ulJobReleaseTick;       /* Release of the current job (ENABLE_CHAINS) */
     
     /* Task identification */
     char pcTaskName[16];             /* Task name for debugging */
-    uint32_t ulTaskID;               /* Unique task ID */
-} TaskControlBlock_t;
+} TaskDetail_t;
+
+extern TaskControlBlock_t xTaskList[MAX_TASKS];
+extern TaskDetail_t xTaskDetails[MAX_TASKS];
+
+/**
+ * @brief The TaskDetail_t of a task
+ */
+static inline TaskDetail_t *pxTaskDetail(const TaskControlBlock_t *pxTCB)
+{
+    return &xTaskDetails[pxTCB - xTaskList];
+}
+
+/* Static task descriptor, placed in flash by TASK_DEFINE() */
+typedef struct {
+    TaskFunction_t pxTaskCode;       /* Task function pointer */
+    const char *pcName;              /* Task name for debugging */
+    uint32_t *pulStack;              /* Statically allocated stack, canary word first */
+    uint32_t ulStackSize;            /* Usable stack size in bytes */
+    void *pvParameters;              /* Task parameters */
+    uint32_t ulPeriod;               /* Task period in ms */
+    uint32_t ulDeadline;             /* Task deadline in ms */
+} TaskDescriptor_t;
+
+/*
+ * On Cortex-M each descriptor goes to .task_table.<period>, which the linker
+ * script sorts numerically, so the table is already in Rate Monotonic order
+ * and priorities are assigned by position at boot. The host linker keeps
+ * definition order; the kernel then ranks the tasks as for dynamic ones.
+ * The period must be an integer literal (or a macro expanding to one) for
+ * the sort to apply.
+ *
+ * Task stacks (.task_stacks, the shared pool included) and kernel objects
+ * (.kernel_bss: TCBs and task details) are placed per board by the linker
+ * script: in the F407's CCM RAM, which the DMA controllers cannot reach and
+ * which is off the bus matrix they use, elsewhere in SRAM. Ordinary .data
+ * and .bss stay in SRAM, so DMA buffers need no annotation. A task that
+ * hands buffers on its stack to DMA is declared with TASK_DEFINE_DMA(),
+ * which keeps its stack in SRAM (.task_stacks_dma).
+ */
+#if defined(__arm__)
+#define TASK_TABLE_SECTION(ulPeriod)    ".task_table." #ulPeriod
+#define TASK_STACK_ATTRIBUTES           __attribute__((section(".task_stacks"), aligned(8)))
+#define TASK_STACK_DMA_ATTRIBUTES       __attribute__((section(".task_stacks_dma"), aligned(8)))
+#define KERNEL_DATA_ATTRIBUTES          __attribute__((section(".kernel_bss")))
+#else
+#define TASK_TABLE_SECTION(ulPeriod)    "task_table"
+#define TASK_STACK_ATTRIBUTES           __attribute__((aligned(8)))
+#define TASK_STACK_DMA_ATTRIBUTES       __attribute__((aligned(8)))
+#define KERNEL_DATA_ATTRIBUTES
+#endif
+
+/**
+ * @brief Declare a periodic task at file scope
+ *
+ * The descriptor is placed in flash and its stack in RAM at link time;
+ * vKernelInit() creates the task, IDs following table order. Both show in
+ * the link map as xTaskDescriptor_<xName> and ulTaskStack_<xName>.
+ *
+ *   TASK_DEFINE(Blink, vBlinkTask, 100, 80, 512, NULL);
+ */
+#define TASK_DEFINE(xName, pxTaskCode, ulPeriod, ulDeadline, ulStackSize, pvParameters)           \
+    TASK_DEFINE_IN(xName, pxTaskCode, ulPeriod, ulDeadline, ulStackSize, pvParameters,            \
+                   TASK_STACK_ATTRIBUTES)
+
+/**
+ * @brief TASK_DEFINE() with the stack in DMA-capable SRAM
+ */
+#define TASK_DEFINE_DMA(xName, pxTaskCode, ulPeriod, ulDeadline, ulStackSize, pvParameters)       \
+    TASK_DEFINE_IN(xName, pxTaskCode, ulPeriod, ulDeadline, ulStackSize, pvParameters,            \
+                   TASK_STACK_DMA_ATTRIBUTES)
+
+/* Shared expansion of TASK_DEFINE() and TASK_DEFINE_DMA() */
+#define TASK_DEFINE_IN(xName, pxTaskCode, ulPeriod, ulDeadline, ulStackSize, pvParameters, xStackAttributes) \
+    _Static_assert((ulStackSize) >= MIN_STACK_SIZE && (ulStackSize) <= MAX_STACK_SIZE,            \
+                   "TASK_DEFINE: stack size out of range");                                       \
+    _Static_assert((ulPeriod) > 0, "TASK_DEFINE: periodic tasks need a period");                  \
+    static uint32_t ulTaskStack_##xName[(ulStackSize) / sizeof(uint32_t) + ENABLE_STACK_CANARY]   \
+        xStackAttributes;                                                                         \
+    static const TaskDescriptor_t xTaskDescriptor_##xName                                         \
+        __attribute__((section(TASK_TABLE_SECTION(ulPeriod)), used, aligned(sizeof(void *)))) = { \
+        (pxTaskCode), #xName, ulTaskStack_##xName, (ulStackSize), (pvParameters),                 \
+        (ulPeriod), (ulDeadline)                                                                  \
+    }
+
+/* Pool words taken by a stack of ulStackSize bytes, as xTaskCreatePeriodic()
+ * sizes it: out-of-range sizes get DEFAULT_STACK_SIZE, plus the canary */
+#define STACK_POOL_WORDS(ulStackSize)                                                              \
+    (((ulStackSize) < MIN_STACK_SIZE || (ulStackSize) > MAX_STACK_SIZE ? DEFAULT_STACK_SIZE         \
+                                                                       : (ulStackSize)) /          \
+         sizeof(uint32_t) + ENABLE_STACK_CANARY)
+
+/**
+ * @brief Replace the kernel's shared stack pool with one sized for the application
+ *
+ * Defined once at file scope. ulIdleStackSize is the idle task's stack in
+ * bytes; ulTaskWords adds up STACK_POOL_WORDS() of every stack passed to
+ * xTaskCreatePeriodic(). The timer service's stack is added when enabled.
+ *
+ *   TASK_STACK_POOL(TASK_STACK_SIZE(vIdleTask),
+ *                   STACK_POOL_WORDS(TASK_STACK_SIZE(vTask1)) +
+ *                   STACK_POOL_WORDS(TASK_STACK_SIZE(vTask2)));
+ */
+#define TASK_STACK_POOL(ulIdleStackSize, ulTaskWords)                                              \
+    _Static_assert((ulIdleStackSize) >= MIN_STACK_SIZE && (ulIdleStackSize) <= MAX_STACK_SIZE,    \
+                   "TASK_STACK_POOL: idle stack size out of range");                              \
+    const uint32_t ulIdleTaskStackSize = (ulIdleStackSize);                                       \
+    const uint32_t ulStackMemoryWords = STACK_POOL_WORDS(ulIdleStackSize) + (ulTaskWords) +       \
+        (ENABLE_SOFTWARE_TIMERS ? STACK_POOL_WORDS(TIMER_SERVICE_STACK_SIZE) : 0);                \
+    uint32_t ulStackMemory[STACK_POOL_WORDS(ulIdleStackSize) + (ulTaskWords) +                    \
+        (ENABLE_SOFTWARE_TIMERS ? STACK_POOL_WORDS(TIMER_SERVICE_STACK_SIZE) : 0)]                \
+        TASK_STACK_ATTRIBUTES
+
+/*
+ * Kernel hot paths (tick, dispatch decision, ready list, context switch)
+ * are linked into .ramfunc, which the startup code copies from flash: to
+ * the F303's CCM RAM, which the core fetches from without flash wait
+ * states, or to SRAM on the F407, whose CCM is data-only. Calls between
+ * flash and RAM code go through linker veneers. The build sets
+ * PERIODRTOS_RAMFUNC=0 where it does not pay (QEMU has no CCM and no
+ * wait states); the host port has no such section.
+ */
+#ifndef PERIODRTOS_RAMFUNC
+#define PERIODRTOS_RAMFUNC              1
+#endif
+#if defined(__arm__) && PERIODRTOS_RAMFUNC
+#define KERNEL_RAMFUNC                  __attribute__((section(".ramfunc")))
+#else
+#define KERNEL_RAMFUNC
+#endif
 
 /* Scheduler state */
 typedef enum {
@@ -92,8 +339,72 @@ typedef struct {
     uint32_t ulIdleTime;             /* Total idle time in ms */
     uint32_t ulTaskCount;            /* Number of created tasks */
     SchedulerState_t eSchedulerState;
+
+    /* Load accounting, utilization in Q16 (LOAD_Q16_ONE == 100%) */
+    uint32_t ulSystemLoadEwma;       /* Smoothed busy fraction */
+    uint32_t ulSystemLoadPeak;       /* Highest busy fraction of any window */
+    uint32_t ulHyperperiod;          /* LCM of task periods in ticks, 0 if too large */
+    uint32_t ulHyperperiodLoad;      /* Busy fraction of the last full hyperperiod */
+    uint32_t ulHyperperiodLoadPeak;  /* Highest busy fraction of any hyperperiod */
 } SystemMonitor_t;
 
+/* Telemetry snapshot configuration */
+#define TELEMETRY_SNAPSHOT_MAGIC     0x4E4F4D50UL  /* "PMON" in little-endian memory */
+#define TELEMETRY_SNAPSHOT_VERSION   2
+#define TELEMETRY_SNAPSHOT_RETRIES   8       /* Reader attempts before giving up */
+
+/* Task telemetry record flags */
+#define TASK_TELEMETRY_FLAG_IN_USE           0x01
+#define TASK_TELEMETRY_FLAG_DEADLINE_MISSED  0x02
+
+/*
+ * Binary telemetry layout. Packed, little-endian, fixed-width fields only so
+ * host tools can parse it straight out of a RAM dump or a transport frame.
+ * Fields may only be appended; any change bumps TELEMETRY_SNAPSHOT_VERSION.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t ulTaskID;               /* +0  */
+    uint32_t ulPriority;             /* +4  */
+    uint32_t ulPeriod;               /* +8  */
+    uint32_t ulDeadline;             /* +12 */
+    uint32_t ulReleaseTime;          /* +16 */
+    uint32_t ulDeadlineTime;         /* +20 */
+    uint32_t ulExecutionTime;        /* +24 */
+    uint32_t ulContextSwitchCount;   /* +28 */
+    uint32_t ulDeadlineMissCount;    /* +32 */
+    uint8_t ucState;                 /* +36 TaskState_t */
+    uint8_t ucFlags;                 /* +37 TASK_TELEMETRY_FLAG_* */
+    uint16_t usReserved;             /* +38 */
+    char pcTaskName[16];             /* +40 */
+} TaskTelemetry_t;                   /* 56 bytes, unchanged since v1 */
+
+typedef struct __attribute__((packed)) {
+    uint32_t ulLoad;                 /* +0 Smoothed utilization, Q16 */
+    uint32_t ulLoadPeak;             /* +4 Peak window utilization, Q16 */
+} TaskLoadTelemetry_t;               /* 8 bytes, v2 */
+
+typedef struct __attribute__((packed)) {
+    uint32_t ulMagic;                /* +0  TELEMETRY_SNAPSHOT_MAGIC */
+    uint16_t usVersion;              /* +4  TELEMETRY_SNAPSHOT_VERSION */
+    uint16_t usSize;                 /* +6  sizeof(TelemetrySnapshot_t) */
+    uint32_t ulSequence;             /* +8  Monitor sequence the copy is consistent with */
+    uint32_t ulSystemUptime;         /* +12 */
+    uint32_t ulTotalContextSwitches; /* +16 */
+    uint32_t ulIdleTime;             /* +20 */
+    uint32_t ulTaskCount;            /* +24 */
+    uint8_t ucSchedulerState;        /* +28 SchedulerState_t */
+    uint8_t ucTaskRecords;           /* +29 Number of entries in xTasks */
+    uint16_t usTaskRecordSize;       /* +30 sizeof(TaskTelemetry_t) */
+    TaskTelemetry_t xTasks[MAX_TASKS]; /* +32 */
+    /* Appended in v2, located after the task records */
+    uint32_t ulSystemLoad;           /* Smoothed busy fraction, Q16 */
+    uint32_t ulSystemLoadPeak;       /* Peak window busy fraction, Q16 */
+    uint32_t ulHyperperiod;          /* Ticks */
+    uint32_t ulHyperperiodLoad;      /* Last hyperperiod busy fraction, Q16 */
+    uint32_t ulHyperperiodLoadPeak;  /* Peak hyperperiod busy fraction, Q16 */
+    TaskLoadTelemetry_t xTaskLoads[MAX_TASKS]; /* Indexed like xTasks */
+} TelemetrySnapshot_t;
+
 /* Function prototypes */
 
 /* Task management */
@@ -109,13 +420,36 @@ void vTaskYield(void);
 void vTaskSuspend(TaskHandle_t xTask);
 void vTaskResume(TaskHandle_t xTask);
 void vRemoveTaskFromReadyList(TaskHandle_t xTask);
+void vTaskSetWcet(TaskHandle_t xTask, uint32_t ulWcetUs);
+bool bTaskSetFirmConstraint(TaskHandle_t xTask, uint32_t ulM, uint32_t ulK);
+void vTaskSetMissPolicy(TaskHandle_t xTask, MissPolicy_t ePolicy);
+void vSetDeadlineMissHook(DeadlineMissHook_t pxHook);
+
+/* Critical sections: mask interrupts up to KERNEL_MAX_SYSCALL_PRIORITY */
+void vKernelEnterCritical(void);
+void vKernelExitCritical(void);
+uint32_t ulKernelEnterCriticalFromISR(void);
+void vKernelExitCriticalFromISR(uint32_t ulState);
 
 /* Monitoring functions */
 uint32_t ulGetContextSwitchCount(void);
 uint32_t ulGetTaskExecutionTime(TaskHandle_t xTask);
 uint32_t ulGetDeadlineMissCount(TaskHandle_t xTask);
+uint32_t ulGetSkippedJobCount(TaskHandle_t xTask);
+uint32_t ulGetFirmViolationCount(TaskHandle_t xTask);
 bool bIsTaskDeadlineMissed(TaskHandle_t xTask);
+uint32_t ulGetTaskUtilization(TaskHandle_t xTask);
+uint32_t ulGetTaskPeakUtilization(TaskHandle_t xTask);
+uint32_t ulGetSystemUtilization(void);
+uint32_t ulGetSystemPeakUtilization(void);
+uint32_t ulGetHyperperiodUtilization(void);
 SystemMonitor_t* pxGetSystemMonitor(void);
+bool bGetTelemetrySnapshot(TelemetrySnapshot_t *pxSnapshot);
+void vMonitorWriteBegin(void);
+void vMonitorWriteEnd(void);
+void vMonitorAccountSwitch(TaskHandle_t xFrom, TaskHandle_t xTo);
+void vMonitorLoadTick(void);
+void vMonitorSetHyperperiod(uint32_t ulHyperperiod);
 
 /* System functions */
 void vSystemTickHandler(void);
@@ -124,9 +458,14 @@ void vIdleTask(void *pvParameters);
 /* Internal kernel functions (not part of public API) */
 void vKernelInit(void);
 void vSchedulerInit(void);
-void vContextSwitch(void);
+uint32_t ulSchedulerHyperperiod(void);
+bool bTaskPrioritiesPrecomputed(void);
+void vSchedulerRecordJob(TaskHandle_t xTask, bool bMet);
+void vSchedulerSetDeadline(TaskHandle_t xTask, uint32_t ulDeadlineTime);
+void vSchedulerWakeTask(TaskHandle_t xTask);
+void vContextSwitch(TaskHandle_t xCurrent, TaskHandle_t xNext);
 void vStartContextSwitch(void);
-void vInitialContextSwitch(void);
+void vInitialContextSwitch(TaskHandle_t xNext);
 TaskHandle_t pxGetCurrentTask(void);
 void vSetCurrentTask(TaskHandle_t xTask);
 TaskHandle_t vSchedulerGetNextTask(void);
@@ -140,12 +479,37 @@ void vInitGPIO(void);
 void vLedOn(uint32_t ulLed);
 void vLedOff(uint32_t ulLed);
 void vLedToggle(uint32_t ulLed);
+void vBoardExit(int iStatus);
+
+/* Clock profiles (board-specific), ascending SYSCLK, the last is the fastest */
+uint32_t ulClockProfileCount(void);
+uint32_t ulClockProfileHz(uint32_t ulProfile);
+uint32_t ulClockGetProfile(void);
+bool bClockSetProfile(uint32_t ulProfile);
+void vSystemClockChanged(void);
+
+/* Frequency scaling */
+uint32_t ulRtdvsSelectProfile(void);
+void vRtdvsStart(void);
+void vRtdvsTick(void);
+void vRtdvsDeadlineMiss(void);
+void vRtdvsApply(void);
 
 /* Timer functions */
 void vSystickInit(void);
+void vSystickUpdateReload(void);
 uint32_t ulGetSystemTick(void);
+uint32_t ulGetRunTimeCounter(void);
+uint32_t ulGetTickElapsedUs(void);
 void vTaskDelay(uint32_t ulTicksToDelay);
 void vTaskDelayUntil(uint32_t *pulPreviousWakeTime, uint32_t ulTimeIncrement);
+void vDelayTick(void);
+void vDelayRemove(TaskHandle_t xTask);
+
+/* Cycle counter (core clock cycles on Cortex-M, nanoseconds on the host) */
+void vCycleCounterInit(void);
+uint32_t ulGetCycleCounter(void);
+uint32_t ulGetTickElapsedCycles(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,251 @@
+/**
+ * @file periodRTOS.hpp
+ * @brief Compile-time task sets for C++17 applications
+ *
+ * A task set is a type list of task types. Each task type derives from
+ * periodrtos::Task<period, deadline, WCET[, stack]> and provides its name
+ * and entry point:
+ *
+ *   struct Blink : periodrtos::Task<100, 80, 2000> {    // ticks, ticks, us
+ *       static constexpr const char *pcName = "Blink";
+ *       static void vRun(void *pvParameters);
+ *   };
+ *   using App = periodrtos::TaskSet<Blink, Sensor, Logger>;
+ *   PERIODRTOS_TASK_TABLE(App);
+ *
+ * The compiler ranks the set in Rate Monotonic order (bRmPrecedes(), the
+ * kernel's own policy), computes utilization, hyperperiod and the
+ * worst-case response time of every task, and rejects the program with a
+ * static_assert if any task can miss its deadline. The analysis matches
+ * rm_analysis.c: WCETs are microseconds at the fastest clock, and a job
+ * must finish by min(deadline, period) since the kernel drops a release
+ * whose previous job is pending.
+ *
+ * PERIODRTOS_TASK_TABLE() emits the descriptors and stacks TASK_DEFINE()
+ * would, already sorted, as a single block at the front of the static
+ * task table; vKernelInit() creates the tasks in that order and the
+ * scheduler keeps the ranking without a pass of its own. Use it once per
+ * image and instead of TASK_DEFINE(): descriptors from both would be
+ * ranked together at run time, and the compile-time analysis would not
+ * have covered the C ones.
+ */
+
+#ifndef PERIODRTOS_HPP
+#define PERIODRTOS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "periodRTOS.h"
+#include "rm_analysis.h"
+#include "rm_policy.h"
+
+#if __cplusplus < 201703L
+#error "periodRTOS.hpp needs C++17"
+#endif
+
+namespace periodrtos {
+
+/**
+ * @brief Timing parameters of one periodic task
+ * @tparam Period     Period in ticks
+ * @tparam Deadline   Relative deadline in ticks
+ * @tparam WcetUs     Worst-case execution time in microseconds
+ * @tparam StackSize  Stack size in bytes
+ *
+ * The derived type adds pcName and vRun(); it may hide pvParameters.
+ */
+template <uint32_t Period, uint32_t Deadline, uint32_t WcetUs, uint32_t StackSize = DEFAULT_STACK_SIZE>
+struct Task {
+    static_assert(Period > 0, "Task: periodic tasks need a period");
+    static_assert(Deadline > 0, "Task: the deadline must be at least one tick");
+    static_assert(WcetUs > 0, "Task: the WCET must be known");
+    static_assert(StackSize >= MIN_STACK_SIZE && StackSize <= MAX_STACK_SIZE, "Task: stack size out of range");
+
+    static constexpr uint32_t ulPeriod = Period;
+    static constexpr uint32_t ulDeadline = Deadline;
+    static constexpr uint32_t ulWcetUs = WcetUs;
+    static constexpr uint32_t ulStackSize = StackSize;
+    static constexpr void *pvParameters = nullptr;
+};
+
+namespace detail {
+
+constexpr uint64_t ullGcd(uint64_t ullA, uint64_t ullB)
+{
+    while (ullB != 0) {
+        uint64_t ullRest = ullA % ullB;
+        ullA = ullB;
+        ullB = ullRest;
+    }
+    return ullA;
+}
+
+/* Stack words of one task: canary first, rounded to 8 bytes */
+constexpr uint32_t ulStackWords(uint32_t ulStackSize)
+{
+    return (ulStackSize / sizeof(uint32_t) + ENABLE_STACK_CANARY + 1) & ~1UL;
+}
+
+/* Declaration indices, highest priority first: same sort as vRmPriorityOrder() */
+template <std::size_t N>
+constexpr std::array<uint32_t, N> xPriorityOrder(const std::array<uint32_t, N> &pulPeriod)
+{
+    std::array<uint32_t, N> pulOrder = {};
+
+    for (uint32_t i = 0; i < N; i++) {
+        uint32_t j = i;
+
+        while (j > 0 && bRmPrecedes(pulPeriod[i], i + 1, pulPeriod[pulOrder[j - 1]], pulOrder[j - 1] + 1)) {
+            pulOrder[j] = pulOrder[j - 1];
+            j--;
+        }
+        pulOrder[j] = i;
+    }
+    return pulOrder;
+}
+
+/* Q30, each task rounded up, as ullRmUtilization() */
+template <std::size_t N>
+constexpr uint64_t ullUtilization(const std::array<uint32_t, N> &pulPeriod, const std::array<uint32_t, N> &pulWcet)
+{
+    uint64_t ullTotal = 0;
+
+    for (std::size_t i = 0; i < N; i++) {
+        uint64_t ullPeriodUs = (uint64_t)pulPeriod[i] * RM_ANALYSIS_TICK_US;
+
+        ullTotal += (((uint64_t)pulWcet[i] << 30) + ullPeriodUs - 1) / ullPeriodUs;
+    }
+    return ullTotal;
+}
+
+/* Least common multiple, 0 if it exceeds 32 bits, as ulSchedulerHyperperiod() */
+template <std::size_t N>
+constexpr uint32_t ulHyperperiod(const std::array<uint32_t, N> &pulPeriod)
+{
+    uint64_t ullLcm = 1;
+
+    for (std::size_t i = 0; i < N; i++) {
+        ullLcm = ullLcm / ullGcd(ullLcm, pulPeriod[i]) * pulPeriod[i];
+        if (ullLcm > UINT32_MAX) {
+            return 0;
+        }
+    }
+    return (uint32_t)ullLcm;
+}
+
+/* R = C + sum(ceil(R / Tj) * Cj) over higher priorities, as ulResponseAt() */
+template <std::size_t N>
+constexpr std::array<uint32_t, N> xResponseTimes(const std::array<uint32_t, N> &pulPeriod,
+                                                 const std::array<uint32_t, N> &pulDeadline,
+                                                 const std::array<uint32_t, N> &pulWcet,
+                                                 const std::array<uint32_t, N> &pulOrder)
+{
+    std::array<uint32_t, N> pulResponse = {};
+
+    for (std::size_t ulPosition = 0; ulPosition < N; ulPosition++) {
+        uint32_t ulTask = pulOrder[ulPosition];
+        uint32_t ulLimitTicks = pulDeadline[ulTask] < pulPeriod[ulTask] ? pulDeadline[ulTask] : pulPeriod[ulTask];
+        uint64_t ullLimit = (uint64_t)ulLimitTicks * RM_ANALYSIS_TICK_US;
+        uint64_t ullResponse = pulWcet[ulTask];
+        uint64_t ullPrevious = 0;
+
+        while (ullResponse != ullPrevious && ullResponse <= ullLimit) {
+            ullPrevious = ullResponse;
+            ullResponse = pulWcet[ulTask];
+            for (std::size_t p = 0; p < ulPosition; p++) {
+                uint32_t ulOther = pulOrder[p];
+                uint64_t ullPeriodUs = (uint64_t)pulPeriod[ulOther] * RM_ANALYSIS_TICK_US;
+
+                ullResponse += ((ullPrevious + ullPeriodUs - 1) / ullPeriodUs) * pulWcet[ulOther];
+            }
+        }
+        pulResponse[ulTask] = (ullResponse > ullLimit) ? RM_RESPONSE_UNSCHEDULABLE : (uint32_t)ullResponse;
+    }
+    return pulResponse;
+}
+
+template <std::size_t N>
+constexpr bool bAllRespond(const std::array<uint32_t, N> &pulResponse)
+{
+    for (std::size_t i = 0; i < N; i++) {
+        if (pulResponse[i] == RM_RESPONSE_UNSCHEDULABLE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief A task set and its Rate Monotonic analysis, all constant expressions
+ */
+template <typename... Tasks>
+struct TaskSet {
+    static constexpr std::size_t ulCount = sizeof...(Tasks);
+
+    static_assert(ulCount > 0, "TaskSet: no tasks");
+    static_assert(ulCount <= MAX_TASKS - 2, "TaskSet: more tasks than slots (MAX_TASKS less slot 0 and idle)");
+
+    static constexpr std::array<uint32_t, ulCount> pulPeriod = { Tasks::ulPeriod... };
+    static constexpr std::array<uint32_t, ulCount> pulDeadline = { Tasks::ulDeadline... };
+    static constexpr std::array<uint32_t, ulCount> pulWcet = { Tasks::ulWcetUs... };
+
+    /* Declaration indices, highest priority first; ties keep declaration order */
+    static constexpr std::array<uint32_t, ulCount> pulOrder = detail::xPriorityOrder(pulPeriod);
+
+    /* Total utilization, Q30 (RM_ANALYSIS_Q30_ONE == 1.0), rounded up */
+    static constexpr uint64_t ullUtilization = detail::ullUtilization(pulPeriod, pulWcet);
+
+    /* Least common multiple of the periods in ticks, 0 if it exceeds 32 bits */
+    static constexpr uint32_t ulHyperperiod = detail::ulHyperperiod(pulPeriod);
+
+    /* Worst-case response times in microseconds by declaration index,
+     * RM_RESPONSE_UNSCHEDULABLE where min(deadline, period) is exceeded */
+    static constexpr std::array<uint32_t, ulCount> pulResponse =
+        detail::xResponseTimes(pulPeriod, pulDeadline, pulWcet, pulOrder);
+
+    static constexpr bool bSchedulable = detail::bAllRespond(pulResponse);
+
+    static_assert(ullUtilization <= RM_ANALYSIS_Q30_ONE, "TaskSet: utilization exceeds 100%");
+    static_assert(bSchedulable, "TaskSet: a task can miss its deadline under Rate Monotonic (see pulResponse)");
+
+    static constexpr uint32_t ulStackWords = (detail::ulStackWords(Tasks::ulStackSize) + ...);
+
+    /**
+     * @brief Descriptors in priority order, stacks carved from pulStacks
+     */
+    static constexpr std::array<TaskDescriptor_t, ulCount> xDescriptors(uint32_t *pulStacks)
+    {
+        std::array<TaskDescriptor_t, ulCount> xDeclared = { TaskDescriptor_t{
+            &Tasks::vRun, Tasks::pcName, nullptr, Tasks::ulStackSize, Tasks::pvParameters,
+            Tasks::ulPeriod, Tasks::ulDeadline }... };
+        std::array<uint32_t, ulCount> pulWords = { detail::ulStackWords(Tasks::ulStackSize)... };
+        std::array<TaskDescriptor_t, ulCount> xSorted = {};
+        uint32_t ulOffset = 0;
+
+        for (std::size_t i = 0; i < ulCount; i++) {
+            xSorted[i] = xDeclared[pulOrder[i]];
+            xSorted[i].pulStack = pulStacks + ulOffset;
+            ulOffset += pulWords[pulOrder[i]];
+        }
+        return xSorted;
+    }
+};
+
+} // namespace periodrtos
+
+/*
+ * Section .task_table.0 sorts ahead of every TASK_DEFINE() period on
+ * Cortex-M; the host linker keeps the block as it is.
+ */
+#define PERIODRTOS_TASK_TABLE(xSet)                                                               \
+    static uint32_t ulTaskSetStacks_##xSet[xSet::ulStackWords] TASK_STACK_ATTRIBUTES;             \
+    static_assert(sizeof(std::array<TaskDescriptor_t, xSet::ulCount>) ==                          \
+                  xSet::ulCount * sizeof(TaskDescriptor_t), "descriptor table layout");           \
+    [[gnu::used, gnu::section(TASK_TABLE_SECTION(0)), gnu::aligned(sizeof(void *))]]              \
+    static constexpr std::array<TaskDescriptor_t, xSet::ulCount> xTaskSetTable_##xSet =           \
+        xSet::xDescriptors(ulTaskSetStacks_##xSet)
+
+#endif /* PERIODRTOS_HPP */
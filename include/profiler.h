@@ -0,0 +1,88 @@
+/**
+ * @file profiler.h
+ * @brief Statistical PC-sampling profiler for periodRTOS
+ *
+ * A timer interrupt independent of SysTick samples, at a configurable rate,
+ * the program counter and link register it interrupted and the task that
+ * was current. Samples go into a fixed ring in RAM; the interrupt does a
+ * constant amount of work and drops the sample if the ring is full, so the
+ * cost is bounded by the rate alone and can be left running in the field.
+ *
+ * A task drains the ring with bProfilerFlush(), which sends the samples on
+ * TELEMETRY_CHANNEL_PROFILE. tools/pcprof reads the telemetry stream and
+ * symbolizes the samples against the ELF image into per-task flat profiles
+ * or collapsed stacks for flame graphs.
+ *
+ * Addresses are sent relative to vProfilerStart(), so the host tool needs
+ * no load address: it adds the symbol's value from the same ELF. This also
+ * covers position-independent host executables.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "periodRTOS.h"
+#include "telemetry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sample flags */
+#define PROFILE_SAMPLE_HANDLER       0x01    /* An interrupt handler was running */
+#define PROFILE_SAMPLE_LR            0x02    /* ulLr holds the interrupted link register */
+
+/* One sample, 12 bytes */
+typedef struct __attribute__((packed)) {
+    uint32_t ulPc;                   /* +0  Interrupted PC, relative to vProfilerStart() */
+    uint32_t ulLr;                   /* +4  Interrupted LR, same base (PROFILE_SAMPLE_LR) */
+    uint8_t ucTaskID;                /* +8  Current task, 0 before the scheduler runs */
+    uint8_t ucFlags;                 /* +9  PROFILE_SAMPLE_* */
+    uint16_t usReserved;             /* +10 */
+} ProfileSample_t;
+
+/* TELEMETRY_CHANNEL_PROFILE frame: this header, then usCount samples */
+#define PROFILE_FRAME_MAGIC          0x464F5250UL  /* "PROF" in little-endian memory */
+
+typedef struct __attribute__((packed)) {
+    uint32_t ulMagic;                /* +0  PROFILE_FRAME_MAGIC */
+    uint32_t ulSampleHz;             /* +4  Current sampling rate */
+    uint32_t ulSamples;              /* +8  Samples taken since start, including dropped */
+    uint32_t ulDropped;              /* +12 Samples lost to a full ring since start */
+    uint16_t usCount;                /* +16 Samples in this frame */
+    uint16_t usSampleSize;           /* +18 sizeof(ProfileSample_t) */
+} ProfileFrameHeader_t;              /* 20 bytes */
+
+/* Samples that fit in one telemetry frame */
+#define PROFILE_FRAME_SAMPLES        ((TELEMETRY_MAX_PAYLOAD - sizeof(ProfileFrameHeader_t)) / sizeof(ProfileSample_t))
+
+/* Profiler statistics */
+typedef struct {
+    uint32_t ulSampleHz;             /* 0 while stopped */
+    uint32_t ulSamples;
+    uint32_t ulDropped;
+    uint32_t ulBuffered;             /* Samples waiting in the ring */
+} ProfilerStats_t;
+
+/* Control, from tasks */
+void vProfilerStart(uint32_t ulSampleHz);
+void vProfilerStop(void);
+bool bProfilerFlush(void);
+uint32_t ulProfilerRead(ProfileSample_t *pxSamples, uint32_t ulMax);
+void vProfilerGetStats(ProfilerStats_t *pxStats);
+
+/* Called by the port's sampling interrupt with the interrupted PC and LR */
+void vProfilerSample(uintptr_t uxPc, uintptr_t uxLr, uint8_t ucFlags);
+
+/* Sampling timer (board specific) */
+void vProfilerTimerStart(uint32_t ulSampleHz);
+void vProfilerTimerStop(void);
+void vProfilerTimerClockChanged(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H */
@@ -0,0 +1,57 @@
+/**
+ * @file rm_analysis.h
+ * @brief Schedulability analysis for Rate Monotonic task sets
+ *
+ * Integer-only so it runs on the target as well as in the host tools.
+ * Periods and deadlines are in ticks, execution times in microseconds.
+ * Tasks are identified by array index; index i has kernel task ID i + 1,
+ * which breaks ties between equal periods (see rm_policy.h).
+ */
+
+#ifndef RM_ANALYSIS_H
+#define RM_ANALYSIS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "periodRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RM_ANALYSIS_TICK_US          (1000000UL / SYSTICK_FREQ_HZ)
+#define RM_ANALYSIS_Q30_ONE          (1UL << 30)      /* Utilization 1.0 */
+#define RM_RESPONSE_UNSCHEDULABLE    UINT32_MAX
+
+/* Priority order (highest first) as assigned by vUpdateTaskPriorities() */
+void vRmPriorityOrder(uint32_t ulCount, const uint32_t *pulPeriod, uint32_t *pulOrder);
+
+/* Utilization tests (sufficient) */
+uint64_t ullRmUtilization(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet);
+uint32_t ulRmLiuLaylandBound(uint32_t ulCount);
+bool bRmLiuLaylandTest(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet);
+bool bRmHyperbolicTest(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet);
+
+/* Response-time analysis (exact for synchronous release, D <= T) */
+uint32_t ulRmResponseTime(uint32_t ulTask, uint32_t ulCount, const uint32_t *pulPeriod,
+                          const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                          const uint32_t *pulOrder);
+bool bRmResponseTimeTest(uint32_t ulCount, const uint32_t *pulPeriod,
+                         const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                         const uint32_t *pulOrder);
+
+/* Longest interval the processor can stay busy (synchronous busy period) */
+uint32_t ulRmBusyPeriod(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet);
+
+/* Frequency scaling: WCETs are measured at the fastest clock, pulHz[ulClocks - 1] */
+uint32_t ulRmScaledWcet(uint32_t ulWcet, uint32_t ulReferenceHz, uint32_t ulHz);
+uint32_t ulRmLowestFeasibleClock(uint32_t ulCount, const uint32_t *pulPeriod,
+                                 const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                                 const uint32_t *pulOrder, const uint32_t *pulHz,
+                                 uint32_t ulClocks, uint32_t *pulScaledWcet);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RM_ANALYSIS_H */
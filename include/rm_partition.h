@@ -0,0 +1,50 @@
+/**
+ * @file rm_partition.h
+ * @brief Partitioned Rate Monotonic scheduling: task-to-core allocation
+ *
+ * Tasks are bin-packed onto cores in order of decreasing utilization. A
+ * core accepts a task only if its partition still passes response-time
+ * analysis, so every core can then run the uniprocessor RM scheduler on
+ * its own tasks with the usual guarantee and no state shared with other
+ * cores. Conventions as in rm_analysis.h: periods in ticks, execution
+ * times in microseconds, task index i has task ID i + 1.
+ */
+
+#ifndef RM_PARTITION_H
+#define RM_PARTITION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rm_analysis.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RM_PARTITION_UNASSIGNED      UINT32_MAX
+
+/* Scratch words bRmPartition() needs for ulCount tasks on ulCores cores */
+#define RM_PARTITION_SCRATCH_WORDS(ulCount, ulCores)   (6 * (ulCount) + 2 * (ulCores))
+
+/* Scratch words bRmCoreSchedulable() needs */
+#define RM_CORE_SCRATCH_WORDS(ulCount)                 (4 * (ulCount))
+
+typedef enum {
+    RM_PARTITION_FIRST_FIT = 0,      /* Lowest-numbered core that fits */
+    RM_PARTITION_WORST_FIT           /* Least-utilized core that fits */
+} RmPartitionHeuristic_t;
+
+bool bRmPartition(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulDeadline,
+                  const uint32_t *pulWcet, uint32_t ulCores, RmPartitionHeuristic_t eHeuristic,
+                  uint32_t *pulCore, uint32_t *pulScratch);
+bool bRmCoreSchedulable(uint32_t ulCore, uint32_t ulCount, const uint32_t *pulPeriod,
+                        const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                        const uint32_t *pulCore, uint32_t *pulScratch);
+uint64_t ullRmCoreUtilization(uint32_t ulCore, uint32_t ulCount, const uint32_t *pulPeriod,
+                              const uint32_t *pulWcet, const uint32_t *pulCore);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RM_PARTITION_H */
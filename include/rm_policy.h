@@ -0,0 +1,148 @@
+/**
+ * @file rm_policy.h
+ * @brief Rate Monotonic policy decisions shared by the kernel and host tools
+ *
+ * rm_scheduler.c makes every priority, release, deadline and preemption
+ * decision through these helpers, and so does the schedule simulator in
+ * tools/rmsim. Change the policy here and both follow.
+ *
+ * Times are kernel ticks (SYSTICK_FREQ_HZ), priorities are 0 = highest.
+ * Tick comparisons are modulo 2^32, as in the delay and timer queues, so
+ * they stay correct across the tick counter wrapping as long as the times
+ * compared are less than 2^31 ticks apart.
+ */
+
+#ifndef RM_POLICY_H
+#define RM_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Lets periodRTOS.hpp rank task sets at compile time with the same rule */
+#ifdef __cplusplus
+#define RM_POLICY_CONSTEXPR constexpr
+#else
+#define RM_POLICY_CONSTEXPR
+#endif
+
+/* The idle task ranks below every periodic task */
+#define RM_IDLE_PRIORITY(levels)     ((levels) - 1)
+
+/* Longest (m,k)-firm window: one history bit per job */
+#define RM_FIRM_MAX_K                32
+
+/**
+ * @brief Rate Monotonic order: shorter period first, creation order breaks ties
+ * @return true if task A gets a higher priority than task B
+ */
+static inline RM_POLICY_CONSTEXPR bool bRmPrecedes(uint32_t ulPeriodA, uint32_t ulIdA,
+                               uint32_t ulPeriodB, uint32_t ulIdB)
+{
+    return (ulPeriodA < ulPeriodB) || (ulPeriodA == ulPeriodB && ulIdA < ulIdB);
+}
+
+/**
+ * @brief Priority of the task ranked ulRank in bRmPrecedes() order
+ *
+ * Tasks ranked past the last of ulLevels priority levels share it.
+ */
+static inline uint32_t ulRmClampPriority(uint32_t ulRank, uint32_t ulLevels)
+{
+    return (ulRank >= ulLevels) ? ulLevels - 1 : ulRank;
+}
+
+/**
+ * @brief Whether tick ulA comes before tick ulB
+ */
+static inline bool bRmTickBefore(uint32_t ulA, uint32_t ulB)
+{
+    return (int32_t)(ulA - ulB) < 0;
+}
+
+/**
+ * @brief Whether a task's next release is due at tick ulNow
+ */
+static inline bool bRmReleaseDue(uint32_t ulNow, uint32_t ulReleaseTime)
+{
+    return !bRmTickBefore(ulNow, ulReleaseTime);
+}
+
+/**
+ * @brief Release time of the job after one released at ulNow
+ */
+static inline uint32_t ulRmNextRelease(uint32_t ulNow, uint32_t ulPeriod)
+{
+    return ulNow + ulPeriod;
+}
+
+/**
+ * @brief Absolute deadline of a job released at ulRelease
+ */
+static inline uint32_t ulRmAbsoluteDeadline(uint32_t ulRelease, uint32_t ulDeadline)
+{
+    return ulRelease + ulDeadline;
+}
+
+/**
+ * @brief Whether a job still incomplete at tick ulNow has missed its deadline
+ *
+ * The deadline is the start of tick ulDeadlineTime, so a job pending at
+ * that tick is already late.
+ */
+static inline bool bRmDeadlineMissed(uint32_t ulNow, uint32_t ulDeadlineTime)
+{
+    return !bRmTickBefore(ulNow, ulDeadlineTime);
+}
+
+/**
+ * @brief Whether a ready task preempts the running one at a tick
+ */
+static inline bool bRmPreempts(uint32_t ulReadyPriority, uint32_t ulRunningPriority)
+{
+    return ulReadyPriority < ulRunningPriority;
+}
+
+/**
+ * @brief Outcome mask of the last ulJobs jobs in an (m,k)-firm history
+ */
+static inline uint32_t ulRmFirmWindow(uint32_t ulJobs)
+{
+    return (ulJobs >= RM_FIRM_MAX_K) ? UINT32_MAX : ((1UL << ulJobs) - 1);
+}
+
+/**
+ * @brief Append a job outcome to an (m,k)-firm history (bit 0 = latest, 1 = met)
+ */
+static inline uint32_t ulRmFirmRecord(uint32_t ulHistory, bool bMet)
+{
+    return (ulHistory << 1) | (bMet ? 1UL : 0UL);
+}
+
+/**
+ * @brief Whether the latest k jobs hold at least m that met their deadline
+ */
+static inline bool bRmFirmSatisfied(uint32_t ulHistory, uint32_t ulM, uint32_t ulK)
+{
+    return (uint32_t)__builtin_popcount(ulHistory & ulRmFirmWindow(ulK)) >= ulM;
+}
+
+/**
+ * @brief Skip-over: whether the next job of an (m,k)-firm task is optional
+ *
+ * It is if the previous k - 1 jobs already hold m that met, so every window
+ * containing the skipped job still does. Hard tasks (k = 0) never skip.
+ */
+static inline bool bRmFirmOptional(uint32_t ulHistory, uint32_t ulM, uint32_t ulK)
+{
+    return ulK > 0 && bRmFirmSatisfied(ulHistory, ulM, ulK - 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RM_POLICY_H */
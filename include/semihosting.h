@@ -0,0 +1,36 @@
+/**
+ * @file semihosting.h
+ * @brief ARM semihosting console and exit (QEMU, debugger-attached targets)
+ *
+ * Semihosting traps into the debugger or emulator with BKPT 0xAB. Without
+ * one attached the BKPT faults, so only boards built with
+ * PERIODRTOS_SEMIHOSTING use it.
+ */
+
+#ifndef SEMIHOSTING_H
+#define SEMIHOSTING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Operations (ARM semihosting specification) */
+#define SEMIHOSTING_SYS_OPEN            0x01
+#define SEMIHOSTING_SYS_WRITE           0x05
+#define SEMIHOSTING_SYS_EXIT            0x18
+#define SEMIHOSTING_SYS_EXIT_EXTENDED   0x20
+
+#define SEMIHOSTING_OPEN_MODE_W         4           /* fopen() "w" */
+#define SEMIHOSTING_ADP_APPLICATION_EXIT 0x20026UL
+
+bool bSemihostingWrite(const void *pvData, uint32_t ulLength);
+void vSemihostingExit(int iStatus) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMIHOSTING_H */
@@ -112,6 +112,8 @@ typedef struct {
 #define SysTick             ((SysTick_Type *) SysTick_BASE)
 #define NVIC                ((NVIC_Type *) NVIC_BASE)
 #define SCB                 ((SCB_Type *) SCB_BASE)
+#define DWT                 ((DWT_Type *) DWT_BASE)
+#define CoreDebug           ((CoreDebug_Type *) CoreDebug_BASE)
 
 /* RCC register definitions (STM32F303) */
 typedef struct {
@@ -193,6 +195,20 @@ typedef struct {
     volatile uint32_t CPACR;
 } SCB_Type;
 
+/* DWT register definitions (cycle counter only) */
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+/* Core debug register definitions */
+typedef struct {
+    volatile uint32_t DHCSR;
+    volatile uint32_t DCRSR;
+    volatile uint32_t DCRDR;
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
 /* Flash register definitions */
 typedef struct {
     volatile uint32_t ACR;
@@ -206,13 +222,77 @@ typedef struct {
 
 #define FLASH                ((FLASH_TypeDef *) FLASH_BASE)
 
+/* USART register definitions (STM32F303) */
+typedef struct {
+    volatile uint32_t CR1;        /* 0x00 */
+    volatile uint32_t CR2;        /* 0x04 */
+    volatile uint32_t CR3;        /* 0x08 */
+    volatile uint32_t BRR;        /* 0x0C */
+    volatile uint32_t GTPR;       /* 0x10 */
+    volatile uint32_t RTOR;       /* 0x14 */
+    volatile uint32_t RQR;        /* 0x18 */
+    volatile uint32_t ISR;        /* 0x1C */
+    volatile uint32_t ICR;        /* 0x20 */
+    volatile uint32_t RDR;        /* 0x24 */
+    volatile uint32_t TDR;        /* 0x28 */
+} USART_TypeDef;
+
+#define USART1               ((USART_TypeDef *) USART1_BASE)
+#define USART2               ((USART_TypeDef *) USART2_BASE)
+#define USART3               ((USART_TypeDef *) USART3_BASE)
+
+/* DMA register definitions (STM32F303) */
+typedef struct {
+    volatile uint32_t CCR;
+    volatile uint32_t CNDTR;
+    volatile uint32_t CPAR;
+    volatile uint32_t CMAR;
+    volatile uint32_t RESERVED;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    volatile uint32_t ISR;
+    volatile uint32_t IFCR;
+    DMA_Channel_TypeDef CH[7];    /* CH[0] is channel 1 */
+} DMA_TypeDef;
+
+#define DMA1_BASE            (AHB1PERIPH_BASE + 0x0000UL)
+#define DMA1                 ((DMA_TypeDef *) DMA1_BASE)
+
+/* General-purpose timer register definitions (STM32F303 TIM2-4) */
+typedef struct {
+    volatile uint32_t CR1;        /* 0x00 */
+    volatile uint32_t CR2;        /* 0x04 */
+    volatile uint32_t SMCR;       /* 0x08 */
+    volatile uint32_t DIER;       /* 0x0C */
+    volatile uint32_t SR;         /* 0x10 */
+    volatile uint32_t EGR;        /* 0x14 */
+    volatile uint32_t CCMR1;      /* 0x18 */
+    volatile uint32_t CCMR2;      /* 0x1C */
+    volatile uint32_t CCER;       /* 0x20 */
+    volatile uint32_t CNT;        /* 0x24 */
+    volatile uint32_t PSC;        /* 0x28 */
+    volatile uint32_t ARR;        /* 0x2C */
+} TIM_TypeDef;
+
+#define TIM2                 ((TIM_TypeDef *) TIM2_BASE)
+
 /* Register bit definitions */
+#define RCC_CR_HSION_Pos             0
+#define RCC_CR_HSION_Msk             (1UL << RCC_CR_HSION_Pos)
+#define RCC_CR_HSION                 RCC_CR_HSION_Msk
+#define RCC_CR_HSIRDY_Pos            1
+#define RCC_CR_HSIRDY_Msk            (1UL << RCC_CR_HSIRDY_Pos)
+#define RCC_CR_HSIRDY                RCC_CR_HSIRDY_Msk
 #define RCC_CR_HSEON_Pos             16
 #define RCC_CR_HSEON_Msk             (1UL << RCC_CR_HSEON_Pos)
 #define RCC_CR_HSEON                 RCC_CR_HSEON_Msk
 #define RCC_CR_HSERDY_Pos            17
 #define RCC_CR_HSERDY_Msk            (1UL << RCC_CR_HSERDY_Pos)
 #define RCC_CR_HSERDY                RCC_CR_HSERDY_Msk
+#define RCC_CR_HSEBYP_Pos            18
+#define RCC_CR_HSEBYP_Msk            (1UL << RCC_CR_HSEBYP_Pos)
+#define RCC_CR_HSEBYP                RCC_CR_HSEBYP_Msk
 #define RCC_CR_PLLON_Pos             24
 #define RCC_CR_PLLON_Msk             (1UL << RCC_CR_PLLON_Pos)
 #define RCC_CR_PLLON                 RCC_CR_PLLON_Msk
@@ -234,21 +314,35 @@ typedef struct {
 
 #define RCC_CFGR_SW_Pos              0
 #define RCC_CFGR_SW_Msk              (3UL << RCC_CFGR_SW_Pos)
+#define RCC_CFGR_SW_HSI              (0UL << RCC_CFGR_SW_Pos)
 #define RCC_CFGR_SW_PLL              (2UL << RCC_CFGR_SW_Pos)
 #define RCC_CFGR_SWS_Pos             2
 #define RCC_CFGR_SWS_Msk             (3UL << RCC_CFGR_SWS_Pos)
 #define RCC_CFGR_SWS                 RCC_CFGR_SWS_Msk
+#define RCC_CFGR_SWS_HSI             (0UL << RCC_CFGR_SWS_Pos)
 #define RCC_CFGR_SWS_PLL             (2UL << RCC_CFGR_SWS_Pos)
 #define RCC_CFGR_HPRE_Pos            4
 #define RCC_CFGR_HPRE_Msk            (0xFUL << RCC_CFGR_HPRE_Pos)
 #define RCC_CFGR_HPRE_DIV1           (0UL << RCC_CFGR_HPRE_Pos)
 #define RCC_CFGR_PPRE1_Pos           10
 #define RCC_CFGR_PPRE1_Msk           (7UL << RCC_CFGR_PPRE1_Pos)
+#define RCC_CFGR_PPRE1_DIV1          (0UL << RCC_CFGR_PPRE1_Pos)
+#define RCC_CFGR_PPRE1_DIV2          (4UL << RCC_CFGR_PPRE1_Pos)
 #define RCC_CFGR_PPRE1_DIV4          (5UL << RCC_CFGR_PPRE1_Pos)
 #define RCC_CFGR_PPRE2_Pos           13
 #define RCC_CFGR_PPRE2_Msk           (7UL << RCC_CFGR_PPRE2_Pos)
+#define RCC_CFGR_PPRE2_DIV1          (0UL << RCC_CFGR_PPRE2_Pos)
 #define RCC_CFGR_PPRE2_DIV2          (4UL << RCC_CFGR_PPRE2_Pos)
 
+/* RCC_CFGR PLL fields (STM32F303xB/C: HSI is divided by 2 in front of the PLL) */
+#define RCC_CFGR_PLLSRC_Pos          16
+#define RCC_CFGR_PLLSRC_Msk          (1UL << RCC_CFGR_PLLSRC_Pos)
+#define RCC_CFGR_PLLSRC_HSI_DIV2     (0UL << RCC_CFGR_PLLSRC_Pos)
+#define RCC_CFGR_PLLSRC_HSE_PREDIV   (1UL << RCC_CFGR_PLLSRC_Pos)
+#define RCC_CFGR_PLLMUL_Pos          18
+#define RCC_CFGR_PLLMUL_Msk          (0xFUL << RCC_CFGR_PLLMUL_Pos)
+#define RCC_CFGR_PLLMUL(x)           ((((x) - 2UL) & 0xFUL) << RCC_CFGR_PLLMUL_Pos)  /* x2 .. x16 */
+
 /* RCC AHB enable bits (STM32F303) */
 #define RCC_AHBENR_IOPAEN_Pos        17
 #define RCC_AHBENR_IOPAEN_Msk        (1UL << RCC_AHBENR_IOPAEN_Pos)
@@ -364,16 +458,67 @@ typedef struct {
 #define GPIO_ODR_OD14                GPIO_ODR_OD14_Msk
 #define GPIO_ODR_OD15                GPIO_ODR_OD15_Msk
 
+#define RCC_AHBENR_DMA1EN_Pos        0
+#define RCC_AHBENR_DMA1EN_Msk        (1UL << RCC_AHBENR_DMA1EN_Pos)
+#define RCC_AHBENR_DMA1EN            RCC_AHBENR_DMA1EN_Msk
+#define RCC_AHBENR_IOPCEN            RCC_AHBENR_IOPCEN_Msk
+#define RCC_APB2ENR_USART1EN_Pos     14
+#define RCC_APB2ENR_USART1EN_Msk     (1UL << RCC_APB2ENR_USART1EN_Pos)
+#define RCC_APB2ENR_USART1EN         RCC_APB2ENR_USART1EN_Msk
+#define RCC_APB1ENR_TIM2EN_Pos       0
+#define RCC_APB1ENR_TIM2EN_Msk       (1UL << RCC_APB1ENR_TIM2EN_Pos)
+#define RCC_APB1ENR_TIM2EN           RCC_APB1ENR_TIM2EN_Msk
+
+#define USART_CR1_UE                 (1UL << 0)
+#define USART_CR1_RE                 (1UL << 2)
+#define USART_CR1_TE                 (1UL << 3)
+#define USART_CR3_DMAT               (1UL << 7)
+#define USART_ISR_TC                 (1UL << 6)
+#define USART_ISR_TXE                (1UL << 7)
+#define USART_ICR_TCCF               (1UL << 6)
+
+#define DMA_CCR_EN                   (1UL << 0)
+#define DMA_CCR_TCIE                 (1UL << 1)
+#define DMA_CCR_TEIE                 (1UL << 3)
+#define DMA_CCR_DIR                  (1UL << 4)
+#define DMA_CCR_MINC                 (1UL << 7)
+#define DMA_CCR_PL_Pos               12
+#define DMA_CCR_PL_LOW               (0UL << DMA_CCR_PL_Pos)
+#define DMA_ISR_GIF_Pos(ch)          (((ch) - 1) * 4)
+#define DMA_ISR_TCIF(ch)             (2UL << DMA_ISR_GIF_Pos(ch))
+#define DMA_ISR_TEIF(ch)             (8UL << DMA_ISR_GIF_Pos(ch))
+#define DMA_IFCR_CGIF(ch)            (1UL << DMA_ISR_GIF_Pos(ch))
+
+#define TIM_CR1_CEN                  (1UL << 0)
+#define TIM_CR1_URS                  (1UL << 2)
+#define TIM_DIER_UIE                 (1UL << 0)
+#define TIM_SR_UIF                   (1UL << 0)
+#define TIM_EGR_UG                   (1UL << 0)
+
+#define GPIO_MODER_AF                2UL
+#define GPIO_AF7_USART1              7UL
+
 #define SysTick_CTRL_ENABLE_Pos      0
 #define SysTick_CTRL_ENABLE_Msk      (1UL << SysTick_CTRL_ENABLE_Pos)
 #define SysTick_CTRL_TICKINT_Pos     1
 #define SysTick_CTRL_TICKINT_Msk     (1UL << SysTick_CTRL_TICKINT_Pos)
 #define SysTick_CTRL_CLKSOURCE_Pos   2
 #define SysTick_CTRL_CLKSOURCE_Msk   (1UL << SysTick_CTRL_CLKSOURCE_Pos)
+#define SysTick_LOAD_RELOAD_Msk      0x00FFFFFFUL
+
+#define SCB_ICSR_PENDSTSET_Pos       26
+#define SCB_ICSR_PENDSTSET_Msk       (1UL << SCB_ICSR_PENDSTSET_Pos)
+
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+#define DWT_CTRL_NOCYCCNT_Msk        (1UL << 25)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
 
 #define FLASH_ACR_LATENCY_Pos        0
 #define FLASH_ACR_LATENCY_Msk        (0xFUL << FLASH_ACR_LATENCY_Pos)
 #define FLASH_ACR_LATENCY_5WS        (5UL << FLASH_ACR_LATENCY_Pos)
+#define FLASH_ACR_PRFTBE_Pos         4       /* STM32F303 prefetch buffer */
+#define FLASH_ACR_PRFTBE_Msk         (1UL << FLASH_ACR_PRFTBE_Pos)
+#define FLASH_ACR_PRFTBE             FLASH_ACR_PRFTBE_Msk
 #define FLASH_ACR_PRFTEN_Pos         8
 #define FLASH_ACR_PRFTEN_Msk         (1UL << FLASH_ACR_PRFTEN_Pos)
 #define FLASH_ACR_PRFTEN             FLASH_ACR_PRFTEN_Msk
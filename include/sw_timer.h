@@ -0,0 +1,63 @@
+/**
+ * @file sw_timer.h
+ * @brief Software timers for periodRTOS
+ *
+ * Short one-shot or periodic actions (debouncing, timeouts, LED patterns)
+ * run as callbacks of one kernel task instead of a periodic task each.
+ * Running timers are kept in a queue ordered by expiry tick; the tick
+ * handler only compares the queue head with the current tick.
+ *
+ * The timer service task is sporadic: it is released at the first tick at
+ * which a timer is due and at least TIMER_SERVICE_PERIOD ticks have passed
+ * since its previous release. For the Rate Monotonic analysis it is a
+ * periodic task of that period and deadline, which is also where its
+ * priority comes from; a period of 1 ranks it above every other task.
+ * Callbacks run in task context, in expiry order, and must not block.
+ *
+ * Start, stop and reset only relink the timer in a critical section and may
+ * be called from tasks, callbacks and interrupts up to
+ * KERNEL_MAX_SYSCALL_PRIORITY.
+ */
+
+#ifndef SW_TIMER_H
+#define SW_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "periodRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Timer handle - opaque pointer */
+typedef void* TimerHandle_t;
+
+/* Timer callback, runs in the timer service task */
+typedef void (*TimerCallback_t)(TimerHandle_t xTimer);
+
+/* Name of the service task, for time-triggered tables (tools/ttgen) */
+#define TIMER_SERVICE_NAME      "TmrSvc"
+
+/* Configuration, from tasks */
+TimerHandle_t xTimerCreate(const char *pcName, uint32_t ulPeriodTicks, bool bAutoReload,
+                           TimerCallback_t pxCallback, void *pvContext);
+
+/* Run time, from tasks, callbacks or interrupts */
+bool bTimerStart(TimerHandle_t xTimer);
+bool bTimerStop(TimerHandle_t xTimer);
+bool bTimerReset(TimerHandle_t xTimer);
+bool bTimerIsActive(TimerHandle_t xTimer);
+void *pvTimerGetContext(TimerHandle_t xTimer);
+const char *pcTimerGetName(TimerHandle_t xTimer);
+TaskHandle_t xTimerGetServiceTask(void);
+
+/* Kernel hooks (ENABLE_SOFTWARE_TIMERS) */
+void vTimerServiceCreate(void);
+bool bTimerServiceDue(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SW_TIMER_H */
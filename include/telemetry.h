@@ -0,0 +1,87 @@
+/**
+ * @file telemetry.h
+ * @brief Non-blocking, COBS-framed telemetry transport for periodRTOS
+ *
+ * Frames are encoded once at enqueue time into one half of a double buffer
+ * while the UART DMA drains the other half. Wire format of a frame:
+ *
+ *   COBS( channel:u8 | sequence:u8 | payload[n] | crc16:u16le ) 0x00
+ *
+ * The CRC is CRC-16/CCITT-FALSE over channel, sequence and payload.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Transport configuration */
+#define TELEMETRY_BAUD_RATE          115200
+#define TELEMETRY_TX_BUFFER_SIZE     1024    /* Bytes per half of the double buffer */
+#define TELEMETRY_MAX_PAYLOAD        832     /* Fits one TelemetrySnapshot_t */
+#define TELEMETRY_FRAME_OVERHEAD     4       /* Channel, sequence, CRC */
+
+/* Worst case COBS output for n input bytes, plus the 0x00 delimiter */
+#define COBS_MAX_ENCODED_SIZE(n)     ((n) + ((n) / 254) + 2)
+
+/* Multiplexed channels */
+typedef enum {
+    TELEMETRY_CHANNEL_TRACE = 0,     /* Kernel/application trace events */
+    TELEMETRY_CHANNEL_LOG,           /* Text output (stdout/stderr via _write) */
+    TELEMETRY_CHANNEL_TELEMETRY,     /* Binary TelemetrySnapshot_t records */
+    TELEMETRY_CHANNEL_PROFILE,       /* PC samples (profiler.h) */
+    TELEMETRY_CHANNEL_COUNT
+} TelemetryChannel_t;
+
+/* Transport statistics */
+typedef struct {
+    uint32_t ulFramesSent[TELEMETRY_CHANNEL_COUNT];
+    uint32_t ulFramesDropped[TELEMETRY_CHANNEL_COUNT];
+    uint32_t ulBytesSent;
+    uint32_t ulDmaTransfers;
+} TelemetryStats_t;
+
+/* Transport API */
+void vTelemetryInit(void);
+bool bTelemetrySend(TelemetryChannel_t eChannel, const void *pvData, uint32_t ulLength);
+bool bTelemetrySendSnapshot(void);
+void vTelemetryGetStats(TelemetryStats_t *pxStats);
+
+/* Called by the UART driver when a DMA transfer has completed */
+void vTelemetryTxComplete(void);
+
+/* Incremental COBS encoder state */
+typedef struct {
+    uint8_t *pucOut;                 /* Next output byte */
+    uint8_t *pucCode;                /* Pending code byte of the current block */
+    uint8_t ucCode;                  /* Distance to the next zero so far */
+} CobsEncoder_t;
+
+/* COBS / CRC helpers (shared with host tools) */
+void vCobsEncodeStart(CobsEncoder_t *pxEncoder, uint8_t *pucDst);
+void vCobsEncodeByte(CobsEncoder_t *pxEncoder, uint8_t ucByte);
+uint32_t ulCobsEncodeFinish(CobsEncoder_t *pxEncoder, uint8_t *pucDst);
+uint32_t ulCobsEncode(const uint8_t *pucSrc, uint32_t ulLength, uint8_t *pucDst);
+uint32_t ulCobsDecode(const uint8_t *pucSrc, uint32_t ulLength, uint8_t *pucDst);
+uint16_t usCrc16Update(uint16_t usCrc, const uint8_t *pucData, uint32_t ulLength);
+
+/* UART DMA driver (board specific) */
+void vUartDmaInit(uint32_t ulBaudRate);
+void vUartDmaStart(const uint8_t *pucData, uint32_t ulLength);
+void vUartDmaClockChanged(void);
+
+/* Short interrupt masking used around buffer bookkeeping; masks up to
+ * KERNEL_MAX_SYSCALL_PRIORITY (see vKernelEnterCritical()) */
+uint32_t ulHalDisableInterrupts(void);
+void vHalRestoreInterrupts(uint32_t ulState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H */
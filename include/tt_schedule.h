@@ -0,0 +1,62 @@
+/**
+ * @file tt_schedule.h
+ * @brief Time-triggered dispatch tables for periodRTOS
+ *
+ * A table covers one hyperperiod of the periodic task set and lists the
+ * ticks at which the running task changes. With ENABLE_TIME_TRIGGERED and
+ * a table installed, the tick handler only compares the tick with the next
+ * entry and, on a match, dispatches the task it names: no priorities, no
+ * ready list. Tables are generated offline by tools/ttgen, which also
+ * checks that every job gets its execution time before its deadline.
+ *
+ * Entries refer to the table's own task list; bTtScheduleInstall() binds
+ * it to kernel tasks by name and period once, before the scheduler starts.
+ */
+
+#ifndef TT_SCHEDULE_H
+#define TT_SCHEDULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "periodRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ucTask value that dispatches the idle task */
+#define TT_IDLE                 0
+
+/* Entry flags */
+#define TT_FLAG_RELEASE         0x01    /* First slot of a new job */
+
+/* One dispatch point */
+typedef struct {
+    uint32_t ulOffset;               /* Tick within the hyperperiod */
+    uint8_t ucTask;                  /* 1-based index into the table's tasks, TT_IDLE */
+    uint8_t ucFlags;                 /* TT_FLAG_* */
+    uint16_t usReserved;
+} TtEntry_t;                         /* 8 bytes */
+
+/* Complete table, as emitted by ttgen */
+typedef struct {
+    uint32_t ulHyperperiod;          /* Ticks; the table repeats after this */
+    uint32_t ulEntries;
+    const TtEntry_t *pxEntries;      /* Strictly ascending offsets, the first at 0 */
+    uint32_t ulTasks;
+    const char * const *ppcTaskNames;
+    const uint32_t *pulTaskPeriods;  /* Ticks, must match the kernel tasks */
+} TtSchedule_t;
+
+/* Kernel mode (ENABLE_TIME_TRIGGERED) */
+bool bTtScheduleInstall(const TtSchedule_t *pxSchedule);
+bool bTtActive(void);
+void vTtStart(void);
+bool bTtTick(void);
+TaskHandle_t xTtGetNextTask(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TT_SCHEDULE_H */
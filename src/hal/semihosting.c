@@ -0,0 +1,69 @@
+/**
+ * @file semihosting.c
+ * @brief ARM semihosting console and exit
+ */
+
+#include "semihosting.h"
+#include <stddef.h>
+
+/* Host console handle, opened on first write */
+static int32_t lConsoleHandle = -1;
+
+/* Internal function prototypes */
+static int32_t lSemihostingCall(uint32_t ulOperation, const void *pvArgument);
+
+/**
+ * @brief Write to the host's stdout
+ * @return false if the host did not take every byte
+ */
+bool bSemihostingWrite(const void *pvData, uint32_t ulLength)
+{
+    uint32_t pulArguments[3];
+
+    if (lConsoleHandle < 0) {
+        static const char pcConsole[] = ":tt";
+
+        pulArguments[0] = (uint32_t)(uintptr_t)pcConsole;
+        pulArguments[1] = SEMIHOSTING_OPEN_MODE_W;
+        pulArguments[2] = sizeof(pcConsole) - 1;
+        lConsoleHandle = lSemihostingCall(SEMIHOSTING_SYS_OPEN, pulArguments);
+        if (lConsoleHandle < 0) {
+            return false;
+        }
+    }
+
+    pulArguments[0] = (uint32_t)lConsoleHandle;
+    pulArguments[1] = (uint32_t)(uintptr_t)pvData;
+    pulArguments[2] = ulLength;
+
+    /* Returns the number of bytes not written */
+    return lSemihostingCall(SEMIHOSTING_SYS_WRITE, pulArguments) == 0;
+}
+
+/**
+ * @brief Terminate the emulator / debug session with an exit status
+ */
+void vSemihostingExit(int iStatus)
+{
+    uint32_t pulArguments[2];
+
+    pulArguments[0] = SEMIHOSTING_ADP_APPLICATION_EXIT;
+    pulArguments[1] = (uint32_t)iStatus;
+    (void)lSemihostingCall(SEMIHOSTING_SYS_EXIT_EXTENDED, pulArguments);
+
+    /* Host without SYS_EXIT_EXTENDED: plain exit, status lost */
+    (void)lSemihostingCall(SEMIHOSTING_SYS_EXIT, (const void *)SEMIHOSTING_ADP_APPLICATION_EXIT);
+
+    for (;;) {
+    }
+}
+
+static int32_t lSemihostingCall(uint32_t ulOperation, const void *pvArgument)
+{
+    register uint32_t r0 __asm("r0") = ulOperation;
+    register const void *r1 __asm("r1") = pvArgument;
+
+    __asm volatile ("bkpt 0xAB" : "+r" (r0) : "r" (r1) : "memory");
+
+    return (int32_t)r0;
+}
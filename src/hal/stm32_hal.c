@@ -3,10 +3,11 @@
  * @brief Simple STM32 HAL implementation for periodRTOS
  */
 
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "profiler.h"
 #include "stm32f303xx.h"
 
-void vConfigureSystemClock(void);
-
 /**
  * @brief Set interrupt priority
  */
@@ -41,6 +42,41 @@ void NVIC_DisableIRQ(IRQn_Type IRQn)
     }
 }
 
+/* BASEPRI value masking KERNEL_MAX_SYSCALL_PRIORITY and everything less urgent;
+ * also used by PendSV_Handler */
+#define KERNEL_SYSCALL_BASEPRI  ((KERNEL_MAX_SYSCALL_PRIORITY << (8 - __NVIC_PRIO_BITS)) & 0xFF)
+
+_Static_assert(KERNEL_MAX_SYSCALL_PRIORITY > 0 &&
+               KERNEL_MAX_SYSCALL_PRIORITY < (1 << __NVIC_PRIO_BITS),
+               "BASEPRI 0 masks nothing; priority 0 stays reserved for zero-latency interrupts");
+
+const uint32_t ulKernelSyscallBasepri = KERNEL_SYSCALL_BASEPRI;
+
+/**
+ * @brief Mask kernel-aware interrupts, returning the previous BASEPRI
+ *
+ * basepri_max only ever raises the mask, so nested calls from interrupts
+ * or already masked code keep the stricter level. Interrupts more urgent
+ * than KERNEL_MAX_SYSCALL_PRIORITY keep running.
+ */
+uint32_t ulHalDisableInterrupts(void)
+{
+    uint32_t ulState;
+
+    __asm volatile ("mrs %0, basepri\n"
+                    "msr basepri_max, %1\n"
+                    "isb" : "=&r" (ulState) : "r" (KERNEL_SYSCALL_BASEPRI) : "memory");
+    return ulState;
+}
+
+/**
+ * @brief Restore BASEPRI saved by ulHalDisableInterrupts()
+ */
+void vHalRestoreInterrupts(uint32_t ulState)
+{
+    __asm volatile ("msr basepri, %0" : : "r" (ulState) : "memory");
+}
+
 /**
  * @brief System initialization
  */
@@ -72,10 +108,35 @@ void WWDG_IRQHandler(void)
 }
 
 /**
- * @brief Configure system clock to 168MHz
+ * @brief Run from the fastest clock profile the board can reach
+ *
+ * A profile fails if its oscillator is missing; fall back to the next
+ * slower one. The profiles themselves are board-specific (clock.c).
  */
 void vConfigureSystemClock(void)
 {
-    /* For STM32F3: keep default HSI (8MHz). Optionally enable HSE and set prescalers later. */
-    SystemCoreClock = 8000000;
+    uint32_t ulProfile = ulClockProfileCount();
+
+    while (ulProfile > 0) {
+        ulProfile--;
+        if (bClockSetProfile(ulProfile)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Re-derive everything that depends on SystemCoreClock
+ *
+ * Called by bClockSetProfile() with interrupts masked.
+ */
+void vSystemClockChanged(void)
+{
+    vSystickUpdateReload();
+#if ENABLE_TELEMETRY_UART
+    vUartDmaClockChanged();
+#endif
+#if ENABLE_PROFILER
+    vProfilerTimerClockChanged();
+#endif
 }
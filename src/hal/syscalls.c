@@ -4,41 +4,184 @@
  */
 
 #include <errno.h>
+#include <stddef.h>
 #include <sys/stat.h>
+#include "heap.h"
+#include "telemetry.h"
+#include "semihosting.h"
 
-/* External symbols from linker script */
-extern char _end;           /* End of BSS */
-extern char _estack;        /* End of stack */
+/* Console on the debugger / emulator instead of the telemetry log channel */
+#ifndef PERIODRTOS_SEMIHOSTING
+#define PERIODRTOS_SEMIHOSTING  0
+#endif
 
-/* Current heap pointer */
-static char *heap_end = &_end;
+/* Heap region from the linker script */
+extern char _heap_start;    /* End of BSS */
+extern char _heap_end;      /* Start of the main stack reserve */
+
+struct _reent;
 
 /**
- * @brief System call for memory allocation
+ * @brief Heap region for the TLSF allocator
  */
-void *_sbrk(ptrdiff_t incr)
+void vBoardHeapRegion(void **ppvStart, size_t *pxSize)
+{
+    *ppvStart = &_heap_start;
+    *pxSize = (size_t)(&_heap_end - &_heap_start);
+}
+
+/**
+ * @brief Standard allocation entry points, routed to the TLSF heap
+ *
+ * newlib's own malloc would grow the heap through _sbrk with unbounded
+ * search times; these take precedence at link time, reentrant variants
+ * included.
+ */
+void *malloc(size_t size)
+{
+    void *ptr = pvHeapAlloc(size);
+
+    if (ptr == NULL) {
+        errno = ENOMEM;
+    }
+    return ptr;
+}
+
+void free(void *ptr)
 {
-    char *prev_heap_end = heap_end;
-    
-    /* Check if we have enough memory */
-    if (heap_end + incr > &_estack) {
+    vHeapFree(ptr);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    void *ptr = pvHeapCalloc(count, size);
+
+    if (ptr == NULL) {
         errno = ENOMEM;
-        return (void *)-1;
     }
-    
-    /* Update heap pointer */
-    heap_end += incr;
-    
-    return (void *)prev_heap_end;
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    void *new_ptr = pvHeapRealloc(ptr, size);
+
+    if (new_ptr == NULL && size != 0) {
+        errno = ENOMEM;
+    }
+    return new_ptr;
+}
+
+void *_malloc_r(struct _reent *r, size_t size)
+{
+    (void)r;
+    return malloc(size);
+}
+
+void _free_r(struct _reent *r, void *ptr)
+{
+    (void)r;
+    free(ptr);
+}
+
+void *_calloc_r(struct _reent *r, size_t count, size_t size)
+{
+    (void)r;
+    return calloc(count, size);
+}
+
+void *_realloc_r(struct _reent *r, void *ptr, size_t size)
+{
+    (void)r;
+    return realloc(ptr, size);
+}
+
+/**
+ * @brief Aligned allocation entry points, on the same TLSF heap
+ *
+ * Left to newlib, these would pull in its malloc and _sbrk next to ours
+ * and hand out blocks that free() cannot take back.
+ */
+void *memalign(size_t alignment, size_t size)
+{
+    void *ptr = pvHeapAllocAligned(alignment, size);
+
+    if (ptr == NULL) {
+        errno = (alignment == 0 || (alignment & (alignment - 1)) != 0) ? EINVAL : ENOMEM;
+    }
+    return ptr;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    void *ptr;
+
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    ptr = pvHeapAllocAligned(alignment, size);
+    if (ptr == NULL) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+}
+
+void *_memalign_r(struct _reent *r, size_t alignment, size_t size)
+{
+    (void)r;
+    return memalign(alignment, size);
 }
 
 /**
- * @brief Write system call (stub)
+ * @brief System call for memory allocation
+ *
+ * The free RAM belongs to the TLSF heap, so there is nothing to grow.
+ */
+void *_sbrk(ptrdiff_t incr)
+{
+    (void)incr;
+    errno = ENOMEM;
+    return (void *)-1;
+}
+
+/**
+ * @brief Write system call - stdout/stderr go out on the telemetry log channel
+ *
+ * Never blocks; output that does not fit the transmit buffer is dropped.
+ * Semihosting builds write to the host console instead.
  */
 int _write(int file, char *ptr, int len)
 {
-    /* For now, just return success */
-    /* In a real system, this would send data via UART */
+    int sent = 0;
+
+    if (file != 1 && file != 2) {
+        errno = EBADF;
+        return -1;
+    }
+
+#if PERIODRTOS_SEMIHOSTING
+    if (!bSemihostingWrite(ptr, (uint32_t)len)) {
+        errno = EIO;
+        return -1;
+    }
+    sent = len;
+#endif
+
+    while (sent < len) {
+        int chunk = len - sent;
+        if (chunk > TELEMETRY_MAX_PAYLOAD) {
+            chunk = TELEMETRY_MAX_PAYLOAD;
+        }
+        bTelemetrySend(TELEMETRY_CHANNEL_LOG, ptr + sent, (uint32_t)chunk);
+        sent += chunk;
+    }
+
     return len;
 }
 
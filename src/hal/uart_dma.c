@@ -0,0 +1,99 @@
+/**
+ * @file uart_dma.c
+ * @brief USART1 transmit via DMA for the telemetry transport (STM32F303)
+ *
+ * USART1 TX on PC4 (AF7), which the STM32F3 Discovery routes to the ST-LINK
+ * virtual COM port. Transmission uses DMA1 channel 4; the CPU only programs
+ * the channel and handles one interrupt per transfer.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "stm32f303xx.h"
+
+/* USART1_TX is hard-wired to DMA1 channel 4 on the F303 */
+#define UART_DMA_CHANNEL        4
+#define UART_DMA_IRQ_PRIORITY   15      /* Lowest - never delays the tick */
+
+/* External variables */
+extern uint32_t SystemCoreClock;
+
+/* Configured baud rate, 0 until vUartDmaInit() */
+static uint32_t ulUartBaudRate = 0;
+
+/**
+ * @brief Configure PC4, USART1 and DMA1 channel 4 for transmission
+ */
+void vUartDmaInit(uint32_t ulBaudRate)
+{
+    DMA_Channel_TypeDef *pxChannel = &DMA1->CH[UART_DMA_CHANNEL - 1];
+
+    /* Clocks: GPIOC, DMA1 (AHB) and USART1 (APB2) */
+    RCC->AHBENR |= RCC_AHBENR_IOPCEN | RCC_AHBENR_DMA1EN;
+    RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
+
+    /* PC4 -> AF7 (USART1_TX) */
+    GPIOC->MODER = (GPIOC->MODER & ~GPIO_MODER_MODER4_Msk) | (GPIO_MODER_AF << GPIO_MODER_MODER4_Pos);
+    GPIOC->AFR[0] = (GPIOC->AFR[0] & ~(0xFUL << 16)) | (GPIO_AF7_USART1 << 16);
+
+    /* 8N1, transmitter only, TX requests served by DMA */
+    ulUartBaudRate = ulBaudRate;
+    USART1->CR1 = 0;
+    USART1->BRR = SystemCoreClock / ulBaudRate;  /* APB2 runs undivided */
+    USART1->CR3 = USART_CR3_DMAT;
+    USART1->CR1 = USART_CR1_TE | USART_CR1_UE;
+
+    /* Memory -> peripheral, byte wide, memory increment, interrupt on completion */
+    pxChannel->CCR = 0;
+    pxChannel->CPAR = (uint32_t)&USART1->TDR;
+    pxChannel->CCR = DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_TCIE | DMA_CCR_TEIE | DMA_CCR_PL_LOW;
+
+    NVIC_SetPriority(DMA1_Channel4_IRQn, UART_DMA_IRQ_PRIORITY);
+    NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+}
+
+/**
+ * @brief Start transmitting a buffer; completion calls vTelemetryTxComplete()
+ */
+void vUartDmaStart(const uint8_t *pucData, uint32_t ulLength)
+{
+    DMA_Channel_TypeDef *pxChannel = &DMA1->CH[UART_DMA_CHANNEL - 1];
+
+    pxChannel->CCR &= ~DMA_CCR_EN;
+    pxChannel->CMAR = (uint32_t)pucData;
+    pxChannel->CNDTR = ulLength;
+    pxChannel->CCR |= DMA_CCR_EN;
+}
+
+/**
+ * @brief Recompute the baud rate divider after a SYSCLK change
+ *
+ * BRR is only writable with the USART disabled. A byte on the wire during
+ * the clock switch is garbled either way; the receiver drops that frame on
+ * its CRC and resynchronizes at the next delimiter.
+ */
+void vUartDmaClockChanged(void)
+{
+    if (ulUartBaudRate == 0) {
+        return;
+    }
+
+    USART1->CR1 &= ~USART_CR1_UE;
+    USART1->BRR = SystemCoreClock / ulUartBaudRate;
+    USART1->CR1 |= USART_CR1_UE;
+}
+
+/**
+ * @brief DMA1 channel 4 interrupt - transfer complete or error
+ */
+void DMA1_Channel4_IRQHandler(void)
+{
+    uint32_t ulStatus = DMA1->ISR;
+
+    DMA1->IFCR = DMA_IFCR_CGIF(UART_DMA_CHANNEL);
+
+    if (ulStatus & (DMA_ISR_TCIF(UART_DMA_CHANNEL) | DMA_ISR_TEIF(UART_DMA_CHANNEL))) {
+        DMA1->CH[UART_DMA_CHANNEL - 1].CCR &= ~DMA_CCR_EN;
+        vTelemetryTxComplete();
+    }
+}
@@ -4,21 +4,41 @@
  */
 
 #include "periodRTOS.h"
+#include "sw_timer.h"
+#include "rm_policy.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include "chain.h"
 #include <string.h>
 #include <stdio.h>
 
-/* Global variables */
-TaskControlBlock_t xTaskList[MAX_TASKS];
+/* Global variables; TCBs, details and the stack pool go to the board's kernel region */
+TaskControlBlock_t xTaskList[MAX_TASKS] KERNEL_DATA_ATTRIBUTES;
+TaskDetail_t xTaskDetails[MAX_TASKS] KERNEL_DATA_ATTRIBUTES;
+
+_Static_assert(MAX_TASKS < 256 && MAX_PRIORITY_LEVELS <= 256, "task IDs and priorities are 8-bit TCB fields");
+_Static_assert(RM_FIRM_MAX_K < 64, "(m,k)-firm parameters are 6-bit TCB fields");
 TaskHandle_t xCurrentTask = NULL;
 TaskHandle_t xIdleTask = NULL;
 static uint32_t ulNextTaskID = 1;
 static uint32_t ulTaskCount = 0;
 static SchedulerState_t eSchedulerState = SCHEDULER_NOT_STARTED;
+static bool bPrioritiesPrecomputed = false;
+static uint32_t ulCriticalNesting = 0;
+static uint32_t ulCriticalSavedState = 0;
 SystemMonitor_t xSystemMonitor = {0};
 
-/* Each task gets a fixed stack size allocated at compile time */
+/* Static task table (TASK_DEFINE); weak so an empty table links on the host */
+extern const TaskDescriptor_t __start_task_table[] __attribute__((weak));
+extern const TaskDescriptor_t __stop_task_table[] __attribute__((weak));
+
+/* Each task gets a fixed stack size allocated at compile time, plus its canary.
+ * Weak: an application sizes the pool and the idle stack with TASK_STACK_POOL() */
+#define STACK_MEMORY_WORDS (STACK_POOL_TASKS * STACK_POOL_WORDS(DEFAULT_STACK_SIZE))
 //uint32_t ulStackMemory[MAX_TASKS][DEFAULT_STACK_SIZE / sizeof(uint32_t)];
-uint32_t ulStackMemory[MAX_TASKS * DEFAULT_STACK_SIZE / sizeof(uint32_t)];
+uint32_t ulStackMemory[STACK_MEMORY_WORDS] TASK_STACK_ATTRIBUTES __attribute__((weak));
+const uint32_t ulStackMemoryWords __attribute__((weak)) = STACK_MEMORY_WORDS;
+const uint32_t ulIdleTaskStackSize __attribute__((weak)) = DEFAULT_STACK_SIZE;
 uint32_t ulStackAllocated[MAX_TASKS] = {0};
 uint32_t ulGlobalStackPtr = 0;
 
@@ -36,6 +56,14 @@ extern uint32_t ulSystemTick;
 
 
 /* Internal function prototypes */
+static TaskHandle_t xCreateTask(TaskFunction_t pxTaskCode,
+                                const char *pcName,
+                                uint32_t ulStackSize,
+                                void *pvParameters,
+                                uint32_t ulPeriod,
+                                uint32_t ulDeadline,
+                                uint32_t *pulStack);
+static void vCreateStaticTasks(void);
 static void vInitializeTaskControlBlock(TaskControlBlock_t *pxTCB, 
                                        TaskFunction_t pxTaskCode,
                                        const char *pcName,
@@ -44,6 +72,7 @@ static void vInitializeTaskControlBlock(TaskControlBlock_t *pxTCB,
                                        uint32_t ulPeriod,
                                        uint32_t ulDeadline);
 static void vSetupTaskStack(TaskControlBlock_t *pxTCB);
+static void vPrepareTaskStack(TaskControlBlock_t *pxTCB, uint32_t *pulMemory);
 static TaskHandle_t pxFindFreeTaskSlot(void);
 
 /**
@@ -60,13 +89,31 @@ void vKernelInit(void)
     xSystemMonitor.ulIdleTime = 0;
     xSystemMonitor.ulTaskCount = 0;
     xSystemMonitor.eSchedulerState = SCHEDULER_NOT_STARTED;
-    
-    /* Reset task counters */
+    xSystemMonitor.ulSystemLoadEwma = 0;
+    xSystemMonitor.ulSystemLoadPeak = 0;
+    xSystemMonitor.ulHyperperiod = 0;
+    xSystemMonitor.ulHyperperiodLoad = 0;
+    xSystemMonitor.ulHyperperiodLoadPeak = 0;
+    
+    /* Reset task counters and the stack pool */
+    ulGlobalStackPtr = 0;
+#if ENABLE_STACK_CANARY
+    memset(ulCanaryAddresses, 0, sizeof(ulCanaryAddresses));
+#endif
     ulNextTaskID = 1;
     ulTaskCount = 0;
     xCurrentTask = NULL;
     xIdleTask = NULL;
     eSchedulerState = SCHEDULER_NOT_STARTED;
+    bPrioritiesPrecomputed = false;
+
+    /* Tasks declared with TASK_DEFINE() */
+    vCreateStaticTasks();
+
+#if ENABLE_SOFTWARE_TIMERS
+    /* Ranked with the periodic tasks, so the table order no longer applies */
+    vTimerServiceCreate();
+#endif
 }
 
 /**
@@ -78,6 +125,88 @@ TaskHandle_t xTaskCreatePeriodic(TaskFunction_t pxTaskCode,
                                 void *pvParameters,
                                 uint32_t ulPeriod,
                                 uint32_t ulDeadline)
+{
+    TaskHandle_t xTaskHandle;
+    
+    /* Validate stack size */
+    if (ulStackSize < MIN_STACK_SIZE || ulStackSize > MAX_STACK_SIZE) {
+        ulStackSize = DEFAULT_STACK_SIZE;
+    }
+    
+    xTaskHandle = xCreateTask(pxTaskCode, pcName, ulStackSize, pvParameters,
+                              ulPeriod, ulDeadline, NULL);
+
+    /* A runtime task has to be ranked against the table at scheduler start */
+    if (xTaskHandle != NULL && ulPeriod != 0) {
+        bPrioritiesPrecomputed = false;
+    }
+    
+    return xTaskHandle;
+}
+
+/**
+ * @brief Whether every periodic task's priority was fixed by the task table
+ *
+ * True when only TASK_DEFINE() tasks exist and the linker emitted them in
+ * Rate Monotonic order; vSchedulerInit() then skips the ranking pass.
+ */
+bool bTaskPrioritiesPrecomputed(void)
+{
+    return bPrioritiesPrecomputed;
+}
+
+/**
+ * @brief Create the TASK_DEFINE() tasks in table order
+ *
+ * On Cortex-M the table is sorted by period at link time, so a task's
+ * position is its Rate Monotonic priority (equal periods keep table
+ * order, matching the ID tie-break). If the order does not hold, e.g. on
+ * the host or for a non-literal period, the scheduler ranks them instead.
+ */
+static void vCreateStaticTasks(void)
+{
+    const TaskDescriptor_t *pxDescriptor;
+    const TaskDescriptor_t *pxPrevious = NULL;
+    bool bSorted = true;
+    uint32_t ulPosition = 0;
+
+    if (__start_task_table == NULL || __stop_task_table == NULL) {
+        return;
+    }
+
+    for (pxDescriptor = __start_task_table; pxDescriptor < __stop_task_table; pxDescriptor++) {
+        TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)xCreateTask(
+            pxDescriptor->pxTaskCode, pxDescriptor->pcName, pxDescriptor->ulStackSize,
+            pxDescriptor->pvParameters, pxDescriptor->ulPeriod, pxDescriptor->ulDeadline,
+            pxDescriptor->pulStack);
+
+        if (pxTCB == NULL) {
+            bSorted = false;
+            continue;
+        }
+
+        /* IDs ascend with position, so only the periods need checking */
+        if (pxPrevious != NULL && pxPrevious->ulPeriod > pxDescriptor->ulPeriod) {
+            bSorted = false;
+        }
+        pxTCB->ulPriority = ulRmClampPriority(ulPosition, MAX_PRIORITY_LEVELS);
+        pxPrevious = pxDescriptor;
+        ulPosition++;
+    }
+
+    bPrioritiesPrecomputed = bSorted && ulPosition > 0;
+}
+
+/**
+ * @brief Create a task on pulStack, or on the shared pool if NULL
+ */
+static TaskHandle_t xCreateTask(TaskFunction_t pxTaskCode,
+                                const char *pcName,
+                                uint32_t ulStackSize,
+                                void *pvParameters,
+                                uint32_t ulPeriod,
+                                uint32_t ulDeadline,
+                                uint32_t *pulStack)
 {
     TaskControlBlock_t *pxTCB;
     TaskHandle_t xTaskHandle;
@@ -92,11 +221,6 @@ TaskHandle_t xTaskCreatePeriodic(TaskFunction_t pxTaskCode,
         return NULL;
     }
     
-    /* Validate stack size */
-    if (ulStackSize < MIN_STACK_SIZE || ulStackSize > MAX_STACK_SIZE) {
-        ulStackSize = DEFAULT_STACK_SIZE;
-    }
-    
     /* Find free task slot */
     xTaskHandle = pxFindFreeTaskSlot();
     if (xTaskHandle == NULL) {
@@ -105,12 +229,18 @@ TaskHandle_t xTaskCreatePeriodic(TaskFunction_t pxTaskCode,
     
     pxTCB = (TaskControlBlock_t *)xTaskHandle;
     
+    vMonitorWriteBegin();
+
     /* Initialize task control block */
     vInitializeTaskControlBlock(pxTCB, pxTaskCode, pcName, ulStackSize, 
                                pvParameters, ulPeriod, ulDeadline);
     
     /* Setup task stack */
-    vSetupTaskStack(pxTCB);
+    if (pulStack != NULL) {
+        vPrepareTaskStack(pxTCB, pulStack);
+    } else {
+        vSetupTaskStack(pxTCB);
+    }
     
     /* Set initial state */
     pxTCB->eCurrentState = TASK_STATE_READY;
@@ -118,6 +248,8 @@ TaskHandle_t xTaskCreatePeriodic(TaskFunction_t pxTaskCode,
     /* Increment task count */
     ulTaskCount++;
     xSystemMonitor.ulTaskCount = ulTaskCount;
+
+    vMonitorWriteEnd();
     
     return xTaskHandle;
 }
@@ -134,7 +266,7 @@ void vTaskStartScheduler(void)
     /* Create idle task if not already created */
     if (xIdleTask == NULL) {
         xIdleTask = xTaskCreatePeriodic(vIdleTask, "Idle", 
-                                       DEFAULT_STACK_SIZE, NULL, 
+                                       ulIdleTaskStackSize, NULL, 
                                        0, 0); /* No period for idle task */
     }
     
@@ -142,57 +274,56 @@ void vTaskStartScheduler(void)
     vSchedulerInit();
     
     /* Set scheduler state */
+    vMonitorWriteBegin();
     eSchedulerState = SCHEDULER_RUNNING;
     xSystemMonitor.eSchedulerState = SCHEDULER_RUNNING;
+    vMonitorWriteEnd();
 
     /*Get next task*/
     TaskControlBlock_t* next = (TaskControlBlock_t*) vSchedulerGetNextTask();
 
+    vMonitorAccountSwitch(NULL, next);
+
     vSetCurrentTask(next);
 
-    asm volatile (
-        "mov r0, %0"        // Move the value of the operand into r1
-        :                   // No output operands
-        : "r" (next)        // Input operand: next, assigned to a general-purpose register
-        : "r0"              // Clobbered register: r1 is modified by the assembly instruction
-    );
+#if ENABLE_PROFILER
+    vProfilerStart(PROFILER_SAMPLE_HZ);
+#endif
     
-    /* Start the first task */
-    vInitialContextSwitch();
+    /* Start the first task (next is passed in r0 on Cortex-M) */
+    vInitialContextSwitch(next);
 }
 
 /**
  * Assumes curr has updated state. 
  */
-void vStartContextSwitch() {
+KERNEL_RAMFUNC void vStartContextSwitch() {
 
     /*Get task*/
     TaskControlBlock_t* curr = (TaskControlBlock_t*) pxGetCurrentTask();
     TaskControlBlock_t* next = (TaskControlBlock_t*) vSchedulerGetNextTask();
 
-    curr->ulExecutionTime += ulSystemTick - curr->ulLastStartTime;
+    vMonitorWriteBegin();
+
+    pxTaskDetail(curr)->ulExecutionTime += ulSystemTick - pxTaskDetail(curr)->ulLastStartTime;
+    vMonitorAccountSwitch(curr, next);
     //if (curr->eCurrentState == TASK_STATE_RUNNING) curr->eCurrentState = TASK_STATE_READY; // move to ready iff. preempted.
 
     next->eCurrentState = TASK_STATE_RUNNING;
-    next->ulLastStartTime = ulSystemTick;
-    next->ulContextSwitchCount++;
+    pxTaskDetail(next)->ulLastStartTime = ulSystemTick;
+    pxTaskDetail(next)->ulContextSwitchCount++;
 
     vSetCurrentTask(next);
 
     xSystemMonitor.ulTotalContextSwitches++;
 
+    vMonitorWriteEnd();
+
     //curr->eCurrentState = TASK_STATE_BLOCKED;
     //TODO move to ready? iff preempted?
 
-    asm volatile (
-        "mov r0, %0;"        // Move the current task of the operand into r0
-        "mov r1, %1;"        // Move the next of the operand into r1
-        :                   // No output operands
-        : "r" (curr), "r" (next)        // Input operands
-        : "r0", "r1"              // Clobbered register: r1 is modified by the assembly instruction
-    );
-
-    vContextSwitch();
+    /* curr and next are passed in r0/r1 on Cortex-M */
+    vContextSwitch(curr, next);
     
 }
 
@@ -204,9 +335,26 @@ void vTaskYield(void)
     if (eSchedulerState == SCHEDULER_RUNNING) {
         TaskControlBlock_t* curr = (TaskControlBlock_t*) pxGetCurrentTask();
 
+#if ENABLE_RTDVS
+        /* Clock switches the tick asked for, outside the interrupt */
+        vRtdvsApply();
+#endif
+
         if (curr->ulTaskID || vSchedulerGetNextTask() != curr) {
+            vKernelEnterCritical();
+            vMonitorWriteBegin();
+            if (curr->ulTaskID && (curr->eCurrentState == TASK_STATE_RUNNING ||
+                                   curr->eCurrentState == TASK_STATE_READY)) {
+                /* The job is done */
+                vSchedulerRecordJob(curr, !bRmDeadlineMissed(ulSystemTick, curr->ulDeadlineTime));
+#if ENABLE_CHAINS
+                vChainJobComplete(curr);
+#endif
+            }
             curr->eCurrentState = TASK_STATE_BLOCKED;
             vRemoveTaskFromReadyList(curr);
+            vMonitorWriteEnd();
+            vKernelExitCritical();
             vStartContextSwitch();
         }
     }
@@ -235,6 +383,50 @@ __attribute__((naked)) void task_epilogue() {
 
 }
 
+/**
+ * @brief Enter a kernel critical section (task level, nestable)
+ *
+ * Masks interrupts up to KERNEL_MAX_SYSCALL_PRIORITY through BASEPRI on
+ * Cortex-M; more urgent interrupts keep running with unchanged latency.
+ * Only the outermost exit unmasks. Never switch tasks inside.
+ */
+void vKernelEnterCritical(void)
+{
+    uint32_t ulState = ulHalDisableInterrupts();
+    
+    if (ulCriticalNesting++ == 0) {
+        ulCriticalSavedState = ulState;
+    }
+}
+
+/**
+ * @brief Leave a critical section entered with vKernelEnterCritical()
+ */
+void vKernelExitCritical(void)
+{
+    if (ulCriticalNesting > 0 && --ulCriticalNesting == 0) {
+        vHalRestoreInterrupts(ulCriticalSavedState);
+    }
+}
+
+/**
+ * @brief Enter a critical section from an interrupt at or below
+ *        KERNEL_MAX_SYSCALL_PRIORITY
+ * @return State to hand to vKernelExitCriticalFromISR()
+ */
+uint32_t ulKernelEnterCriticalFromISR(void)
+{
+    return ulHalDisableInterrupts();
+}
+
+/**
+ * @brief Leave a critical section entered with ulKernelEnterCriticalFromISR()
+ */
+void vKernelExitCriticalFromISR(uint32_t ulState)
+{
+    vHalRestoreInterrupts(ulState);
+}
+
 /**
  * @brief Suspend a task
  */
@@ -247,7 +439,15 @@ void vTaskSuspend(TaskHandle_t xTask)
     }
     
     pxTCB = (TaskControlBlock_t *)xTask;
+    vKernelEnterCritical();
+    vMonitorWriteBegin();
+    if (pxTCB->eCurrentState == TASK_STATE_DELAYED) {
+        /* Resuming continues the job without the rest of the delay */
+        vDelayRemove(xTask);
+    }
     pxTCB->eCurrentState = TASK_STATE_SUSPENDED;
+    vMonitorWriteEnd();
+    vKernelExitCritical();
 }
 
 /**
@@ -262,33 +462,96 @@ void vTaskResume(TaskHandle_t xTask)
     }
     
     pxTCB = (TaskControlBlock_t *)xTask;
+    vKernelEnterCritical();
     if (pxTCB->eCurrentState == TASK_STATE_SUSPENDED) {
+        vMonitorWriteBegin();
         pxTCB->eCurrentState = TASK_STATE_READY;
+        vMonitorWriteEnd();
     }
+    vKernelExitCritical();
 }
 
 /**
- * @brief Get current task handle
+ * @brief Declare a task's worst-case execution time at the fastest clock
+ *
+ * Used by the schedulability-driven frequency scaling (ENABLE_RTDVS);
+ * takes effect at the next vSchedulerInit().
  */
-TaskHandle_t pxGetCurrentTask(void)
+void vTaskSetWcet(TaskHandle_t xTask, uint32_t ulWcetUs)
 {
-    return xCurrentTask;
+    if (!bIsValidTaskHandle(xTask)) {
+        return;
+    }
+    
+    pxTaskDetail((TaskControlBlock_t *)xTask)->ulWcet = ulWcetUs;
 }
 
 /**
- * @brief Set current task
+ * @brief Choose what happens to a job of the task that misses its deadline
+ *
+ * MISS_POLICY_ABORT discards the late job, whatever it was doing, and the
+ * task starts a fresh instance at its next release; use it only for tasks
+ * that can be cut off at any point. An unknown policy is ignored.
  */
-void vSetCurrentTask(TaskHandle_t xTask)
+void vTaskSetMissPolicy(TaskHandle_t xTask, MissPolicy_t ePolicy)
 {
-    xCurrentTask = xTask;
+    TaskControlBlock_t *pxTCB;
+
+    if (!bIsValidTaskHandle(xTask) || (uint32_t)ePolicy > MISS_POLICY_SKIP_NEXT) {
+        return;
+    }
+    
+    /* The bitfield word is shared with ucFirmM/ucFirmK and read by the tick */
+    pxTCB = (TaskControlBlock_t *)xTask;
+    vKernelEnterCritical();
+    vMonitorWriteBegin();
+    pxTCB->ucMissPolicy = ePolicy;
+    vMonitorWriteEnd();
+    vKernelExitCritical();
+}
+
+/**
+ * @brief Make a task (m,k)-firm: at least ulM of any ulK consecutive jobs
+ *        must meet their deadline
+ * @return false for an invalid handle or 0 < ulM <= ulK <= RM_FIRM_MAX_K not holding
+ *
+ * Under overload the scheduler skips jobs of such a task as long as the
+ * constraint allows (skip-over), instead of letting late jobs delay every
+ * task below it. ulK = 0 makes the task hard again.
+ */
+bool bTaskSetFirmConstraint(TaskHandle_t xTask, uint32_t ulM, uint32_t ulK)
+{
+    TaskControlBlock_t *pxTCB;
+
+    if (!bIsValidTaskHandle(xTask) || ulK > RM_FIRM_MAX_K || ulM > ulK || (ulK > 0 && ulM == 0)) {
+        return false;
+    }
+
+    pxTCB = (TaskControlBlock_t *)xTask;
+    vKernelEnterCritical();
+    vMonitorWriteBegin();
+    pxTCB->ucFirmM = ulM;
+    pxTCB->ucFirmK = ulK;
+    pxTCB->ulFirmHistory = UINT32_MAX;    /* No failures before the first job */
+    vMonitorWriteEnd();
+    vKernelExitCritical();
+    return true;
 }
 
 /**
- * @brief Get system monitor
+ * @brief Get current task handle
  */
-SystemMonitor_t* pxGetSystemMonitor(void)
+KERNEL_RAMFUNC TaskHandle_t pxGetCurrentTask(void)
 {
-    return &xSystemMonitor;
+    return xCurrentTask;
+}
+
+/**
+ * @brief Set current task
+ */
+KERNEL_RAMFUNC void vSetCurrentTask(TaskHandle_t xTask)
+{
+    xCurrentTask = xTask;
 }
 
 /**
@@ -328,16 +591,19 @@ static void vInitializeTaskControlBlock(TaskControlBlock_t *pxTCB,
                                        uint32_t ulPeriod,
                                        uint32_t ulDeadline)
 {
+    TaskDetail_t *pxDetail = pxTaskDetail(pxTCB);
+    
     /* Clear the TCB */
     memset(pxTCB, 0, sizeof(TaskControlBlock_t));
+    memset(pxDetail, 0, sizeof(TaskDetail_t));
     
     /* Set task properties */
     pxTCB->pxTaskCode = pxTaskCode;
     pxTCB->taskFlags = 1;
-    pxTCB->pvParameters = pvParameters;
+    pxDetail->pvParameters = pvParameters;
     pxTCB->ulPeriod = ulPeriod;
     pxTCB->ulDeadline = ulDeadline;
-    pxTCB->ulStackSize = ulStackSize / sizeof(uint32_t); /* Convert to words */
+    pxDetail->ulStackSize = ulStackSize / sizeof(uint32_t); /* Convert to words */
     if (!ulPeriod){ // this should be the idle task
         if (!xIdleTask) { // idle task not init yet
             pxTCB->ulTaskID = 0;
@@ -349,24 +615,33 @@ static void vInitializeTaskControlBlock(TaskControlBlock_t *pxTCB,
     }
     
     /* Copy task name */
-    strncpy(pxTCB->pcTaskName, pcName, sizeof(pxTCB->pcTaskName) - 1);
-    pxTCB->pcTaskName[sizeof(pxTCB->pcTaskName) - 1] = '\0';
+    strncpy(pxDetail->pcTaskName, pcName, sizeof(pxDetail->pcTaskName) - 1);
+    pxDetail->pcTaskName[sizeof(pxDetail->pcTaskName) - 1] = '\0';
     
     /* Initialize timing */
     pxTCB->ulReleaseTime = 0;
     pxTCB->ulDeadlineTime = 0;
-    pxTCB->ulExecutionTime = 0;
-    pxTCB->ulLastStartTime = 0;
+    pxDetail->ulExecutionTime = 0;
+    pxDetail->ulLastStartTime = 0;
+    pxTCB->ulWakeTime = 0;
+    pxTCB->pxNextDelayed = NULL;
     
     /* Initialize monitoring */
-    pxTCB->ulContextSwitchCount = 0;
-    pxTCB->ulDeadlineMissCount = 0;
+    pxDetail->ulContextSwitchCount = 0;
+    pxDetail->ulDeadlineMissCount = 0;
     pxTCB->bDeadlineMissed = false;
+    pxTCB->ucFirmM = 0;
+    pxTCB->ucFirmK = 0;
+    pxTCB->ulFirmHistory = UINT32_MAX;
+    pxDetail->ulSkippedJobs = 0;
+    pxDetail->ulFirmViolations = 0;
+    pxTCB->ucMissPolicy = MISS_POLICY_CONTINUE;
+    pxTCB->bSkipNextRelease = false;
 }
 
 static void vInitializeTaskStack(void) {
     TaskControlBlock_t* curr = (TaskControlBlock_t*) pxGetCurrentTask();
-    curr->pxTopOfStack = curr->pxStackBase + (curr->ulStackSize * 4) - 10;
+    curr->pxTopOfStack = pxTaskDetail(curr)->pxStackBase + (pxTaskDetail(curr)->ulStackSize * 4) - 10;
 }
 
 /**
@@ -389,34 +664,40 @@ static void vSetupTaskStack(TaskControlBlock_t *pxTCB)
         }
     }*/
 
-    #if ENABLE_STACK_CANARY
-    ulStackMemory[ulGlobalStackPtr] = STACK_CANARY;
-    ulCanaryAddresses[pxTCB->ulTaskID] = &ulStackMemory[ulGlobalStackPtr];
-    ulGlobalStackPtr++;
-    #endif
-
-    pxTCB->pxStackBase = &ulStackMemory[ulGlobalStackPtr];
-    unsigned int bytes = pxTCB->ulStackSize * sizeof(uint32_t);
+    /* ulStackSize is in words, so all offsets into ulStackMemory are too */
+    unsigned int words = pxTaskDetail(pxTCB)->ulStackSize;
     
-    if (ulGlobalStackPtr + bytes < MAX_TASKS * DEFAULT_STACK_SIZE) {
-        pxTCB->pxTopOfStack = pxTCB->pxStackBase + bytes - 1;
-
-        pxTCB->pxTopOfStack -= 9; // compensate for 8 registers and return pointer
-        pxTCB->pxStackMax = pxTCB->pxTopOfStack;
-        *pxTCB->pxTopOfStack  = (unsigned int)pxTCB->pxTaskCode;
-
-        ulGlobalStackPtr += bytes;
-
-        
+    if (ulGlobalStackPtr + ENABLE_STACK_CANARY + words <= ulStackMemoryWords) {
+        vPrepareTaskStack(pxTCB, &ulStackMemory[ulGlobalStackPtr]);
+        ulGlobalStackPtr += ENABLE_STACK_CANARY + words;
         return;
     }
 
     
     /* If we get here, no stack available */
-    pxTCB->pxStackBase = NULL;
+    pxTaskDetail(pxTCB)->pxStackBase = NULL;
     pxTCB->pxTopOfStack = NULL;
 }
 
+/**
+ * @brief Lay out a task's initial frame in pulMemory (canary word, then ulStackSize words)
+ */
+static void vPrepareTaskStack(TaskControlBlock_t *pxTCB, uint32_t *pulMemory)
+{
+#if ENABLE_STACK_CANARY
+    *pulMemory = STACK_CANARY;
+    ulCanaryAddresses[pxTCB->ulTaskID] = pulMemory;
+    pulMemory++;
+#endif
+
+    pxTaskDetail(pxTCB)->pxStackBase = pulMemory;
+    pxTCB->pxTopOfStack = pulMemory + pxTaskDetail(pxTCB)->ulStackSize - 1;
+
+    pxTCB->pxTopOfStack -= 9; // compensate for 8 registers and return pointer
+    pxTCB->pxStackMax = pxTCB->pxTopOfStack;
+    *pxTCB->pxTopOfStack  = (uint32_t)(uintptr_t)pxTCB->pxTaskCode;
+}
+
 /**
  * @brief Find free task slot
  */
@@ -0,0 +1,25 @@
+/**
+ * @file tcb_offsets.c
+ * @brief TaskControlBlock_t offsets for context_switch.S
+ *
+ * Compiled to assembly only, never linked: each OFFSET() leaves a
+ * "->NAME value" marker that cmake/tcb_offsets.cmake turns into a #define
+ * of tcb_offsets.h. The assembly port thus follows the C layout, whatever
+ * the compiler and ABI make of it.
+ */
+
+#include "periodRTOS.h"
+#include <stddef.h>
+
+#define OFFSET(xName, xMember) \
+    __asm__ volatile("\n.ascii \"->" #xName " %0\"" : : "i"(offsetof(TaskControlBlock_t, xMember)))
+
+void vTcbOffsets(void);
+
+void vTcbOffsets(void)
+{
+    OFFSET(TCB_TOP_OF_STACK, pxTopOfStack);
+    OFFSET(TCB_STACK_MAX, pxStackMax);
+    OFFSET(TCB_TASK_CODE, pxTaskCode);
+    OFFSET(TCB_TASK_FLAGS, taskFlags);
+}
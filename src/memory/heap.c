@@ -0,0 +1,637 @@
+/**
+ * @file heap.c
+ * @brief Two-Level Segregated Fit allocator
+ *
+ * Free blocks sit in HEAP_FL_COUNT x HEAP_SL_COUNT doubly linked lists.
+ * The first level is the power of two of the size, the second splits that
+ * range linearly into 16 classes; one bitmap per level marks non-empty
+ * lists. Allocation rounds the request up to the next class boundary so
+ * that the head of any list at or above it fits (good-fit), found with two
+ * bit scans. Freed blocks merge with free physical neighbours immediately,
+ * so there are never two adjacent free blocks.
+ *
+ * Block layout (sizes are multiples of HEAP_ALIGN):
+ *
+ *   pxPrevPhys   previous physical block, valid only if it is free
+ *   xSize        payload size | HEAP_BLOCK_FREE | HEAP_BLOCK_PREV_FREE
+ *   payload      free blocks keep their list links here
+ *
+ * The two header words take one HEAP_ALIGN unit, so an allocated block
+ * costs 8 bytes on Cortex-M. Payloads are aligned for any object type
+ * (max_align_t: 8 bytes on Cortex-M, for doubles and 64-bit integers
+ * accessed with LDRD/STRD or VLDR). pvHeapAllocAligned() covers larger
+ * alignments.
+ */
+
+#include "heap.h"
+#include "telemetry.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Size classes */
+#define HEAP_ALIGN              _Alignof(max_align_t)
+#define HEAP_ALIGN_LOG2         ((HEAP_ALIGN == 16) ? 4 : (HEAP_ALIGN == 8) ? 3 : 2)
+#define HEAP_SL_LOG2            4
+#define HEAP_SL_COUNT           (1U << HEAP_SL_LOG2)
+#define HEAP_FL_SHIFT           (HEAP_SL_LOG2 + HEAP_ALIGN_LOG2)
+#ifndef HEAP_FL_INDEX_MAX
+#define HEAP_FL_INDEX_MAX       24      /* Blocks below 16 MB */
+#endif
+#define HEAP_FL_COUNT           (HEAP_FL_INDEX_MAX - HEAP_FL_SHIFT + 1)
+#define HEAP_SMALL_BLOCK        ((size_t)1 << HEAP_FL_SHIFT)
+
+/* Flags in the low bits of xSize */
+#define HEAP_BLOCK_FREE         ((size_t)1)
+#define HEAP_BLOCK_PREV_FREE    ((size_t)2)
+#define HEAP_BLOCK_FLAGS        (HEAP_BLOCK_FREE | HEAP_BLOCK_PREV_FREE)
+
+typedef struct HeapBlock {
+    struct HeapBlock *pxPrevPhys;    /* Previous physical block, if free */
+    size_t xSize;                    /* Payload size and flags */
+    struct HeapBlock *pxNextFree;    /* Free list links, free blocks only */
+    struct HeapBlock *pxPrevFree;
+} HeapBlock_t;
+
+#define HEAP_BLOCK_OVERHEAD     HEAP_ALIGN
+#define HEAP_PAYLOAD_OFFSET     (offsetof(HeapBlock_t, xSize) + sizeof(size_t))
+#define HEAP_BLOCK_SIZE_MIN     ((2 * sizeof(HeapBlock_t *) + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1))
+#define HEAP_BLOCK_SIZE_MAX     (((size_t)1 << HEAP_FL_INDEX_MAX) - HEAP_ALIGN)
+
+_Static_assert((HEAP_ALIGN & (HEAP_ALIGN - 1)) == 0 && HEAP_ALIGN == ((size_t)1 << HEAP_ALIGN_LOG2),
+               "HEAP_ALIGN must be a power of two from 4 to 16");
+_Static_assert(HEAP_PAYLOAD_OFFSET <= HEAP_BLOCK_OVERHEAD,
+               "the block header must fit in one alignment unit");
+
+typedef struct {
+    HeapBlock_t xNull;               /* Terminates every free list */
+    uint32_t ulFlBitmap;
+    uint32_t pulSlBitmap[HEAP_FL_COUNT];
+    HeapBlock_t *pxBlocks[HEAP_FL_COUNT][HEAP_SL_COUNT];
+
+    /* Statistics; block sizes here include the header word */
+    size_t xTotal;
+    size_t xFree;
+    size_t xPeakUsed;
+    uint32_t ulFreeBlocks;
+    uint32_t ulAllocations;
+    uint32_t ulFrees;
+    uint32_t ulFailures;
+} HeapControl_t;
+
+static HeapControl_t xHeap;
+static bool bHeapReady = false;
+
+/* Internal function prototypes */
+static void vHeapInit(void);
+static void *pvAllocLocked(size_t xSize);
+static void *pvAllocAlignedLocked(size_t xAlign, size_t xSize);
+static void vFreeLocked(void *pv);
+static size_t xAdjustRequest(size_t xSize);
+static void vMappingInsert(size_t xSize, uint32_t *pulFl, uint32_t *pulSl);
+static HeapBlock_t *pxLocateFree(size_t xSize);
+static void vInsertFree(HeapBlock_t *pxBlock);
+static void vRemoveFree(HeapBlock_t *pxBlock);
+static HeapBlock_t *pxSplit(HeapBlock_t *pxBlock, size_t xSize);
+static HeapBlock_t *pxMergePrev(HeapBlock_t *pxBlock);
+static HeapBlock_t *pxMergeNext(HeapBlock_t *pxBlock);
+static void vTrimFree(HeapBlock_t *pxBlock, size_t xSize);
+static void vTrimUsed(HeapBlock_t *pxBlock, size_t xSize);
+
+static inline size_t xBlockSize(const HeapBlock_t *pxBlock)
+{
+    return pxBlock->xSize & ~HEAP_BLOCK_FLAGS;
+}
+
+static inline void vBlockSetSize(HeapBlock_t *pxBlock, size_t xSize)
+{
+    pxBlock->xSize = xSize | (pxBlock->xSize & HEAP_BLOCK_FLAGS);
+}
+
+static inline void *pvBlockToPtr(const HeapBlock_t *pxBlock)
+{
+    return (uint8_t *)pxBlock + HEAP_PAYLOAD_OFFSET;
+}
+
+static inline HeapBlock_t *pxBlockFromPtr(const void *pv)
+{
+    return (HeapBlock_t *)((uint8_t *)pv - HEAP_PAYLOAD_OFFSET);
+}
+
+/* Block that starts after the first xSize payload bytes of pxBlock */
+static inline HeapBlock_t *pxBlockAfter(const HeapBlock_t *pxBlock, size_t xSize)
+{
+    return (HeapBlock_t *)((uint8_t *)pvBlockToPtr(pxBlock) + xSize + HEAP_BLOCK_OVERHEAD - HEAP_PAYLOAD_OFFSET);
+}
+
+static inline HeapBlock_t *pxBlockNext(const HeapBlock_t *pxBlock)
+{
+    return pxBlockAfter(pxBlock, xBlockSize(pxBlock));
+}
+
+static inline HeapBlock_t *pxBlockLinkNext(HeapBlock_t *pxBlock)
+{
+    HeapBlock_t *pxNext = pxBlockNext(pxBlock);
+
+    pxNext->pxPrevPhys = pxBlock;
+    return pxNext;
+}
+
+static inline void vBlockMarkFree(HeapBlock_t *pxBlock)
+{
+    pxBlockLinkNext(pxBlock)->xSize |= HEAP_BLOCK_PREV_FREE;
+    pxBlock->xSize |= HEAP_BLOCK_FREE;
+}
+
+static inline void vBlockMarkUsed(HeapBlock_t *pxBlock)
+{
+    pxBlockNext(pxBlock)->xSize &= ~HEAP_BLOCK_PREV_FREE;
+    pxBlock->xSize &= ~HEAP_BLOCK_FREE;
+}
+
+static inline uint32_t ulFls(size_t x)
+{
+    return (uint32_t)(sizeof(unsigned long) * 8 - 1) - (uint32_t)__builtin_clzl((unsigned long)x);
+}
+
+/**
+ * @brief Allocate xSize bytes; NULL if no free block is large enough
+ */
+void *pvHeapAlloc(size_t xSize)
+{
+    uint32_t ulState = ulHalDisableInterrupts();
+    void *pv = pvAllocLocked(xSize);
+
+    vHalRestoreInterrupts(ulState);
+    return pv;
+}
+
+/**
+ * @brief Allocate xSize bytes aligned to xAlign, a power of two
+ *
+ * Alignments up to the natural one cost nothing extra. Larger ones search
+ * for a block with room to spare and return the leading gap to the free
+ * lists, so the call is still bounded.
+ */
+void *pvHeapAllocAligned(size_t xAlign, size_t xSize)
+{
+    uint32_t ulState;
+    void *pv;
+
+    if (xAlign == 0 || (xAlign & (xAlign - 1)) != 0) {
+        return NULL;
+    }
+
+    ulState = ulHalDisableInterrupts();
+    pv = (xAlign <= HEAP_ALIGN) ? pvAllocLocked(xSize) : pvAllocAlignedLocked(xAlign, xSize);
+    vHalRestoreInterrupts(ulState);
+    return pv;
+}
+
+/**
+ * @brief Allocate a zeroed array
+ */
+void *pvHeapCalloc(size_t xCount, size_t xSize)
+{
+    void *pv;
+
+    if (xSize != 0 && xCount > (size_t)-1 / xSize) {
+        return NULL;
+    }
+    pv = pvHeapAlloc(xCount * xSize);
+    if (pv != NULL) {
+        /* Outside the critical section: the block is already ours */
+        memset(pv, 0, xCount * xSize);
+    }
+    return pv;
+}
+
+/**
+ * @brief Resize an allocation, in place when the block or its free successor allows
+ */
+void *pvHeapRealloc(void *pv, size_t xSize)
+{
+    HeapBlock_t *pxBlock;
+    HeapBlock_t *pxNext;
+    size_t xAdjusted;
+    size_t xCurrent;
+    uint32_t ulState;
+    void *pvNew;
+
+    if (pv == NULL) {
+        return pvHeapAlloc(xSize);
+    }
+    if (xSize == 0) {
+        vHeapFree(pv);
+        return NULL;
+    }
+
+    ulState = ulHalDisableInterrupts();
+
+    pxBlock = pxBlockFromPtr(pv);
+    pxNext = pxBlockNext(pxBlock);
+    xCurrent = xBlockSize(pxBlock);
+    xAdjusted = xAdjustRequest(xSize);
+
+    if (xAdjusted != 0 &&
+        (xAdjusted <= xCurrent ||
+         ((pxNext->xSize & HEAP_BLOCK_FREE) &&
+          xAdjusted <= xCurrent + xBlockSize(pxNext) + HEAP_BLOCK_OVERHEAD))) {
+        if (xAdjusted > xCurrent) {
+            (void)pxMergeNext(pxBlock);
+            vBlockMarkUsed(pxBlock);
+        }
+        vTrimUsed(pxBlock, xAdjusted);
+        if (xHeap.xTotal - xHeap.xFree > xHeap.xPeakUsed) {
+            xHeap.xPeakUsed = xHeap.xTotal - xHeap.xFree;
+        }
+        vHalRestoreInterrupts(ulState);
+        return pv;
+    }
+
+    /* Move: allocate, copy, free - each step is bounded */
+    pvNew = pvAllocLocked(xSize);
+    vHalRestoreInterrupts(ulState);
+    if (pvNew != NULL) {
+        memcpy(pvNew, pv, xCurrent);
+        vHeapFree(pv);
+    }
+    return pvNew;
+}
+
+/**
+ * @brief Release an allocation; NULL is ignored
+ */
+void vHeapFree(void *pv)
+{
+    uint32_t ulState;
+
+    if (pv == NULL) {
+        return;
+    }
+
+    ulState = ulHalDisableInterrupts();
+    vFreeLocked(pv);
+    vHalRestoreInterrupts(ulState);
+}
+
+/**
+ * @brief Snapshot of usage and fragmentation
+ *
+ * The largest free block is searched for in the highest non-empty list
+ * only, so this is not constant-time; call it from monitoring code, not
+ * from the allocation path.
+ */
+void vHeapGetStats(HeapStats_t *pxStats)
+{
+    uint32_t ulState = ulHalDisableInterrupts();
+    size_t xLargest = 0;
+
+    if (!bHeapReady) {
+        vHeapInit();
+    }
+
+    if (xHeap.ulFlBitmap != 0) {
+        uint32_t ulFl = ulFls(xHeap.ulFlBitmap);
+        uint32_t ulSl = ulFls(xHeap.pulSlBitmap[ulFl]);
+
+        for (HeapBlock_t *pxBlock = xHeap.pxBlocks[ulFl][ulSl]; pxBlock != &xHeap.xNull;
+             pxBlock = pxBlock->pxNextFree) {
+            if (xBlockSize(pxBlock) > xLargest) {
+                xLargest = xBlockSize(pxBlock);
+            }
+        }
+    }
+
+    pxStats->ulTotalBytes = (uint32_t)xHeap.xTotal;
+    pxStats->ulUsedBytes = (uint32_t)(xHeap.xTotal - xHeap.xFree);
+    pxStats->ulPeakUsedBytes = (uint32_t)xHeap.xPeakUsed;
+    pxStats->ulFreeBytes = (uint32_t)xHeap.xFree;
+    pxStats->ulLargestFreeBlock = (uint32_t)xLargest;
+    pxStats->ulFreeBlocks = xHeap.ulFreeBlocks;
+    pxStats->ulAllocations = xHeap.ulAllocations;
+    pxStats->ulFrees = xHeap.ulFrees;
+    pxStats->ulFailures = xHeap.ulFailures;
+    pxStats->ulFragmentation = (xHeap.xFree == 0) ? 0 :
+        (uint32_t)(100 - ((uint64_t)(xLargest + HEAP_BLOCK_OVERHEAD) * 100) / xHeap.xFree);
+
+    vHalRestoreInterrupts(ulState);
+}
+
+/**
+ * @brief Take over the board's heap region as one free block
+ */
+static void vHeapInit(void)
+{
+    void *pvStart;
+    size_t xBytes;
+    uintptr_t xAligned;
+    size_t xPool;
+    HeapBlock_t *pxBlock;
+    HeapBlock_t *pxSentinel;
+
+    memset(&xHeap, 0, sizeof(xHeap));
+    xHeap.xNull.pxNextFree = &xHeap.xNull;
+    xHeap.xNull.pxPrevFree = &xHeap.xNull;
+    for (uint32_t i = 0; i < HEAP_FL_COUNT; i++) {
+        for (uint32_t j = 0; j < HEAP_SL_COUNT; j++) {
+            xHeap.pxBlocks[i][j] = &xHeap.xNull;
+        }
+    }
+    bHeapReady = true;
+
+    vBoardHeapRegion(&pvStart, &xBytes);
+
+    /* xAligned: payload of the first block, its header just before */
+    xAligned = ((uintptr_t)pvStart + HEAP_BLOCK_OVERHEAD + HEAP_ALIGN - 1) & ~(uintptr_t)(HEAP_ALIGN - 1);
+    if (pvStart == NULL || xBytes < (xAligned - (uintptr_t)pvStart) + HEAP_BLOCK_OVERHEAD + HEAP_BLOCK_SIZE_MIN) {
+        return;
+    }
+    xBytes -= xAligned - (uintptr_t)pvStart;
+
+    /* One free block and a zero-sized used sentinel that ends the region */
+    xPool = (xBytes - HEAP_BLOCK_OVERHEAD) & ~(HEAP_ALIGN - 1);
+    if (xPool > HEAP_BLOCK_SIZE_MAX) {
+        xPool = HEAP_BLOCK_SIZE_MAX;
+    }
+
+    pxBlock = (HeapBlock_t *)(xAligned - HEAP_PAYLOAD_OFFSET);
+    pxBlock->xSize = xPool | HEAP_BLOCK_FREE;
+    vInsertFree(pxBlock);
+
+    pxSentinel = pxBlockLinkNext(pxBlock);
+    pxSentinel->xSize = HEAP_BLOCK_PREV_FREE;
+
+    xHeap.xTotal = xPool + HEAP_BLOCK_OVERHEAD;
+}
+
+static void *pvAllocLocked(size_t xSize)
+{
+    size_t xAdjusted;
+    HeapBlock_t *pxBlock;
+
+    if (!bHeapReady) {
+        vHeapInit();
+    }
+
+    xAdjusted = xAdjustRequest(xSize);
+    pxBlock = (xAdjusted != 0) ? pxLocateFree(xAdjusted) : NULL;
+    if (pxBlock == NULL) {
+        xHeap.ulFailures++;
+        return NULL;
+    }
+
+    vTrimFree(pxBlock, xAdjusted);
+    vBlockMarkUsed(pxBlock);
+
+    xHeap.ulAllocations++;
+    if (xHeap.xTotal - xHeap.xFree > xHeap.xPeakUsed) {
+        xHeap.xPeakUsed = xHeap.xTotal - xHeap.xFree;
+    }
+    return pvBlockToPtr(pxBlock);
+}
+
+/**
+ * @brief Allocation aligned beyond HEAP_ALIGN
+ *
+ * The block found has room for a leading gap of at least a minimum free
+ * block; the gap goes back to the free lists, the tail as usual.
+ */
+static void *pvAllocAlignedLocked(size_t xAlign, size_t xSize)
+{
+    size_t xAdjusted;
+    size_t xGap;
+    uintptr_t xPayload;
+    uintptr_t xTarget;
+    HeapBlock_t *pxBlock;
+
+    if (!bHeapReady) {
+        vHeapInit();
+    }
+
+    xAdjusted = xAdjustRequest(xSize);
+    pxBlock = NULL;
+    if (xAdjusted != 0 && xAlign <= HEAP_BLOCK_SIZE_MAX) {
+        size_t xSearch = xAdjustRequest(xAdjusted + xAlign + HEAP_BLOCK_OVERHEAD + HEAP_BLOCK_SIZE_MIN);
+
+        pxBlock = (xSearch != 0) ? pxLocateFree(xSearch) : NULL;
+    }
+    if (pxBlock == NULL) {
+        xHeap.ulFailures++;
+        return NULL;
+    }
+
+    xPayload = (uintptr_t)pvBlockToPtr(pxBlock);
+    xTarget = (xPayload + xAlign - 1) & ~(uintptr_t)(xAlign - 1);
+    if (xTarget != xPayload && xTarget - xPayload < HEAP_BLOCK_OVERHEAD + HEAP_BLOCK_SIZE_MIN) {
+        xTarget = (xPayload + HEAP_BLOCK_OVERHEAD + HEAP_BLOCK_SIZE_MIN + xAlign - 1) & ~(uintptr_t)(xAlign - 1);
+    }
+    xGap = xTarget - xPayload;
+
+    if (xGap != 0) {
+        /* The gap becomes a free block of its own; its predecessor is in use */
+        HeapBlock_t *pxAligned = pxSplit(pxBlock, xGap - HEAP_BLOCK_OVERHEAD);
+
+        (void)pxBlockLinkNext(pxBlock);
+        pxAligned->xSize |= HEAP_BLOCK_PREV_FREE;
+        vInsertFree(pxBlock);
+        pxBlock = pxAligned;
+    }
+
+    vTrimFree(pxBlock, xAdjusted);
+    vBlockMarkUsed(pxBlock);
+
+    xHeap.ulAllocations++;
+    if (xHeap.xTotal - xHeap.xFree > xHeap.xPeakUsed) {
+        xHeap.xPeakUsed = xHeap.xTotal - xHeap.xFree;
+    }
+    return pvBlockToPtr(pxBlock);
+}
+
+static void vFreeLocked(void *pv)
+{
+    HeapBlock_t *pxBlock = pxBlockFromPtr(pv);
+
+    vBlockMarkFree(pxBlock);
+    pxBlock = pxMergePrev(pxBlock);
+    pxBlock = pxMergeNext(pxBlock);
+    vInsertFree(pxBlock);
+
+    xHeap.ulFrees++;
+}
+
+/**
+ * @brief Request rounded to the alignment and the minimum block, 0 if too large
+ */
+static size_t xAdjustRequest(size_t xSize)
+{
+    size_t xAligned;
+
+    if (xSize > HEAP_BLOCK_SIZE_MAX) {
+        return 0;
+    }
+    xAligned = (xSize + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1);
+    return (xAligned < HEAP_BLOCK_SIZE_MIN) ? HEAP_BLOCK_SIZE_MIN : xAligned;
+}
+
+/**
+ * @brief List that a block of xSize bytes belongs to
+ */
+static void vMappingInsert(size_t xSize, uint32_t *pulFl, uint32_t *pulSl)
+{
+    if (xSize < HEAP_SMALL_BLOCK) {
+        *pulFl = 0;
+        *pulSl = (uint32_t)(xSize / (HEAP_SMALL_BLOCK / HEAP_SL_COUNT));
+    } else {
+        uint32_t ulFl = ulFls(xSize);
+
+        *pulSl = (uint32_t)(xSize >> (ulFl - HEAP_SL_LOG2)) ^ HEAP_SL_COUNT;
+        *pulFl = ulFl - (HEAP_FL_SHIFT - 1);
+    }
+}
+
+/**
+ * @brief Remove and return a free block of at least xSize bytes
+ *
+ * The request is rounded up to the next list boundary, so any block in
+ * the first non-empty list at or above it is large enough.
+ */
+static HeapBlock_t *pxLocateFree(size_t xSize)
+{
+    uint32_t ulFl, ulSl;
+    uint32_t ulSlMap, ulFlMap;
+    HeapBlock_t *pxBlock;
+
+    if (xSize >= HEAP_SMALL_BLOCK) {
+        xSize += ((size_t)1 << (ulFls(xSize) - HEAP_SL_LOG2)) - 1;
+    }
+    vMappingInsert(xSize, &ulFl, &ulSl);
+    if (ulFl >= HEAP_FL_COUNT) {
+        return NULL;
+    }
+
+    ulSlMap = xHeap.pulSlBitmap[ulFl] & (~0U << ulSl);
+    if (ulSlMap == 0) {
+        ulFlMap = xHeap.ulFlBitmap & (~0U << (ulFl + 1));
+        if (ulFlMap == 0) {
+            return NULL;
+        }
+        ulFl = (uint32_t)__builtin_ctz(ulFlMap);
+        ulSlMap = xHeap.pulSlBitmap[ulFl];
+    }
+    ulSl = (uint32_t)__builtin_ctz(ulSlMap);
+
+    pxBlock = xHeap.pxBlocks[ulFl][ulSl];
+    vRemoveFree(pxBlock);
+    return pxBlock;
+}
+
+static void vInsertFree(HeapBlock_t *pxBlock)
+{
+    uint32_t ulFl, ulSl;
+    HeapBlock_t *pxHead;
+
+    vMappingInsert(xBlockSize(pxBlock), &ulFl, &ulSl);
+    pxHead = xHeap.pxBlocks[ulFl][ulSl];
+
+    pxBlock->pxNextFree = pxHead;
+    pxBlock->pxPrevFree = &xHeap.xNull;
+    pxHead->pxPrevFree = pxBlock;
+    xHeap.pxBlocks[ulFl][ulSl] = pxBlock;
+
+    xHeap.ulFlBitmap |= 1U << ulFl;
+    xHeap.pulSlBitmap[ulFl] |= 1U << ulSl;
+
+    xHeap.xFree += xBlockSize(pxBlock) + HEAP_BLOCK_OVERHEAD;
+    xHeap.ulFreeBlocks++;
+}
+
+static void vRemoveFree(HeapBlock_t *pxBlock)
+{
+    uint32_t ulFl, ulSl;
+    HeapBlock_t *pxPrev = pxBlock->pxPrevFree;
+    HeapBlock_t *pxNext = pxBlock->pxNextFree;
+
+    vMappingInsert(xBlockSize(pxBlock), &ulFl, &ulSl);
+
+    pxNext->pxPrevFree = pxPrev;
+    pxPrev->pxNextFree = pxNext;
+    if (xHeap.pxBlocks[ulFl][ulSl] == pxBlock) {
+        xHeap.pxBlocks[ulFl][ulSl] = pxNext;
+        if (pxNext == &xHeap.xNull) {
+            xHeap.pulSlBitmap[ulFl] &= ~(1U << ulSl);
+            if (xHeap.pulSlBitmap[ulFl] == 0) {
+                xHeap.ulFlBitmap &= ~(1U << ulFl);
+            }
+        }
+    }
+
+    xHeap.xFree -= xBlockSize(pxBlock) + HEAP_BLOCK_OVERHEAD;
+    xHeap.ulFreeBlocks--;
+}
+
+/**
+ * @brief Cut pxBlock to xSize bytes and return the (free, unlisted) remainder
+ */
+static HeapBlock_t *pxSplit(HeapBlock_t *pxBlock, size_t xSize)
+{
+    HeapBlock_t *pxRemaining = pxBlockAfter(pxBlock, xSize);
+
+    pxRemaining->xSize = xBlockSize(pxBlock) - (xSize + HEAP_BLOCK_OVERHEAD);
+    vBlockSetSize(pxBlock, xSize);
+    vBlockMarkFree(pxRemaining);
+
+    return pxRemaining;
+}
+
+static HeapBlock_t *pxMergePrev(HeapBlock_t *pxBlock)
+{
+    if (pxBlock->xSize & HEAP_BLOCK_PREV_FREE) {
+        HeapBlock_t *pxPrev = pxBlock->pxPrevPhys;
+
+        vRemoveFree(pxPrev);
+        vBlockSetSize(pxPrev, xBlockSize(pxPrev) + xBlockSize(pxBlock) + HEAP_BLOCK_OVERHEAD);
+        (void)pxBlockLinkNext(pxPrev);
+        pxBlock = pxPrev;
+    }
+    return pxBlock;
+}
+
+static HeapBlock_t *pxMergeNext(HeapBlock_t *pxBlock)
+{
+    HeapBlock_t *pxNext = pxBlockNext(pxBlock);
+
+    if (pxNext->xSize & HEAP_BLOCK_FREE) {
+        vRemoveFree(pxNext);
+        vBlockSetSize(pxBlock, xBlockSize(pxBlock) + xBlockSize(pxNext) + HEAP_BLOCK_OVERHEAD);
+        (void)pxBlockLinkNext(pxBlock);
+    }
+    return pxBlock;
+}
+
+/**
+ * @brief Return the tail of a block about to be handed out to the free lists
+ */
+static void vTrimFree(HeapBlock_t *pxBlock, size_t xSize)
+{
+    if (xBlockSize(pxBlock) >= xSize + HEAP_BLOCK_OVERHEAD + HEAP_BLOCK_SIZE_MIN) {
+        HeapBlock_t *pxRemaining = pxSplit(pxBlock, xSize);
+
+        (void)pxBlockLinkNext(pxBlock);
+        pxRemaining->xSize |= HEAP_BLOCK_PREV_FREE;
+        vInsertFree(pxRemaining);
+    }
+}
+
+/**
+ * @brief Return the tail of an allocated block to the free lists
+ */
+static void vTrimUsed(HeapBlock_t *pxBlock, size_t xSize)
+{
+    if (xBlockSize(pxBlock) >= xSize + HEAP_BLOCK_OVERHEAD + HEAP_BLOCK_SIZE_MIN) {
+        HeapBlock_t *pxRemaining = pxSplit(pxBlock, xSize);
+
+        pxRemaining->xSize &= ~HEAP_BLOCK_PREV_FREE;
+        pxRemaining = pxMergeNext(pxRemaining);
+        vInsertFree(pxRemaining);
+    }
+}
@@ -0,0 +1,273 @@
+/**
+ * @file chain.c
+ * @brief End-to-end data age and reaction latency of cause-effect chains
+ *
+ * Chains come from a static pool of MAX_CHAINS. The head's release tick
+ * is kept by the scheduler (vSchedulerSetDeadline()); the tail's
+ * completion is reported by vTaskYield(), which calls vChainJobComplete()
+ * inside its critical section. Times are microseconds on the tick
+ * timebase: a release is its tick times CHAIN_TICK_US, a completion adds
+ * the elapsed part of the current tick (ulChainNow()). Only differences
+ * are used, so the time may wrap.
+ */
+
+#include "periodRTOS.h"
+#include "chain.h"
+#include <stddef.h>
+#include <string.h>
+
+#define CHAIN_TICK_US           (1000000 / SYSTICK_FREQ_HZ)
+
+_Static_assert(CHAIN_HISTOGRAM_BUCKETS >= 2 &&
+               ((uint64_t)CHAIN_HISTOGRAM_BASE_US << (CHAIN_HISTOGRAM_BUCKETS - 2)) <= UINT32_MAX,
+               "the last histogram bucket must start below 2^32 us");
+
+typedef struct {
+    const char *pcName;              /* NULL if the slot is free */
+    TaskControlBlock_t *pxTasks[MAX_CHAIN_TASKS]; /* Head first */
+    uint32_t ulTaskCount;
+
+    /* Written by the head */
+    uint32_t ulHeadOrigin;
+    uint32_t ulHeadPrevious;
+    bool bHeadStamped;
+
+    /* Written by the tail */
+    ChainStamp_t xPending;           /* Stamp the current tail job acted on */
+    uint32_t ulPendingRelease;       /* Release tick of that job */
+    bool bPending;
+    uint32_t ulLastReacted;          /* Newest origin a reaction was recorded for */
+    bool bReacted;
+
+    ChainStats_t xStats;
+} Chain_t;
+
+static Chain_t xChains[MAX_CHAINS];
+
+/* Internal function prototypes */
+static bool bIsValidChain(ChainHandle_t xChain);
+static uint32_t ulChainNow(void);
+static void vChainRecord(uint32_t *pulHistogram, uint32_t *pulMax, uint32_t ulLatency);
+
+/**
+ * @brief Declare a chain of periodic tasks, head first
+ * @return NULL if the pool is exhausted or a task is not a periodic task
+ *
+ * The same task may belong to several chains, and a chain may consist of
+ * a single task (then age and reaction measure its own release to
+ * completion).
+ */
+ChainHandle_t xChainCreate(const char *pcName, const TaskHandle_t *pxTasks, uint32_t ulTaskCount)
+{
+    Chain_t *pxChain = NULL;
+
+    if (pcName == NULL || pxTasks == NULL || ulTaskCount == 0 || ulTaskCount > MAX_CHAIN_TASKS) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < ulTaskCount; i++) {
+        TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)pxTasks[i];
+
+        if (!bIsValidTaskHandle(pxTasks[i]) || pxTCB->ulTaskID == 0 || pxTCB->ulPeriod == 0) {
+            return NULL;
+        }
+    }
+
+    vKernelEnterCritical();
+    for (uint32_t i = 0; i < MAX_CHAINS; i++) {
+        if (xChains[i].pcName == NULL) {
+            pxChain = &xChains[i];
+            memset(pxChain, 0, sizeof(*pxChain));
+            pxChain->pcName = pcName;
+            for (uint32_t j = 0; j < ulTaskCount; j++) {
+                pxChain->pxTasks[j] = (TaskControlBlock_t *)pxTasks[j];
+            }
+            pxChain->ulTaskCount = ulTaskCount;
+            break;
+        }
+    }
+    vKernelExitCritical();
+
+    return (ChainHandle_t)pxChain;
+}
+
+/**
+ * @brief Stamp data produced by the current job of the chain's head
+ *
+ * Every call within one head job gives the same stamp.
+ */
+void vChainStamp(ChainHandle_t xChain, ChainStamp_t *pxStamp)
+{
+    Chain_t *pxChain = (Chain_t *)xChain;
+    TaskControlBlock_t *pxHead;
+    uint32_t ulOrigin;
+
+    if (!bIsValidChain(xChain) || pxStamp == NULL) {
+        return;
+    }
+    pxHead = pxChain->pxTasks[0];
+    ulOrigin = pxTaskDetail(pxHead)->ulJobReleaseTick * CHAIN_TICK_US;
+
+    vKernelEnterCritical();
+    if (!pxChain->bHeadStamped) {
+        /* No earlier release seen: assume one period before */
+        pxChain->ulHeadPrevious = ulOrigin - pxHead->ulPeriod * CHAIN_TICK_US;
+        pxChain->ulHeadOrigin = ulOrigin;
+        pxChain->bHeadStamped = true;
+    } else if (ulOrigin != pxChain->ulHeadOrigin) {
+        pxChain->ulHeadPrevious = pxChain->ulHeadOrigin;
+        pxChain->ulHeadOrigin = ulOrigin;
+    }
+    pxStamp->ulOrigin = pxChain->ulHeadOrigin;
+    pxStamp->ulPreviousOrigin = pxChain->ulHeadPrevious;
+    vKernelExitCritical();
+}
+
+/**
+ * @brief Note the stamp of the data the current tail job acts on
+ *
+ * Recorded when the job completes; a later call in the same job replaces
+ * the stamp, and a job that is aborted records nothing.
+ */
+void vChainConsume(ChainHandle_t xChain, const ChainStamp_t *pxStamp)
+{
+    Chain_t *pxChain = (Chain_t *)xChain;
+
+    if (!bIsValidChain(xChain) || pxStamp == NULL) {
+        return;
+    }
+
+    vKernelEnterCritical();
+    pxChain->xPending = *pxStamp;
+    pxChain->ulPendingRelease = pxTaskDetail(pxChain->pxTasks[pxChain->ulTaskCount - 1])->ulJobReleaseTick;
+    pxChain->bPending = true;
+    vKernelExitCritical();
+}
+
+/**
+ * @brief Record the chains whose tail job just completed
+ *
+ * Called by vTaskYield() in a critical section. A pending stamp from an
+ * earlier, aborted job of the tail is discarded.
+ */
+void vChainJobComplete(TaskHandle_t xTask)
+{
+    uint32_t ulNow = ulChainNow();
+    uint32_t ulRelease = pxTaskDetail((TaskControlBlock_t *)xTask)->ulJobReleaseTick;
+
+    for (uint32_t i = 0; i < MAX_CHAINS; i++) {
+        Chain_t *pxChain = &xChains[i];
+
+        if (pxChain->pcName == NULL || !pxChain->bPending ||
+            (TaskHandle_t)pxChain->pxTasks[pxChain->ulTaskCount - 1] != xTask) {
+            continue;
+        }
+        pxChain->bPending = false;
+        if (pxChain->ulPendingRelease != ulRelease) {
+            continue;
+        }
+
+        pxChain->xStats.ulSamples++;
+        pxChain->xStats.ulLastAge = ulNow - pxChain->xPending.ulOrigin;
+        vChainRecord(pxChain->xStats.ulAgeHistogram, &pxChain->xStats.ulMaxAge,
+                     pxChain->xStats.ulLastAge);
+
+        /* Only the first reaction to an origin counts; later ones are older data */
+        if (!pxChain->bReacted || (int32_t)(pxChain->xPending.ulOrigin - pxChain->ulLastReacted) > 0) {
+            pxChain->ulLastReacted = pxChain->xPending.ulOrigin;
+            pxChain->bReacted = true;
+            pxChain->xStats.ulReactions++;
+            vChainRecord(pxChain->xStats.ulReactionHistogram, &pxChain->xStats.ulMaxReaction,
+                         ulNow - pxChain->xPending.ulPreviousOrigin);
+        }
+    }
+}
+
+/**
+ * @brief Copy a chain's statistics
+ * @return false for an invalid handle
+ */
+bool bChainGetStats(ChainHandle_t xChain, ChainStats_t *pxStats)
+{
+    if (!bIsValidChain(xChain) || pxStats == NULL) {
+        return false;
+    }
+
+    vKernelEnterCritical();
+    *pxStats = ((Chain_t *)xChain)->xStats;
+    vKernelExitCritical();
+
+    return true;
+}
+
+/**
+ * @brief Clear a chain's statistics, e.g. after a period change
+ */
+void vChainResetStats(ChainHandle_t xChain)
+{
+    if (!bIsValidChain(xChain)) {
+        return;
+    }
+
+    vKernelEnterCritical();
+    memset(&((Chain_t *)xChain)->xStats, 0, sizeof(ChainStats_t));
+    vKernelExitCritical();
+}
+
+/**
+ * @brief Name given to xChainCreate()
+ */
+const char *pcChainGetName(ChainHandle_t xChain)
+{
+    return bIsValidChain(xChain) ? ((Chain_t *)xChain)->pcName : NULL;
+}
+
+/**
+ * @brief Copy up to ulMax of the chain's tasks, head first
+ * @return Number of tasks in the chain
+ */
+uint32_t ulChainGetTasks(ChainHandle_t xChain, TaskHandle_t *pxTasks, uint32_t ulMax)
+{
+    Chain_t *pxChain = (Chain_t *)xChain;
+
+    if (!bIsValidChain(xChain)) {
+        return 0;
+    }
+    for (uint32_t i = 0; pxTasks != NULL && i < ulMax && i < pxChain->ulTaskCount; i++) {
+        pxTasks[i] = (TaskHandle_t)pxChain->pxTasks[i];
+    }
+    return pxChain->ulTaskCount;
+}
+
+static bool bIsValidChain(ChainHandle_t xChain)
+{
+    Chain_t *pxChain = (Chain_t *)xChain;
+
+    return pxChain >= &xChains[0] && pxChain < &xChains[MAX_CHAINS] && pxChain->pcName != NULL;
+}
+
+/**
+ * @brief Now, on the timebase of the release stamps
+ *
+ * Called with the tick masked, so ulSystemTick is stable; a tick that is
+ * already pending is counted by ulGetTickElapsedUs().
+ */
+static uint32_t ulChainNow(void)
+{
+    return ulGetSystemTick() * CHAIN_TICK_US + ulGetTickElapsedUs();
+}
+
+/**
+ * @brief Count ulLatency in its histogram bucket and track the maximum
+ */
+static void vChainRecord(uint32_t *pulHistogram, uint32_t *pulMax, uint32_t ulLatency)
+{
+    uint32_t ulBucket = 0;
+
+    while (ulBucket < CHAIN_HISTOGRAM_BUCKETS - 1 && ulLatency >= CHAIN_BUCKET_LOWER_US(ulBucket + 1)) {
+        ulBucket++;
+    }
+    pulHistogram[ulBucket]++;
+    if (ulLatency > *pulMax) {
+        *pulMax = ulLatency;
+    }
+}
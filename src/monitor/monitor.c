@@ -4,11 +4,46 @@
  */
 
 #include "periodRTOS.h"
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 /* External variables */
 extern TaskControlBlock_t xTaskList[MAX_TASKS];
 extern SystemMonitor_t xSystemMonitor;
+extern TaskHandle_t xIdleTask;
+
+/* Layout checks - host tools rely on these offsets */
+_Static_assert(sizeof(TaskTelemetry_t) == 56, "TaskTelemetry_t layout changed");
+_Static_assert(sizeof(TelemetrySnapshot_t) == 32 + MAX_TASKS * sizeof(TaskTelemetry_t) + 20 +
+               MAX_TASKS * sizeof(TaskLoadTelemetry_t),
+               "TelemetrySnapshot_t layout changed");
+_Static_assert(offsetof(TelemetrySnapshot_t, ulSystemLoad) == 32 + MAX_TASKS * 56,
+               "v2 fields must follow the v1 task records");
+
+/*
+ * Monitor sequence lock. Odd while kernel code is updating monitoring state,
+ * even otherwise. Writers nest (the tick ISR can preempt a thread-mode writer),
+ * only the outermost begin/end pair moves the sequence.
+ */
+volatile uint32_t ulMonitorSequence = 0;
+static volatile uint32_t ulMonitorWriteNesting = 0;
+
+/* Load accounting state (run-time counter is in microseconds) */
+#define LOAD_WINDOW_TICKS   ((LOAD_WINDOW_MS * SYSTICK_FREQ_HZ) / 1000)
+
+static uint32_t ulLoadWindowStart = 0;       /* Run-time counter at window start */
+static uint32_t ulLoadWindowTicks = 0;
+static uint32_t ulHyperperiodStart = 0;      /* Run-time counter at hyperperiod start */
+static uint32_t ulHyperperiodTicks = 0;
+static uint32_t ulHyperperiodIdleTime = 0;   /* Idle run time in the current hyperperiod */
+static uint32_t ulIdleTimeRemainder = 0;     /* Sub-millisecond idle time carry */
+
+static void vFillTelemetrySnapshot(TelemetrySnapshot_t *pxSnapshot);
+static void vChargeRunTime(TaskControlBlock_t *pxTCB, uint32_t ulNow);
+static void vFoldLoadWindow(uint32_t ulElapsed);
+static uint32_t ulLoadFraction(uint32_t ulRunTime, uint32_t ulElapsed);
+static uint32_t ulLoadToPercent(uint32_t ulLoad);
 
 /**
  * @brief Get total context switch count
@@ -30,7 +65,7 @@ uint32_t ulGetTaskExecutionTime(TaskHandle_t xTask)
     }
     
     pxTCB = (TaskControlBlock_t *)xTask;
-    return pxTCB->ulExecutionTime;
+    return pxTaskDetail(pxTCB)->ulExecutionTime;
 }
 
 /**
@@ -45,7 +80,31 @@ uint32_t ulGetDeadlineMissCount(TaskHandle_t xTask)
     }
     
     pxTCB = (TaskControlBlock_t *)xTask;
-    return pxTCB->ulDeadlineMissCount;
+    return pxTaskDetail(pxTCB)->ulDeadlineMissCount;
+}
+
+/**
+ * @brief Get the number of jobs skipped under overload ((m,k)-firm tasks)
+ */
+uint32_t ulGetSkippedJobCount(TaskHandle_t xTask)
+{
+    if (!bIsValidTaskHandle(xTask)) {
+        return 0;
+    }
+    
+    return pxTaskDetail((TaskControlBlock_t *)xTask)->ulSkippedJobs;
+}
+
+/**
+ * @brief Get the number of jobs that ended a window violating (m,k)
+ */
+uint32_t ulGetFirmViolationCount(TaskHandle_t xTask)
+{
+    if (!bIsValidTaskHandle(xTask)) {
+        return 0;
+    }
+    
+    return pxTaskDetail((TaskControlBlock_t *)xTask)->ulFirmViolations;
 }
 
 /**
@@ -65,12 +124,128 @@ bool bIsTaskDeadlineMissed(TaskHandle_t xTask)
 
 /**
  * @brief Get system monitor structure
+ *
+ * Returns the live structure; fields may change between reads. Use
+ * bGetTelemetrySnapshot() when several fields must be consistent.
  */
 SystemMonitor_t* pxGetSystemMonitor(void)
 {
     return &xSystemMonitor;
 }
 
+/**
+ * @brief Mark the start of a monitoring state update
+ */
+void vMonitorWriteBegin(void)
+{
+    if (ulMonitorWriteNesting++ == 0) {
+        ulMonitorSequence++;
+        __sync_synchronize();
+    }
+}
+
+/**
+ * @brief Mark the end of a monitoring state update
+ */
+void vMonitorWriteEnd(void)
+{
+    if (--ulMonitorWriteNesting == 0) {
+        __sync_synchronize();
+        ulMonitorSequence++;
+    }
+}
+
+/**
+ * @brief Take a consistent binary snapshot of system and task statistics
+ *
+ * Lock-free: copies the live data and retries if a writer was active or ran
+ * in between. Never masks interrupts. Returns false if no consistent copy
+ * could be taken within TELEMETRY_SNAPSHOT_RETRIES attempts (e.g. a preempted
+ * lower-priority task is in the middle of an update); callers retry later.
+ */
+bool bGetTelemetrySnapshot(TelemetrySnapshot_t *pxSnapshot)
+{
+    uint32_t ulSequence;
+
+    if (pxSnapshot == NULL) {
+        return false;
+    }
+
+    for (uint32_t ulAttempt = 0; ulAttempt < TELEMETRY_SNAPSHOT_RETRIES; ulAttempt++) {
+        ulSequence = ulMonitorSequence;
+        if (ulSequence & 1) {
+            continue; /* Update in progress */
+        }
+        __sync_synchronize();
+
+        vFillTelemetrySnapshot(pxSnapshot);
+
+        __sync_synchronize();
+        if (ulMonitorSequence == ulSequence) {
+            pxSnapshot->ulSequence = ulSequence;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Copy live monitoring data into the snapshot layout
+ */
+static void vFillTelemetrySnapshot(TelemetrySnapshot_t *pxSnapshot)
+{
+    TaskControlBlock_t *pxTCB;
+    TaskDetail_t *pxDetail;
+    TaskTelemetry_t *pxRecord;
+
+    pxSnapshot->ulMagic = TELEMETRY_SNAPSHOT_MAGIC;
+    pxSnapshot->usVersion = TELEMETRY_SNAPSHOT_VERSION;
+    pxSnapshot->usSize = sizeof(TelemetrySnapshot_t);
+    pxSnapshot->ulSystemUptime = xSystemMonitor.ulSystemUptime;
+    pxSnapshot->ulTotalContextSwitches = xSystemMonitor.ulTotalContextSwitches;
+    pxSnapshot->ulIdleTime = xSystemMonitor.ulIdleTime;
+    pxSnapshot->ulTaskCount = xSystemMonitor.ulTaskCount;
+    pxSnapshot->ucSchedulerState = (uint8_t)xSystemMonitor.eSchedulerState;
+    pxSnapshot->ucTaskRecords = MAX_TASKS;
+    pxSnapshot->usTaskRecordSize = sizeof(TaskTelemetry_t);
+
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        pxTCB = &xTaskList[i];
+        pxDetail = &xTaskDetails[i];
+        pxRecord = &pxSnapshot->xTasks[i];
+
+        pxRecord->ulTaskID = pxTCB->ulTaskID;
+        pxRecord->ulPriority = pxTCB->ulPriority;
+        pxRecord->ulPeriod = pxTCB->ulPeriod;
+        pxRecord->ulDeadline = pxTCB->ulDeadline;
+        pxRecord->ulReleaseTime = pxTCB->ulReleaseTime;
+        pxRecord->ulDeadlineTime = pxTCB->ulDeadlineTime;
+        pxRecord->ulExecutionTime = pxDetail->ulExecutionTime;
+        pxRecord->ulContextSwitchCount = pxDetail->ulContextSwitchCount;
+        pxRecord->ulDeadlineMissCount = pxDetail->ulDeadlineMissCount;
+        pxRecord->ucState = (uint8_t)pxTCB->eCurrentState;
+        pxRecord->ucFlags = 0;
+        if (pxTCB->pxTaskCode != NULL) {
+            /* The idle task has ID 0, so use the code pointer for occupancy */
+            pxRecord->ucFlags |= TASK_TELEMETRY_FLAG_IN_USE;
+        }
+        if (pxTCB->bDeadlineMissed) {
+            pxRecord->ucFlags |= TASK_TELEMETRY_FLAG_DEADLINE_MISSED;
+        }
+        pxRecord->usReserved = 0;
+        memcpy(pxRecord->pcTaskName, pxDetail->pcTaskName, sizeof(pxRecord->pcTaskName));
+        pxSnapshot->xTaskLoads[i].ulLoad = pxDetail->ulLoadEwma;
+        pxSnapshot->xTaskLoads[i].ulLoadPeak = pxDetail->ulLoadPeak;
+    }
+
+    pxSnapshot->ulSystemLoad = xSystemMonitor.ulSystemLoadEwma;
+    pxSnapshot->ulSystemLoadPeak = xSystemMonitor.ulSystemLoadPeak;
+    pxSnapshot->ulHyperperiod = xSystemMonitor.ulHyperperiod;
+    pxSnapshot->ulHyperperiodLoad = xSystemMonitor.ulHyperperiodLoad;
+    pxSnapshot->ulHyperperiodLoadPeak = xSystemMonitor.ulHyperperiodLoadPeak;
+}
+
 /**
  * @brief Update context switch count
  */
@@ -91,7 +266,7 @@ void vUpdateTaskContextSwitchCount(TaskHandle_t xTask)
     }
     
     pxTCB = (TaskControlBlock_t *)xTask;
-    pxTCB->ulContextSwitchCount++;
+    pxTaskDetail(pxTCB)->ulContextSwitchCount++;
 }
 
 /**
@@ -103,45 +278,212 @@ void vUpdateIdleTime(uint32_t ulIdleTicks)
 }
 
 /**
- * @brief Get task utilization percentage
+ * @brief Get task utilization percentage (smoothed over recent windows)
  */
 uint32_t ulGetTaskUtilization(TaskHandle_t xTask)
 {
-    TaskControlBlock_t *pxTCB;
-    uint32_t ulUtilization;
-    
     if (!bIsValidTaskHandle(xTask)) {
         return 0;
     }
-    
-    pxTCB = (TaskControlBlock_t *)xTask;
-    
-    if (pxTCB->ulPeriod == 0 || xSystemMonitor.ulSystemUptime == 0) {
+
+    return ulLoadToPercent(pxTaskDetail((TaskControlBlock_t *)xTask)->ulLoadEwma);
+}
+
+/**
+ * @brief Get the highest window utilization a task has reached (percent)
+ */
+uint32_t ulGetTaskPeakUtilization(TaskHandle_t xTask)
+{
+    if (!bIsValidTaskHandle(xTask)) {
         return 0;
     }
-    
-    /* Calculate utilization as (execution_time / period) * 100 */
-    ulUtilization = (pxTCB->ulExecutionTime * 100) / pxTCB->ulPeriod;
-    
-    return ulUtilization;
+
+    return ulLoadToPercent(pxTaskDetail((TaskControlBlock_t *)xTask)->ulLoadPeak);
 }
 
 /**
- * @brief Get system utilization percentage
+ * @brief Get system utilization percentage (non-idle time, smoothed)
  */
 uint32_t ulGetSystemUtilization(void)
 {
-    uint32_t ulTotalUtilization = 0;
+    return ulLoadToPercent(xSystemMonitor.ulSystemLoadEwma);
+}
+
+/**
+ * @brief Get the highest window system utilization (percent)
+ */
+uint32_t ulGetSystemPeakUtilization(void)
+{
+    return ulLoadToPercent(xSystemMonitor.ulSystemLoadPeak);
+}
+
+/**
+ * @brief Get system utilization over the last full hyperperiod (percent)
+ */
+uint32_t ulGetHyperperiodUtilization(void)
+{
+    return ulLoadToPercent(xSystemMonitor.ulHyperperiodLoad);
+}
+
+/**
+ * @brief Charge elapsed run time at a context switch
+ *
+ * Called by the kernel with the monitor write section open. xFrom may be
+ * NULL for the very first switch.
+ */
+void vMonitorAccountSwitch(TaskHandle_t xFrom, TaskHandle_t xTo)
+{
+    uint32_t ulNow = ulGetRunTimeCounter();
+
+    if (xFrom != NULL) {
+        vChargeRunTime((TaskControlBlock_t *)xFrom, ulNow);
+    }
+
+    if (xTo != NULL) {
+        pxTaskDetail((TaskControlBlock_t *)xTo)->ulLastSwitchInTime = ulNow;
+    }
+}
+
+/**
+ * @brief Close load windows and hyperperiods - called from the tick handler
+ *
+ * O(1) on most ticks; walks the task list once per LOAD_WINDOW_MS.
+ */
+void vMonitorLoadTick(void)
+{
+    TaskControlBlock_t *pxCurrent = (TaskControlBlock_t *)pxGetCurrentTask();
+    bool bWindowEnd = (++ulLoadWindowTicks >= LOAD_WINDOW_TICKS);
+    bool bHyperperiodEnd = (xSystemMonitor.ulHyperperiod != 0 &&
+                            ++ulHyperperiodTicks >= xSystemMonitor.ulHyperperiod);
+    uint32_t ulNow;
+
+    if (!bWindowEnd && !bHyperperiodEnd) {
+        return;
+    }
+
+    /* Bring the running task's accounting up to now */
+    ulNow = ulGetRunTimeCounter();
+    if (pxCurrent != NULL) {
+        vChargeRunTime(pxCurrent, ulNow);
+    }
+
+    if (bWindowEnd) {
+        vFoldLoadWindow(ulNow - ulLoadWindowStart);
+        ulLoadWindowStart = ulNow;
+        ulLoadWindowTicks = 0;
+    }
+
+    if (bHyperperiodEnd) {
+        uint32_t ulIdle = ulLoadFraction(ulHyperperiodIdleTime, ulNow - ulHyperperiodStart);
+
+        xSystemMonitor.ulHyperperiodLoad = LOAD_Q16_ONE - ulIdle;
+        if (xSystemMonitor.ulHyperperiodLoad > xSystemMonitor.ulHyperperiodLoadPeak) {
+            xSystemMonitor.ulHyperperiodLoadPeak = xSystemMonitor.ulHyperperiodLoad;
+        }
+        ulHyperperiodStart = ulNow;
+        ulHyperperiodTicks = 0;
+        ulHyperperiodIdleTime = 0;
+    }
+}
+
+/**
+ * @brief Set the hyperperiod (ticks) and restart load measurement
+ */
+void vMonitorSetHyperperiod(uint32_t ulHyperperiod)
+{
+    uint32_t ulNow = ulGetRunTimeCounter();
+
+    xSystemMonitor.ulHyperperiod = ulHyperperiod;
+    ulLoadWindowStart = ulNow;
+    ulLoadWindowTicks = 0;
+    ulHyperperiodStart = ulNow;
+    ulHyperperiodTicks = 0;
+    ulHyperperiodIdleTime = 0;
+}
+
+/**
+ * @brief Add run time since the task was switched in (or last charged)
+ */
+static void vChargeRunTime(TaskControlBlock_t *pxTCB, uint32_t ulNow)
+{
+    TaskDetail_t *pxDetail = pxTaskDetail(pxTCB);
+    uint32_t ulRan = ulNow - pxDetail->ulLastSwitchInTime;
+
+    pxDetail->ulWindowRunTime += ulRan;
+    pxDetail->ulLastSwitchInTime = ulNow;
+
+    if ((TaskHandle_t)pxTCB == xIdleTask) {
+        ulHyperperiodIdleTime += ulRan;
+    }
+}
+
+/**
+ * @brief Turn the window's run times into utilization samples
+ */
+static void vFoldLoadWindow(uint32_t ulElapsed)
+{
     TaskControlBlock_t *pxTCB;
-    
+    TaskDetail_t *pxDetail;
+    uint32_t ulSample;
+
+    if (ulElapsed == 0) {
+        return;
+    }
+
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         pxTCB = &xTaskList[i];
-        if (pxTCB->ulTaskID != 0 && pxTCB->ulPeriod > 0) {
-            ulTotalUtilization += ulGetTaskUtilization((TaskHandle_t)pxTCB);
+        pxDetail = &xTaskDetails[i];
+        if (pxTCB->pxTaskCode == NULL) {
+            continue;
+        }
+
+        ulSample = ulLoadFraction(pxDetail->ulWindowRunTime, ulElapsed);
+        pxDetail->ulLoadEwma = pxDetail->ulLoadEwma - (pxDetail->ulLoadEwma >> LOAD_EWMA_SHIFT)
+                             + (ulSample >> LOAD_EWMA_SHIFT);
+        if (ulSample > pxDetail->ulLoadPeak) {
+            pxDetail->ulLoadPeak = ulSample;
+        }
+
+        if ((TaskHandle_t)pxTCB == xIdleTask) {
+            /* System load is everything the idle task did not get */
+            ulIdleTimeRemainder += pxDetail->ulWindowRunTime;
+            xSystemMonitor.ulIdleTime += ulIdleTimeRemainder / 1000;
+            ulIdleTimeRemainder %= 1000;
+
+            ulSample = LOAD_Q16_ONE - ulSample;
+            xSystemMonitor.ulSystemLoadEwma = xSystemMonitor.ulSystemLoadEwma
+                                            - (xSystemMonitor.ulSystemLoadEwma >> LOAD_EWMA_SHIFT)
+                                            + (ulSample >> LOAD_EWMA_SHIFT);
+            if (ulSample > xSystemMonitor.ulSystemLoadPeak) {
+                xSystemMonitor.ulSystemLoadPeak = ulSample;
+            }
         }
+
+        pxDetail->ulWindowRunTime = 0;
     }
-    
-    return ulTotalUtilization;
+}
+
+/**
+ * @brief ulRunTime / ulElapsed as Q16, saturated at 100%
+ */
+static uint32_t ulLoadFraction(uint32_t ulRunTime, uint32_t ulElapsed)
+{
+    uint64_t ullFraction;
+
+    if (ulElapsed == 0) {
+        return 0;
+    }
+
+    ullFraction = ((uint64_t)ulRunTime << 16) / ulElapsed;
+    return (ullFraction > LOAD_Q16_ONE) ? LOAD_Q16_ONE : (uint32_t)ullFraction;
+}
+
+/**
+ * @brief Q16 fraction to rounded percent
+ */
+static uint32_t ulLoadToPercent(uint32_t ulLoad)
+{
+    return (ulLoad * 100 + LOAD_Q16_ONE / 2) >> 16;
 }
 
 /**
@@ -150,12 +492,14 @@ uint32_t ulGetSystemUtilization(void)
 void vGetTaskInfo(TaskHandle_t xTask, char *pcBuffer, uint32_t ulBufferSize)
 {
     TaskControlBlock_t *pxTCB;
+    TaskDetail_t *pxDetail;
     
     if (!bIsValidTaskHandle(xTask) || pcBuffer == NULL || ulBufferSize == 0) {
         return;
     }
     
     pxTCB = (TaskControlBlock_t *)xTask;
+    pxDetail = pxTaskDetail(pxTCB);
     
     /* Format task information */
     snprintf(pcBuffer, ulBufferSize,
@@ -168,17 +512,19 @@ void vGetTaskInfo(TaskHandle_t xTask, char *pcBuffer, uint32_t ulBufferSize)
              "Execution Time: %lu ms\n"
              "Context Switches: %lu\n"
              "Deadline Misses: %lu\n"
+             "Skipped Jobs: %lu\n"
              "Utilization: %lu%%\n",
-             pxTCB->pcTaskName,
-             pxTCB->ulTaskID,
+             pxDetail->pcTaskName,
+             (unsigned long)pxTCB->ulTaskID,
              pxTCB->eCurrentState,
-             pxTCB->ulPriority,
-             pxTCB->ulPeriod,
-             pxTCB->ulDeadline,
-             pxTCB->ulExecutionTime,
-             pxTCB->ulContextSwitchCount,
-             pxTCB->ulDeadlineMissCount,
-             ulGetTaskUtilization(xTask));
+             (unsigned long)pxTCB->ulPriority,
+             (unsigned long)pxTCB->ulPeriod,
+             (unsigned long)pxTCB->ulDeadline,
+             (unsigned long)pxDetail->ulExecutionTime,
+             (unsigned long)pxDetail->ulContextSwitchCount,
+             (unsigned long)pxDetail->ulDeadlineMissCount,
+             (unsigned long)pxDetail->ulSkippedJobs,
+             (unsigned long)ulGetTaskUtilization(xTask));
 }
 
 /**
@@ -197,12 +543,17 @@ void vGetSystemInfo(char *pcBuffer, uint32_t ulBufferSize)
              "Idle Time: %lu ms\n"
              "Task Count: %lu\n"
              "System Utilization: %lu%%\n"
+             "Peak Utilization: %lu%%\n"
+             "Hyperperiod: %lu ms (%lu%% busy)\n"
              "Scheduler State: %d\n",
-             xSystemMonitor.ulSystemUptime,
-             xSystemMonitor.ulTotalContextSwitches,
-             xSystemMonitor.ulIdleTime,
-             xSystemMonitor.ulTaskCount,
-             ulGetSystemUtilization(),
+             (unsigned long)xSystemMonitor.ulSystemUptime,
+             (unsigned long)xSystemMonitor.ulTotalContextSwitches,
+             (unsigned long)xSystemMonitor.ulIdleTime,
+             (unsigned long)xSystemMonitor.ulTaskCount,
+             (unsigned long)ulGetSystemUtilization(),
+             (unsigned long)ulGetSystemPeakUtilization(),
+             (unsigned long)xSystemMonitor.ulHyperperiod,
+             (unsigned long)ulGetHyperperiodUtilization(),
              xSystemMonitor.eSchedulerState);
 }
 
@@ -212,19 +563,36 @@ void vGetSystemInfo(char *pcBuffer, uint32_t ulBufferSize)
 void vResetMonitoringData(void)
 {
     TaskControlBlock_t *pxTCB;
+    TaskDetail_t *pxDetail;
     
+    vKernelEnterCritical();
+    vMonitorWriteBegin();
+
     /* Reset system monitor */
     xSystemMonitor.ulTotalContextSwitches = 0;
     xSystemMonitor.ulIdleTime = 0;
+    xSystemMonitor.ulSystemLoadEwma = 0;
+    xSystemMonitor.ulSystemLoadPeak = 0;
+    xSystemMonitor.ulHyperperiodLoad = 0;
+    xSystemMonitor.ulHyperperiodLoadPeak = 0;
+    ulIdleTimeRemainder = 0;
     
     /* Reset task monitoring data */
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         pxTCB = &xTaskList[i];
+        pxDetail = &xTaskDetails[i];
         if (pxTCB->ulTaskID != 0) {
-            pxTCB->ulExecutionTime = 0;
-            pxTCB->ulContextSwitchCount = 0;
-            pxTCB->ulDeadlineMissCount = 0;
+            pxDetail->ulExecutionTime = 0;
+            pxDetail->ulContextSwitchCount = 0;
+            pxDetail->ulDeadlineMissCount = 0;
             pxTCB->bDeadlineMissed = false;
+            pxDetail->ulSkippedJobs = 0;
+            pxDetail->ulFirmViolations = 0;
+            pxDetail->ulLoadEwma = 0;
+            pxDetail->ulLoadPeak = 0;
         }
     }
+
+    vMonitorWriteEnd();
+    vKernelExitCritical();
 }
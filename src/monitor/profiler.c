@@ -0,0 +1,183 @@
+/**
+ * @file profiler.c
+ * @brief Statistical PC-sampling profiler: sample ring and telemetry drain
+ *
+ * The sampling interrupt is the only writer of the ring and the draining
+ * task the only reader, so the two indices need no lock: each side writes
+ * its own index and reads the other's. The interrupt runs above the
+ * kernel's critical sections and therefore calls nothing in the kernel.
+ */
+
+#include "periodRTOS.h"
+#include "profiler.h"
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert((PROFILER_RING_SAMPLES & (PROFILER_RING_SAMPLES - 1)) == 0,
+               "PROFILER_RING_SAMPLES must be a power of two");
+_Static_assert(sizeof(ProfileSample_t) == 12, "ProfileSample_t layout changed");
+_Static_assert(sizeof(ProfileFrameHeader_t) == 20, "ProfileFrameHeader_t layout changed");
+
+/* External variables */
+extern TaskHandle_t xCurrentTask;
+
+static ProfileSample_t xRing[PROFILER_RING_SAMPLES];
+static volatile uint32_t ulRingHead = 0;     /* Written by the interrupt */
+static volatile uint32_t ulRingTail = 0;     /* Written by the reader */
+static volatile uint32_t ulSamples = 0;
+static volatile uint32_t ulDropped = 0;
+static volatile uint32_t ulCurrentHz = 0;
+
+/**
+ * @brief Start sampling at ulSampleHz, or PROFILER_SAMPLE_HZ if 0
+ *
+ * Also changes the rate of a running profiler; buffered samples are kept.
+ */
+void vProfilerStart(uint32_t ulSampleHz)
+{
+    if (ulSampleHz == 0) {
+        ulSampleHz = PROFILER_SAMPLE_HZ;
+    }
+    ulCurrentHz = ulSampleHz;
+    vProfilerTimerStart(ulSampleHz);
+}
+
+/**
+ * @brief Stop sampling; buffered samples can still be read or flushed
+ */
+void vProfilerStop(void)
+{
+    vProfilerTimerStop();
+    ulCurrentHz = 0;
+}
+
+/**
+ * @brief Record one sample, from the port's sampling interrupt
+ *
+ * Constant time; the sample is counted and dropped if the ring is full.
+ */
+KERNEL_RAMFUNC void vProfilerSample(uintptr_t uxPc, uintptr_t uxLr, uint8_t ucFlags)
+{
+    TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)xCurrentTask;
+    uint32_t ulHead = ulRingHead;
+    ProfileSample_t *pxSample;
+
+    ulSamples++;
+    if (ulHead - ulRingTail >= PROFILER_RING_SAMPLES) {
+        ulDropped++;
+        return;
+    }
+
+    pxSample = &xRing[ulHead & (PROFILER_RING_SAMPLES - 1)];
+    pxSample->ulPc = (uint32_t)(uxPc - (uintptr_t)vProfilerStart);
+    pxSample->ulLr = (uint32_t)(uxLr - (uintptr_t)vProfilerStart);
+    pxSample->ucTaskID = (pxTCB != NULL) ? (uint8_t)pxTCB->ulTaskID : 0;
+    pxSample->ucFlags = ucFlags;
+    pxSample->usReserved = 0;
+
+    /* Publish the sample before the index that makes it visible */
+    __asm volatile ("" : : : "memory");
+    ulRingHead = ulHead + 1;
+}
+
+/**
+ * @brief Move up to ulMax buffered samples, oldest first, into pxSamples
+ * @return Number of samples copied
+ */
+uint32_t ulProfilerRead(ProfileSample_t *pxSamples, uint32_t ulMax)
+{
+    uint32_t ulTail = ulRingTail;
+    uint32_t ulCount = ulRingHead - ulTail;
+
+    if (pxSamples == NULL) {
+        return 0;
+    }
+    if (ulCount > ulMax) {
+        ulCount = ulMax;
+    }
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        pxSamples[i] = xRing[(ulTail + i) & (PROFILER_RING_SAMPLES - 1)];
+    }
+
+    /* Copy out before the interrupt may reuse the slots */
+    __asm volatile ("" : : : "memory");
+    ulRingTail = ulTail + ulCount;
+
+    return ulCount;
+}
+
+/**
+ * @brief Send all buffered samples on TELEMETRY_CHANNEL_PROFILE
+ * @return false if the transport had no room; the rest stays buffered
+ *
+ * Call from one task, e.g. next to bTelemetrySendSnapshot(). Sending stops
+ * at the first frame the transport drops, so no samples are lost to it.
+ */
+bool bProfilerFlush(void)
+{
+    /* Static: a full frame is larger than a small task stack */
+    static struct __attribute__((packed)) {
+        ProfileFrameHeader_t xHeader;
+        ProfileSample_t xSamples[PROFILE_FRAME_SAMPLES];
+    } xFrame;
+    static volatile bool bFlushBusy = false;
+    bool bSent = true;
+    uint32_t ulState;
+
+    ulState = ulHalDisableInterrupts();
+    if (bFlushBusy) {
+        vHalRestoreInterrupts(ulState);
+        return false;
+    }
+    bFlushBusy = true;
+    vHalRestoreInterrupts(ulState);
+
+    while (ulRingHead != ulRingTail) {
+        uint32_t ulTail = ulRingTail;
+        uint32_t ulCount = ulRingHead - ulTail;
+
+        if (ulCount > PROFILE_FRAME_SAMPLES) {
+            ulCount = PROFILE_FRAME_SAMPLES;
+        }
+        for (uint32_t i = 0; i < ulCount; i++) {
+            xFrame.xSamples[i] = xRing[(ulTail + i) & (PROFILER_RING_SAMPLES - 1)];
+        }
+
+        xFrame.xHeader.ulMagic = PROFILE_FRAME_MAGIC;
+        xFrame.xHeader.ulSampleHz = ulCurrentHz;
+        xFrame.xHeader.ulSamples = ulSamples;
+        xFrame.xHeader.ulDropped = ulDropped;
+        xFrame.xHeader.usCount = (uint16_t)ulCount;
+        xFrame.xHeader.usSampleSize = sizeof(ProfileSample_t);
+
+        if (!bTelemetrySend(TELEMETRY_CHANNEL_PROFILE, &xFrame,
+                            sizeof(ProfileFrameHeader_t) + ulCount * sizeof(ProfileSample_t))) {
+            bSent = false;
+            break;
+        }
+
+        /* Only consume what the transport took */
+        __asm volatile ("" : : : "memory");
+        ulRingTail = ulTail + ulCount;
+    }
+
+    bFlushBusy = false;
+
+    return bSent;
+}
+
+/**
+ * @brief Get sampling rate and counters
+ */
+void vProfilerGetStats(ProfilerStats_t *pxStats)
+{
+    if (pxStats == NULL) {
+        return;
+    }
+
+    pxStats->ulSampleHz = ulCurrentHz;
+    pxStats->ulSamples = ulSamples;
+    pxStats->ulDropped = ulDropped;
+    pxStats->ulBuffered = ulRingHead - ulRingTail;
+}
@@ -0,0 +1,292 @@
+/**
+ * @file mode_change.c
+ * @brief Task-set modes with the idle-time mode-change protocol
+ *
+ * A mode is a bit mask over xTaskList slots. While no change is pending the
+ * tick hook costs one comparison. During a change it scans the task list
+ * once per tick: leaving tasks whose job has finished are suspended, and
+ * the change completes at the first tick that finds no periodic job
+ * pending. vModeTick() runs before the tick's release scan, so tasks
+ * entering the mode are released at the completion tick itself and tasks
+ * leaving it never see another release.
+ */
+
+#include "periodRTOS.h"
+#include "mode_change.h"
+#include "rm_analysis.h"
+#include "telemetry.h"
+#include "tt_schedule.h"
+#include <stddef.h>
+
+_Static_assert(MAX_TASKS <= 32, "mode task masks are 32 bits");
+
+typedef struct {
+    const char *pcName;              /* NULL if the mode is not defined */
+    uint32_t ulTasks;                /* Bit i: xTaskList[i] runs in this mode */
+} Mode_t;
+
+/* External variables */
+extern TaskControlBlock_t xTaskList[MAX_TASKS];
+extern TaskHandle_t xTimerServiceTask;
+extern uint32_t ulSystemTick;
+
+static Mode_t xModes[MAX_MODES];
+static uint32_t ulCurrentMode = 0;       /* Starting mode until vModeStart() */
+static volatile uint32_t ulPendingMode = MODE_NONE;
+static bool bModesStarted = false;
+static uint32_t ulRequestTick = 0;
+static uint32_t ulRequestCycles = 0;
+static ModeStats_t xStats = { MODE_NONE, MODE_NONE, 0, 0, 0, 0, 0 };
+
+/* Internal function prototypes */
+static bool bIsPeriodicTask(const TaskControlBlock_t *pxTCB);
+static void vEnterMode(uint32_t ulMode);
+
+/**
+ * @brief Name the periodic tasks that run in mode ulMode
+ * @return false if ulMode is out of range, a handle is not a periodic task,
+ *         or the scheduler has already started
+ *
+ * Mode 0 is the starting mode unless bModeRequest() picks another one
+ * before vTaskStartScheduler(). Without any mode defined every task runs.
+ */
+bool bModeDefine(uint32_t ulMode, const char *pcName, const TaskHandle_t *pxTasks, uint32_t ulCount)
+{
+    uint32_t ulTasks = 0;
+
+    if (ulMode >= MAX_MODES || pcName == NULL || bModesStarted) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        const TaskControlBlock_t *pxTCB = (const TaskControlBlock_t *)pxTasks[i];
+
+        if (!bIsValidTaskHandle(pxTasks[i]) || !bIsPeriodicTask(pxTCB)) {
+            return false;
+        }
+        ulTasks |= 1UL << (pxTCB - xTaskList);
+    }
+
+    xModes[ulMode].pcName = pcName;
+    xModes[ulMode].ulTasks = ulTasks;
+    return true;
+}
+
+/**
+ * @brief Ask for a change to mode ulMode
+ * @return false if the mode is not defined or a time-triggered table is active
+ *
+ * Before the scheduler starts this selects the starting mode. A request
+ * made while another change is in progress retargets that change; its
+ * latency still counts from the first request.
+ */
+bool bModeRequest(uint32_t ulMode)
+{
+    uint32_t ulState;
+
+    if (ulMode >= MAX_MODES || xModes[ulMode].pcName == NULL || bTtActive()) {
+        return false;
+    }
+
+    ulState = ulHalDisableInterrupts();
+    if (!bModesStarted) {
+        ulCurrentMode = ulMode;
+    } else if (ulPendingMode != MODE_NONE) {
+        ulPendingMode = ulMode;
+    } else if (ulMode != ulCurrentMode) {
+        ulRequestTick = ulSystemTick;
+        ulRequestCycles = ulGetCycleCounter();
+        ulPendingMode = ulMode;
+    }
+    vHalRestoreInterrupts(ulState);
+
+    return true;
+}
+
+/**
+ * @brief Mode in effect, MODE_NONE if no modes are used
+ *
+ * Stays at the old mode until a requested change completes.
+ */
+uint32_t ulModeGetCurrent(void)
+{
+    return xStats.ulCurrentMode;
+}
+
+/**
+ * @brief Name given to bModeDefine(), NULL for an undefined mode
+ */
+const char *pcModeGetName(uint32_t ulMode)
+{
+    return (ulMode < MAX_MODES) ? xModes[ulMode].pcName : NULL;
+}
+
+/**
+ * @brief Worst-case latency in ticks of a change away from mode ulFrom
+ * @return 0 if unknown: a task of the mode has no WCET (vTaskSetWcet()) or
+ *         the mode is overloaded
+ *
+ * The change completes at the end of the busy period the request falls
+ * into, which is no longer than the synchronous busy period of ulFrom's
+ * tasks, plus up to one tick until the next tick observes it. Kernel
+ * overhead is not included in the WCETs and hence not in the bound.
+ */
+uint32_t ulModeTransitionBound(uint32_t ulFrom)
+{
+    uint32_t pulPeriod[MAX_TASKS];
+    uint32_t pulWcet[MAX_TASKS];
+    uint32_t ulCount = 0;
+    uint32_t ulBusyUs;
+
+    if (ulFrom >= MAX_MODES || xModes[ulFrom].pcName == NULL) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        if (xModes[ulFrom].ulTasks & (1UL << i)) {
+            if (xTaskDetails[i].ulWcet == 0) {
+                return 0;
+            }
+            pulPeriod[ulCount] = xTaskList[i].ulPeriod;
+            pulWcet[ulCount] = xTaskDetails[i].ulWcet;
+            ulCount++;
+        }
+    }
+
+    ulBusyUs = ulRmBusyPeriod(ulCount, pulPeriod, pulWcet);
+    if (ulBusyUs == RM_RESPONSE_UNSCHEDULABLE) {
+        return 0;
+    }
+    return (ulBusyUs + RM_ANALYSIS_TICK_US - 1) / RM_ANALYSIS_TICK_US + 1;
+}
+
+/**
+ * @brief Copy the mode-change counters
+ */
+void vModeGetStats(ModeStats_t *pxStats)
+{
+    uint32_t ulState;
+
+    if (pxStats == NULL) {
+        return;
+    }
+
+    ulState = ulHalDisableInterrupts();
+    *pxStats = xStats;
+    pxStats->ulPendingMode = ulPendingMode;
+    vHalRestoreInterrupts(ulState);
+}
+
+/**
+ * @brief Suspend the tasks outside the starting mode (from vSchedulerInit)
+ *
+ * Runs before the ready list is filled, so only the starting mode's tasks
+ * get a first release.
+ */
+void vModeStart(void)
+{
+    uint32_t ulTasks;
+
+    bModesStarted = true;
+
+    if (xModes[ulCurrentMode].pcName == NULL) {
+        xStats.ulCurrentMode = MODE_NONE;
+        return;
+    }
+
+    ulTasks = xModes[ulCurrentMode].ulTasks;
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        if (bIsPeriodicTask(&xTaskList[i]) && !(ulTasks & (1UL << i))) {
+            xTaskList[i].eCurrentState = TASK_STATE_SUSPENDED;
+        }
+    }
+    xStats.ulCurrentMode = ulCurrentMode;
+}
+
+/**
+ * @brief Advance a pending mode change (from vSystemTickHandler)
+ */
+void vModeTick(void)
+{
+    uint32_t ulTarget = ulPendingMode;
+    uint32_t ulLeaving;
+    bool bIdle = true;
+
+    if (ulTarget == MODE_NONE) {
+        return;
+    }
+
+    ulLeaving = xModes[ulCurrentMode].ulTasks & ~xModes[ulTarget].ulTasks;
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        TaskControlBlock_t *pxTCB = &xTaskList[i];
+
+        if (!bIsPeriodicTask(pxTCB)) {
+            continue;
+        }
+        if ((ulLeaving & (1UL << i)) && pxTCB->eCurrentState == TASK_STATE_BLOCKED) {
+            /* Last job done */
+            pxTCB->eCurrentState = TASK_STATE_SUSPENDED;
+        }
+        if (pxTCB->eCurrentState == TASK_STATE_READY || pxTCB->eCurrentState == TASK_STATE_RUNNING ||
+            pxTCB->eCurrentState == TASK_STATE_DELAYED) {
+            /* Still inside the busy period */
+            bIdle = false;
+        }
+    }
+
+    if (bIdle) {
+        vEnterMode(ulTarget);
+    }
+}
+
+/**
+ * @brief Whether a task belongs to modes; the timer service runs in all of them
+ */
+static bool bIsPeriodicTask(const TaskControlBlock_t *pxTCB)
+{
+    return pxTCB->ulTaskID != 0 && pxTCB->ulPeriod > 0 && (TaskHandle_t)pxTCB != xTimerServiceTask;
+}
+
+/**
+ * @brief Complete a change at an idle tick
+ *
+ * Every periodic task is blocked or suspended here. Entering tasks get a
+ * release at this tick; tasks in both modes keep their next release.
+ */
+static void vEnterMode(uint32_t ulMode)
+{
+    uint32_t ulTasks = xModes[ulMode].ulTasks;
+    uint32_t ulTicks = ulSystemTick - ulRequestTick;
+    uint32_t ulCycles = ulGetCycleCounter() - ulRequestCycles;
+
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        TaskControlBlock_t *pxTCB = &xTaskList[i];
+
+        if (!bIsPeriodicTask(pxTCB)) {
+            continue;
+        }
+        if (!(ulTasks & (1UL << i))) {
+            pxTCB->eCurrentState = TASK_STATE_SUSPENDED;
+        } else if (pxTCB->eCurrentState == TASK_STATE_SUSPENDED) {
+            pxTCB->eCurrentState = TASK_STATE_BLOCKED;
+            pxTCB->ulReleaseTime = ulSystemTick;
+        }
+    }
+
+    ulCurrentMode = ulMode;
+    ulPendingMode = MODE_NONE;
+
+    xStats.ulCurrentMode = ulMode;
+    xStats.ulTransitions++;
+    xStats.ulLastLatencyTicks = ulTicks;
+    xStats.ulLastLatencyCycles = ulCycles;
+    if (ulTicks > xStats.ulMaxLatencyTicks) {
+        xStats.ulMaxLatencyTicks = ulTicks;
+    }
+    if (ulCycles > xStats.ulMaxLatencyCycles) {
+        xStats.ulMaxLatencyCycles = ulCycles;
+    }
+
+    /* Load accounting follows the new task set */
+    vMonitorSetHyperperiod(ulSchedulerHyperperiod());
+}
@@ -0,0 +1,263 @@
+/**
+ * @file rm_analysis.c
+ * @brief Schedulability analysis for Rate Monotonic task sets
+ *
+ * Utilizations are Q30 fixed point, rounded so that a test can only ever be
+ * pessimistic. Response times are computed in microseconds with the
+ * standard recurrence R = C + sum(ceil(R / Tj) * Cj) over higher priorities.
+ *
+ * The kernel drops a release whose previous job is still pending, so a job
+ * must finish within its period as well as its deadline: the analysis uses
+ * min(D, T) as the effective deadline.
+ */
+
+#include "rm_analysis.h"
+#include "rm_policy.h"
+
+/* n(2^(1/n) - 1) in Q30, rounded down */
+static const uint32_t ulLiuLaylandBound[] = {
+    1073741824UL, 889516851UL, 837264306UL, 812638371UL,
+    798318214UL,  788955738UL, 782356849UL, 777455503UL,
+    773671410UL,  770661685UL, 768210718UL, 766176136UL,
+    764460149UL,  762993360UL, 761725165UL, 760617790UL,
+    759642470UL,  758776913UL, 758003578UL, 757308472UL,
+    756680297UL,  756109830UL, 755589468UL, 755112888UL,
+    754674787UL,  754270687UL, 753896776UL, 753549794UL,
+    753226933UL,  752925762UL, 752644167UL, 752380298UL,
+};
+#define LIU_LAYLAND_TABLE_SIZE   (sizeof(ulLiuLaylandBound) / sizeof(ulLiuLaylandBound[0]))
+#define LIU_LAYLAND_LIMIT_Q30    744261117UL   /* ln 2, the bound as n -> infinity */
+
+/* Internal function prototypes */
+static uint64_t ullTaskUtilization(uint32_t ulPeriod, uint32_t ulWcet);
+static uint32_t ulResponseAt(uint32_t ulPosition, const uint32_t *pulPeriod,
+                             const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                             const uint32_t *pulOrder);
+
+/**
+ * @brief Fill pulOrder with task indices from highest to lowest priority
+ *
+ * Insertion sort on bRmPrecedes(), fine for kernel-sized sets; tools with
+ * very large sets sort their own.
+ */
+void vRmPriorityOrder(uint32_t ulCount, const uint32_t *pulPeriod, uint32_t *pulOrder)
+{
+    for (uint32_t i = 0; i < ulCount; i++) {
+        uint32_t j = i;
+
+        while (j > 0 && bRmPrecedes(pulPeriod[i], i + 1,
+                                    pulPeriod[pulOrder[j - 1]], pulOrder[j - 1] + 1)) {
+            pulOrder[j] = pulOrder[j - 1];
+            j--;
+        }
+        pulOrder[j] = i;
+    }
+}
+
+/**
+ * @brief Total utilization, Q30 rounded up
+ */
+uint64_t ullRmUtilization(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet)
+{
+    uint64_t ullUtilization = 0;
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        ullUtilization += ullTaskUtilization(pulPeriod[i], pulWcet[i]);
+    }
+    return ullUtilization;
+}
+
+/**
+ * @brief Liu & Layland bound n(2^(1/n) - 1) for n tasks, Q30 rounded down
+ */
+uint32_t ulRmLiuLaylandBound(uint32_t ulCount)
+{
+    if (ulCount == 0) {
+        return RM_ANALYSIS_Q30_ONE;
+    }
+    if (ulCount <= LIU_LAYLAND_TABLE_SIZE) {
+        return ulLiuLaylandBound[ulCount - 1];
+    }
+    return LIU_LAYLAND_LIMIT_Q30;
+}
+
+/**
+ * @brief Liu & Layland utilization test (implicit deadlines)
+ */
+bool bRmLiuLaylandTest(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet)
+{
+    return ullRmUtilization(ulCount, pulPeriod, pulWcet) <= ulRmLiuLaylandBound(ulCount);
+}
+
+/**
+ * @brief Hyperbolic bound (Bini et al.): prod(Ui + 1) <= 2 (implicit deadlines)
+ */
+bool bRmHyperbolicTest(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet)
+{
+    uint64_t ullProduct = RM_ANALYSIS_Q30_ONE;
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        uint64_t ullFactor = RM_ANALYSIS_Q30_ONE + ullTaskUtilization(pulPeriod[i], pulWcet[i]);
+
+        if (ullFactor > 2 * RM_ANALYSIS_Q30_ONE) {
+            return false;
+        }
+        /* Both operands <= 2^31, round the product up */
+        ullProduct = (ullProduct * ullFactor + RM_ANALYSIS_Q30_ONE - 1) >> 30;
+        if (ullProduct > 2 * RM_ANALYSIS_Q30_ONE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Worst-case response time of task ulTask in microseconds
+ * @return RM_RESPONSE_UNSCHEDULABLE if it exceeds min(deadline, period)
+ */
+uint32_t ulRmResponseTime(uint32_t ulTask, uint32_t ulCount, const uint32_t *pulPeriod,
+                          const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                          const uint32_t *pulOrder)
+{
+    for (uint32_t ulPosition = 0; ulPosition < ulCount; ulPosition++) {
+        if (pulOrder[ulPosition] == ulTask) {
+            return ulResponseAt(ulPosition, pulPeriod, pulDeadline, pulWcet, pulOrder);
+        }
+    }
+    return RM_RESPONSE_UNSCHEDULABLE;
+}
+
+/**
+ * @brief Response-time test of the whole set
+ */
+bool bRmResponseTimeTest(uint32_t ulCount, const uint32_t *pulPeriod,
+                         const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                         const uint32_t *pulOrder)
+{
+    for (uint32_t ulPosition = 0; ulPosition < ulCount; ulPosition++) {
+        if (ulResponseAt(ulPosition, pulPeriod, pulDeadline, pulWcet, pulOrder) ==
+            RM_RESPONSE_UNSCHEDULABLE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Length of the synchronous busy period in microseconds
+ * @return RM_RESPONSE_UNSCHEDULABLE if utilization exceeds 1 or the length
+ *         does not fit 32 bits
+ *
+ * Smallest L = sum(ceil(L / Ti) * Ci). No busy period of the set, whatever
+ * the phasing, is longer; it is independent of the priority order.
+ */
+uint32_t ulRmBusyPeriod(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulWcet)
+{
+    uint64_t ullLength = 0;
+    uint64_t ullPrevious = UINT64_MAX;
+
+    if (ullRmUtilization(ulCount, pulPeriod, pulWcet) > RM_ANALYSIS_Q30_ONE) {
+        return RM_RESPONSE_UNSCHEDULABLE;
+    }
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        ullLength += pulWcet[i];
+    }
+
+    while (ullLength != ullPrevious) {
+        if (ullLength >= RM_RESPONSE_UNSCHEDULABLE) {
+            return RM_RESPONSE_UNSCHEDULABLE;
+        }
+        ullPrevious = ullLength;
+        ullLength = 0;
+        for (uint32_t i = 0; i < ulCount; i++) {
+            uint64_t ullPeriodUs = (uint64_t)pulPeriod[i] * RM_ANALYSIS_TICK_US;
+
+            ullLength += ((ullPrevious + ullPeriodUs - 1) / ullPeriodUs) * pulWcet[i];
+        }
+    }
+
+    return (uint32_t)ullLength;
+}
+
+/**
+ * @brief Execution time at ulHz of work taking ulWcet microseconds at ulReferenceHz
+ *
+ * Assumes run time is proportional to the core clock (CPU-bound code);
+ * rounded up and saturated so the result is never optimistic.
+ */
+uint32_t ulRmScaledWcet(uint32_t ulWcet, uint32_t ulReferenceHz, uint32_t ulHz)
+{
+    uint64_t ullScaled;
+
+    if (ulHz == 0) {
+        return UINT32_MAX;
+    }
+    ullScaled = ((uint64_t)ulWcet * ulReferenceHz + ulHz - 1) / ulHz;
+    return (ullScaled > UINT32_MAX) ? UINT32_MAX : (uint32_t)ullScaled;
+}
+
+/**
+ * @brief Index of the slowest clock in pulHz (ascending) that passes RTA
+ * @param pulScaledWcet Scratch space for ulCount execution times
+ * @return ulClocks if the set misses deadlines even at the fastest clock
+ */
+uint32_t ulRmLowestFeasibleClock(uint32_t ulCount, const uint32_t *pulPeriod,
+                                 const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                                 const uint32_t *pulOrder, const uint32_t *pulHz,
+                                 uint32_t ulClocks, uint32_t *pulScaledWcet)
+{
+    if (ulClocks == 0) {
+        return 0;
+    }
+
+    for (uint32_t c = 0; c < ulClocks; c++) {
+        for (uint32_t i = 0; i < ulCount; i++) {
+            pulScaledWcet[i] = ulRmScaledWcet(pulWcet[i], pulHz[ulClocks - 1], pulHz[c]);
+        }
+        if (bRmResponseTimeTest(ulCount, pulPeriod, pulDeadline, pulScaledWcet, pulOrder)) {
+            return c;
+        }
+    }
+    return ulClocks;
+}
+
+static uint64_t ullTaskUtilization(uint32_t ulPeriod, uint32_t ulWcet)
+{
+    uint64_t ullPeriodUs = (uint64_t)ulPeriod * RM_ANALYSIS_TICK_US;
+
+    if (ullPeriodUs == 0) {
+        return 2 * (uint64_t)RM_ANALYSIS_Q30_ONE;
+    }
+    return (((uint64_t)ulWcet << 30) + ullPeriodUs - 1) / ullPeriodUs;
+}
+
+/**
+ * @brief Response time of the task at ulPosition in priority order
+ */
+static uint32_t ulResponseAt(uint32_t ulPosition, const uint32_t *pulPeriod,
+                             const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                             const uint32_t *pulOrder)
+{
+    uint32_t ulTask = pulOrder[ulPosition];
+    uint32_t ulLimitTicks = pulDeadline[ulTask] < pulPeriod[ulTask] ? pulDeadline[ulTask] : pulPeriod[ulTask];
+    uint64_t ullLimit = (uint64_t)ulLimitTicks * RM_ANALYSIS_TICK_US;
+    uint64_t ullResponse = pulWcet[ulTask];
+    uint64_t ullPrevious = 0;
+
+    while (ullResponse != ullPrevious) {
+        if (ullResponse > ullLimit) {
+            return RM_RESPONSE_UNSCHEDULABLE;
+        }
+        ullPrevious = ullResponse;
+        ullResponse = pulWcet[ulTask];
+        for (uint32_t p = 0; p < ulPosition; p++) {
+            uint32_t ulOther = pulOrder[p];
+            uint64_t ullPeriodUs = (uint64_t)pulPeriod[ulOther] * RM_ANALYSIS_TICK_US;
+
+            ullResponse += ((ullPrevious + ullPeriodUs - 1) / ullPeriodUs) * pulWcet[ulOther];
+        }
+    }
+
+    return (uint32_t)ullResponse;
+}
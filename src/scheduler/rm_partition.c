@@ -0,0 +1,145 @@
+/**
+ * @file rm_partition.c
+ * @brief Partitioned Rate Monotonic scheduling: task-to-core allocation
+ *
+ * First-fit / worst-fit decreasing with an exact per-core admission test.
+ * Admission re-runs RTA on the candidate core's whole partition, which is
+ * O(partition^2) per attempt; fine for kernel-sized sets and the sizes
+ * the host tools sweep.
+ */
+
+#include "rm_partition.h"
+
+/* Internal function prototypes */
+static uint32_t ulNextCore(RmPartitionHeuristic_t eHeuristic, uint32_t ulAttempt,
+                           const uint32_t *pulCoreUtil, const uint32_t *pulTried, uint32_t ulCores);
+
+/**
+ * @brief Assign every task to a core
+ * @param pulCore    Output, core per task or RM_PARTITION_UNASSIGNED
+ * @param pulScratch RM_PARTITION_SCRATCH_WORDS(ulCount, ulCores) words
+ * @return false if some task fits on no core; the others are still placed
+ */
+bool bRmPartition(uint32_t ulCount, const uint32_t *pulPeriod, const uint32_t *pulDeadline,
+                  const uint32_t *pulWcet, uint32_t ulCores, RmPartitionHeuristic_t eHeuristic,
+                  uint32_t *pulCore, uint32_t *pulScratch)
+{
+    uint32_t *pulByUtil = pulScratch;
+    uint32_t *pulUtil = pulByUtil + ulCount;
+    uint32_t *pulCoreScratch = pulUtil + ulCount;
+    uint32_t *pulCoreUtil = pulCoreScratch + RM_CORE_SCRATCH_WORDS(ulCount);
+    uint32_t *pulTried = pulCoreUtil + ulCores;
+    bool bAllPlaced = true;
+
+    /* Decreasing utilization, equal ones in task order (stable insertion sort) */
+    for (uint32_t i = 0; i < ulCount; i++) {
+        uint64_t ullUtil = ullRmUtilization(1, &pulPeriod[i], &pulWcet[i]);
+        uint32_t j = i;
+
+        pulCore[i] = RM_PARTITION_UNASSIGNED;
+        pulUtil[i] = (ullUtil > UINT32_MAX) ? UINT32_MAX : (uint32_t)ullUtil;
+
+        while (j > 0 && pulUtil[pulByUtil[j - 1]] < pulUtil[i]) {
+            pulByUtil[j] = pulByUtil[j - 1];
+            j--;
+        }
+        pulByUtil[j] = i;
+    }
+
+    for (uint32_t c = 0; c < ulCores; c++) {
+        pulCoreUtil[c] = 0;
+    }
+
+    for (uint32_t k = 0; k < ulCount; k++) {
+        uint32_t ulTask = pulByUtil[k];
+
+        for (uint32_t c = 0; c < ulCores; c++) {
+            pulTried[c] = 0;
+        }
+
+        for (uint32_t ulAttempt = 0; ulAttempt < ulCores; ulAttempt++) {
+            uint32_t ulCandidate = ulNextCore(eHeuristic, ulAttempt, pulCoreUtil, pulTried, ulCores);
+
+            pulTried[ulCandidate] = 1;
+            pulCore[ulTask] = ulCandidate;
+            if (bRmCoreSchedulable(ulCandidate, ulCount, pulPeriod, pulDeadline, pulWcet,
+                                   pulCore, pulCoreScratch)) {
+                /* An admitted partition has U <= 1, so the sum stays below 2^31 */
+                pulCoreUtil[ulCandidate] += pulUtil[ulTask];
+                break;
+            }
+            pulCore[ulTask] = RM_PARTITION_UNASSIGNED;
+        }
+
+        if (pulCore[ulTask] == RM_PARTITION_UNASSIGNED) {
+            bAllPlaced = false;
+        }
+    }
+
+    return bAllPlaced;
+}
+
+/**
+ * @brief Response-time test of the tasks assigned to ulCore
+ * @param pulScratch RM_CORE_SCRATCH_WORDS(ulCount) words
+ *
+ * The partition keeps task order, so equal periods break ties the same
+ * way as on a uniprocessor.
+ */
+bool bRmCoreSchedulable(uint32_t ulCore, uint32_t ulCount, const uint32_t *pulPeriod,
+                        const uint32_t *pulDeadline, const uint32_t *pulWcet,
+                        const uint32_t *pulCore, uint32_t *pulScratch)
+{
+    uint32_t *pulCorePeriod = pulScratch;
+    uint32_t *pulCoreDeadline = pulCorePeriod + ulCount;
+    uint32_t *pulCoreWcet = pulCoreDeadline + ulCount;
+    uint32_t *pulOrder = pulCoreWcet + ulCount;
+    uint32_t ulTasks = 0;
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        if (pulCore[i] == ulCore) {
+            pulCorePeriod[ulTasks] = pulPeriod[i];
+            pulCoreDeadline[ulTasks] = pulDeadline[i];
+            pulCoreWcet[ulTasks] = pulWcet[i];
+            ulTasks++;
+        }
+    }
+
+    vRmPriorityOrder(ulTasks, pulCorePeriod, pulOrder);
+    return bRmResponseTimeTest(ulTasks, pulCorePeriod, pulCoreDeadline, pulCoreWcet, pulOrder);
+}
+
+/**
+ * @brief Utilization of the tasks assigned to ulCore, Q30 rounded up
+ */
+uint64_t ullRmCoreUtilization(uint32_t ulCore, uint32_t ulCount, const uint32_t *pulPeriod,
+                              const uint32_t *pulWcet, const uint32_t *pulCore)
+{
+    uint64_t ullUtil = 0;
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        if (pulCore[i] == ulCore) {
+            ullUtil += ullRmUtilization(1, &pulPeriod[i], &pulWcet[i]);
+        }
+    }
+    return ullUtil;
+}
+
+/**
+ * @brief Core to try at ulAttempt: in index order, or least utilized first
+ */
+static uint32_t ulNextCore(RmPartitionHeuristic_t eHeuristic, uint32_t ulAttempt,
+                           const uint32_t *pulCoreUtil, const uint32_t *pulTried, uint32_t ulCores)
+{
+    uint32_t ulBest = ulAttempt;
+
+    if (eHeuristic == RM_PARTITION_WORST_FIT) {
+        ulBest = ulCores;
+        for (uint32_t c = 0; c < ulCores; c++) {
+            if (!pulTried[c] && (ulBest == ulCores || pulCoreUtil[c] < pulCoreUtil[ulBest])) {
+                ulBest = c;
+            }
+        }
+    }
+    return ulBest;
+}
@@ -4,11 +4,16 @@
  */
 
 #include "periodRTOS.h"
+#include "rm_policy.h"
+#include "tt_schedule.h"
+#include "mode_change.h"
+#include "sw_timer.h"
 #include <string.h>
 
 /* External variables */
 extern TaskControlBlock_t xTaskList[MAX_TASKS];
 extern TaskHandle_t xIdleTask;
+extern TaskHandle_t xTimerServiceTask;
 extern SystemMonitor_t xSystemMonitor;
 
 /* Scheduler state */
@@ -16,6 +21,10 @@ TaskHandle_t pxReadyList[MAX_PRIORITY_LEVELS];
 static TaskHandle_t pxCurrentTaskTCB = NULL;
 uint32_t ulSystemTick = 0;
 static bool bSchedulerInitialized = false;
+static bool bOverload = false;           /* Busy period in which a job went late */
+static uint32_t ulNextDeadline = 0;     /* Earliest deadline of a pending job */
+static bool bDeadlinePending = false;   /* ulNextDeadline is valid */
+static DeadlineMissHook_t pxDeadlineMissHook = NULL;
 
 /* External function prototypes */
 extern void vTriggerContextSwitch(void);
@@ -28,8 +37,10 @@ static TaskHandle_t pxGetHighestPriorityReadyTask(void);
 static void vAddTaskToReadyList(TaskHandle_t xTask);
 //static void vRemoveTaskFromReadyList(TaskHandle_t xTask);
 static bool bIsTaskReady(TaskHandle_t xTask);
-static void vCheckDeadlines(void);
-static void vUpdateTaskTiming(TaskHandle_t xTask);
+static bool bCheckDeadlines(void);
+static bool bHandleDeadlineMiss(TaskControlBlock_t *pxTCB);
+static void vUpdateTaskTiming(TaskHandle_t xTask, bool bReleased);
+static bool bReleaseAndPreempt(void);
 
 
 #if ENABLE_STACK_CANARY
@@ -45,24 +56,50 @@ void vSchedulerInit(void)
     /* Clear ready list */
     memset(pxReadyList, 0, sizeof(pxReadyList));
     
-    /* Update task priorities based on periods (Rate Monotonic) */
-    vUpdateTaskPriorities();
+    /* Update task priorities based on periods (Rate Monotonic), unless the
+     * linker already sorted the static task table */
+    if (!bTaskPrioritiesPrecomputed()) {
+        vUpdateTaskPriorities();
+    } else if (xIdleTask != NULL) {
+        ((TaskControlBlock_t *)xIdleTask)->ulPriority = RM_IDLE_PRIORITY(MAX_PRIORITY_LEVELS);
+    }
     
-    /* Add all ready tasks to ready list */
-    for (uint32_t i = 0; i < MAX_TASKS; i++) {
-        TaskControlBlock_t *pxTCB = &xTaskList[i];
-        if (pxTCB->ulTaskID != 0 && pxTCB->eCurrentState == TASK_STATE_READY) {
-            vAddTaskToReadyList((TaskHandle_t)pxTCB);
+#if ENABLE_TIME_TRIGGERED
+    if (bTtActive()) {
+        /* Jobs are released by the table's entries */
+        vTtStart();
+    } else
+#endif
+    {
+#if ENABLE_MODE_CHANGE
+        /* Only the starting mode's tasks get a first release */
+        vModeStart();
+#endif
+        /* Add all ready tasks to ready list; their first job is released now */
+        for (uint32_t i = 0; i < MAX_TASKS; i++) {
+            TaskControlBlock_t *pxTCB = &xTaskList[i];
+            if (pxTCB->ulTaskID != 0 && pxTCB->eCurrentState == TASK_STATE_READY) {
+                vAddTaskToReadyList((TaskHandle_t)pxTCB);
+                vUpdateTaskTiming((TaskHandle_t)pxTCB, true);
+            }
         }
     }
     
+#if ENABLE_RTDVS
+    /* Slowest clock the task set tolerates; before load accounting restarts */
+    vRtdvsStart();
+#endif
+    
+    /* Restart load accounting on the new task set's hyperperiod */
+    vMonitorSetHyperperiod(ulSchedulerHyperperiod());
+    
     bSchedulerInitialized = true;
 }
 
 /**
  * @brief Get the next task to run (Rate Monotonic scheduling)
  */
-TaskHandle_t vSchedulerGetNextTask(void)
+KERNEL_RAMFUNC TaskHandle_t vSchedulerGetNextTask(void)
 {
     TaskHandle_t xNextTask;
     
@@ -70,14 +107,27 @@ TaskHandle_t vSchedulerGetNextTask(void)
         return NULL;
     }
     
-    /* Get highest priority ready task */
-    xNextTask = pxGetHighestPriorityReadyTask();
+#if ENABLE_TIME_TRIGGERED
+    if (bTtActive()) {
+        /* Slot owner of the time-triggered table */
+        xNextTask = xTtGetNextTask();
+    } else
+#endif
+    {
+        /* Get highest priority ready task */
+        xNextTask = pxGetHighestPriorityReadyTask();
+    }
     
     /* If no ready task, return idle task */
     if (xNextTask == NULL) {
         xNextTask = xIdleTask;
     }
     
+    /* No job pending: the busy period, and any overload in it, is over */
+    if (xNextTask == xIdleTask) {
+        bOverload = false;
+    }
+    
     /* Update current task */
     pxCurrentTaskTCB = xNextTask;
     
@@ -85,7 +135,7 @@ TaskHandle_t vSchedulerGetNextTask(void)
     if (xNextTask != xIdleTask) {
         TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)xNextTask;
         pxTCB->eCurrentState = TASK_STATE_RUNNING;
-        pxTCB->ulLastStartTime = ulSystemTick;
+        pxTaskDetail(pxTCB)->ulLastStartTime = ulSystemTick;
     } */  // TODO lets let this be handled elsewhere
     
     return xNextTask;
@@ -94,45 +144,81 @@ TaskHandle_t vSchedulerGetNextTask(void)
 /**
  * @brief Update task priorities based on Rate Monotonic algorithm
  * Shorter period = higher priority (lower priority number)
+ *
+ * Each task's priority is its rank in bRmPrecedes() order. TCBs stay in
+ * their slots, so handles returned by xTaskCreatePeriodic() remain valid.
  */
 static void vUpdateTaskPriorities(void)
 {
     TaskControlBlock_t *pxTCB;
-    uint32_t ulPriority = 0;
     
-    /* Sort tasks by period (ascending order) */
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
-        for (uint32_t j = i + 1; j < MAX_TASKS; j++) {
-            TaskControlBlock_t *pxTCB1 = &xTaskList[i];
-            TaskControlBlock_t *pxTCB2 = &xTaskList[j];
+        uint32_t ulPriority = 0;
+        
+        pxTCB = &xTaskList[i];
+        if (pxTCB->ulTaskID == 0) {
+            continue;
+        }
+        
+        for (uint32_t j = 0; j < MAX_TASKS; j++) {
+            TaskControlBlock_t *pxOther = &xTaskList[j];
             
-            if (pxTCB1->ulTaskID != 0 && pxTCB2->ulTaskID != 0) {
-                if (pxTCB1->ulPeriod > pxTCB2->ulPeriod) {
-                    /* Swap tasks */
-                    TaskControlBlock_t xTemp = *pxTCB1;
-                    *pxTCB1 = *pxTCB2;
-                    *pxTCB2 = xTemp;
-                }
+            if (pxOther->ulTaskID != 0 &&
+                bRmPrecedes(pxOther->ulPeriod, pxOther->ulTaskID,
+                            pxTCB->ulPeriod, pxTCB->ulTaskID)) {
+                ulPriority++;
             }
         }
+        
+        pxTCB->ulPriority = ulRmClampPriority(ulPriority, MAX_PRIORITY_LEVELS);
+    }
+    
+    /* Any released task preempts idle at the next tick */
+    if (xIdleTask != NULL) {
+        ((TaskControlBlock_t *)xIdleTask)->ulPriority = RM_IDLE_PRIORITY(MAX_PRIORITY_LEVELS);
     }
+}
+
+/**
+ * @brief Least common multiple of the active task periods, 0 if it exceeds 32 bits
+ *
+ * Suspended tasks, such as those outside the current mode, do not count.
+ */
+uint32_t ulSchedulerHyperperiod(void)
+{
+    uint64_t ullHyperperiod = 1;
     
-    /* Assign priorities based on sorted order */
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
-        pxTCB = &xTaskList[i];
-        if (pxTCB->ulTaskID != 0) {
-            pxTCB->ulPriority = ulPriority++;
-            if (ulPriority >= MAX_PRIORITY_LEVELS) {
-                ulPriority = MAX_PRIORITY_LEVELS - 1;
-            }
+        TaskControlBlock_t *pxTCB = &xTaskList[i];
+        uint64_t ullA, ullB;
+        
+        if (pxTCB->ulTaskID == 0 || pxTCB->ulPeriod == 0 ||
+            pxTCB->eCurrentState == TASK_STATE_SUSPENDED) {
+            continue;
+        }
+        
+        /* lcm(a, b) = a / gcd(a, b) * b */
+        ullA = ullHyperperiod;
+        ullB = pxTCB->ulPeriod;
+        while (ullB != 0) {
+            uint64_t ullTemp = ullA % ullB;
+            ullA = ullB;
+            ullB = ullTemp;
+        }
+        ullHyperperiod = (ullHyperperiod / ullA) * pxTCB->ulPeriod;
+        
+        if (ullHyperperiod > UINT32_MAX) {
+            return 0;
         }
     }
+    
+    return (ullHyperperiod == 1) ? 0 : (uint32_t)ullHyperperiod;
 }
 
 /**
  * @brief Get highest priority ready task
  */
-static TaskHandle_t pxGetHighestPriorityReadyTask(void)
+static KERNEL_RAMFUNC TaskHandle_t pxGetHighestPriorityReadyTask(void)
 {
     for (uint32_t i = 0; i < MAX_PRIORITY_LEVELS; i++) {
         if (pxReadyList[i] != NULL) {
@@ -145,7 +231,7 @@ static TaskHandle_t pxGetHighestPriorityReadyTask(void)
 /**
  * @brief Add task to ready list based on priority
  */
-static void vAddTaskToReadyList(TaskHandle_t xTask)
+static KERNEL_RAMFUNC void vAddTaskToReadyList(TaskHandle_t xTask)
 {
     TaskControlBlock_t *pxTCB;
     
@@ -167,7 +253,7 @@ static void vAddTaskToReadyList(TaskHandle_t xTask)
 /**
  * @brief Remove task from ready list
  */
-void vRemoveTaskFromReadyList(TaskHandle_t xTask)
+KERNEL_RAMFUNC void vRemoveTaskFromReadyList(TaskHandle_t xTask)
 {
     TaskControlBlock_t *pxTCB;
     
@@ -200,29 +286,154 @@ static bool bIsTaskReady(TaskHandle_t xTask)
 }
 
 /**
- * @brief Check task deadlines
+ * @brief Detect deadline misses at the deadline tick
+ * @return true if the running job was aborted and a switch is required
+ *
+ * Deadlines fall on tick boundaries, so the tick interrupt at a deadline
+ * is its timer: misses are seen when the deadline passes, not a tick
+ * later. Each tick costs one comparison against the earliest pending
+ * deadline; the task list is only scanned when it is reached. A job that
+ * finished early leaves that deadline stale, which costs one scan.
  */
-static void vCheckDeadlines(void)
+static KERNEL_RAMFUNC bool bCheckDeadlines(void)
 {
     TaskControlBlock_t *pxTCB;
+    uint32_t ulNext = 0;
+    bool bPending = false;
+    bool bAbortCurrent = false;
+    
+    if (!bDeadlinePending || !bRmDeadlineMissed(ulSystemTick, ulNextDeadline)) {
+        return false;
+    }
     
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         pxTCB = &xTaskList[i];
         
-        if (pxTCB->ulTaskID != 0 && pxTCB->eCurrentState == TASK_STATE_RUNNING) {
-            /* Check if deadline is missed */
-            if (ulSystemTick > pxTCB->ulDeadlineTime) {
-                pxTCB->ulDeadlineMissCount++;
-                pxTCB->bDeadlineMissed = true;
-            }
+        if (pxTCB->ulTaskID == 0 || pxTCB->ulPeriod == 0 || pxTCB->bDeadlineMissed ||
+            (pxTCB->eCurrentState != TASK_STATE_RUNNING && pxTCB->eCurrentState != TASK_STATE_READY &&
+             pxTCB->eCurrentState != TASK_STATE_DELAYED)) {
+            continue;
+        }
+        
+        if (bRmDeadlineMissed(ulSystemTick, pxTCB->ulDeadlineTime)) {
+            bAbortCurrent |= bHandleDeadlineMiss(pxTCB);
+        } else if (!bPending || bRmTickBefore(pxTCB->ulDeadlineTime, ulNext)) {
+            ulNext = pxTCB->ulDeadlineTime;
+            bPending = true;
         }
     }
+    
+    ulNextDeadline = ulNext;
+    bDeadlinePending = bPending;
+    return bAbortCurrent;
+}
+
+/**
+ * @brief Count a miss, report it and apply the task's miss policy
+ * @return true if the job aborted was the running one
+ *
+ * A late job, running or preempted, delays every task below it: overload
+ * starts and lasts until no job is pending, i.e. to the end of that busy
+ * period; (m,k)-firm tasks skip optional jobs meanwhile.
+ */
+static bool bHandleDeadlineMiss(TaskControlBlock_t *pxTCB)
+{
+    pxTaskDetail(pxTCB)->ulDeadlineMissCount++;
+    pxTCB->bDeadlineMissed = true;
+    bOverload = true;
+#if ENABLE_RTDVS
+    vRtdvsDeadlineMiss();
+#endif
+    
+    if (pxDeadlineMissHook != NULL) {
+        pxDeadlineMissHook((TaskHandle_t)pxTCB);
+    }
+    
+    switch (pxTCB->ucMissPolicy) {
+        case MISS_POLICY_ABORT:
+            /* The next release starts a fresh instance; this one is discarded */
+            vSchedulerRecordJob((TaskHandle_t)pxTCB, false);
+            if (pxTCB->eCurrentState == TASK_STATE_DELAYED) {
+                vDelayRemove((TaskHandle_t)pxTCB);
+            }
+            pxTCB->taskFlags = 1;
+            pxTCB->eCurrentState = TASK_STATE_BLOCKED;
+            vRemoveTaskFromReadyList((TaskHandle_t)pxTCB);
+            return (TaskHandle_t)pxTCB == pxGetCurrentTask();
+        case MISS_POLICY_SKIP_NEXT:
+            pxTCB->bSkipNextRelease = true;
+            break;
+        default:
+            break;
+    }
+    return false;
+}
+
+/**
+ * @brief Install the hook called for every deadline miss, NULL to remove it
+ *
+ * Runs in the tick interrupt as soon as the deadline passes, before the
+ * miss policy is applied; it may only use interrupt-safe calls.
+ * ulGetTickElapsedCycles() in the hook measures the reporting latency.
+ */
+void vSetDeadlineMissHook(DeadlineMissHook_t pxHook)
+{
+    pxDeadlineMissHook = pxHook;
+}
+
+/**
+ * @brief Start the deadline of a released job (RM releases and TT entries)
+ */
+KERNEL_RAMFUNC void vSchedulerSetDeadline(TaskHandle_t xTask, uint32_t ulDeadlineTime)
+{
+    TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)xTask;
+    
+    pxTCB->ulDeadlineTime = ulDeadlineTime;
+    pxTCB->bDeadlineMissed = false;
+#if ENABLE_CHAINS
+    pxTaskDetail(pxTCB)->ulJobReleaseTick = ulDeadlineTime - pxTCB->ulDeadline;
+#endif
+    if (!bDeadlinePending || bRmTickBefore(ulDeadlineTime, ulNextDeadline)) {
+        ulNextDeadline = ulDeadlineTime;
+        bDeadlinePending = true;
+    }
+}
+
+/**
+ * @brief Make a task whose delay ended ready again (from bDelayTick())
+ */
+KERNEL_RAMFUNC void vSchedulerWakeTask(TaskHandle_t xTask)
+{
+    ((TaskControlBlock_t *)xTask)->eCurrentState = TASK_STATE_READY;
+    vAddTaskToReadyList(xTask);
+}
+
+/**
+ * @brief Account a job of an (m,k)-firm task: finished (bMet tells whether in
+ *        time), skipped or dropped (bMet = false)
+ */
+void vSchedulerRecordJob(TaskHandle_t xTask, bool bMet)
+{
+    TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)xTask;
+    
+    if (pxTCB->ucFirmK == 0) {
+        return;
+    }
+    
+    pxTCB->ulFirmHistory = ulRmFirmRecord(pxTCB->ulFirmHistory, bMet);
+    if (!bRmFirmSatisfied(pxTCB->ulFirmHistory, pxTCB->ucFirmM, pxTCB->ucFirmK)) {
+        pxTaskDetail(pxTCB)->ulFirmViolations++;
+    }
 }
 
 /**
  * @brief Update task timing information
+ * @param bReleased true if a new job was released at this tick
+ *
+ * A release that finds the previous job still pending is dropped; that job
+ * keeps its own deadline.
  */
-static void vUpdateTaskTiming(TaskHandle_t xTask)
+static KERNEL_RAMFUNC void vUpdateTaskTiming(TaskHandle_t xTask, bool bReleased)
 {
     TaskControlBlock_t *pxTCB;
     
@@ -233,22 +444,24 @@ static void vUpdateTaskTiming(TaskHandle_t xTask)
     pxTCB = (TaskControlBlock_t *)xTask;
     
     /* Update execution time 
-    if (pxTCB->ulLastStartTime > 0) {
-        uint32_t ulExecutionTime = ulSystemTick - pxTCB->ulLastStartTime;
-        pxTCB->ulExecutionTime += ulExecutionTime;
+    if (pxTaskDetail(pxTCB)->ulLastStartTime > 0) {
+        uint32_t ulExecutionTime = ulSystemTick - pxTaskDetail(pxTCB)->ulLastStartTime;
+        pxTaskDetail(pxTCB)->ulExecutionTime += ulExecutionTime;
     } */
     
     /* Update release and deadline times for periodic tasks */
     if (pxTCB->ulPeriod > 0) {
-        pxTCB->ulReleaseTime = ulSystemTick + pxTCB->ulPeriod;
-        pxTCB->ulDeadlineTime = pxTCB->ulReleaseTime + pxTCB->ulDeadline;
+        if (bReleased) {
+            vSchedulerSetDeadline(xTask, ulRmAbsoluteDeadline(ulSystemTick, pxTCB->ulDeadline));
+        }
+        pxTCB->ulReleaseTime = ulRmNextRelease(ulSystemTick, pxTCB->ulPeriod);
     }
 }
 
 /**
  * @brief System tick handler - called every 1ms
  */
-void vSystemTickHandler(void)
+KERNEL_RAMFUNC void vSystemTickHandler(void)
 {
 
     #if ENABLE_STACK_CANARY
@@ -260,29 +473,100 @@ void vSystemTickHandler(void)
     }
     #endif
 
-    TaskControlBlock_t *pxTCB;
+    bool bSwitchRequired = false;
+    bool bAborted;
     
+    vMonitorWriteBegin();
+
     /* Increment system tick */
     ulSystemTick++;
     xSystemMonitor.ulSystemUptime = ulSystemTick;
+
+    /* Close load windows / hyperperiods */
+    vMonitorLoadTick();
     
     /* Check deadlines */
-    vCheckDeadlines();
+    bAborted = bCheckDeadlines();
+    
+    /* End due delays; woken jobs compete below like released ones */
+    vDelayTick();
+
+#if ENABLE_RTDVS
+    /* Raise the clock on a miss or overload, drop it back when quiet */
+    vRtdvsTick();
+#endif
+    
+#if ENABLE_TIME_TRIGGERED
+    if (bTtActive()) {
+        /* Table-driven dispatch: the cursor decides, no priorities involved;
+         * a slot owner woken from a delay takes its slot back from idle */
+        bSwitchRequired = bTtTick() || xTtGetNextTask() != pxGetCurrentTask();
+    } else
+#endif
+    {
+#if ENABLE_MODE_CHANGE
+        /* Retire leaving tasks, complete a pending change once idle */
+        vModeTick();
+#endif
+        bSwitchRequired = bReleaseAndPreempt();
+    }
     
+    /* An aborted running job gives up the processor whatever else happened */
+    bSwitchRequired |= bAborted;
+
+    vMonitorWriteEnd();
+
+    if (bSwitchRequired) {
+        vStartContextSwitch();
+        //vTriggerContextSwitch();
+    }
+}
+
+/**
+ * @brief Release due jobs and check whether the highest ready one preempts
+ * @return true if a context switch is required
+ */
+static KERNEL_RAMFUNC bool bReleaseAndPreempt(void)
+{
+    TaskControlBlock_t *pxTCB;
+
     /* Check for task releases */
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         pxTCB = &xTaskList[i];
         
         if (pxTCB->ulTaskID != 0 && pxTCB->ulPeriod > 0) {
+#if ENABLE_SOFTWARE_TIMERS
+            if ((TaskHandle_t)pxTCB == xTimerServiceTask && !bTimerServiceDue()) {
+                /* Sporadic: its release waits for a due timer */
+                continue;
+            }
+#endif
             /* Check if task should be released */
-            if (ulSystemTick >= pxTCB->ulReleaseTime) {
+            if (bRmReleaseDue(ulSystemTick, pxTCB->ulReleaseTime)) {
+                bool bReleased = false;
+                
+                bool bSkipNext = pxTCB->bSkipNextRelease;
+                
+                pxTCB->bSkipNextRelease = false;
                 if (pxTCB->eCurrentState == TASK_STATE_BLOCKED) {
-                    pxTCB->eCurrentState = TASK_STATE_READY;
-                    vAddTaskToReadyList((TaskHandle_t)pxTCB);
+                    if (bSkipNext ||
+                        (bOverload && bRmFirmOptional(pxTCB->ulFirmHistory, pxTCB->ucFirmM,
+                                                      pxTCB->ucFirmK))) {
+                        /* Skip-over or miss policy: drop this job rather than add to the backlog */
+                        pxTaskDetail(pxTCB)->ulSkippedJobs++;
+                        vSchedulerRecordJob((TaskHandle_t)pxTCB, false);
+                    } else {
+                        pxTCB->eCurrentState = TASK_STATE_READY;
+                        vAddTaskToReadyList((TaskHandle_t)pxTCB);
+                        bReleased = true;
+                    }
+                } else if (pxTCB->eCurrentState != TASK_STATE_SUSPENDED) {
+                    /* Previous job still pending: this release is lost */
+                    vSchedulerRecordJob((TaskHandle_t)pxTCB, false);
                 }
                 
                 /* Update timing for next release */
-                vUpdateTaskTiming((TaskHandle_t)pxTCB);
+                vUpdateTaskTiming((TaskHandle_t)pxTCB, bReleased);
             }
         }
     }
@@ -295,12 +579,14 @@ void vSystemTickHandler(void)
         TaskControlBlock_t *pxCurrentTCB = (TaskControlBlock_t *)xCurrentTask;
         TaskControlBlock_t *pxNextTCB = (TaskControlBlock_t *)xNextTask;
         
-        if (pxNextTCB->ulPriority < pxCurrentTCB->ulPriority) {
+        if (bRmPreempts(pxNextTCB->ulPriority, pxCurrentTCB->ulPriority)) {
             /* Higher priority task is ready, trigger context switch */
-            pxCurrentTCB->eCurrentState = TASK_STATE_READY;
-            
-            vStartContextSwitch();
-            //vTriggerContextSwitch();
+            if (pxCurrentTCB->eCurrentState == TASK_STATE_RUNNING) {
+                pxCurrentTCB->eCurrentState = TASK_STATE_READY;
+            }
+            return true;
         }
     }
+
+    return false;
 }
@@ -0,0 +1,188 @@
+/**
+ * @file rtdvs.c
+ * @brief Real-time frequency scaling for Rate Monotonic task sets
+ *
+ * Static RT-DVS: when the scheduler starts, the slowest clock profile at
+ * which the task set still passes response-time analysis becomes the
+ * floor. WCETs are given for the fastest profile and scale with f_max / f;
+ * a task without a WCET pins the fastest profile.
+ *
+ * The tick handler picks the profile overload calls for: a deadline miss
+ * jumps to the fastest profile, smoothed load above RTDVS_OVERLOAD_LOAD
+ * steps up one profile per load window. After RTDVS_HOLD_TICKS without
+ * either the clock drops back one profile at a time, never below the
+ * floor. Relocking the PLL takes far longer than a tick, so the switch
+ * itself is left to vRtdvsApply() in task context: vTaskYield() calls it
+ * at the end of every job and from the idle loop.
+ */
+
+#include "periodRTOS.h"
+#include "rm_analysis.h"
+
+/* Profiles considered by the analysis (the fastest ones if a board has more) */
+#define RTDVS_MAX_PROFILES      8
+
+/* Minimum ticks between two load-driven steps up: one load window */
+#define RTDVS_STEP_TICKS        ((LOAD_WINDOW_MS * SYSTICK_FREQ_HZ) / 1000)
+
+/* External variables */
+extern TaskControlBlock_t xTaskList[MAX_TASKS];
+extern SystemMonitor_t xSystemMonitor;
+
+static uint32_t ulFloorProfile = 0;
+static uint32_t ulMissCount = 0;             /* Deadline misses, from the tick */
+static uint32_t ulMissesSeen = 0;
+static uint32_t ulTicksSinceChange = 0;
+static volatile uint32_t ulTargetProfile = 0; /* Chosen by the tick, set by vRtdvsApply() */
+static bool bApplying = false;
+
+/* Internal function prototypes */
+static void vRaiseTo(uint32_t ulProfile);
+
+/**
+ * @brief Slowest clock profile that keeps the current task set schedulable
+ */
+uint32_t ulRtdvsSelectProfile(void)
+{
+    uint32_t pulPeriod[MAX_TASKS];
+    uint32_t pulDeadline[MAX_TASKS];
+    uint32_t pulWcet[MAX_TASKS];
+    uint32_t pulOrder[MAX_TASKS];
+    uint32_t pulScaledWcet[MAX_TASKS];
+    uint32_t pulHz[RTDVS_MAX_PROFILES];
+    uint32_t ulProfiles = ulClockProfileCount();
+    uint32_t ulFastest = (ulProfiles > 0) ? ulProfiles - 1 : 0;
+    uint32_t ulFirst = (ulProfiles > RTDVS_MAX_PROFILES) ? ulProfiles - RTDVS_MAX_PROFILES : 0;
+    uint32_t ulClocks = ulProfiles - ulFirst;
+    uint32_t ulCount = 0;
+    uint32_t ulClock;
+
+    /* Slots are in task ID order, so compacting keeps RM tie-breaking */
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        TaskControlBlock_t *pxTCB = &xTaskList[i];
+
+        if (pxTCB->ulTaskID == 0 || pxTCB->ulPeriod == 0) {
+            continue;
+        }
+        if (pxTaskDetail(pxTCB)->ulWcet == 0) {
+            return ulFastest;
+        }
+        pulPeriod[ulCount] = pxTCB->ulPeriod;
+        pulDeadline[ulCount] = pxTCB->ulDeadline;
+        pulWcet[ulCount] = pxTaskDetail(pxTCB)->ulWcet;
+        ulCount++;
+    }
+
+    for (uint32_t c = 0; c < ulClocks; c++) {
+        pulHz[c] = ulClockProfileHz(ulFirst + c);
+    }
+
+    vRmPriorityOrder(ulCount, pulPeriod, pulOrder);
+    ulClock = ulRmLowestFeasibleClock(ulCount, pulPeriod, pulDeadline, pulWcet, pulOrder,
+                                      pulHz, ulClocks, pulScaledWcet);
+
+    return (ulClock < ulClocks) ? ulFirst + ulClock : ulFastest;
+}
+
+/**
+ * @brief Drop to the floor profile of the current task set
+ */
+void vRtdvsStart(void)
+{
+    ulFloorProfile = ulRtdvsSelectProfile();
+    ulMissesSeen = ulMissCount;
+    ulTicksSinceChange = 0;
+
+    vRaiseTo(ulFloorProfile);
+    ulTargetProfile = ulClockGetProfile();
+}
+
+/**
+ * @brief Count a deadline miss - called by the scheduler from the tick handler
+ */
+void vRtdvsDeadlineMiss(void)
+{
+    ulMissCount++;
+}
+
+/**
+ * @brief Overload handling - called from the tick handler
+ *
+ * Only chooses the target profile; constant time, no clock switch.
+ */
+void vRtdvsTick(void)
+{
+    uint32_t ulProfile = ulTargetProfile;
+    uint32_t ulFastest = ulClockProfileCount() - 1;
+    bool bOverload = xSystemMonitor.ulSystemLoadEwma > RTDVS_OVERLOAD_LOAD;
+
+    ulTicksSinceChange++;
+
+    if (ulMissCount != ulMissesSeen) {
+        ulMissesSeen = ulMissCount;
+        ulTicksSinceChange = 0;
+        ulTargetProfile = ulFastest;
+    } else if (bOverload) {
+        if (ulProfile < ulFastest && ulTicksSinceChange >= RTDVS_STEP_TICKS) {
+            ulTicksSinceChange = 0;
+            ulTargetProfile = ulProfile + 1;
+        }
+    } else if (ulProfile > ulFloorProfile && ulTicksSinceChange >= RTDVS_HOLD_TICKS) {
+        ulTicksSinceChange = 0;
+        ulTargetProfile = ulProfile - 1;
+    }
+}
+
+/**
+ * @brief Switch to the profile the tick chose - task context only
+ *
+ * A step down that fails falls back to the floor. The target then follows
+ * the profile actually reached, unless the tick chose a new one meanwhile.
+ */
+void vRtdvsApply(void)
+{
+    uint32_t ulTarget = ulTargetProfile;
+    uint32_t ulProfile = ulClockGetProfile();
+
+    if (ulTarget == ulProfile) {
+        return;
+    }
+
+    /* A task preempted halfway through a switch leaves it to finish */
+    vKernelEnterCritical();
+    if (bApplying) {
+        vKernelExitCritical();
+        return;
+    }
+    bApplying = true;
+    vKernelExitCritical();
+
+    if (ulTarget > ulProfile) {
+        vRaiseTo(ulTarget);
+    } else if (!bClockSetProfile(ulTarget)) {
+        vRaiseTo(ulFloorProfile);
+    }
+
+    vKernelEnterCritical();
+    if (ulTargetProfile == ulTarget) {
+        ulTargetProfile = ulClockGetProfile();
+    }
+    bApplying = false;
+    vKernelExitCritical();
+}
+
+/**
+ * @brief Switch to ulProfile or, if it cannot be reached, the next faster one
+ *
+ * A failed switch leaves the core on the slowest profile; if nothing at or
+ * above ulProfile works, settle for the fastest profile that does.
+ */
+static void vRaiseTo(uint32_t ulProfile)
+{
+    for (uint32_t p = ulProfile; p < ulClockProfileCount(); p++) {
+        if (bClockSetProfile(p)) {
+            return;
+        }
+    }
+    vConfigureSystemClock();
+}
@@ -0,0 +1,179 @@
+/**
+ * @file tt_scheduler.c
+ * @brief Time-triggered table dispatch
+ *
+ * The cursor walks the installed table once per hyperperiod. Each tick
+ * costs one comparison; a matching entry releases its job if flagged and
+ * makes its task the slot owner. The slot owner runs while its job is
+ * unfinished, the idle task otherwise. Jobs restart through TaskWrapper's
+ * instance path exactly as under Rate Monotonic scheduling.
+ *
+ * Tasks the table does not name never run while it is active.
+ */
+
+#include "periodRTOS.h"
+#include "tt_schedule.h"
+#include "rm_policy.h"
+#include <string.h>
+
+/* External variables */
+extern TaskControlBlock_t xTaskList[MAX_TASKS];
+extern TaskHandle_t xIdleTask;
+extern uint32_t ulSystemTick;
+
+static const TtSchedule_t *pxTtSchedule = NULL;
+static TaskControlBlock_t *pxTtTasks[MAX_TASKS + 1];    /* Entry task index -> TCB */
+static TaskControlBlock_t *pxSlotOwner = NULL;
+static uint32_t ulCursor = 0;
+static uint32_t ulFrameStart = 0;
+
+/* Internal function prototypes */
+static void vApplyEntry(const TtEntry_t *pxEntry);
+
+/**
+ * @brief Bind a generated table to the created tasks
+ * @return false, leaving Rate Monotonic scheduling in place, if the table is
+ *         malformed or a task is missing or has a different period
+ *
+ * Call after the tasks exist and before vTaskStartScheduler().
+ */
+bool bTtScheduleInstall(const TtSchedule_t *pxSchedule)
+{
+    TaskControlBlock_t *pxBound[MAX_TASKS + 1];
+    uint32_t ulPrevious = 0;
+
+    pxTtSchedule = NULL;
+
+    if (pxSchedule == NULL || pxSchedule->ulHyperperiod == 0 || pxSchedule->ulEntries == 0 ||
+        pxSchedule->ulTasks > MAX_TASKS || pxSchedule->pxEntries[0].ulOffset != 0) {
+        return false;
+    }
+
+    pxBound[TT_IDLE] = NULL;
+    for (uint32_t k = 0; k < pxSchedule->ulTasks; k++) {
+        pxBound[k + 1] = NULL;
+
+        for (uint32_t i = 0; i < MAX_TASKS; i++) {
+            TaskControlBlock_t *pxTCB = &xTaskList[i];
+
+            if (pxTCB->ulTaskID != 0 && pxTCB->ulPeriod == pxSchedule->pulTaskPeriods[k] &&
+                strncmp(pxTaskDetail(pxTCB)->pcTaskName, pxSchedule->ppcTaskNames[k],
+                        sizeof(pxTaskDetail(pxTCB)->pcTaskName)) == 0) {
+                pxBound[k + 1] = pxTCB;
+                break;
+            }
+        }
+        if (pxBound[k + 1] == NULL || pxSchedule->ulHyperperiod % pxSchedule->pulTaskPeriods[k] != 0) {
+            return false;
+        }
+    }
+
+    for (uint32_t e = 0; e < pxSchedule->ulEntries; e++) {
+        const TtEntry_t *pxEntry = &pxSchedule->pxEntries[e];
+
+        if ((e > 0 && pxEntry->ulOffset <= ulPrevious) ||
+            pxEntry->ulOffset >= pxSchedule->ulHyperperiod ||
+            pxEntry->ucTask > pxSchedule->ulTasks) {
+            return false;
+        }
+        ulPrevious = pxEntry->ulOffset;
+    }
+
+    memcpy(pxTtTasks, pxBound, sizeof(pxBound));
+    pxTtSchedule = pxSchedule;
+    return true;
+}
+
+/**
+ * @brief Whether a table is installed and drives dispatch
+ */
+bool bTtActive(void)
+{
+    return pxTtSchedule != NULL;
+}
+
+/**
+ * @brief Start the first frame at the current tick (from vSchedulerInit)
+ *
+ * Every periodic task waits for its first release entry.
+ */
+void vTtStart(void)
+{
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        TaskControlBlock_t *pxTCB = &xTaskList[i];
+
+        if (pxTCB->ulTaskID != 0 && pxTCB->ulPeriod > 0) {
+            pxTCB->eCurrentState = TASK_STATE_BLOCKED;
+        }
+    }
+
+    ulFrameStart = ulSystemTick;
+    ulCursor = 0;
+    vApplyEntry(&pxTtSchedule->pxEntries[ulCursor++]);
+}
+
+/**
+ * @brief Advance the cursor by one tick (from vSystemTickHandler)
+ * @return true if the running task has to change
+ */
+bool bTtTick(void)
+{
+    uint32_t ulOffset = ulSystemTick - ulFrameStart;
+    TaskControlBlock_t *pxCurrent;
+
+    if (ulOffset >= pxTtSchedule->ulHyperperiod) {
+        ulFrameStart += pxTtSchedule->ulHyperperiod;
+        ulOffset -= pxTtSchedule->ulHyperperiod;
+        ulCursor = 0;
+    }
+
+    if (ulCursor >= pxTtSchedule->ulEntries || pxTtSchedule->pxEntries[ulCursor].ulOffset != ulOffset) {
+        return false;
+    }
+
+    vApplyEntry(&pxTtSchedule->pxEntries[ulCursor++]);
+
+    pxCurrent = (TaskControlBlock_t *)pxGetCurrentTask();
+    if ((TaskHandle_t)pxCurrent == xTtGetNextTask()) {
+        return false;
+    }
+    if (pxCurrent->eCurrentState == TASK_STATE_RUNNING) {
+        pxCurrent->eCurrentState = TASK_STATE_READY;
+    }
+    return true;
+}
+
+/**
+ * @brief The slot owner while its job is pending, idle otherwise
+ */
+TaskHandle_t xTtGetNextTask(void)
+{
+    if (pxSlotOwner != NULL && (pxSlotOwner->eCurrentState == TASK_STATE_READY ||
+                                pxSlotOwner->eCurrentState == TASK_STATE_RUNNING)) {
+        return (TaskHandle_t)pxSlotOwner;
+    }
+    return xIdleTask;
+}
+
+/**
+ * @brief Hand the slot to the entry's task, releasing its job if flagged
+ *
+ * As under RM, a release that finds the previous job unfinished is dropped.
+ */
+static void vApplyEntry(const TtEntry_t *pxEntry)
+{
+    TaskControlBlock_t *pxTCB = pxTtTasks[pxEntry->ucTask];
+
+    if (pxTCB != NULL && (pxEntry->ucFlags & TT_FLAG_RELEASE)) {
+        /* The job may start after its release; deadlines count from the release */
+        uint32_t ulRelease = ulFrameStart + pxEntry->ulOffset - pxEntry->ulOffset % pxTCB->ulPeriod;
+
+        if (pxTCB->eCurrentState == TASK_STATE_BLOCKED) {
+            pxTCB->eCurrentState = TASK_STATE_READY;
+            vSchedulerSetDeadline((TaskHandle_t)pxTCB, ulRmAbsoluteDeadline(ulRelease, pxTCB->ulDeadline));
+        }
+        pxTCB->ulReleaseTime = ulRmNextRelease(ulRelease, pxTCB->ulPeriod);
+    }
+
+    pxSlotOwner = pxTCB;
+}
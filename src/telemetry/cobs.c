@@ -0,0 +1,109 @@
+/**
+ * @file cobs.c
+ * @brief Consistent Overhead Byte Stuffing and CRC-16 helpers
+ *
+ * Plain C with no kernel dependencies so host tools can build it as-is.
+ */
+
+#include "telemetry.h"
+#include <stddef.h>
+
+/**
+ * @brief Start encoding a new COBS frame at pucDst
+ */
+void vCobsEncodeStart(CobsEncoder_t *pxEncoder, uint8_t *pucDst)
+{
+    pxEncoder->pucCode = pucDst;
+    pxEncoder->pucOut = pucDst + 1;
+    pxEncoder->ucCode = 1;
+}
+
+/**
+ * @brief Append one byte to the frame being encoded
+ */
+void vCobsEncodeByte(CobsEncoder_t *pxEncoder, uint8_t ucByte)
+{
+    if (ucByte != 0) {
+        *pxEncoder->pucOut++ = ucByte;
+        pxEncoder->ucCode++;
+    }
+
+    if (ucByte == 0 || pxEncoder->ucCode == 0xFF) {
+        /* Close the current block and open a new one */
+        *pxEncoder->pucCode = pxEncoder->ucCode;
+        pxEncoder->pucCode = pxEncoder->pucOut++;
+        pxEncoder->ucCode = 1;
+    }
+}
+
+/**
+ * @brief Close the frame, append the 0x00 delimiter
+ * @return Number of bytes written since vCobsEncodeStart (delimiter included)
+ */
+uint32_t ulCobsEncodeFinish(CobsEncoder_t *pxEncoder, uint8_t *pucDst)
+{
+    *pxEncoder->pucCode = pxEncoder->ucCode;
+    *pxEncoder->pucOut++ = 0x00;
+
+    return (uint32_t)(pxEncoder->pucOut - pucDst);
+}
+
+/**
+ * @brief Encode a buffer as one delimited COBS frame
+ * @return Encoded length including the trailing delimiter
+ */
+uint32_t ulCobsEncode(const uint8_t *pucSrc, uint32_t ulLength, uint8_t *pucDst)
+{
+    CobsEncoder_t xEncoder;
+
+    vCobsEncodeStart(&xEncoder, pucDst);
+    for (uint32_t i = 0; i < ulLength; i++) {
+        vCobsEncodeByte(&xEncoder, pucSrc[i]);
+    }
+
+    return ulCobsEncodeFinish(&xEncoder, pucDst);
+}
+
+/**
+ * @brief Decode one COBS frame (without its delimiter)
+ * @return Decoded length, or 0 if the frame is malformed
+ */
+uint32_t ulCobsDecode(const uint8_t *pucSrc, uint32_t ulLength, uint8_t *pucDst)
+{
+    const uint8_t *pucEnd = pucSrc + ulLength;
+    uint8_t *pucOut = pucDst;
+
+    while (pucSrc < pucEnd) {
+        uint8_t ucCode = *pucSrc++;
+
+        if (ucCode == 0 || pucSrc + ucCode - 1 > pucEnd) {
+            return 0;
+        }
+
+        for (uint8_t i = 1; i < ucCode; i++) {
+            *pucOut++ = *pucSrc++;
+        }
+
+        /* A block shorter than 254 data bytes implies a zero, except at the end */
+        if (ucCode != 0xFF && pucSrc < pucEnd) {
+            *pucOut++ = 0x00;
+        }
+    }
+
+    return (uint32_t)(pucOut - pucDst);
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021), start with 0xFFFF
+ */
+uint16_t usCrc16Update(uint16_t usCrc, const uint8_t *pucData, uint32_t ulLength)
+{
+    for (uint32_t i = 0; i < ulLength; i++) {
+        usCrc ^= (uint16_t)pucData[i] << 8;
+        for (uint8_t ucBit = 0; ucBit < 8; ucBit++) {
+            usCrc = (usCrc & 0x8000) ? (uint16_t)((usCrc << 1) ^ 0x1021) : (uint16_t)(usCrc << 1);
+        }
+    }
+
+    return usCrc;
+}
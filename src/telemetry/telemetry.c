@@ -0,0 +1,209 @@
+/**
+ * @file telemetry.c
+ * @brief Double-buffered, COBS-framed telemetry transport
+ *
+ * Senders encode their frame straight into the buffer half that is being
+ * filled. When the UART DMA is idle the filled half is handed to it and the
+ * halves swap; the DMA completion interrupt (or the last sender to finish
+ * encoding) hands over the next half once it has data. Nothing ever waits
+ * for the UART: if the fill half has no room the frame is dropped and counted.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include <stddef.h>
+
+_Static_assert(sizeof(TelemetrySnapshot_t) <= TELEMETRY_MAX_PAYLOAD,
+               "Snapshot does not fit in one telemetry frame");
+_Static_assert(COBS_MAX_ENCODED_SIZE(TELEMETRY_MAX_PAYLOAD + TELEMETRY_FRAME_OVERHEAD) <= TELEMETRY_TX_BUFFER_SIZE,
+               "Largest frame does not fit in the transmit buffer");
+
+/* Double buffer */
+static uint8_t ucTxBuffer[2][TELEMETRY_TX_BUFFER_SIZE];
+static volatile uint32_t ulTxFillLength[2];
+static volatile uint32_t ulTxWritersPending[2];   /* Senders still encoding into a half */
+static volatile uint8_t ucTxFillIndex = 0;
+static volatile bool bTxDmaBusy = false;
+
+static uint8_t ucTxSequence[TELEMETRY_CHANNEL_COUNT];
+static TelemetryStats_t xTelemetryStats;
+
+/* Internal function prototypes */
+static void vKickTransfer(void);
+
+/**
+ * @brief Initialize the telemetry transport and its UART
+ */
+void vTelemetryInit(void)
+{
+    ulTxFillLength[0] = 0;
+    ulTxFillLength[1] = 0;
+    ulTxWritersPending[0] = 0;
+    ulTxWritersPending[1] = 0;
+    ucTxFillIndex = 0;
+    bTxDmaBusy = false;
+
+    for (uint32_t i = 0; i < TELEMETRY_CHANNEL_COUNT; i++) {
+        ucTxSequence[i] = 0;
+        xTelemetryStats.ulFramesSent[i] = 0;
+        xTelemetryStats.ulFramesDropped[i] = 0;
+    }
+    xTelemetryStats.ulBytesSent = 0;
+    xTelemetryStats.ulDmaTransfers = 0;
+
+    vUartDmaInit(TELEMETRY_BAUD_RATE);
+}
+
+/**
+ * @brief Queue one frame for transmission (non-blocking, ISR-safe)
+ * @return false if the frame was dropped
+ *
+ * Space is reserved with interrupts masked for a few instructions; the
+ * encoding itself runs with interrupts enabled. Unused reserved bytes are
+ * filled with 0x00, which the receiver sees as empty frames.
+ */
+bool bTelemetrySend(TelemetryChannel_t eChannel, const void *pvData, uint32_t ulLength)
+{
+    const uint8_t *pucData = (const uint8_t *)pvData;
+    CobsEncoder_t xEncoder;
+    uint8_t ucHeader[2];
+    uint8_t ucCrc[2];
+    uint16_t usCrc;
+    uint8_t *pucFrame;
+    uint32_t ulReserved;
+    uint32_t ulEncoded;
+    uint32_t ulState;
+    uint8_t ucIndex;
+
+    if (eChannel >= TELEMETRY_CHANNEL_COUNT ||
+        ulLength > TELEMETRY_MAX_PAYLOAD ||
+        (pucData == NULL && ulLength != 0)) {
+        return false;
+    }
+
+    ulReserved = COBS_MAX_ENCODED_SIZE(ulLength + TELEMETRY_FRAME_OVERHEAD);
+
+    /* Reserve worst-case space in the fill half */
+    ulState = ulHalDisableInterrupts();
+    ucIndex = ucTxFillIndex;
+    if (ulTxFillLength[ucIndex] + ulReserved > TELEMETRY_TX_BUFFER_SIZE) {
+        xTelemetryStats.ulFramesDropped[eChannel]++;
+        vHalRestoreInterrupts(ulState);
+        return false;
+    }
+    pucFrame = &ucTxBuffer[ucIndex][ulTxFillLength[ucIndex]];
+    ulTxFillLength[ucIndex] += ulReserved;
+    ulTxWritersPending[ucIndex]++;
+    ucHeader[0] = (uint8_t)eChannel;
+    ucHeader[1] = ucTxSequence[eChannel]++;
+    vHalRestoreInterrupts(ulState);
+
+    usCrc = usCrc16Update(0xFFFF, ucHeader, sizeof(ucHeader));
+    usCrc = usCrc16Update(usCrc, pucData, ulLength);
+    ucCrc[0] = (uint8_t)(usCrc & 0xFF);
+    ucCrc[1] = (uint8_t)(usCrc >> 8);
+
+    /* Encode in place - this is the only pass over the payload */
+    vCobsEncodeStart(&xEncoder, pucFrame);
+    vCobsEncodeByte(&xEncoder, ucHeader[0]);
+    vCobsEncodeByte(&xEncoder, ucHeader[1]);
+    for (uint32_t i = 0; i < ulLength; i++) {
+        vCobsEncodeByte(&xEncoder, pucData[i]);
+    }
+    vCobsEncodeByte(&xEncoder, ucCrc[0]);
+    vCobsEncodeByte(&xEncoder, ucCrc[1]);
+    ulEncoded = ulCobsEncodeFinish(&xEncoder, pucFrame);
+
+    while (ulEncoded < ulReserved) {
+        pucFrame[ulEncoded++] = 0x00;
+    }
+
+    /* Commit; the last writer of an idle half starts the DMA */
+    ulState = ulHalDisableInterrupts();
+    ulTxWritersPending[ucIndex]--;
+    xTelemetryStats.ulFramesSent[eChannel]++;
+    if (!bTxDmaBusy && ucIndex == ucTxFillIndex && ulTxWritersPending[ucIndex] == 0) {
+        vKickTransfer();
+    }
+    vHalRestoreInterrupts(ulState);
+
+    return true;
+}
+
+/**
+ * @brief Send a consistent system snapshot on the telemetry channel
+ */
+bool bTelemetrySendSnapshot(void)
+{
+    /* Static: a snapshot is far larger than a default task stack */
+    static TelemetrySnapshot_t xSnapshot;
+    static volatile bool bSnapshotBusy = false;
+    bool bSent = false;
+    uint32_t ulState;
+
+    ulState = ulHalDisableInterrupts();
+    if (bSnapshotBusy) {
+        vHalRestoreInterrupts(ulState);
+        return false;
+    }
+    bSnapshotBusy = true;
+    vHalRestoreInterrupts(ulState);
+
+    if (bGetTelemetrySnapshot(&xSnapshot)) {
+        bSent = bTelemetrySend(TELEMETRY_CHANNEL_TELEMETRY, &xSnapshot, sizeof(xSnapshot));
+    }
+
+    bSnapshotBusy = false;
+
+    return bSent;
+}
+
+/**
+ * @brief Copy transport statistics
+ */
+void vTelemetryGetStats(TelemetryStats_t *pxStats)
+{
+    uint32_t ulState;
+
+    if (pxStats == NULL) {
+        return;
+    }
+
+    ulState = ulHalDisableInterrupts();
+    *pxStats = xTelemetryStats;
+    vHalRestoreInterrupts(ulState);
+}
+
+/**
+ * @brief DMA completion - called from the UART driver's interrupt
+ */
+void vTelemetryTxComplete(void)
+{
+    uint32_t ulState = ulHalDisableInterrupts();
+
+    bTxDmaBusy = false;
+    if (ulTxFillLength[ucTxFillIndex] > 0 && ulTxWritersPending[ucTxFillIndex] == 0) {
+        vKickTransfer();
+    }
+
+    vHalRestoreInterrupts(ulState);
+}
+
+/**
+ * @brief Hand the fill half to the DMA and swap halves (interrupts masked)
+ */
+static void vKickTransfer(void)
+{
+    uint8_t ucIndex = ucTxFillIndex;
+    uint32_t ulLength = ulTxFillLength[ucIndex];
+
+    /* The other half finished transmitting, so it is free to fill */
+    ucTxFillIndex = ucIndex ^ 1;
+    ulTxFillLength[ucTxFillIndex] = 0;
+
+    bTxDmaBusy = true;
+    xTelemetryStats.ulBytesSent += ulLength;
+    xTelemetryStats.ulDmaTransfers++;
+
+    vUartDmaStart(ucTxBuffer[ucIndex], ulLength);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file profile_timer.c
+ * @brief TIM2 sampling interrupt for the PC-sampling profiler (Cortex-M)
+ *
+ * TIM2 is free on the Discovery board and modelled by QEMU. Its interrupt
+ * is more urgent than KERNEL_MAX_SYSCALL_PRIORITY, so kernel critical
+ * sections and the tick show up in the profile instead of being hidden
+ * behind BASEPRI.
+ */
+
+#include "periodRTOS.h"
+#include "profiler.h"
+#include "stm32f303xx.h"
+
+_Static_assert(PROFILER_PRIORITY < KERNEL_MAX_SYSCALL_PRIORITY,
+               "the profiler samples inside kernel critical sections");
+
+/* External variables */
+extern uint32_t SystemCoreClock;
+
+static uint32_t ulTimerHz = 0;
+
+/* TIM2 is 32 bits wide and clocked at SystemCoreClock on APB1 */
+static void vProfilerTimerReload(void)
+{
+    uint32_t ulReload = SystemCoreClock / ulTimerHz;
+
+    TIM2->ARR = (ulReload > 1) ? ulReload - 1 : 1;
+}
+
+/**
+ * @brief Start or retune the sampling interrupt
+ */
+void vProfilerTimerStart(uint32_t ulSampleHz)
+{
+    ulTimerHz = ulSampleHz;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+    (void)RCC->APB1ENR;
+
+    TIM2->CR1 = TIM_CR1_URS;
+    TIM2->PSC = 0;
+    vProfilerTimerReload();
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE;
+
+    NVIC_SetPriority(TIM2_IRQn, PROFILER_PRIORITY);
+    NVIC_EnableIRQ(TIM2_IRQn);
+    TIM2->CR1 = TIM_CR1_URS | TIM_CR1_CEN;
+}
+
+/**
+ * @brief Stop the sampling interrupt
+ */
+void vProfilerTimerStop(void)
+{
+    TIM2->CR1 = 0;
+    TIM2->DIER = 0;
+    NVIC_DisableIRQ(TIM2_IRQn);
+    TIM2->SR = 0;
+    ulTimerHz = 0;
+}
+
+/**
+ * @brief Keep the sampling rate across a SystemCoreClock change
+ *
+ * ARR is not preloaded, so the new period applies from the next update.
+ */
+void vProfilerTimerClockChanged(void)
+{
+    if (ulTimerHz != 0) {
+        vProfilerTimerReload();
+    }
+}
+
+/**
+ * @brief Take one sample from the interrupted exception frame
+ *
+ * pulFrame is the basic frame the hardware stacked: r0-r3, r12, lr, pc,
+ * xPSR. A non-zero IPSR in the stacked xPSR means a handler was running.
+ */
+KERNEL_RAMFUNC void vProfilerTimerSample(const uint32_t *pulFrame)
+{
+    uint8_t ucFlags = PROFILE_SAMPLE_LR;
+
+    TIM2->SR = 0;
+    if ((pulFrame[7] & 0x1FFUL) != 0) {
+        ucFlags |= PROFILE_SAMPLE_HANDLER;
+    }
+    vProfilerSample(pulFrame[6], pulFrame[5], ucFlags);
+}
+
+/**
+ * @brief TIM2 interrupt: pass the stacked frame to vProfilerTimerSample()
+ *
+ * Naked so that the frame pointer is the one the hardware pushed, on
+ * whichever stack EXC_RETURN names.
+ */
+KERNEL_RAMFUNC __attribute__((naked)) void TIM2_IRQHandler(void)
+{
+    __asm volatile ("tst lr, #4\n"
+                    "ite eq\n"
+                    "mrseq r0, msp\n"
+                    "mrsne r0, psp\n"
+                    "b vProfilerTimerSample\n");
+}
@@ -0,0 +1,280 @@
+/**
+ * @file sw_timer.c
+ * @brief Software timers run by a sporadic timer service task
+ *
+ * Timers come from a static pool of MAX_TIMERS. Running timers form a
+ * singly linked queue sorted by expiry tick, so starting or stopping one
+ * walks at most MAX_TIMERS links and the tick looks at the head only.
+ * Expiry ticks are compared by their signed distance, which keeps the order
+ * across the 32-bit tick wrap.
+ */
+
+#include "periodRTOS.h"
+#include "sw_timer.h"
+#include <stddef.h>
+
+typedef struct Timer {
+    const char *pcName;              /* NULL if the slot is free */
+    uint32_t ulPeriod;               /* Ticks */
+    uint32_t ulExpiry;               /* Tick the timer fires at while active */
+    TimerCallback_t pxCallback;
+    void *pvContext;
+    bool bAutoReload;
+    bool bActive;                    /* Linked into the queue */
+    struct Timer *pxNext;
+} Timer_t;
+
+/* External variables */
+extern uint32_t ulSystemTick;
+
+TaskHandle_t xTimerServiceTask = NULL;
+
+static Timer_t xTimers[MAX_TIMERS];
+static Timer_t *pxTimerQueue = NULL;     /* Active timers, earliest expiry first */
+
+/* Internal function prototypes */
+static void vTimerServiceTask(void *pvParameters);
+static bool bIsValidTimer(TimerHandle_t xTimer);
+static bool bExpiresBefore(uint32_t ulA, uint32_t ulB);
+static void vInsertTimer(Timer_t *pxTimer);
+static void vUnlinkTimer(Timer_t *pxTimer);
+
+/**
+ * @brief Create a stopped timer
+ * @return NULL if the pool is exhausted or the period is 0 or too long
+ *
+ * An auto-reload timer fires every ulPeriodTicks once started; a one-shot
+ * timer fires once, ulPeriodTicks after it was started or reset.
+ */
+TimerHandle_t xTimerCreate(const char *pcName, uint32_t ulPeriodTicks, bool bAutoReload,
+                           TimerCallback_t pxCallback, void *pvContext)
+{
+    Timer_t *pxTimer = NULL;
+
+    if (pcName == NULL || pxCallback == NULL || ulPeriodTicks == 0 || ulPeriodTicks > MAX_DELAY_TICKS) {
+        return NULL;
+    }
+
+    vKernelEnterCritical();
+    for (uint32_t i = 0; i < MAX_TIMERS; i++) {
+        if (xTimers[i].pcName == NULL) {
+            pxTimer = &xTimers[i];
+            pxTimer->pcName = pcName;
+            pxTimer->ulPeriod = ulPeriodTicks;
+            pxTimer->ulExpiry = 0;
+            pxTimer->pxCallback = pxCallback;
+            pxTimer->pvContext = pvContext;
+            pxTimer->bAutoReload = bAutoReload;
+            pxTimer->bActive = false;
+            pxTimer->pxNext = NULL;
+            break;
+        }
+    }
+    vKernelExitCritical();
+
+    return (TimerHandle_t)pxTimer;
+}
+
+/**
+ * @brief Start a stopped timer; a running one keeps its expiry
+ */
+bool bTimerStart(TimerHandle_t xTimer)
+{
+    Timer_t *pxTimer = (Timer_t *)xTimer;
+    uint32_t ulState;
+
+    if (!bIsValidTimer(xTimer)) {
+        return false;
+    }
+
+    ulState = ulKernelEnterCriticalFromISR();
+    if (!pxTimer->bActive) {
+        pxTimer->ulExpiry = ulSystemTick + pxTimer->ulPeriod;
+        vInsertTimer(pxTimer);
+    }
+    vKernelExitCriticalFromISR(ulState);
+
+    return true;
+}
+
+/**
+ * @brief Stop a timer; a stopped timer's callback does not run again
+ */
+bool bTimerStop(TimerHandle_t xTimer)
+{
+    Timer_t *pxTimer = (Timer_t *)xTimer;
+    uint32_t ulState;
+
+    if (!bIsValidTimer(xTimer)) {
+        return false;
+    }
+
+    ulState = ulKernelEnterCriticalFromISR();
+    if (pxTimer->bActive) {
+        vUnlinkTimer(pxTimer);
+    }
+    vKernelExitCriticalFromISR(ulState);
+
+    return true;
+}
+
+/**
+ * @brief Restart a timer's period from the current tick, starting it if stopped
+ *
+ * Resetting a one-shot timer on every event makes it fire one period after
+ * the last event, as debouncing and timeouts need.
+ */
+bool bTimerReset(TimerHandle_t xTimer)
+{
+    Timer_t *pxTimer = (Timer_t *)xTimer;
+    uint32_t ulState;
+
+    if (!bIsValidTimer(xTimer)) {
+        return false;
+    }
+
+    ulState = ulKernelEnterCriticalFromISR();
+    if (pxTimer->bActive) {
+        vUnlinkTimer(pxTimer);
+    }
+    pxTimer->ulExpiry = ulSystemTick + pxTimer->ulPeriod;
+    vInsertTimer(pxTimer);
+    vKernelExitCriticalFromISR(ulState);
+
+    return true;
+}
+
+/**
+ * @brief Whether a timer is running
+ */
+bool bTimerIsActive(TimerHandle_t xTimer)
+{
+    return bIsValidTimer(xTimer) && ((Timer_t *)xTimer)->bActive;
+}
+
+/**
+ * @brief Context pointer given to xTimerCreate()
+ */
+void *pvTimerGetContext(TimerHandle_t xTimer)
+{
+    return bIsValidTimer(xTimer) ? ((Timer_t *)xTimer)->pvContext : NULL;
+}
+
+/**
+ * @brief Name given to xTimerCreate()
+ */
+const char *pcTimerGetName(TimerHandle_t xTimer)
+{
+    return bIsValidTimer(xTimer) ? ((Timer_t *)xTimer)->pcName : NULL;
+}
+
+/**
+ * @brief The timer service task, NULL without ENABLE_SOFTWARE_TIMERS
+ *
+ * For vTaskSetWcet() with the callbacks' budget. It runs in every mode.
+ */
+TaskHandle_t xTimerGetServiceTask(void)
+{
+    return xTimerServiceTask;
+}
+
+/**
+ * @brief Create the timer service task (from vKernelInit)
+ *
+ * Created with the kernel, so a time-triggered table can bind it by name
+ * before the scheduler starts.
+ */
+void vTimerServiceCreate(void)
+{
+    xTimerServiceTask = xTaskCreatePeriodic(vTimerServiceTask, TIMER_SERVICE_NAME,
+                                            TIMER_SERVICE_STACK_SIZE, NULL,
+                                            TIMER_SERVICE_PERIOD, TIMER_SERVICE_PERIOD);
+}
+
+/**
+ * @brief Whether a timer has expired (from the tick's release scan)
+ */
+bool bTimerServiceDue(void)
+{
+    return pxTimerQueue != NULL && !bExpiresBefore(ulSystemTick, pxTimerQueue->ulExpiry);
+}
+
+/**
+ * @brief One job of the service task: fire the timers due at its start
+ *
+ * An auto-reload timer is requeued one period after its previous expiry
+ * before its callback runs, so its rate does not drift with the service's
+ * response time and the callback may stop or reset it. Timers coming due
+ * after the job started wait for the next release; one that fell more than
+ * a period behind fires once per period missed.
+ */
+static void vTimerServiceTask(void *pvParameters)
+{
+    uint32_t ulNow = ulSystemTick;
+
+    (void)pvParameters;
+
+    for (;;) {
+        Timer_t *pxTimer;
+
+        vKernelEnterCritical();
+        pxTimer = pxTimerQueue;
+        if (pxTimer == NULL || bExpiresBefore(ulNow, pxTimer->ulExpiry)) {
+            vKernelExitCritical();
+            break;
+        }
+        vUnlinkTimer(pxTimer);
+        if (pxTimer->bAutoReload) {
+            pxTimer->ulExpiry += pxTimer->ulPeriod;
+            vInsertTimer(pxTimer);
+        }
+        vKernelExitCritical();
+
+        pxTimer->pxCallback((TimerHandle_t)pxTimer);
+    }
+}
+
+static bool bIsValidTimer(TimerHandle_t xTimer)
+{
+    Timer_t *pxTimer = (Timer_t *)xTimer;
+
+    return pxTimer >= &xTimers[0] && pxTimer < &xTimers[MAX_TIMERS] && pxTimer->pcName != NULL;
+}
+
+/**
+ * @brief Whether expiry tick ulA comes before ulB, modulo 2^32
+ */
+static bool bExpiresBefore(uint32_t ulA, uint32_t ulB)
+{
+    return (int32_t)(ulA - ulB) < 0;
+}
+
+/**
+ * @brief Link a timer into the queue behind those expiring no later
+ */
+static void vInsertTimer(Timer_t *pxTimer)
+{
+    Timer_t **ppxLink = &pxTimerQueue;
+
+    while (*ppxLink != NULL && !bExpiresBefore(pxTimer->ulExpiry, (*ppxLink)->ulExpiry)) {
+        ppxLink = &(*ppxLink)->pxNext;
+    }
+    pxTimer->pxNext = *ppxLink;
+    *ppxLink = pxTimer;
+    pxTimer->bActive = true;
+}
+
+static void vUnlinkTimer(Timer_t *pxTimer)
+{
+    Timer_t **ppxLink = &pxTimerQueue;
+
+    while (*ppxLink != NULL) {
+        if (*ppxLink == pxTimer) {
+            *ppxLink = pxTimer->pxNext;
+            break;
+        }
+        ppxLink = &(*ppxLink)->pxNext;
+    }
+    pxTimer->pxNext = NULL;
+    pxTimer->bActive = false;
+}
@@ -1,6 +1,6 @@
 /**
  * @file systick.c
- * @brief Systick timer implementation for periodRTOS
+ * @brief Systick tick source for periodRTOS (Cortex-M)
  */
 
 #include "periodRTOS.h"
@@ -8,12 +8,24 @@
 
 /* Systick configuration */
 #define SYSTICK_RELOAD_VALUE    (SystemCoreClock / SYSTICK_FREQ_HZ - 1)
-#define SYSTICK_PRIORITY        0
+
+_Static_assert(SYSTICK_PRIORITY >= KERNEL_MAX_SYSCALL_PRIORITY,
+               "kernel critical sections must mask the tick");
+
+/* Cycle counter source: DWT CYCCNT, or SysTick where there is no DWT (QEMU) */
+#ifndef PERIODRTOS_CYCLE_COUNTER_SYSTICK
+#define PERIODRTOS_CYCLE_COUNTER_SYSTICK    0
+#endif
 
 /* External variables */
 extern uint32_t SystemCoreClock;
 extern uint32_t ulSystemTick;
 
+#if PERIODRTOS_CYCLE_COUNTER_SYSTICK
+/* Cycles at the start of the current SysTick period */
+static volatile uint32_t ulCycleEpoch = 0;
+#endif
+
 /**
  * @brief Initialize Systick timer
  */
@@ -26,53 +38,123 @@ void vSystickInit(void)
                    SysTick_CTRL_TICKINT_Msk | 
                    SysTick_CTRL_ENABLE_Msk;
     
-    /* Set Systick priority (highest priority) */
+    /* Set Systick priority (the most urgent one kernel critical sections mask) */
     NVIC_SetPriority(SysTick_IRQn, SYSTICK_PRIORITY);
 }
 
+/**
+ * @brief Follow a SystemCoreClock change
+ *
+ * The new reload value is used from the next wrap on; the period in
+ * progress is stretched or shortened by the clock ratio, which shifts the
+ * tick by less than one period.
+ */
+void vSystickUpdateReload(void)
+{
+    SysTick->LOAD = SYSTICK_RELOAD_VALUE;
+}
+
 /**
  * @brief Systick interrupt handler
  */
-void SysTick_Handler(void)
+KERNEL_RAMFUNC void SysTick_Handler(void)
 {
+#if PERIODRTOS_CYCLE_COUNTER_SYSTICK
+    ulCycleEpoch += SysTick->LOAD + 1;
+#endif
+
     /* Call system tick handler */
     vSystemTickHandler();
 }
 
 /**
- * @brief Get current system tick
+ * @brief Free-running microsecond counter for run-time accounting
+ *
+ * Tick count plus the elapsed part of the current SysTick period. Wraps
+ * after ~71 minutes; only differences are meaningful. Also called with
+ * the tick masked (context switch, tick handler): a pending tick that
+ * ulSystemTick does not count yet is added by ulGetTickElapsedCycles(),
+ * so the counter never steps back.
  */
-uint32_t ulGetSystemTick(void)
+uint32_t ulGetRunTimeCounter(void)
 {
-    return ulSystemTick;
+    volatile uint32_t *pulTick = &ulSystemTick;
+    uint32_t ulTick;
+    uint32_t ulElapsedUs;
+    
+    /* Re-read if the tick interrupt ran in between */
+    do {
+        ulTick = *pulTick;
+        ulElapsedUs = ulGetTickElapsedUs();
+    } while (ulTick != *pulTick);
+    
+    return ulTick * (1000000 / SYSTICK_FREQ_HZ) + ulElapsedUs;
 }
 
 /**
- * @brief Delay for specified number of ticks
+ * @brief Microseconds since the current tick period began
+ *
+ * A pending tick that ulSystemTick does not count yet adds one period
+ * (ulGetTickElapsedCycles()), so ulSystemTick in microseconds plus this
+ * is the time now, also with the tick masked.
  */
-void vTaskDelay(uint32_t ulTicksToDelay)
+uint32_t ulGetTickElapsedUs(void)
 {
-    uint32_t ulStartTick = ulSystemTick;
+    uint32_t ulReload = SysTick->LOAD;
+
+    return (ulGetTickElapsedCycles() * (1000000 / SYSTICK_FREQ_HZ)) / (ulReload + 1);
+}
+
+/**
+ * @brief Start the cycle counter
+ */
+void vCycleCounterInit(void)
+{
+#if PERIODRTOS_CYCLE_COUNTER_SYSTICK
+    ulCycleEpoch = 0;
+#else
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief Free-running core clock cycle counter; only differences are meaningful
+ */
+uint32_t ulGetCycleCounter(void)
+{
+#if PERIODRTOS_CYCLE_COUNTER_SYSTICK
+    uint32_t ulEpoch;
+    uint32_t ulElapsed;
     
-    while ((ulSystemTick - ulStartTick) < ulTicksToDelay) {
-        /* Yield to other tasks */
-        vTaskYield();
-    }
+    do {
+        ulEpoch = ulCycleEpoch;
+        ulElapsed = ulGetTickElapsedCycles();
+    } while (ulEpoch != ulCycleEpoch);
+    
+    return ulEpoch + ulElapsed;
+#else
+    return DWT->CYCCNT;
+#endif
 }
 
 /**
- * @brief Delay until specified tick
+ * @brief Core clock cycles since the current tick period began
+ *
+ * With interrupts masked a tick may already be pending; the counter has
+ * then wrapped and one period is added.
  */
-void vTaskDelayUntil(uint32_t *pulPreviousWakeTime, uint32_t ulTimeIncrement)
+uint32_t ulGetTickElapsedCycles(void)
 {
-    uint32_t ulNextWakeTime = *pulPreviousWakeTime + ulTimeIncrement;
-    uint32_t ulCurrentTick = ulSystemTick;
+    uint32_t ulReload = SysTick->LOAD;
+    uint32_t ulCount = SysTick->VAL;
     
-    /* Check if we need to wait */
-    if (ulCurrentTick < ulNextWakeTime) {
-        vTaskDelay(ulNextWakeTime - ulCurrentTick);
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        /* Re-read: the first value may predate the wrap */
+        ulCount = SysTick->VAL;
+        return (ulReload - ulCount) + ulReload + 1;
     }
     
-    /* Update previous wake time */
-    *pulPreviousWakeTime = ulNextWakeTime;
+    return ulReload - ulCount;
 }
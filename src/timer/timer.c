@@ -0,0 +1,140 @@
+/**
+ * @file timer.c
+ * @brief Portable tick-based timing services for periodRTOS
+ *
+ * Only uses the kernel tick count; the tick source itself lives in the port
+ * (systick.c on Cortex-M, boards/posix/port.c on the host).
+ *
+ * A delayed task leaves the ready list and is linked into the wake-up list,
+ * kept sorted by wake tick. Insertion walks the list from task level; the
+ * tick only looks at the head, so a tick without a due delay costs one
+ * comparison. Wake ticks are compared by their signed distance, which stays
+ * correct across the 32-bit tick wrap for delays up to MAX_DELAY_TICKS.
+ */
+
+#include "periodRTOS.h"
+#include <stddef.h>
+
+/* External variables */
+extern uint32_t ulSystemTick;
+
+/* Delayed tasks, earliest wake tick first */
+static TaskControlBlock_t *pxDelayedList = NULL;
+
+/* Internal function prototypes */
+static bool bWakesBefore(uint32_t ulA, uint32_t ulB);
+static void vInsertDelayed(TaskControlBlock_t *pxTCB);
+
+/**
+ * @brief Get current system tick
+ */
+uint32_t ulGetSystemTick(void)
+{
+    return ulSystemTick;
+}
+
+/**
+ * @brief Block the calling task for a number of ticks
+ *
+ * The job stays pending while delayed: its deadline is still checked and
+ * releases falling into the delay are lost as for any unfinished job. The
+ * delay ends at the tick ulTicksToDelay ticks after the current one; the
+ * task then competes at its own priority. Ignored before the scheduler
+ * starts and in the idle task, which must never block.
+ */
+void vTaskDelay(uint32_t ulTicksToDelay)
+{
+    TaskControlBlock_t *pxTCB = (TaskControlBlock_t *)pxGetCurrentTask();
+
+    if (ulTicksToDelay == 0 || pxTCB == NULL || pxTCB->ulPeriod == 0) {
+        return;
+    }
+    if (ulTicksToDelay > MAX_DELAY_TICKS) {
+        ulTicksToDelay = MAX_DELAY_TICKS;
+    }
+
+    vKernelEnterCritical();
+    vMonitorWriteBegin();
+    pxTCB->ulWakeTime = ulSystemTick + ulTicksToDelay;
+    pxTCB->eCurrentState = TASK_STATE_DELAYED;
+    vInsertDelayed(pxTCB);
+    vRemoveTaskFromReadyList((TaskHandle_t)pxTCB);
+    vMonitorWriteEnd();
+    vKernelExitCritical();
+
+    vStartContextSwitch();
+}
+
+/**
+ * @brief Block the calling task until *pulPreviousWakeTime + ulTimeIncrement
+ *
+ * Returns at once if that tick has already passed. Either way
+ * *pulPreviousWakeTime advances by ulTimeIncrement, so a sequence of calls
+ * keeps a fixed cadence without drift. Wrap-safe.
+ */
+void vTaskDelayUntil(uint32_t *pulPreviousWakeTime, uint32_t ulTimeIncrement)
+{
+    uint32_t ulElapsed = ulSystemTick - *pulPreviousWakeTime;
+
+    if (ulElapsed < ulTimeIncrement) {
+        vTaskDelay(ulTimeIncrement - ulElapsed);
+    }
+
+    *pulPreviousWakeTime += ulTimeIncrement;
+}
+
+/**
+ * @brief Wake the tasks whose delay ends at this tick (from vSystemTickHandler)
+ */
+KERNEL_RAMFUNC void vDelayTick(void)
+{
+    while (pxDelayedList != NULL && !bWakesBefore(ulSystemTick, pxDelayedList->ulWakeTime)) {
+        TaskControlBlock_t *pxTCB = pxDelayedList;
+
+        pxDelayedList = pxTCB->pxNextDelayed;
+        pxTCB->pxNextDelayed = NULL;
+        vSchedulerWakeTask((TaskHandle_t)pxTCB);
+    }
+}
+
+/**
+ * @brief Take a delayed task off the wake-up list without waking it
+ *
+ * For a delay cut short by suspension or a deadline abort; the caller
+ * holds a critical section or runs in the tick.
+ */
+void vDelayRemove(TaskHandle_t xTask)
+{
+    TaskControlBlock_t **ppxLink = &pxDelayedList;
+
+    while (*ppxLink != NULL) {
+        if (*ppxLink == (TaskControlBlock_t *)xTask) {
+            *ppxLink = (*ppxLink)->pxNextDelayed;
+            ((TaskControlBlock_t *)xTask)->pxNextDelayed = NULL;
+            return;
+        }
+        ppxLink = &(*ppxLink)->pxNextDelayed;
+    }
+}
+
+/**
+ * @brief Whether wake tick ulA comes before ulB, modulo 2^32
+ */
+static bool bWakesBefore(uint32_t ulA, uint32_t ulB)
+{
+    return (int32_t)(ulA - ulB) < 0;
+}
+
+/**
+ * @brief Link a task into the wake-up list behind those due no later
+ */
+static void vInsertDelayed(TaskControlBlock_t *pxTCB)
+{
+    TaskControlBlock_t **ppxLink = &pxDelayedList;
+
+    while (*ppxLink != NULL && !bWakesBefore(pxTCB->ulWakeTime, (*ppxLink)->ulWakeTime)) {
+        ppxLink = &(*ppxLink)->pxNextDelayed;
+    }
+    pxTCB->pxNextDelayed = *ppxLink;
+    *ppxLink = pxTCB;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file chain_age.c
+ * @brief Host test: chain data age against a known release-to-completion distance
+ *
+ * A single-task chain whose task plays the scheduler's part: the kernel
+ * library is built without ENABLE_CHAINS, so the task sets its own
+ * release tick and reports its completion with vChainJobComplete(), in a
+ * critical section as vTaskYield() does. A job released at tick R that
+ * completes in tick R + CHAIN_TEST_DISTANCE must age between
+ * CHAIN_TEST_DISTANCE and CHAIN_TEST_DISTANCE + 1 ticks:
+ *   - settled: the completion tick has been handled;
+ *   - pending: the completion tick is held back by the critical section,
+ *     so ulSystemTick still reads one tick earlier.
+ *
+ * Exits 0 when both ages are in range.
+ */
+
+#define _GNU_SOURCE
+#include "periodRTOS.h"
+#include "chain.h"
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+
+#define CHAIN_TEST_DISTANCE     3       /* Ticks from release to completion */
+#define CHAIN_TEST_PERIOD       1000    /* No second release during the test */
+#define CHAIN_TEST_TICK_US      (1000000 / SYSTICK_FREQ_HZ)
+#define CHAIN_TEST_TIMEOUT_NS   1000000000ULL
+
+static TaskHandle_t xTestTask = NULL;
+static ChainHandle_t xTestChain = NULL;
+static uint32_t ulFailures = 0;
+
+/**
+ * @brief Release a job of the test task at the current tick and consume its stamp
+ * @return The release tick
+ */
+static uint32_t ulReleaseJob(void)
+{
+    ChainStamp_t xStamp;
+    uint32_t ulRelease;
+
+    vKernelEnterCritical();
+    ulRelease = ulGetSystemTick();
+    pxTaskDetail((TaskControlBlock_t *)xTestTask)->ulJobReleaseTick = ulRelease;
+    vKernelExitCritical();
+
+    vChainStamp(xTestChain, &xStamp);
+    vChainConsume(xTestChain, &xStamp);
+
+    return ulRelease;
+}
+
+/**
+ * @brief Spin until ulTick has been handled
+ */
+static void vWaitForTick(uint32_t ulTick)
+{
+    while ((int32_t)(ulGetSystemTick() - ulTick) < 0) {
+    }
+}
+
+/**
+ * @brief Spin with the tick masked until its signal is pending
+ * @return false on timeout
+ */
+static bool bWaitForPendingTick(void)
+{
+    struct timespec xStart;
+    struct timespec xNow;
+    sigset_t xPending;
+
+    clock_gettime(CLOCK_MONOTONIC, &xStart);
+    do {
+        sigpending(&xPending);
+        if (sigismember(&xPending, SIGALRM) || sigismember(&xPending, SIGVTALRM)) {
+            return true;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &xNow);
+    } while ((uint64_t)(xNow.tv_sec - xStart.tv_sec) * 1000000000ULL + xNow.tv_nsec - xStart.tv_nsec <
+             CHAIN_TEST_TIMEOUT_NS);
+
+    return false;
+}
+
+/**
+ * @brief Compare the last recorded age with the expected distance
+ */
+static void vCheckAge(const char *pcCase, uint32_t ulSamples)
+{
+    ChainStats_t xStats;
+    uint32_t ulMin = CHAIN_TEST_DISTANCE * CHAIN_TEST_TICK_US;
+    uint32_t ulMax = ulMin + CHAIN_TEST_TICK_US;
+    bool bPass;
+
+    bChainGetStats(xTestChain, &xStats);
+    bPass = xStats.ulSamples == ulSamples && xStats.ulLastAge >= ulMin && xStats.ulLastAge < ulMax;
+    printf("chain_age: %-8s age %lu us, expected [%lu, %lu) - %s\n", pcCase,
+           (unsigned long)xStats.ulLastAge, (unsigned long)ulMin, (unsigned long)ulMax,
+           bPass ? "ok" : "FAIL");
+    if (!bPass) {
+        ulFailures++;
+    }
+}
+
+/**
+ * @brief Run both cases, then end the process
+ */
+static void vChainTestTask(void *pvParameters)
+{
+    uint32_t ulRelease;
+
+    (void)pvParameters;
+
+    /* Settled: complete once tick R + distance has been handled */
+    ulRelease = ulReleaseJob();
+    vWaitForTick(ulRelease + CHAIN_TEST_DISTANCE);
+    vKernelEnterCritical();
+    vChainJobComplete(xTestTask);
+    vKernelExitCritical();
+    vCheckAge("settled", 1);
+
+    /* Pending: tick R + distance arrives while the tick is masked */
+    ulRelease = ulReleaseJob();
+    vWaitForTick(ulRelease + CHAIN_TEST_DISTANCE - 1);
+    vKernelEnterCritical();
+    if (!bWaitForPendingTick() || ulGetSystemTick() != ulRelease + CHAIN_TEST_DISTANCE - 1) {
+        vKernelExitCritical();
+        printf("chain_age: the tick did not become pending\n");
+        vBoardExit(2);
+    }
+    vChainJobComplete(xTestTask);
+    vKernelExitCritical();
+    vCheckAge("pending", 2);
+
+    vBoardExit(ulFailures ? 1 : 0);
+}
+
+/**
+ * @brief Idle task - spin until a release preempts it
+ */
+void vIdleTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    while (1) {
+        vTaskYield();
+    }
+}
+
+int main(void)
+{
+    vBoardInit();
+
+    xTestTask = xTaskCreatePeriodic(vChainTestTask, "ChainTest", DEFAULT_STACK_SIZE, NULL,
+                                    CHAIN_TEST_PERIOD, CHAIN_TEST_PERIOD);
+    if (xTestTask != NULL) {
+        xTestChain = xChainCreate("age", &xTestTask, 1);
+    }
+    if (xTestChain == NULL) {
+        printf("chain_age: cannot create the chain\n");
+        vBoardExit(2);
+    }
+
+    vTaskStartScheduler();
+
+    vBoardExit(2);
+    return 2;
+}
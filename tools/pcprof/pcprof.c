@@ -0,0 +1,614 @@
+/**
+ * @file pcprof.c
+ * @brief pcprof - symbolize periodRTOS profiler samples against an ELF image
+ *
+ * Reads the telemetry byte stream (as telemetry_rx does), collects the
+ * TELEMETRY_CHANNEL_PROFILE samples and the task names from snapshot
+ * frames, and resolves each sample against the STT_FUNC symbols of the
+ * image that produced it.
+ *
+ * Usage: pcprof [-c] <elf> [capture|-]
+ *   -c    collapsed stacks ("task;caller;function count") for flamegraph.pl
+ *         or speedscope, instead of the per-task flat profile
+ *
+ * Stacks are two frames deep at most: the sampled PC and, where the port
+ * records it (PROFILE_SAMPLE_LR), the function the link register points
+ * into. The caller frame is left out when the LR resolves to the sampled
+ * function itself, which is the usual case in non-leaf functions. Samples
+ * taken in an interrupt handler get a "[handler]" frame under the task.
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define RX_FRAME_MAX         COBS_MAX_ENCODED_SIZE(TELEMETRY_MAX_PAYLOAD + TELEMETRY_FRAME_OVERHEAD)
+#define PCPROF_MAX_TASKS     256     /* ucTaskID range */
+#define PCPROF_UNKNOWN       UINT32_MAX
+
+#define ELF_SHT_SYMTAB       2
+#define ELF_STT_FUNC         2
+#define ELF_EM_ARM           40
+
+typedef struct {
+    uint64_t ullAddress;
+    uint64_t ullSize;
+    const char *pcName;
+} Symbol_t;
+
+typedef struct {
+    uint8_t *pucData;
+    size_t xSize;
+    bool b64Bit;
+    bool bThumb;             /* ARM: bit 0 of function addresses is the Thumb bit */
+    uint64_t ullBase;        /* st_value of vProfilerStart */
+    Symbol_t *pxSymbols;
+    uint32_t ulSymbols;
+} Image_t;
+
+/* One resolved sample: function of the PC and of the caller (or PCPROF_UNKNOWN) */
+typedef struct {
+    uint32_t ulFunction;
+    uint32_t ulCaller;
+    uint8_t ucTaskID;
+    bool bHandler;
+} Resolved_t;
+
+static Image_t xImage;
+static ProfileSample_t *pxSamples = NULL;
+static uint32_t ulSampleCount = 0;
+static uint32_t ulSampleCapacity = 0;
+static ProfileFrameHeader_t xLastHeader;
+static char pcTaskNames[PCPROF_MAX_TASKS][17];
+static uint32_t ulFramesBad = 0;
+static uint32_t ulProfileFramesLost = 0;
+static int lLastProfileSequence = -1;
+
+static void vPrintUsage(void)
+{
+    fprintf(stderr, "usage: pcprof [-c] <elf> [capture|-]\n");
+}
+
+static uint16_t usRead16(const uint8_t *pucData)
+{
+    return (uint16_t)(pucData[0] | (pucData[1] << 8));
+}
+
+static uint32_t ulRead32(const uint8_t *pucData)
+{
+    return (uint32_t)usRead16(pucData) | ((uint32_t)usRead16(pucData + 2) << 16);
+}
+
+static uint64_t ullRead64(const uint8_t *pucData)
+{
+    return (uint64_t)ulRead32(pucData) | ((uint64_t)ulRead32(pucData + 4) << 32);
+}
+
+static int iCompareSymbols(const void *pvA, const void *pvB)
+{
+    const Symbol_t *pxA = (const Symbol_t *)pvA;
+    const Symbol_t *pxB = (const Symbol_t *)pvB;
+
+    if (pxA->ullAddress != pxB->ullAddress) {
+        return (pxA->ullAddress < pxB->ullAddress) ? -1 : 1;
+    }
+    /* Sized symbols first, so an alias without a size loses to the real one */
+    return (pxA->ullSize > pxB->ullSize) ? -1 : (pxA->ullSize < pxB->ullSize);
+}
+
+/**
+ * @brief Load the function symbols of a little-endian ELF32/ELF64 image
+ */
+static bool bLoadImage(const char *pcPath)
+{
+    FILE *pxFile = fopen(pcPath, "rb");
+    const uint8_t *pucData;
+    uint64_t ullShOff;
+    uint32_t ulShEntSize, ulShNum;
+    bool bBaseFound = false;
+
+    if (pxFile == NULL) {
+        perror(pcPath);
+        return false;
+    }
+    fseek(pxFile, 0, SEEK_END);
+    xImage.xSize = (size_t)ftell(pxFile);
+    fseek(pxFile, 0, SEEK_SET);
+    xImage.pucData = malloc(xImage.xSize);
+    if (xImage.pucData == NULL || fread(xImage.pucData, 1, xImage.xSize, pxFile) != xImage.xSize) {
+        fprintf(stderr, "pcprof: cannot read %s\n", pcPath);
+        fclose(pxFile);
+        return false;
+    }
+    fclose(pxFile);
+    pucData = xImage.pucData;
+
+    if (xImage.xSize < 64 || memcmp(pucData, "\177ELF", 4) != 0 || pucData[5] != 1 ||
+        (pucData[4] != 1 && pucData[4] != 2)) {
+        fprintf(stderr, "pcprof: %s is not a little-endian ELF file\n", pcPath);
+        return false;
+    }
+    xImage.b64Bit = (pucData[4] == 2);
+    xImage.bThumb = (usRead16(pucData + 18) == ELF_EM_ARM);
+
+    if (xImage.b64Bit) {
+        ullShOff = ullRead64(pucData + 0x28);
+        ulShEntSize = usRead16(pucData + 0x3A);
+        ulShNum = usRead16(pucData + 0x3C);
+    } else {
+        ullShOff = ulRead32(pucData + 0x20);
+        ulShEntSize = usRead16(pucData + 0x2E);
+        ulShNum = usRead16(pucData + 0x30);
+    }
+    if (ullShOff + (uint64_t)ulShEntSize * ulShNum > xImage.xSize) {
+        fprintf(stderr, "pcprof: %s: truncated section table\n", pcPath);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < ulShNum; i++) {
+        const uint8_t *pucSection = pucData + ullShOff + (uint64_t)i * ulShEntSize;
+        const uint8_t *pucStrings;
+        uint64_t ullOffset, ullSize, ullEntSize, ullStrOffset, ullStrSize;
+        uint32_t ulLink;
+
+        if (ulRead32(pucSection + 4) != ELF_SHT_SYMTAB) {
+            continue;
+        }
+        if (xImage.b64Bit) {
+            ullOffset = ullRead64(pucSection + 24);
+            ullSize = ullRead64(pucSection + 32);
+            ulLink = ulRead32(pucSection + 40);
+            ullEntSize = ullRead64(pucSection + 56);
+        } else {
+            ullOffset = ulRead32(pucSection + 16);
+            ullSize = ulRead32(pucSection + 20);
+            ulLink = ulRead32(pucSection + 24);
+            ullEntSize = ulRead32(pucSection + 36);
+        }
+        if (ulLink >= ulShNum || ullEntSize == 0 || ullOffset + ullSize > xImage.xSize) {
+            continue;
+        }
+        pucSection = pucData + ullShOff + (uint64_t)ulLink * ulShEntSize;
+        ullStrOffset = xImage.b64Bit ? ullRead64(pucSection + 24) : ulRead32(pucSection + 16);
+        ullStrSize = xImage.b64Bit ? ullRead64(pucSection + 32) : ulRead32(pucSection + 20);
+        if (ullStrOffset + ullStrSize > xImage.xSize) {
+            continue;
+        }
+        pucStrings = pucData + ullStrOffset;
+
+        xImage.pxSymbols = calloc((size_t)(ullSize / ullEntSize), sizeof(Symbol_t));
+        if (xImage.pxSymbols == NULL) {
+            fprintf(stderr, "pcprof: out of memory\n");
+            return false;
+        }
+
+        for (uint64_t ullEntry = 0; ullEntry < ullSize / ullEntSize; ullEntry++) {
+            const uint8_t *pucSymbol = pucData + ullOffset + ullEntry * ullEntSize;
+            uint32_t ulName = ulRead32(pucSymbol);
+            uint8_t ucInfo = xImage.b64Bit ? pucSymbol[4] : pucSymbol[12];
+            uint16_t usSection = usRead16(pucSymbol + (xImage.b64Bit ? 6 : 14));
+            uint64_t ullValue = xImage.b64Bit ? ullRead64(pucSymbol + 8) : ulRead32(pucSymbol + 4);
+            uint64_t ullSymbolSize = xImage.b64Bit ? ullRead64(pucSymbol + 16) : ulRead32(pucSymbol + 8);
+            const char *pcName;
+
+            if ((ucInfo & 0xF) != ELF_STT_FUNC || usSection == 0 || ulName >= ullStrSize) {
+                continue;
+            }
+            pcName = (const char *)pucStrings + ulName;
+            if (strcmp(pcName, "vProfilerStart") == 0) {
+                xImage.ullBase = ullValue;
+                bBaseFound = true;
+            }
+
+            xImage.pxSymbols[xImage.ulSymbols].ullAddress = xImage.bThumb ? (ullValue & ~1ULL) : ullValue;
+            xImage.pxSymbols[xImage.ulSymbols].ullSize = ullSymbolSize;
+            xImage.pxSymbols[xImage.ulSymbols].pcName = pcName;
+            xImage.ulSymbols++;
+        }
+        break;
+    }
+
+    if (!bBaseFound) {
+        fprintf(stderr, "pcprof: %s has no vProfilerStart symbol (stripped, or built without the profiler)\n",
+                pcPath);
+        return false;
+    }
+
+    qsort(xImage.pxSymbols, xImage.ulSymbols, sizeof(Symbol_t), iCompareSymbols);
+    return true;
+}
+
+/**
+ * @brief Index of the function containing ullAddress, or PCPROF_UNKNOWN
+ *
+ * Symbols without a size extend to the next symbol.
+ */
+static uint32_t ulLookup(uint64_t ullAddress)
+{
+    uint32_t ulLow = 0;
+    uint32_t ulHigh = xImage.ulSymbols;
+    const Symbol_t *pxSymbol;
+
+    while (ulLow < ulHigh) {
+        uint32_t ulMid = ulLow + (ulHigh - ulLow) / 2;
+
+        if (xImage.pxSymbols[ulMid].ullAddress <= ullAddress) {
+            ulLow = ulMid + 1;
+        } else {
+            ulHigh = ulMid;
+        }
+    }
+    if (ulLow == 0) {
+        return PCPROF_UNKNOWN;
+    }
+
+    /* First of the symbols sharing this address */
+    ulLow--;
+    while (ulLow > 0 && xImage.pxSymbols[ulLow - 1].ullAddress == xImage.pxSymbols[ulLow].ullAddress) {
+        ulLow--;
+    }
+    pxSymbol = &xImage.pxSymbols[ulLow];
+
+    if (pxSymbol->ullSize != 0) {
+        return (ullAddress < pxSymbol->ullAddress + pxSymbol->ullSize) ? ulLow : PCPROF_UNKNOWN;
+    }
+    return ulLow;
+}
+
+/**
+ * @brief Absolute link-time address of a vProfilerStart()-relative offset
+ */
+static uint64_t ullAbsolute(uint32_t ulOffset)
+{
+    uint64_t ullAddress = xImage.ullBase + (uint64_t)(int64_t)(int32_t)ulOffset;
+
+    if (!xImage.b64Bit) {
+        ullAddress &= UINT32_MAX;
+    }
+    if (xImage.bThumb) {
+        ullAddress &= ~1ULL;
+    }
+    return ullAddress;
+}
+
+static void vResolve(const ProfileSample_t *pxSample, Resolved_t *pxResolved)
+{
+    pxResolved->ucTaskID = pxSample->ucTaskID;
+    pxResolved->bHandler = (pxSample->ucFlags & PROFILE_SAMPLE_HANDLER) != 0;
+    pxResolved->ulFunction = ulLookup(ullAbsolute(pxSample->ulPc));
+    pxResolved->ulCaller = PCPROF_UNKNOWN;
+
+    if (pxSample->ucFlags & PROFILE_SAMPLE_LR) {
+        /* The return address may be just past a call that ends its function */
+        uint64_t ullReturn = ullAbsolute(pxSample->ulLr);
+
+        if (ullReturn != 0) {
+            pxResolved->ulCaller = ulLookup(ullReturn - 1);
+        }
+        if (pxResolved->ulCaller == pxResolved->ulFunction) {
+            pxResolved->ulCaller = PCPROF_UNKNOWN;
+        }
+    }
+}
+
+static const char *pcFunctionName(uint32_t ulFunction)
+{
+    return (ulFunction == PCPROF_UNKNOWN) ? "[unknown]" : xImage.pxSymbols[ulFunction].pcName;
+}
+
+static const char *pcTaskName(uint8_t ucTaskID)
+{
+    static char pcFallback[16];
+
+    if (pcTaskNames[ucTaskID][0] != '\0') {
+        return pcTaskNames[ucTaskID];
+    }
+    if (ucTaskID == 0) {
+        return "Idle";
+    }
+    snprintf(pcFallback, sizeof(pcFallback), "task%u", ucTaskID);
+    return pcFallback;
+}
+
+/**
+ * @brief Remember the task names of a snapshot frame
+ */
+static void vTakeSnapshot(const uint8_t *pucPayload, uint32_t ulLength)
+{
+    TelemetrySnapshot_t xSnapshot;
+
+    if (ulLength != sizeof(xSnapshot)) {
+        return;
+    }
+    memcpy(&xSnapshot, pucPayload, sizeof(xSnapshot));
+    if (xSnapshot.ulMagic != TELEMETRY_SNAPSHOT_MAGIC || xSnapshot.usVersion != TELEMETRY_SNAPSHOT_VERSION) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < xSnapshot.ucTaskRecords && i < MAX_TASKS; i++) {
+        const TaskTelemetry_t *pxTask = &xSnapshot.xTasks[i];
+
+        if ((pxTask->ucFlags & TASK_TELEMETRY_FLAG_IN_USE) && pxTask->ulTaskID < PCPROF_MAX_TASKS) {
+            memcpy(pcTaskNames[pxTask->ulTaskID], pxTask->pcTaskName, 16);
+            pcTaskNames[pxTask->ulTaskID][16] = '\0';
+        }
+    }
+}
+
+/**
+ * @brief Append the samples of a profiler frame
+ */
+static void vTakeProfile(const uint8_t *pucPayload, uint32_t ulLength, uint8_t ucSequence)
+{
+    ProfileFrameHeader_t xHeader;
+
+    if (ulLength < sizeof(xHeader)) {
+        ulFramesBad++;
+        return;
+    }
+    memcpy(&xHeader, pucPayload, sizeof(xHeader));
+    if (xHeader.ulMagic != PROFILE_FRAME_MAGIC || xHeader.usSampleSize != sizeof(ProfileSample_t) ||
+        sizeof(xHeader) + (uint32_t)xHeader.usCount * xHeader.usSampleSize != ulLength) {
+        ulFramesBad++;
+        return;
+    }
+
+    if (lLastProfileSequence >= 0 && (uint8_t)(lLastProfileSequence + 1) != ucSequence) {
+        ulProfileFramesLost += (uint8_t)(ucSequence - lLastProfileSequence - 1);
+    }
+    lLastProfileSequence = ucSequence;
+    xLastHeader = xHeader;
+
+    if (ulSampleCount + xHeader.usCount > ulSampleCapacity) {
+        uint32_t ulCapacity = ulSampleCapacity ? ulSampleCapacity * 2 : 4096;
+        ProfileSample_t *pxGrown;
+
+        while (ulCapacity < ulSampleCount + xHeader.usCount) {
+            ulCapacity *= 2;
+        }
+        pxGrown = realloc(pxSamples, (size_t)ulCapacity * sizeof(ProfileSample_t));
+        if (pxGrown == NULL) {
+            fprintf(stderr, "pcprof: out of memory\n");
+            exit(2);
+        }
+        pxSamples = pxGrown;
+        ulSampleCapacity = ulCapacity;
+    }
+    memcpy(&pxSamples[ulSampleCount], pucPayload + sizeof(xHeader),
+           (size_t)xHeader.usCount * sizeof(ProfileSample_t));
+    ulSampleCount += xHeader.usCount;
+}
+
+/**
+ * @brief Validate and dispatch one COBS-encoded frame (delimiter stripped)
+ */
+static void vHandleFrame(const uint8_t *pucEncoded, uint32_t ulEncodedLength)
+{
+    uint8_t ucFrame[RX_FRAME_MAX];
+    uint32_t ulLength;
+    uint16_t usCrc;
+
+    if (ulEncodedLength == 0) {
+        return;
+    }
+
+    ulLength = ulCobsDecode(pucEncoded, ulEncodedLength, ucFrame);
+    if (ulLength < TELEMETRY_FRAME_OVERHEAD) {
+        ulFramesBad++;
+        return;
+    }
+    usCrc = usCrc16Update(0xFFFF, ucFrame, ulLength - 2);
+    if (ucFrame[ulLength - 2] != (usCrc & 0xFF) || ucFrame[ulLength - 1] != (usCrc >> 8)) {
+        ulFramesBad++;
+        return;
+    }
+
+    if (ucFrame[0] == TELEMETRY_CHANNEL_TELEMETRY) {
+        vTakeSnapshot(&ucFrame[2], ulLength - TELEMETRY_FRAME_OVERHEAD);
+    } else if (ucFrame[0] == TELEMETRY_CHANNEL_PROFILE) {
+        vTakeProfile(&ucFrame[2], ulLength - TELEMETRY_FRAME_OVERHEAD, ucFrame[1]);
+    }
+}
+
+static int iCompareByStack(const void *pvA, const void *pvB)
+{
+    const Resolved_t *pxA = (const Resolved_t *)pvA;
+    const Resolved_t *pxB = (const Resolved_t *)pvB;
+
+    if (pxA->ucTaskID != pxB->ucTaskID) {
+        return (int)pxA->ucTaskID - (int)pxB->ucTaskID;
+    }
+    if (pxA->bHandler != pxB->bHandler) {
+        return (int)pxA->bHandler - (int)pxB->bHandler;
+    }
+    if (pxA->ulCaller != pxB->ulCaller) {
+        return (pxA->ulCaller < pxB->ulCaller) ? -1 : 1;
+    }
+    if (pxA->ulFunction != pxB->ulFunction) {
+        return (pxA->ulFunction < pxB->ulFunction) ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief One line per distinct stack: task;[handler;][caller;]function count
+ */
+static void vPrintCollapsed(Resolved_t *pxResolved)
+{
+    qsort(pxResolved, ulSampleCount, sizeof(Resolved_t), iCompareByStack);
+
+    for (uint32_t i = 0; i < ulSampleCount;) {
+        uint32_t j = i + 1;
+
+        while (j < ulSampleCount && iCompareByStack(&pxResolved[i], &pxResolved[j]) == 0) {
+            j++;
+        }
+        printf("%s;", pcTaskName(pxResolved[i].ucTaskID));
+        if (pxResolved[i].bHandler) {
+            printf("[handler];");
+        }
+        if (pxResolved[i].ulCaller != PCPROF_UNKNOWN) {
+            printf("%s;", pcFunctionName(pxResolved[i].ulCaller));
+        }
+        printf("%s %u\n", pcFunctionName(pxResolved[i].ulFunction), j - i);
+        i = j;
+    }
+}
+
+typedef struct {
+    uint32_t ulFunction;
+    uint32_t ulCount;
+    uint32_t ulHandler;
+} FlatEntry_t;
+
+static int iCompareByCount(const void *pvA, const void *pvB)
+{
+    const FlatEntry_t *pxA = (const FlatEntry_t *)pvA;
+    const FlatEntry_t *pxB = (const FlatEntry_t *)pvB;
+
+    if (pxA->ulCount != pxB->ulCount) {
+        return (pxA->ulCount > pxB->ulCount) ? -1 : 1;
+    }
+    return (pxA->ulFunction < pxB->ulFunction) ? -1 : (pxA->ulFunction > pxB->ulFunction);
+}
+
+/**
+ * @brief Per task: samples by function, most frequent first
+ */
+static void vPrintFlat(const Resolved_t *pxResolved)
+{
+    uint32_t pulTaskSamples[PCPROF_MAX_TASKS] = { 0 };
+    FlatEntry_t *pxEntries = calloc((size_t)xImage.ulSymbols + 1, sizeof(FlatEntry_t));
+
+    if (pxEntries == NULL) {
+        fprintf(stderr, "pcprof: out of memory\n");
+        exit(2);
+    }
+    for (uint32_t i = 0; i < ulSampleCount; i++) {
+        pulTaskSamples[pxResolved[i].ucTaskID]++;
+    }
+
+    for (uint32_t ulTask = 0; ulTask < PCPROF_MAX_TASKS; ulTask++) {
+        uint32_t ulEntries = 0;
+
+        if (pulTaskSamples[ulTask] == 0) {
+            continue;
+        }
+
+        memset(pxEntries, 0, ((size_t)xImage.ulSymbols + 1) * sizeof(FlatEntry_t));
+        for (uint32_t i = 0; i < ulSampleCount; i++) {
+            uint32_t ulSlot;
+
+            if (pxResolved[i].ucTaskID != ulTask) {
+                continue;
+            }
+            ulSlot = (pxResolved[i].ulFunction == PCPROF_UNKNOWN) ? xImage.ulSymbols : pxResolved[i].ulFunction;
+            pxEntries[ulSlot].ulFunction = pxResolved[i].ulFunction;
+            pxEntries[ulSlot].ulCount++;
+            pxEntries[ulSlot].ulHandler += pxResolved[i].bHandler ? 1 : 0;
+        }
+        for (uint32_t i = 0; i <= xImage.ulSymbols; i++) {
+            if (pxEntries[i].ulCount != 0) {
+                pxEntries[ulEntries++] = pxEntries[i];
+            }
+        }
+        qsort(pxEntries, ulEntries, sizeof(FlatEntry_t), iCompareByCount);
+
+        printf("\n%s (id %u): %u samples, %.1f%% of all\n", pcTaskName((uint8_t)ulTask), ulTask,
+               pulTaskSamples[ulTask], 100.0 * pulTaskSamples[ulTask] / ulSampleCount);
+        printf("  %8s %7s %7s %8s  %s\n", "samples", "task%", "total%", "handler", "function");
+        for (uint32_t i = 0; i < ulEntries; i++) {
+            printf("  %8u %6.1f%% %6.1f%% %8u  %s\n", pxEntries[i].ulCount,
+                   100.0 * pxEntries[i].ulCount / pulTaskSamples[ulTask],
+                   100.0 * pxEntries[i].ulCount / ulSampleCount,
+                   pxEntries[i].ulHandler, pcFunctionName(pxEntries[i].ulFunction));
+        }
+    }
+
+    free(pxEntries);
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t ucEncoded[RX_FRAME_MAX];
+    uint32_t ulFill = 0;
+    bool bOverflow = false;
+    bool bCollapsed = false;
+    FILE *pxInput = stdin;
+    Resolved_t *pxResolved;
+    int iOption;
+    int lByte;
+
+    while ((iOption = getopt(argc, argv, "ch")) != -1) {
+        switch (iOption) {
+            case 'c': bCollapsed = true; break;
+            default:
+                vPrintUsage();
+                return 2;
+        }
+    }
+    if (optind >= argc) {
+        vPrintUsage();
+        return 2;
+    }
+    if (!bLoadImage(argv[optind])) {
+        return 2;
+    }
+    if (optind + 1 < argc && strcmp(argv[optind + 1], "-") != 0) {
+        pxInput = fopen(argv[optind + 1], "rb");
+        if (pxInput == NULL) {
+            perror(argv[optind + 1]);
+            return 2;
+        }
+    }
+
+    while ((lByte = fgetc(pxInput)) != EOF) {
+        if (lByte == 0x00) {
+            if (bOverflow) {
+                ulFramesBad++;
+            } else {
+                vHandleFrame(ucEncoded, ulFill);
+            }
+            ulFill = 0;
+            bOverflow = false;
+        } else if (ulFill < sizeof(ucEncoded)) {
+            ucEncoded[ulFill++] = (uint8_t)lByte;
+        } else {
+            bOverflow = true;
+        }
+    }
+
+    fprintf(stderr, "pcprof: %u samples at %u Hz; device took %u, dropped %u (ring full); "
+            "%u profile frame(s) lost, %u bad frame(s)\n",
+            ulSampleCount, xLastHeader.ulSampleHz, xLastHeader.ulSamples, xLastHeader.ulDropped,
+            ulProfileFramesLost, ulFramesBad);
+    if (ulSampleCount == 0) {
+        return 1;
+    }
+
+    pxResolved = calloc(ulSampleCount, sizeof(Resolved_t));
+    if (pxResolved == NULL) {
+        fprintf(stderr, "pcprof: out of memory\n");
+        return 2;
+    }
+    for (uint32_t i = 0; i < ulSampleCount; i++) {
+        vResolve(&pxSamples[i], &pxResolved[i]);
+    }
+
+    if (bCollapsed) {
+        vPrintCollapsed(pxResolved);
+    } else {
+        vPrintFlat(pxResolved);
+    }
+
+    free(pxResolved);
+    free(pxSamples);
+    free(xImage.pxSymbols);
+    free(xImage.pucData);
+
+    return 0;
+}
@@ -0,0 +1,394 @@
+/**
+ * @file main.c
+ * @brief rmpart - partitioned Rate Monotonic scheduling on simulated cores
+ *
+ * Usage: rmpart [options] [taskset-file|-]
+ *   -m CORES      number of cores (default 2)
+ *   -a ff|wf      allocation: first-fit or worst-fit decreasing (default ff)
+ *   -j N          host threads (default one per core)
+ *   -g N          generate N tasks (UUniFast) instead of reading a file
+ *   -u U          total utilization for -g (default 0.7 per core)
+ *   -p MIN:MAX    period range in ticks for -g (default 10:1000)
+ *   -b RATIO      BCET/WCET ratio; execution times are sampled in [RATIO*WCET, WCET]
+ *   -s SEED       random seed for generation and sampling (default 1)
+ *   -H N          simulate N hyperperiods (default 10, capped by the tick range)
+ *   -t TICKS      simulate TICKS ticks (overrides -H)
+ *   -c FILE       write per-task allocation and results as CSV ("-" for stdout)
+ *   -q            summary only
+ *
+ * Tasks are allocated with bRmPartition() (per-core RTA admission), then
+ * every core's partition is simulated by rmsim on a thread of its own. A
+ * core's task set, ready bitmap and release heap are allocated by the
+ * thread that runs it and nothing is shared until the results are merged,
+ * so throughput scales with the number of host CPUs.
+ *
+ * Exits with status 1 if a task could not be placed or any job missed its
+ * deadline or lost a release.
+ */
+
+#include "rmsim.h"
+#include "rm_partition.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RMPART_DEFAULT_HORIZON   1000000UL
+#define RMPART_TABLE_MAX_TASKS   32
+
+typedef struct {
+    uint32_t ulCore;
+    const TaskSet_t *pxAll;          /* Whole task set, read only */
+    const uint32_t *pulCore;         /* Allocation, read only */
+    SimConfig_t xConfig;
+
+    /* Owned by the thread that simulates this core */
+    TaskSet_t xSet;                  /* The core's partition */
+    uint32_t *pulTask;               /* Partition index -> task set index */
+    SimResult_t xResult;
+    bool bSimulated;
+} CoreRun_t;
+
+typedef struct {
+    CoreRun_t *pxCores;
+    uint32_t ulCores;
+    uint32_t ulThread;
+    uint32_t ulThreads;
+    pthread_t xThread;
+} Worker_t;
+
+static void vPrintUsage(void)
+{
+    fprintf(stderr,
+            "usage: rmpart [-m CORES] [-a ff|wf] [-j THREADS] [-g N [-u U] [-p MIN:MAX]]\n"
+            "              [-b RATIO] [-s SEED] [-H N | -t TICKS] [-c tasks.csv] [-q] [taskset|-]\n");
+}
+
+/**
+ * @brief Build and simulate one core's partition
+ */
+static void vRunCore(CoreRun_t *pxRun)
+{
+    const TaskSet_t *pxAll = pxRun->pxAll;
+    uint32_t ulTasks = 0;
+
+    for (uint32_t i = 0; i < pxAll->ulCount; i++) {
+        if (pxRun->pulCore[i] == pxRun->ulCore) {
+            ulTasks++;
+        }
+    }
+    if (ulTasks == 0 || !bTaskSetInit(&pxRun->xSet, ulTasks)) {
+        return;
+    }
+    pxRun->pulTask = malloc(ulTasks * sizeof(uint32_t));
+    if (pxRun->pulTask == NULL) {
+        return;
+    }
+
+    /* Task order is kept, so RM ties break as in the analysis */
+    for (uint32_t i = 0; i < pxAll->ulCount; i++) {
+        if (pxRun->pulCore[i] == pxRun->ulCore) {
+            pxRun->pulTask[pxRun->xSet.ulCount] = i;
+            bTaskSetAdd(&pxRun->xSet, pxAll->pcName[i], pxAll->pulPeriod[i], pxAll->pulDeadline[i],
+                        pxAll->pulWcet[i], pxAll->pulBcet[i]);
+        }
+    }
+
+    pxRun->bSimulated = bSimRun(&pxRun->xSet, &pxRun->xConfig, &pxRun->xResult);
+}
+
+static void *pvWorkerMain(void *pvArgument)
+{
+    Worker_t *pxWorker = pvArgument;
+
+    for (uint32_t c = pxWorker->ulThread; c < pxWorker->ulCores; c += pxWorker->ulThreads) {
+        vRunCore(&pxWorker->pxCores[c]);
+    }
+    return NULL;
+}
+
+static void vWriteTaskCsv(FILE *pxFile, const TaskSet_t *pxSet, const uint32_t *pulCore,
+                          const CoreRun_t *pxCores, uint32_t ulCores)
+{
+    fprintf(pxFile, "task,core,period,deadline,wcet_us,utilization,priority,jobs,misses,dropped,"
+                    "response_max_us\n");
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        double dUtil = (double)pxSet->pulWcet[i] / ((double)pxSet->pulPeriod[i] * TASKSET_TICK_US);
+
+        if (pulCore[i] == RM_PARTITION_UNASSIGNED) {
+            fprintf(pxFile, "%s,,%u,%u,%u,%.4f,,,,,\n", pxSet->pcName[i], pxSet->pulPeriod[i],
+                    pxSet->pulDeadline[i], pxSet->pulWcet[i], dUtil);
+        }
+    }
+    for (uint32_t c = 0; c < ulCores; c++) {
+        const CoreRun_t *pxRun = &pxCores[c];
+
+        if (!pxRun->bSimulated) {
+            continue;
+        }
+        for (uint32_t k = 0; k < pxRun->xSet.ulCount; k++) {
+            uint32_t i = pxRun->pulTask[k];
+            double dUtil = (double)pxSet->pulWcet[i] / ((double)pxSet->pulPeriod[i] * TASKSET_TICK_US);
+
+            fprintf(pxFile, "%s,%u,%u,%u,%u,%.4f,%u,%llu,%llu,%llu,%llu\n",
+                    pxSet->pcName[i], c, pxSet->pulPeriod[i], pxSet->pulDeadline[i],
+                    pxSet->pulWcet[i], dUtil, pxRun->xResult.pulPriority[k],
+                    (unsigned long long)pxRun->xResult.pullJobs[k],
+                    (unsigned long long)pxRun->xResult.pullMisses[k],
+                    (unsigned long long)pxRun->xResult.pullDropped[k],
+                    (unsigned long long)pxRun->xResult.pullResponseMax[k]);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    TaskSet_t xSet;
+    SimConfig_t xConfig = { 0 };
+    uint32_t ulCores = 2;
+    uint32_t ulThreads = 0;
+    RmPartitionHeuristic_t eHeuristic = RM_PARTITION_FIRST_FIT;
+    uint32_t ulGenerate = 0;
+    double dUtilization = 0.0;
+    uint32_t ulPeriodMin = 10, ulPeriodMax = 1000;
+    double dBcetRatio = 1.0;
+    uint64_t ullSeed = 1;
+    uint32_t ulHyperperiods = 10;
+    uint32_t ulTicks = 0;
+    const char *pcCsvPath = NULL;
+    bool bQuiet = false;
+    uint32_t *pulCore;
+    uint32_t *pulScratch;
+    bool bPlaced;
+    CoreRun_t *pxCores;
+    Worker_t *pxWorkers;
+    uint64_t ullHyperperiod;
+    uint64_t ullEvents = 0, ullJobs = 0, ullMisses = 0, ullDropped = 0;
+    struct timespec xStart, xEnd;
+    double dSeconds;
+    int iOption;
+    int iStatus = 0;
+
+    while ((iOption = getopt(argc, argv, "m:a:j:g:u:p:b:s:H:t:c:qh")) != -1) {
+        switch (iOption) {
+            case 'm': ulCores = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'a':
+                if (strcmp(optarg, "ff") == 0) {
+                    eHeuristic = RM_PARTITION_FIRST_FIT;
+                } else if (strcmp(optarg, "wf") == 0) {
+                    eHeuristic = RM_PARTITION_WORST_FIT;
+                } else {
+                    vPrintUsage();
+                    return 2;
+                }
+                break;
+            case 'j': ulThreads = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'g': ulGenerate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'u': dUtilization = strtod(optarg, NULL); break;
+            case 'p':
+                if (sscanf(optarg, "%u:%u", &ulPeriodMin, &ulPeriodMax) != 2) {
+                    vPrintUsage();
+                    return 2;
+                }
+                break;
+            case 'b': dBcetRatio = strtod(optarg, NULL); break;
+            case 's': ullSeed = strtoull(optarg, NULL, 0); break;
+            case 'H': ulHyperperiods = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': ulTicks = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': pcCsvPath = optarg; break;
+            case 'q': bQuiet = true; break;
+            default:
+                vPrintUsage();
+                return 2;
+        }
+    }
+    if (ulCores == 0) {
+        vPrintUsage();
+        return 2;
+    }
+    if (ulThreads == 0 || ulThreads > ulCores) {
+        ulThreads = ulCores;
+    }
+
+    if (!bTaskSetInit(&xSet, ulGenerate)) {
+        fprintf(stderr, "rmpart: out of memory\n");
+        return 2;
+    }
+
+    if (ulGenerate > 0) {
+        uint64_t ullGeneratorSeed = ullSeed;
+
+        if (dUtilization <= 0.0) {
+            dUtilization = 0.7 * ulCores;
+        }
+        if (!bTaskSetGenerate(&xSet, ulGenerate, dUtilization, ulPeriodMin, ulPeriodMax,
+                              dBcetRatio, &ullGeneratorSeed)) {
+            fprintf(stderr, "rmpart: cannot generate task set\n");
+            return 2;
+        }
+    } else {
+        if (optind >= argc) {
+            vPrintUsage();
+            return 2;
+        }
+        if (!bTaskSetLoad(&xSet, argv[optind])) {
+            return 2;
+        }
+        if (dBcetRatio < 1.0) {
+            for (uint32_t i = 0; i < xSet.ulCount; i++) {
+                xSet.pulBcet[i] = (uint32_t)(xSet.pulWcet[i] * dBcetRatio);
+            }
+        }
+    }
+    if (xSet.ulCount == 0) {
+        fprintf(stderr, "rmpart: empty task set\n");
+        return 2;
+    }
+
+    /* Allocation */
+    pulCore = malloc(xSet.ulCount * sizeof(uint32_t));
+    pulScratch = malloc(RM_PARTITION_SCRATCH_WORDS(xSet.ulCount, ulCores) * sizeof(uint32_t));
+    pxCores = calloc(ulCores, sizeof(CoreRun_t));
+    pxWorkers = calloc(ulThreads, sizeof(Worker_t));
+    if (pulCore == NULL || pulScratch == NULL || pxCores == NULL || pxWorkers == NULL) {
+        fprintf(stderr, "rmpart: out of memory\n");
+        return 2;
+    }
+    bPlaced = bRmPartition(xSet.ulCount, xSet.pulPeriod, xSet.pulDeadline, xSet.pulWcet,
+                           ulCores, eHeuristic, pulCore, pulScratch);
+
+    /* Horizon: explicit ticks, else N hyperperiods of the whole set if that fits */
+    ullHyperperiod = ullTaskSetHyperperiod(&xSet);
+    if (ulTicks != 0) {
+        xConfig.ulHorizon = ulTicks;
+    } else if (ullHyperperiod != 0 && ullHyperperiod * ulHyperperiods <= UINT32_MAX / 2) {
+        xConfig.ulHorizon = (uint32_t)(ullHyperperiod * ulHyperperiods);
+    } else {
+        xConfig.ulHorizon = RMPART_DEFAULT_HORIZON;
+    }
+
+    for (uint32_t c = 0; c < ulCores; c++) {
+        pxCores[c].ulCore = c;
+        pxCores[c].pxAll = &xSet;
+        pxCores[c].pulCore = pulCore;
+        pxCores[c].xConfig = xConfig;
+        /* Per-core sampling stream, independent of the thread count */
+        pxCores[c].xConfig.ullSeed = ullSeed + c;
+    }
+
+    /* One thread per core (or -j threads taking cores round robin); thread 0 is main */
+    clock_gettime(CLOCK_MONOTONIC, &xStart);
+    for (uint32_t t = 0; t < ulThreads; t++) {
+        pxWorkers[t].pxCores = pxCores;
+        pxWorkers[t].ulCores = ulCores;
+        pxWorkers[t].ulThread = t;
+        pxWorkers[t].ulThreads = ulThreads;
+    }
+    for (uint32_t t = 1; t < ulThreads; t++) {
+        if (pthread_create(&pxWorkers[t].xThread, NULL, pvWorkerMain, &pxWorkers[t]) != 0) {
+            fprintf(stderr, "rmpart: cannot start thread %u\n", t);
+            return 2;
+        }
+    }
+    pvWorkerMain(&pxWorkers[0]);
+    for (uint32_t t = 1; t < ulThreads; t++) {
+        pthread_join(pxWorkers[t].xThread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &xEnd);
+    dSeconds = (double)(xEnd.tv_sec - xStart.tv_sec) + (double)(xEnd.tv_nsec - xStart.tv_nsec) * 1e-9;
+
+    printf("tasks %u, utilization %.3f, cores %u (%s-fit decreasing), simulated %u ticks\n",
+           xSet.ulCount, dTaskSetUtilization(&xSet), ulCores,
+           (eHeuristic == RM_PARTITION_WORST_FIT) ? "worst" : "first", xConfig.ulHorizon);
+    printf("  %4s %6s %7s %4s %10s %8s %8s %8s\n",
+           "core", "tasks", "util", "rta", "jobs", "misses", "dropped", "busy");
+    for (uint32_t c = 0; c < ulCores; c++) {
+        CoreRun_t *pxRun = &pxCores[c];
+        double dUtil = (double)ullRmCoreUtilization(c, xSet.ulCount, xSet.pulPeriod,
+                                                    xSet.pulWcet, pulCore) / RM_ANALYSIS_Q30_ONE;
+        bool bRta = bRmCoreSchedulable(c, xSet.ulCount, xSet.pulPeriod, xSet.pulDeadline,
+                                       xSet.pulWcet, pulCore, pulScratch);
+
+        if (!pxRun->bSimulated) {
+            printf("  %4u %6u %7.3f %4s %10s %8s %8s %8s\n", c, 0U, dUtil, bRta ? "ok" : "FAIL",
+                   "-", "-", "-", "-");
+            continue;
+        }
+        printf("  %4u %6u %7.3f %4s %10llu %8llu %8llu %7.2f%%\n", c, pxRun->xSet.ulCount, dUtil,
+               bRta ? "ok" : "FAIL",
+               (unsigned long long)pxRun->xResult.ullJobs,
+               (unsigned long long)pxRun->xResult.ullMisses,
+               (unsigned long long)pxRun->xResult.ullDropped,
+               pxRun->xResult.ullSimulatedTime ?
+                   100.0 * (double)pxRun->xResult.ullBusyTime / (double)pxRun->xResult.ullSimulatedTime : 0.0);
+
+        ullEvents += pxRun->xResult.ullEvents;
+        ullJobs += pxRun->xResult.ullJobs;
+        ullMisses += pxRun->xResult.ullMisses;
+        ullDropped += pxRun->xResult.ullDropped;
+    }
+
+    if (!bPlaced) {
+        printf("unplaced:");
+        for (uint32_t i = 0; i < xSet.ulCount; i++) {
+            if (pulCore[i] == RM_PARTITION_UNASSIGNED) {
+                printf(" %s", xSet.pcName[i]);
+            }
+        }
+        printf("\n");
+        iStatus = 1;
+    }
+    printf("jobs %llu, misses %llu, dropped releases %llu\n",
+           (unsigned long long)ullJobs, (unsigned long long)ullMisses, (unsigned long long)ullDropped);
+    printf("events %llu in %.3f s on %u threads (%.2f M events/s)\n",
+           (unsigned long long)ullEvents, dSeconds, ulThreads,
+           dSeconds > 0.0 ? (double)ullEvents / dSeconds * 1e-6 : 0.0);
+
+    if (!bQuiet && pcCsvPath == NULL && xSet.ulCount <= RMPART_TABLE_MAX_TASKS) {
+        printf("  %-15s %4s %7s %7s %9s %7s\n", "task", "core", "period", "dline", "wcet_us", "util");
+        for (uint32_t i = 0; i < xSet.ulCount; i++) {
+            char pcCore[12] = "-";
+
+            if (pulCore[i] != RM_PARTITION_UNASSIGNED) {
+                snprintf(pcCore, sizeof(pcCore), "%u", pulCore[i]);
+            }
+            printf("  %-15s %4s %7u %7u %9u %7.3f\n", xSet.pcName[i], pcCore, xSet.pulPeriod[i],
+                   xSet.pulDeadline[i], xSet.pulWcet[i],
+                   (double)xSet.pulWcet[i] / ((double)xSet.pulPeriod[i] * TASKSET_TICK_US));
+        }
+    }
+
+    if (pcCsvPath != NULL) {
+        FILE *pxCsv = (strcmp(pcCsvPath, "-") == 0) ? stdout : fopen(pcCsvPath, "w");
+
+        if (pxCsv == NULL) {
+            perror(pcCsvPath);
+            return 2;
+        }
+        vWriteTaskCsv(pxCsv, &xSet, pulCore, pxCores, ulCores);
+        if (pxCsv != stdout) {
+            fclose(pxCsv);
+        }
+    }
+
+    if (ullMisses != 0 || ullDropped != 0) {
+        iStatus = 1;
+    }
+
+    for (uint32_t c = 0; c < ulCores; c++) {
+        if (pxCores[c].bSimulated) {
+            vSimResultFree(&pxCores[c].xResult);
+        }
+        vTaskSetFree(&pxCores[c].xSet);
+        free(pxCores[c].pulTask);
+    }
+    free(pxWorkers);
+    free(pxCores);
+    free(pulScratch);
+    free(pulCore);
+    vTaskSetFree(&xSet);
+
+    return iStatus;
+}
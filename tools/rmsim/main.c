@@ -0,0 +1,221 @@
+/**
+ * @file main.c
+ * @brief rmsim - simulate a periodic task set under the periodRTOS scheduler
+ *
+ * Usage: rmsim [options] [taskset-file|-]
+ *   -g N          generate N tasks (UUniFast) instead of reading a file
+ *   -u U          total utilization for -g (default 0.7)
+ *   -p MIN:MAX    period range in ticks for -g (default 10:1000)
+ *   -b RATIO      BCET/WCET ratio; execution times are sampled in [RATIO*WCET, WCET]
+ *   -s SEED       random seed for generation and sampling (default 1)
+ *   -H N          simulate N hyperperiods (default 10, capped by the tick range)
+ *   -t TICKS      simulate TICKS ticks (overrides -H)
+ *   -L LEVELS     priority levels (default MAX_PRIORITY_LEVELS, 0 = one per task)
+ *   -T FILE       write the event trace as CSV
+ *   -c FILE       write per-task results as CSV ("-" for stdout)
+ *   -q            summary only
+ *
+ * Exits with status 1 if any job missed its deadline or lost a release.
+ */
+
+#include "rmsim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Horizon when the hyperperiod is too large to simulate several of */
+#define RMSIM_DEFAULT_HORIZON    1000000UL
+#define RMSIM_TABLE_MAX_TASKS    32
+
+static void vPrintUsage(void)
+{
+    fprintf(stderr,
+            "usage: rmsim [-g N [-u U] [-p MIN:MAX]] [-b RATIO] [-s SEED]\n"
+            "             [-H N | -t TICKS] [-L LEVELS] [-T trace.csv] [-c tasks.csv] [-q]\n"
+            "             [taskset|-]\n");
+}
+
+static void vWriteTaskCsv(FILE *pxFile, const TaskSet_t *pxSet, const SimResult_t *pxResult)
+{
+    fprintf(pxFile, "task,priority,period,deadline,wcet_us,bcet_us,jobs,completed,misses,dropped,"
+                    "response_avg_us,response_max_us\n");
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        uint64_t ullAverage = pxResult->pullCompleted[i] ?
+                              pxResult->pullResponseSum[i] / pxResult->pullCompleted[i] : 0;
+
+        fprintf(pxFile, "%s,%u,%u,%u,%u,%u,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                pxSet->pcName[i], pxResult->pulPriority[i], pxSet->pulPeriod[i],
+                pxSet->pulDeadline[i], pxSet->pulWcet[i], pxSet->pulBcet[i],
+                (unsigned long long)pxResult->pullJobs[i],
+                (unsigned long long)pxResult->pullCompleted[i],
+                (unsigned long long)pxResult->pullMisses[i],
+                (unsigned long long)pxResult->pullDropped[i],
+                (unsigned long long)ullAverage,
+                (unsigned long long)pxResult->pullResponseMax[i]);
+    }
+}
+
+static void vPrintTaskTable(const TaskSet_t *pxSet, const SimResult_t *pxResult)
+{
+    printf("  %-15s %4s %7s %7s %9s %9s %7s %7s %9s %9s\n",
+           "task", "prio", "period", "dline", "wcet_us", "jobs", "misses", "dropped",
+           "avg_us", "max_us");
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        uint64_t ullAverage = pxResult->pullCompleted[i] ?
+                              pxResult->pullResponseSum[i] / pxResult->pullCompleted[i] : 0;
+
+        printf("  %-15s %4u %7u %7u %9u %9llu %7llu %7llu %9llu %9llu\n",
+               pxSet->pcName[i], pxResult->pulPriority[i], pxSet->pulPeriod[i],
+               pxSet->pulDeadline[i], pxSet->pulWcet[i],
+               (unsigned long long)pxResult->pullJobs[i],
+               (unsigned long long)pxResult->pullMisses[i],
+               (unsigned long long)pxResult->pullDropped[i],
+               (unsigned long long)ullAverage,
+               (unsigned long long)pxResult->pullResponseMax[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    TaskSet_t xSet;
+    SimConfig_t xConfig = { 0 };
+    SimResult_t xResult;
+    uint32_t ulGenerate = 0;
+    double dUtilization = 0.7;
+    uint32_t ulPeriodMin = 10, ulPeriodMax = 1000;
+    double dBcetRatio = 1.0;
+    uint64_t ullSeed = 1;
+    uint32_t ulHyperperiods = 10;
+    uint32_t ulTicks = 0;
+    uint32_t ulLevels = MAX_PRIORITY_LEVELS;
+    const char *pcTracePath = NULL;
+    const char *pcCsvPath = NULL;
+    bool bQuiet = false;
+    uint64_t ullHyperperiod;
+    struct timespec xStart, xEnd;
+    double dSeconds;
+    int iOption;
+
+    while ((iOption = getopt(argc, argv, "g:u:p:b:s:H:t:L:T:c:qh")) != -1) {
+        switch (iOption) {
+            case 'g': ulGenerate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'u': dUtilization = strtod(optarg, NULL); break;
+            case 'p':
+                if (sscanf(optarg, "%u:%u", &ulPeriodMin, &ulPeriodMax) != 2) {
+                    vPrintUsage();
+                    return 2;
+                }
+                break;
+            case 'b': dBcetRatio = strtod(optarg, NULL); break;
+            case 's': ullSeed = strtoull(optarg, NULL, 0); break;
+            case 'H': ulHyperperiods = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': ulTicks = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'L': ulLevels = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'T': pcTracePath = optarg; break;
+            case 'c': pcCsvPath = optarg; break;
+            case 'q': bQuiet = true; break;
+            default:
+                vPrintUsage();
+                return 2;
+        }
+    }
+
+    if (!bTaskSetInit(&xSet, ulGenerate)) {
+        fprintf(stderr, "rmsim: out of memory\n");
+        return 2;
+    }
+
+    if (ulGenerate > 0) {
+        uint64_t ullGeneratorSeed = ullSeed;
+        if (!bTaskSetGenerate(&xSet, ulGenerate, dUtilization, ulPeriodMin, ulPeriodMax,
+                              dBcetRatio, &ullGeneratorSeed)) {
+            fprintf(stderr, "rmsim: cannot generate task set\n");
+            return 2;
+        }
+    } else {
+        if (optind >= argc) {
+            vPrintUsage();
+            return 2;
+        }
+        if (!bTaskSetLoad(&xSet, argv[optind])) {
+            return 2;
+        }
+        if (dBcetRatio < 1.0) {
+            for (uint32_t i = 0; i < xSet.ulCount; i++) {
+                xSet.pulBcet[i] = (uint32_t)(xSet.pulWcet[i] * dBcetRatio);
+            }
+        }
+    }
+    if (xSet.ulCount == 0) {
+        fprintf(stderr, "rmsim: empty task set\n");
+        return 2;
+    }
+
+    /* Horizon: explicit ticks, else N hyperperiods if that fits */
+    ullHyperperiod = ullTaskSetHyperperiod(&xSet);
+    if (ulTicks != 0) {
+        xConfig.ulHorizon = ulTicks;
+    } else if (ullHyperperiod != 0 && ullHyperperiod * ulHyperperiods <= UINT32_MAX / 2) {
+        xConfig.ulHorizon = (uint32_t)(ullHyperperiod * ulHyperperiods);
+    } else {
+        xConfig.ulHorizon = RMSIM_DEFAULT_HORIZON;
+    }
+    xConfig.ullSeed = ullSeed;
+    xConfig.ulPriorityLevels = ulLevels;
+
+    if (pcTracePath != NULL) {
+        xConfig.pxTrace = fopen(pcTracePath, "w");
+        if (xConfig.pxTrace == NULL) {
+            perror(pcTracePath);
+            return 2;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &xStart);
+    if (!bSimRun(&xSet, &xConfig, &xResult)) {
+        fprintf(stderr, "rmsim: simulation failed (out of memory or horizon too long)\n");
+        return 2;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &xEnd);
+    dSeconds = (double)(xEnd.tv_sec - xStart.tv_sec) + (double)(xEnd.tv_nsec - xStart.tv_nsec) * 1e-9;
+
+    if (xConfig.pxTrace != NULL) {
+        fclose(xConfig.pxTrace);
+    }
+
+    printf("tasks %u, utilization %.3f, hyperperiod %llu ticks, simulated %u ticks\n",
+           xSet.ulCount, dTaskSetUtilization(&xSet),
+           (unsigned long long)ullHyperperiod, xConfig.ulHorizon);
+    printf("jobs %llu, misses %llu, dropped releases %llu, preemptions %llu, busy %.2f%%\n",
+           (unsigned long long)xResult.ullJobs, (unsigned long long)xResult.ullMisses,
+           (unsigned long long)xResult.ullDropped, (unsigned long long)xResult.ullPreemptions,
+           xResult.ullSimulatedTime ? 100.0 * (double)xResult.ullBusyTime / (double)xResult.ullSimulatedTime : 0.0);
+    printf("events %llu in %.3f s (%.2f M events/s)\n",
+           (unsigned long long)xResult.ullEvents, dSeconds,
+           dSeconds > 0.0 ? (double)xResult.ullEvents / dSeconds * 1e-6 : 0.0);
+
+    if (!bQuiet && pcCsvPath == NULL && xSet.ulCount <= RMSIM_TABLE_MAX_TASKS) {
+        vPrintTaskTable(&xSet, &xResult);
+    }
+
+    if (pcCsvPath != NULL) {
+        FILE *pxCsv = (strcmp(pcCsvPath, "-") == 0) ? stdout : fopen(pcCsvPath, "w");
+        if (pxCsv == NULL) {
+            perror(pcCsvPath);
+            return 2;
+        }
+        vWriteTaskCsv(pxCsv, &xSet, &xResult);
+        if (pxCsv != stdout) {
+            fclose(pxCsv);
+        }
+    }
+
+    int iStatus = (xResult.ullMisses != 0 || xResult.ullDropped != 0) ? 1 : 0;
+
+    vSimResultFree(&xResult);
+    vTaskSetFree(&xSet);
+
+    return iStatus;
+}
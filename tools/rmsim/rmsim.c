@@ -0,0 +1,445 @@
+/**
+ * @file rmsim.c
+ * @brief Discrete-event simulator of the periodRTOS Rate Monotonic scheduler
+ *
+ * State is kept as a struct of arrays. Pending releases sit in a binary
+ * min-heap keyed by release tick; ready jobs are a two-level bitmap indexed
+ * by Rate Monotonic rank, the scalable form of the kernel's
+ * pxReadyList[priority], so picking the highest-priority job is two
+ * count-trailing-zeros.
+ *
+ * With SimConfig_t.ulPriorityLevels set, priorities are clamped as the
+ * kernel clamps them and the tasks on the last level share it: none of
+ * them preempts another, and the lowest-ranked ready one runs next.
+ */
+
+#include "rmsim.h"
+#include "rm_policy.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t ulCount;
+    const TaskSet_t *pxSet;
+    const uint32_t *pulPriority;     /* Kernel priority, clamped */
+    FILE *pxTrace;
+
+    /* Per task */
+    uint32_t *pulReleaseTime;        /* Next release, ticks */
+    uint32_t *pulDeadlineTime;       /* Absolute deadline of the pending job, ticks */
+    uint32_t *pulRemaining;          /* Execution left of the pending job, us */
+    uint64_t *pullJobRelease;        /* Release of the pending job, us */
+    uint8_t *pucPending;
+    uint32_t *pulRank;               /* Position in bRmPrecedes() order */
+
+    /* Per rank */
+    uint32_t *pulTaskAtRank;
+    uint64_t *pullReady;             /* Bit r: job of rank r is ready */
+    uint64_t *pullReadySummary;      /* Bit w: pullReady[w] != 0 */
+    uint32_t ulSummaryWords;
+
+    /* Release queue */
+    uint32_t *pulHeap;
+
+    uint64_t ullRandom;
+} SimState_t;
+
+/* Internal function prototypes */
+static bool bSimAllocate(SimState_t *pxState, SimResult_t *pxResult, uint32_t ulCount);
+static void vSimFree(SimState_t *pxState);
+static void vAssignRanks(const TaskSet_t *pxSet, uint32_t *pulRank, uint32_t *pulScratch);
+static void vHeapSiftDown(SimState_t *pxState, uint32_t ulPosition);
+static void vHeapBuild(SimState_t *pxState);
+static void vReadySet(SimState_t *pxState, uint32_t ulRank);
+static void vReadyClear(SimState_t *pxState, uint32_t ulRank);
+static uint32_t ulHighestReady(const SimState_t *pxState);
+static void vReleaseJob(SimState_t *pxState, SimResult_t *pxResult, uint32_t ulTask, uint32_t ulTick);
+static void vCompleteJob(SimState_t *pxState, SimResult_t *pxResult, uint32_t ulTask, uint64_t ullNow);
+static void vTrace(const SimState_t *pxState, uint64_t ullTime, const char *pcEvent, uint32_t ulTask);
+
+/**
+ * @brief Simulate pxSet over ticks [0, pxConfig->ulHorizon)
+ * @return false if out of memory or the horizon is too long for 32-bit tick comparisons
+ */
+bool bSimRun(const TaskSet_t *pxSet, const SimConfig_t *pxConfig, SimResult_t *pxResult)
+{
+    SimState_t xState;
+    uint64_t ullEnd = (uint64_t)pxConfig->ulHorizon * TASKSET_TICK_US;
+    uint64_t ullNow = 0;
+    uint64_t ullMaxSpan = 0;
+    uint32_t ulRunning;
+
+    if (pxSet->ulCount == 0) {
+        return false;
+    }
+
+    /* Tick comparisons are 32-bit modulo, as in the kernel; keep them in range */
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        uint64_t ullSpan = (uint64_t)pxSet->pulPeriod[i] + pxSet->pulDeadline[i];
+        if (ullSpan > ullMaxSpan) {
+            ullMaxSpan = ullSpan;
+        }
+    }
+    if ((uint64_t)pxConfig->ulHorizon + ullMaxSpan > INT32_MAX) {
+        return false;
+    }
+
+    if (!bSimAllocate(&xState, pxResult, pxSet->ulCount)) {
+        return false;
+    }
+    xState.pxSet = pxSet;
+    xState.pulPriority = pxResult->pulPriority;
+    xState.pxTrace = pxConfig->pxTrace;
+    xState.ullRandom = pxConfig->ullSeed;
+
+    vAssignRanks(pxSet, xState.pulRank, xState.pulHeap);
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        xState.pulTaskAtRank[xState.pulRank[i]] = i;
+        pxResult->pulPriority[i] = (pxConfig->ulPriorityLevels == 0) ? xState.pulRank[i] :
+                                   ulRmClampPriority(xState.pulRank[i], pxConfig->ulPriorityLevels);
+    }
+
+    if (xState.pxTrace != NULL) {
+        fprintf(xState.pxTrace, "time_us,event,task\n");
+    }
+
+    /* Scheduler start: every task's first job is released at tick 0 */
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        vReleaseJob(&xState, pxResult, i, 0);
+        xState.pulReleaseTime[i] = ulRmNextRelease(0, pxSet->pulPeriod[i]);
+        xState.pulHeap[i] = i;
+    }
+    vHeapBuild(&xState);
+
+    ulRunning = ulHighestReady(&xState);
+    vTrace(&xState, 0, "run", ulRunning);
+
+    for (;;) {
+        uint32_t ulTick = xState.pulReleaseTime[xState.pulHeap[0]];
+        bool bEnd = (ulTick >= pxConfig->ulHorizon);
+        uint64_t ullLimit = bEnd ? ullEnd : (uint64_t)ulTick * TASKSET_TICK_US;
+        uint32_t ulNext;
+
+        /* Run the current job up to the next tick that releases something */
+        if (ulRunning != RMSIM_NO_TASK &&
+            ullNow + xState.pulRemaining[ulRunning] <= ullLimit) {
+            ullNow += xState.pulRemaining[ulRunning];
+            pxResult->ullBusyTime += xState.pulRemaining[ulRunning];
+            vCompleteJob(&xState, pxResult, ulRunning, ullNow);
+
+            ulRunning = ulHighestReady(&xState);
+            vTrace(&xState, ullNow, "run", ulRunning);
+            continue;
+        }
+        if (ulRunning != RMSIM_NO_TASK) {
+            xState.pulRemaining[ulRunning] -= (uint32_t)(ullLimit - ullNow);
+            pxResult->ullBusyTime += ullLimit - ullNow;
+        }
+        ullNow = ullLimit;
+
+        if (bEnd) {
+            break;
+        }
+
+        /* Release processing, as in vSystemTickHandler() */
+        while (bRmReleaseDue(ulTick, xState.pulReleaseTime[xState.pulHeap[0]])) {
+            uint32_t ulTask = xState.pulHeap[0];
+
+            if (xState.pucPending[ulTask]) {
+                pxResult->pullDropped[ulTask]++;
+                pxResult->ullEvents++;
+                vTrace(&xState, ullNow, "drop", ulTask);
+            } else {
+                vReleaseJob(&xState, pxResult, ulTask, ulTick);
+            }
+
+            xState.pulReleaseTime[ulTask] = ulRmNextRelease(ulTick, pxSet->pulPeriod[ulTask]);
+            vHeapSiftDown(&xState, 0);
+        }
+
+        /* Preemption check at the tick; a task sharing the running one's level waits */
+        ulNext = ulHighestReady(&xState);
+        if (ulNext != ulRunning &&
+            (ulRunning == RMSIM_NO_TASK ||
+             bRmPreempts(xState.pulPriority[ulNext], xState.pulPriority[ulRunning]))) {
+            if (ulRunning != RMSIM_NO_TASK) {
+                pxResult->ullPreemptions++;
+                vTrace(&xState, ullNow, "preempt", ulRunning);
+            }
+            ulRunning = ulNext;
+            vTrace(&xState, ullNow, "run", ulRunning);
+        }
+    }
+
+    /* Jobs still pending at the horizon count as missed once past their deadline */
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        if (xState.pucPending[i] &&
+            bRmDeadlineMissed(pxConfig->ulHorizon, xState.pulDeadlineTime[i])) {
+            pxResult->pullMisses[i]++;
+        }
+        pxResult->ullJobs += pxResult->pullJobs[i];
+        pxResult->ullMisses += pxResult->pullMisses[i];
+        pxResult->ullDropped += pxResult->pullDropped[i];
+    }
+    pxResult->ullSimulatedTime = ullEnd;
+
+    vSimFree(&xState);
+    return true;
+}
+
+/**
+ * @brief Release simulation results
+ */
+void vSimResultFree(SimResult_t *pxResult)
+{
+    free(pxResult->pulPriority);
+    free(pxResult->pullJobs);
+    free(pxResult->pullCompleted);
+    free(pxResult->pullMisses);
+    free(pxResult->pullDropped);
+    free(pxResult->pullResponseSum);
+    free(pxResult->pullResponseMax);
+    memset(pxResult, 0, sizeof(*pxResult));
+}
+
+static bool bSimAllocate(SimState_t *pxState, SimResult_t *pxResult, uint32_t ulCount)
+{
+    uint32_t ulReadyWords = (ulCount + 63) / 64;
+
+    memset(pxState, 0, sizeof(*pxState));
+    memset(pxResult, 0, sizeof(*pxResult));
+
+    pxState->ulCount = ulCount;
+    pxState->ulSummaryWords = (ulReadyWords + 63) / 64;
+    pxState->pulReleaseTime = calloc(ulCount, sizeof(uint32_t));
+    pxState->pulDeadlineTime = calloc(ulCount, sizeof(uint32_t));
+    pxState->pulRemaining = calloc(ulCount, sizeof(uint32_t));
+    pxState->pullJobRelease = calloc(ulCount, sizeof(uint64_t));
+    pxState->pucPending = calloc(ulCount, sizeof(uint8_t));
+    pxState->pulRank = calloc(ulCount, sizeof(uint32_t));
+    pxState->pulTaskAtRank = calloc(ulCount, sizeof(uint32_t));
+    pxState->pullReady = calloc(ulReadyWords, sizeof(uint64_t));
+    pxState->pullReadySummary = calloc(pxState->ulSummaryWords, sizeof(uint64_t));
+    pxState->pulHeap = calloc(ulCount, sizeof(uint32_t));
+
+    pxResult->ulCount = ulCount;
+    pxResult->pulPriority = calloc(ulCount, sizeof(uint32_t));
+    pxResult->pullJobs = calloc(ulCount, sizeof(uint64_t));
+    pxResult->pullCompleted = calloc(ulCount, sizeof(uint64_t));
+    pxResult->pullMisses = calloc(ulCount, sizeof(uint64_t));
+    pxResult->pullDropped = calloc(ulCount, sizeof(uint64_t));
+    pxResult->pullResponseSum = calloc(ulCount, sizeof(uint64_t));
+    pxResult->pullResponseMax = calloc(ulCount, sizeof(uint64_t));
+
+    if (!pxState->pulReleaseTime || !pxState->pulDeadlineTime || !pxState->pulRemaining ||
+        !pxState->pullJobRelease || !pxState->pucPending || !pxState->pulRank ||
+        !pxState->pulTaskAtRank ||
+        !pxState->pullReady || !pxState->pullReadySummary || !pxState->pulHeap ||
+        !pxResult->pulPriority || !pxResult->pullJobs || !pxResult->pullCompleted ||
+        !pxResult->pullMisses || !pxResult->pullDropped || !pxResult->pullResponseSum ||
+        !pxResult->pullResponseMax) {
+        vSimFree(pxState);
+        vSimResultFree(pxResult);
+        return false;
+    }
+    return true;
+}
+
+static void vSimFree(SimState_t *pxState)
+{
+    free(pxState->pulReleaseTime);
+    free(pxState->pulDeadlineTime);
+    free(pxState->pulRemaining);
+    free(pxState->pullJobRelease);
+    free(pxState->pucPending);
+    free(pxState->pulRank);
+    free(pxState->pulTaskAtRank);
+    free(pxState->pullReady);
+    free(pxState->pullReadySummary);
+    free(pxState->pulHeap);
+}
+
+/**
+ * @brief Rank tasks in bRmPrecedes() order, as vUpdateTaskPriorities() does
+ *
+ * Task i gets kernel task ID i + 1 (creation order). Bottom-up merge sort
+ * of task indices; pulScratch holds ulCount entries.
+ */
+static void vAssignRanks(const TaskSet_t *pxSet, uint32_t *pulRank, uint32_t *pulScratch)
+{
+    uint32_t ulCount = pxSet->ulCount;
+    uint32_t *pulOrder = malloc(ulCount * sizeof(uint32_t));
+    uint32_t *pulSource;
+    uint32_t *pulDest;
+
+    if (pulOrder == NULL) {
+        /* Fall back to creation order */
+        for (uint32_t i = 0; i < ulCount; i++) {
+            pulRank[i] = i;
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        pulOrder[i] = i;
+    }
+
+    pulSource = pulOrder;
+    pulDest = pulScratch;
+    for (uint32_t ulWidth = 1; ulWidth < ulCount; ulWidth *= 2) {
+        for (uint32_t ulLeft = 0; ulLeft < ulCount; ulLeft += 2 * ulWidth) {
+            uint32_t ulMid = (ulLeft + ulWidth < ulCount) ? ulLeft + ulWidth : ulCount;
+            uint32_t ulRight = (ulMid + ulWidth < ulCount) ? ulMid + ulWidth : ulCount;
+            uint32_t a = ulLeft, b = ulMid, k = ulLeft;
+
+            while (a < ulMid && b < ulRight) {
+                uint32_t ulA = pulSource[a], ulB = pulSource[b];
+                if (bRmPrecedes(pxSet->pulPeriod[ulB], ulB + 1, pxSet->pulPeriod[ulA], ulA + 1)) {
+                    pulDest[k++] = pulSource[b++];
+                } else {
+                    pulDest[k++] = pulSource[a++];
+                }
+            }
+            while (a < ulMid) {
+                pulDest[k++] = pulSource[a++];
+            }
+            while (b < ulRight) {
+                pulDest[k++] = pulSource[b++];
+            }
+        }
+        uint32_t *pulTemp = pulSource;
+        pulSource = pulDest;
+        pulDest = pulTemp;
+    }
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        pulRank[pulSource[i]] = i;
+    }
+    free(pulOrder);
+}
+
+static void vHeapSiftDown(SimState_t *pxState, uint32_t ulPosition)
+{
+    uint32_t *pulHeap = pxState->pulHeap;
+    const uint32_t *pulKey = pxState->pulReleaseTime;
+    uint32_t ulTask = pulHeap[ulPosition];
+    uint32_t ulKey = pulKey[ulTask];
+
+    for (;;) {
+        uint32_t ulChild = 2 * ulPosition + 1;
+
+        if (ulChild >= pxState->ulCount) {
+            break;
+        }
+        if (ulChild + 1 < pxState->ulCount && pulKey[pulHeap[ulChild + 1]] < pulKey[pulHeap[ulChild]]) {
+            ulChild++;
+        }
+        if (pulKey[pulHeap[ulChild]] >= ulKey) {
+            break;
+        }
+        pulHeap[ulPosition] = pulHeap[ulChild];
+        ulPosition = ulChild;
+    }
+    pulHeap[ulPosition] = ulTask;
+}
+
+static void vHeapBuild(SimState_t *pxState)
+{
+    for (uint32_t i = pxState->ulCount / 2; i-- > 0;) {
+        vHeapSiftDown(pxState, i);
+    }
+}
+
+static void vReadySet(SimState_t *pxState, uint32_t ulRank)
+{
+    uint32_t ulWord = ulRank / 64;
+
+    pxState->pullReady[ulWord] |= 1ULL << (ulRank % 64);
+    pxState->pullReadySummary[ulWord / 64] |= 1ULL << (ulWord % 64);
+}
+
+static void vReadyClear(SimState_t *pxState, uint32_t ulRank)
+{
+    uint32_t ulWord = ulRank / 64;
+
+    pxState->pullReady[ulWord] &= ~(1ULL << (ulRank % 64));
+    if (pxState->pullReady[ulWord] == 0) {
+        pxState->pullReadySummary[ulWord / 64] &= ~(1ULL << (ulWord % 64));
+    }
+}
+
+/**
+ * @brief Task of the highest-priority ready job, RMSIM_NO_TASK when idle
+ */
+static uint32_t ulHighestReady(const SimState_t *pxState)
+{
+    for (uint32_t s = 0; s < pxState->ulSummaryWords; s++) {
+        if (pxState->pullReadySummary[s] != 0) {
+            uint32_t ulWord = s * 64 + (uint32_t)__builtin_ctzll(pxState->pullReadySummary[s]);
+            uint32_t ulRank = ulWord * 64 + (uint32_t)__builtin_ctzll(pxState->pullReady[ulWord]);
+            return pxState->pulTaskAtRank[ulRank];
+        }
+    }
+    return RMSIM_NO_TASK;
+}
+
+static void vReleaseJob(SimState_t *pxState, SimResult_t *pxResult, uint32_t ulTask, uint32_t ulTick)
+{
+    const TaskSet_t *pxSet = pxState->pxSet;
+    uint32_t ulBcet = pxSet->pulBcet[ulTask];
+    uint32_t ulWcet = pxSet->pulWcet[ulTask];
+    uint32_t ulExecution = ulWcet;
+
+    if (ulBcet < ulWcet) {
+        ulExecution = ulBcet + (uint32_t)(ullRandomNext(&pxState->ullRandom) % (ulWcet - ulBcet + 1));
+    }
+
+    pxState->pucPending[ulTask] = 1;
+    pxState->pulRemaining[ulTask] = ulExecution;
+    pxState->pullJobRelease[ulTask] = (uint64_t)ulTick * TASKSET_TICK_US;
+    pxState->pulDeadlineTime[ulTask] = ulRmAbsoluteDeadline(ulTick, pxSet->pulDeadline[ulTask]);
+    vReadySet(pxState, pxState->pulRank[ulTask]);
+
+    pxResult->pullJobs[ulTask]++;
+    pxResult->ullEvents++;
+    vTrace(pxState, pxState->pullJobRelease[ulTask], "release", ulTask);
+}
+
+/**
+ * @brief Finish the pending job of ulTask at time ullNow (us)
+ *
+ * The kernel checks deadlines on each tick, including the deadline's own,
+ * so the job missed if it was still pending at its deadline tick. A job
+ * that sampled a zero execution time completes at its release tick.
+ */
+static void vCompleteJob(SimState_t *pxState, SimResult_t *pxResult, uint32_t ulTask, uint64_t ullNow)
+{
+    uint64_t ullResponse = ullNow - pxState->pullJobRelease[ulTask];
+    uint32_t ulLastTick = (uint32_t)(((ullResponse > 0) ? ullNow - 1 : ullNow) / TASKSET_TICK_US);
+
+    pxState->pucPending[ulTask] = 0;
+    pxState->pulRemaining[ulTask] = 0;
+    vReadyClear(pxState, pxState->pulRank[ulTask]);
+
+    pxResult->pullCompleted[ulTask]++;
+    pxResult->pullResponseSum[ulTask] += ullResponse;
+    if (ullResponse > pxResult->pullResponseMax[ulTask]) {
+        pxResult->pullResponseMax[ulTask] = ullResponse;
+    }
+    pxResult->ullEvents++;
+
+    vTrace(pxState, ullNow, "complete", ulTask);
+    if (bRmDeadlineMissed(ulLastTick, pxState->pulDeadlineTime[ulTask])) {
+        pxResult->pullMisses[ulTask]++;
+        vTrace(pxState, ullNow, "miss", ulTask);
+    }
+}
+
+static void vTrace(const SimState_t *pxState, uint64_t ullTime, const char *pcEvent, uint32_t ulTask)
+{
+    if (pxState->pxTrace == NULL) {
+        return;
+    }
+    fprintf(pxState->pxTrace, "%llu,%s,%s\n", (unsigned long long)ullTime, pcEvent,
+            (ulTask == RMSIM_NO_TASK) ? "idle" : pxState->pxSet->pcName[ulTask]);
+}
@@ -0,0 +1,64 @@
+/**
+ * @file rmsim.h
+ * @brief Discrete-event simulator of the periodRTOS Rate Monotonic scheduler
+ *
+ * Priorities, releases, deadlines and preemption come from rm_policy.h, the
+ * same helpers rm_scheduler.c uses, so the simulated schedule is the one the
+ * kernel would produce with the given execution times and zero kernel
+ * overhead. Like the kernel, releases and preemptions happen on ticks and a
+ * release that finds the previous job unfinished is dropped.
+ *
+ * Time advances from event to event (release ticks and job completions),
+ * never tick by tick.
+ */
+
+#ifndef RMSIM_H
+#define RMSIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "taskset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RMSIM_NO_TASK   UINT32_MAX
+
+typedef struct {
+    uint32_t ulHorizon;              /* Simulated ticks */
+    uint64_t ullSeed;                /* Execution time sampling seed */
+    FILE *pxTrace;                   /* CSV event trace, NULL for none */
+    uint32_t ulPriorityLevels;       /* Kernel priority levels, 0 for one per task */
+} SimConfig_t;
+
+/* Per-task results, one array entry per task (struct of arrays) */
+typedef struct {
+    uint32_t ulCount;
+    uint32_t *pulPriority;           /* Assigned priority, 0 = highest, clamped to the levels */
+    uint64_t *pullJobs;              /* Released jobs */
+    uint64_t *pullCompleted;         /* Completed jobs */
+    uint64_t *pullMisses;            /* Jobs that missed (incl. unfinished at the horizon) */
+    uint64_t *pullDropped;           /* Releases dropped, previous job still pending */
+    uint64_t *pullResponseSum;       /* Microseconds, completed jobs */
+    uint64_t *pullResponseMax;       /* Microseconds */
+
+    /* Totals */
+    uint64_t ullEvents;              /* Releases + completions processed */
+    uint64_t ullPreemptions;
+    uint64_t ullBusyTime;            /* Microseconds not spent idle */
+    uint64_t ullSimulatedTime;       /* Microseconds */
+    uint64_t ullJobs;
+    uint64_t ullMisses;
+    uint64_t ullDropped;
+} SimResult_t;
+
+bool bSimRun(const TaskSet_t *pxSet, const SimConfig_t *pxConfig, SimResult_t *pxResult);
+void vSimResultFree(SimResult_t *pxResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RMSIM_H */
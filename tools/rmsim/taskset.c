@@ -0,0 +1,308 @@
+/**
+ * @file taskset.c
+ * @brief Task set storage, file loading and UUniFast generation
+ *
+ * File format, one task per line ('#' starts a comment):
+ *
+ *   name  period_ticks  deadline_ticks  wcet_us  [bcet_us]
+ *
+ * A deadline of 0 means implicit (equal to the period).
+ */
+
+#include "taskset.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Allocate storage for ulCapacity tasks
+ */
+bool bTaskSetInit(TaskSet_t *pxSet, uint32_t ulCapacity)
+{
+    memset(pxSet, 0, sizeof(*pxSet));
+    if (ulCapacity == 0) {
+        ulCapacity = 16;
+    }
+
+    pxSet->pulPeriod = malloc(ulCapacity * sizeof(uint32_t));
+    pxSet->pulDeadline = malloc(ulCapacity * sizeof(uint32_t));
+    pxSet->pulWcet = malloc(ulCapacity * sizeof(uint32_t));
+    pxSet->pulBcet = malloc(ulCapacity * sizeof(uint32_t));
+    pxSet->pcName = malloc(ulCapacity * sizeof(*pxSet->pcName));
+    pxSet->ulCapacity = ulCapacity;
+
+    if (!pxSet->pulPeriod || !pxSet->pulDeadline || !pxSet->pulWcet ||
+        !pxSet->pulBcet || !pxSet->pcName) {
+        vTaskSetFree(pxSet);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Release task set storage
+ */
+void vTaskSetFree(TaskSet_t *pxSet)
+{
+    free(pxSet->pulPeriod);
+    free(pxSet->pulDeadline);
+    free(pxSet->pulWcet);
+    free(pxSet->pulBcet);
+    free(pxSet->pcName);
+    memset(pxSet, 0, sizeof(*pxSet));
+}
+
+/**
+ * @brief Remove all tasks, keeping the storage
+ */
+void vTaskSetClear(TaskSet_t *pxSet)
+{
+    pxSet->ulCount = 0;
+}
+
+/**
+ * @brief Append one task, growing the storage as needed
+ */
+bool bTaskSetAdd(TaskSet_t *pxSet, const char *pcName, uint32_t ulPeriod,
+                 uint32_t ulDeadline, uint32_t ulWcet, uint32_t ulBcet)
+{
+    uint32_t i = pxSet->ulCount;
+
+    if (ulPeriod == 0 || ulWcet == 0) {
+        return false;
+    }
+
+    if (i == pxSet->ulCapacity) {
+        uint32_t ulCapacity = pxSet->ulCapacity * 2;
+        void *pvPeriod = realloc(pxSet->pulPeriod, ulCapacity * sizeof(uint32_t));
+        void *pvDeadline = pvPeriod ? realloc(pxSet->pulDeadline, ulCapacity * sizeof(uint32_t)) : NULL;
+        void *pvWcet = pvDeadline ? realloc(pxSet->pulWcet, ulCapacity * sizeof(uint32_t)) : NULL;
+        void *pvBcet = pvWcet ? realloc(pxSet->pulBcet, ulCapacity * sizeof(uint32_t)) : NULL;
+        void *pvName = pvBcet ? realloc(pxSet->pcName, ulCapacity * sizeof(*pxSet->pcName)) : NULL;
+
+        /* Keep whatever moved so vTaskSetFree() stays correct */
+        if (pvPeriod) pxSet->pulPeriod = pvPeriod;
+        if (pvDeadline) pxSet->pulDeadline = pvDeadline;
+        if (pvWcet) pxSet->pulWcet = pvWcet;
+        if (pvBcet) pxSet->pulBcet = pvBcet;
+        if (pvName == NULL) {
+            return false;
+        }
+        pxSet->pcName = pvName;
+        pxSet->ulCapacity = ulCapacity;
+    }
+
+    pxSet->pulPeriod[i] = ulPeriod;
+    pxSet->pulDeadline[i] = (ulDeadline == 0) ? ulPeriod : ulDeadline;
+    pxSet->pulWcet[i] = ulWcet;
+    pxSet->pulBcet[i] = (ulBcet == 0 || ulBcet > ulWcet) ? ulWcet : ulBcet;
+    if (pcName != NULL) {
+        strncpy(pxSet->pcName[i], pcName, TASKSET_NAME_LENGTH - 1);
+        pxSet->pcName[i][TASKSET_NAME_LENGTH - 1] = '\0';
+    } else {
+        snprintf(pxSet->pcName[i], TASKSET_NAME_LENGTH, "T%u", i);
+    }
+    pxSet->ulCount++;
+
+    return true;
+}
+
+/**
+ * @brief Append the tasks listed in a task set file ("-" reads stdin)
+ */
+bool bTaskSetLoad(TaskSet_t *pxSet, const char *pcPath)
+{
+    FILE *pxFile = (strcmp(pcPath, "-") == 0) ? stdin : fopen(pcPath, "r");
+    char pcLine[256];
+    uint32_t ulLine = 0;
+    bool bOk = true;
+
+    if (pxFile == NULL) {
+        perror(pcPath);
+        return false;
+    }
+
+    while (fgets(pcLine, sizeof(pcLine), pxFile) != NULL) {
+        char pcName[TASKSET_NAME_LENGTH];
+        unsigned long ulPeriod, ulDeadline, ulWcet, ulBcet = 0;
+        char *pcComment = strchr(pcLine, '#');
+        int iFields;
+
+        ulLine++;
+        if (pcComment != NULL) {
+            *pcComment = '\0';
+        }
+
+        iFields = sscanf(pcLine, "%15s %lu %lu %lu %lu", pcName, &ulPeriod, &ulDeadline, &ulWcet, &ulBcet);
+        if (iFields <= 0) {
+            continue;
+        }
+        if (iFields < 4 || !bTaskSetAdd(pxSet, pcName, (uint32_t)ulPeriod, (uint32_t)ulDeadline,
+                                        (uint32_t)ulWcet, (uint32_t)ulBcet)) {
+            fprintf(stderr, "%s:%u: expected 'name period deadline wcet_us [bcet_us]'\n", pcPath, ulLine);
+            bOk = false;
+            break;
+        }
+    }
+
+    if (pxFile != stdin) {
+        fclose(pxFile);
+    }
+    return bOk;
+}
+
+/**
+ * @brief Draw one candidate set for bTaskSetGenerate()
+ *
+ * Each WCET is rounded with the error of the previous ones carried over, and
+ * what is left after the last task is absorbed by the task with the longest
+ * period, whose microsecond is the finest utilization step in the set.
+ */
+static bool bTaskSetDraw(TaskSet_t *pxSet, uint32_t ulCount, double dUtilization,
+                         uint32_t ulPeriodMin, uint32_t ulPeriodMax, uint64_t *pullSeed)
+{
+    double dSum = dUtilization;
+    double dCarry = 0.0;
+    double dLogMin = log((double)ulPeriodMin);
+    double dLogMax = log((double)ulPeriodMax + 1.0);
+    double dWcet;
+    uint32_t ulLongest = 0;
+
+    vTaskSetClear(pxSet);
+
+    for (uint32_t i = 0; i < ulCount; i++) {
+        double dTaskUtilization;
+        double dTicksUs;
+        uint32_t ulPeriod;
+        uint32_t ulWcet;
+
+        if (i + 1 < ulCount) {
+            double dNext = dSum * pow(dRandomUniform(pullSeed), 1.0 / (double)(ulCount - i - 1));
+            dTaskUtilization = dSum - dNext;
+            dSum = dNext;
+        } else {
+            dTaskUtilization = dSum;
+        }
+
+        ulPeriod = (uint32_t)exp(dLogMin + (dLogMax - dLogMin) * dRandomUniform(pullSeed));
+        if (ulPeriod > ulPeriodMax) {
+            ulPeriod = ulPeriodMax;
+        }
+
+        dTicksUs = (double)ulPeriod * (double)TASKSET_TICK_US;
+        dWcet = (dTaskUtilization + dCarry) * dTicksUs;
+        ulWcet = (dWcet < 1.0) ? 1 : (uint32_t)(dWcet + 0.5);
+        dCarry += dTaskUtilization - (double)ulWcet / dTicksUs;
+
+        if (!bTaskSetAdd(pxSet, NULL, ulPeriod, 0, ulWcet, 0)) {
+            return false;
+        }
+        if (ulPeriod > pxSet->pulPeriod[ulLongest]) {
+            ulLongest = i;
+        }
+    }
+
+    dWcet = (double)pxSet->pulWcet[ulLongest] +
+            dCarry * (double)pxSet->pulPeriod[ulLongest] * (double)TASKSET_TICK_US;
+    pxSet->pulWcet[ulLongest] = (dWcet < 1.0) ? 1 : (uint32_t)(dWcet + 0.5);
+
+    return true;
+}
+
+/**
+ * @brief Replace the set with ulCount random tasks of total utilization dUtilization
+ *
+ * Utilizations follow UUniFast (Bini & Buttazzo), periods are log-uniform
+ * in [ulPeriodMin, ulPeriodMax] ticks and deadlines are implicit. With
+ * dBcetRatio < 1 the BCET is that fraction of the WCET.
+ *
+ * WCETs are whole microseconds, so the rounded set is checked against the
+ * target: a set off by more than TASKSET_UTILIZATION_TOLERANCE is redrawn,
+ * and generation fails after TASKSET_GENERATE_ATTEMPTS draws.
+ */
+bool bTaskSetGenerate(TaskSet_t *pxSet, uint32_t ulCount, double dUtilization,
+                      uint32_t ulPeriodMin, uint32_t ulPeriodMax,
+                      double dBcetRatio, uint64_t *pullSeed)
+{
+    if (ulCount == 0 || ulPeriodMin == 0 || ulPeriodMax < ulPeriodMin) {
+        return false;
+    }
+
+    for (uint32_t ulAttempt = 0; ulAttempt < TASKSET_GENERATE_ATTEMPTS; ulAttempt++) {
+        if (!bTaskSetDraw(pxSet, ulCount, dUtilization, ulPeriodMin, ulPeriodMax, pullSeed)) {
+            return false;
+        }
+        if (fabs(dTaskSetUtilization(pxSet) - dUtilization) > TASKSET_UTILIZATION_TOLERANCE) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+            uint32_t ulBcet = (dBcetRatio < 1.0) ? (uint32_t)(pxSet->pulWcet[i] * dBcetRatio) : 0;
+
+            pxSet->pulBcet[i] = (ulBcet == 0) ? pxSet->pulWcet[i] : ulBcet;
+        }
+        return true;
+    }
+
+    vTaskSetClear(pxSet);
+    return false;
+}
+
+/**
+ * @brief Total worst-case utilization
+ */
+double dTaskSetUtilization(const TaskSet_t *pxSet)
+{
+    double dUtilization = 0.0;
+
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        dUtilization += (double)pxSet->pulWcet[i] / ((double)pxSet->pulPeriod[i] * TASKSET_TICK_US);
+    }
+    return dUtilization;
+}
+
+/**
+ * @brief LCM of all periods in ticks, 0 if it exceeds 32 bits
+ */
+uint64_t ullTaskSetHyperperiod(const TaskSet_t *pxSet)
+{
+    uint64_t ullHyperperiod = 1;
+
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        uint64_t ullA = ullHyperperiod;
+        uint64_t ullB = pxSet->pulPeriod[i];
+
+        while (ullB != 0) {
+            uint64_t ullTemp = ullA % ullB;
+            ullA = ullB;
+            ullB = ullTemp;
+        }
+        ullHyperperiod = (ullHyperperiod / ullA) * pxSet->pulPeriod[i];
+
+        if (ullHyperperiod > UINT32_MAX) {
+            return 0;
+        }
+    }
+    return ullHyperperiod;
+}
+
+/**
+ * @brief splitmix64 step
+ */
+uint64_t ullRandomNext(uint64_t *pullState)
+{
+    uint64_t ullZ = (*pullState += 0x9E3779B97F4A7C15ULL);
+
+    ullZ = (ullZ ^ (ullZ >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    ullZ = (ullZ ^ (ullZ >> 27)) * 0x94D049BB133111EBULL;
+    return ullZ ^ (ullZ >> 31);
+}
+
+/**
+ * @brief Uniform double in [0, 1)
+ */
+double dRandomUniform(uint64_t *pullState)
+{
+    return (double)(ullRandomNext(pullState) >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file taskset.h
+ * @brief Periodic task sets for the host analysis tools
+ *
+ * Task sets are stored as a struct of arrays so that tools can stream over
+ * one attribute of thousands of tasks at a time.
+ */
+
+#ifndef TASKSET_H
+#define TASKSET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "periodRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Kernel tick length in microseconds */
+#define TASKSET_TICK_US          (1000000UL / SYSTICK_FREQ_HZ)
+#define TASKSET_NAME_LENGTH      16
+
+/* Generated sets: largest |actual - requested| utilization, and draws before giving up */
+#define TASKSET_UTILIZATION_TOLERANCE   1e-4
+#define TASKSET_GENERATE_ATTEMPTS       16
+
+typedef struct {
+    uint32_t ulCount;
+    uint32_t ulCapacity;
+    uint32_t *pulPeriod;             /* Ticks */
+    uint32_t *pulDeadline;           /* Ticks, relative to the release */
+    uint32_t *pulWcet;               /* Microseconds */
+    uint32_t *pulBcet;               /* Microseconds, == WCET for fixed execution times */
+    char (*pcName)[TASKSET_NAME_LENGTH];
+} TaskSet_t;
+
+/* Storage */
+bool bTaskSetInit(TaskSet_t *pxSet, uint32_t ulCapacity);
+void vTaskSetFree(TaskSet_t *pxSet);
+void vTaskSetClear(TaskSet_t *pxSet);
+bool bTaskSetAdd(TaskSet_t *pxSet, const char *pcName, uint32_t ulPeriod,
+                 uint32_t ulDeadline, uint32_t ulWcet, uint32_t ulBcet);
+
+/* Input */
+bool bTaskSetLoad(TaskSet_t *pxSet, const char *pcPath);
+bool bTaskSetGenerate(TaskSet_t *pxSet, uint32_t ulCount, double dUtilization,
+                      uint32_t ulPeriodMin, uint32_t ulPeriodMax,
+                      double dBcetRatio, uint64_t *pullSeed);
+
+/* Properties */
+double dTaskSetUtilization(const TaskSet_t *pxSet);
+uint64_t ullTaskSetHyperperiod(const TaskSet_t *pxSet);
+
+/* Deterministic random numbers (splitmix64) */
+uint64_t ullRandomNext(uint64_t *pullState);
+double dRandomUniform(uint64_t *pullState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TASKSET_H */
@@ -0,0 +1,538 @@
+/**
+ * @file main.c
+ * @brief rmsweep - parallel schedulability sweep over many task sets
+ *
+ * Generated mode (default): for every task count in -n, draw task sets with
+ * UUniFast and
+ *   - acceptance: at each utilization of the -U grid, the fraction of sets
+ *     accepted by Liu & Layland, the hyperbolic bound, response-time
+ *     analysis and (with -S) the schedule simulator;
+ *   - breakdown: the largest utilization at which a set of the same shape
+ *     (periods and utilization ratios) stays schedulable under RTA and (-S)
+ *     simulation.
+ *
+ * File mode: every task set file given on the command line is analysed the
+ * same way and reported on its own row.
+ *
+ * Usage: rmsweep [options] [taskset ...]
+ *   -n LIST        task counts, e.g. 4,8,16 (default 8)
+ *   -m SETS        task sets per utilization level and task count (default 1000)
+ *   -U FROM:TO:STEP  utilization grid (default 0.05:1.00:0.05)
+ *   -p MIN:MAX     period range in ticks (default 10:1000)
+ *   -S             also decide by simulation (critical instant, first jobs)
+ *   -j THREADS     worker threads (default: all online CPUs)
+ *   -s SEED        base seed (default 1)
+ *   -a FILE        acceptance-ratio CSV (default stdout)
+ *   -B FILE        breakdown-utilization CSV (default stdout)
+ */
+
+#include "pool.h"
+#include "taskset.h"
+#include "rmsim.h"
+#include "rm_analysis.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SWEEP_MAX_TASK_COUNTS       16
+#define SWEEP_BREAKDOWN_STEPS       20      /* Bisection steps, ~1e-6 resolution */
+
+/* Acceptance counters for one (task count, utilization level) cell */
+enum { TEST_LL = 0, TEST_HYPERBOLIC, TEST_RTA, TEST_SIM, TEST_COUNT };
+static const char *pcTestNames[TEST_COUNT] = { "liu_layland", "hyperbolic", "rta", "sim" };
+
+/* Per-worker scratch, one cache line apart */
+typedef struct {
+    TaskSet_t xSet;
+    uint32_t *pulScaled;
+    uint32_t *pulOrder;
+    uint64_t *pullAccepted;          /* [cell][test] */
+    uint64_t *pullGenerated;         /* [cell] */
+    char pcPad[64];
+} SweepWorker_t;
+
+typedef struct {
+    /* Configuration */
+    uint32_t pulTaskCounts[SWEEP_MAX_TASK_COUNTS];
+    uint32_t ulTaskCountCount;
+    uint32_t ulSetsPerCell;
+    uint32_t ulLevels;
+    double dUtilFrom;
+    double dUtilStep;
+    uint32_t ulPeriodMin, ulPeriodMax;
+    bool bSimulate;
+    uint64_t ullSeed;
+    char **ppcFiles;
+    uint32_t ulFileCount;
+
+    /* Results */
+    SweepWorker_t *pxWorkers;
+    double *pdBreakdownRta;          /* [task count][set] or [file] */
+    double *pdBreakdownSim;
+    bool (*pbFileAccepted)[TEST_COUNT];
+} Sweep_t;
+
+/* Internal function prototypes */
+static bool bParseList(const char *pcList, uint32_t *pulOut, uint32_t ulMax, uint32_t *pulCount);
+static uint64_t ullJobSeed(uint64_t ullBase, uint32_t ulStream, uint32_t ulJob);
+static bool bSetSchedulable(const TaskSet_t *pxSet, SweepWorker_t *pxWorker, uint32_t ulTest);
+static double dBreakdown(const TaskSet_t *pxSet, SweepWorker_t *pxWorker, uint32_t ulTest);
+static void vAcceptanceJob(uint32_t ulJob, uint32_t ulWorker, void *pvContext);
+static void vBreakdownJob(uint32_t ulJob, uint32_t ulWorker, void *pvContext);
+static void vFileJob(uint32_t ulJob, uint32_t ulWorker, void *pvContext);
+static int iCompareDouble(const void *pvA, const void *pvB);
+static FILE *pxOpenOutput(const char *pcPath);
+
+static void vPrintUsage(void)
+{
+    fprintf(stderr,
+            "usage: rmsweep [-n 4,8,16] [-m SETS] [-U FROM:TO:STEP] [-p MIN:MAX] [-S]\n"
+            "               [-j THREADS] [-s SEED] [-a acceptance.csv] [-B breakdown.csv]\n"
+            "               [taskset ...]\n");
+}
+
+int main(int argc, char **argv)
+{
+    Sweep_t xSweep;
+    PoolStats_t xStats;
+    uint32_t ulThreads = 0;
+    uint32_t ulMaxTasks = 0;
+    uint32_t ulCells;
+    double dUtilTo = 1.0;
+    const char *pcAcceptancePath = NULL;
+    const char *pcBreakdownPath = NULL;
+    int iOption;
+
+    memset(&xSweep, 0, sizeof(xSweep));
+    xSweep.pulTaskCounts[0] = 8;
+    xSweep.ulTaskCountCount = 1;
+    xSweep.ulSetsPerCell = 1000;
+    xSweep.dUtilFrom = 0.05;
+    xSweep.dUtilStep = 0.05;
+    xSweep.ulPeriodMin = 10;
+    xSweep.ulPeriodMax = 1000;
+    xSweep.ullSeed = 1;
+
+    while ((iOption = getopt(argc, argv, "n:m:U:p:Sj:s:a:B:h")) != -1) {
+        switch (iOption) {
+            case 'n':
+                if (!bParseList(optarg, xSweep.pulTaskCounts, SWEEP_MAX_TASK_COUNTS,
+                                &xSweep.ulTaskCountCount)) {
+                    vPrintUsage();
+                    return 2;
+                }
+                break;
+            case 'm': xSweep.ulSetsPerCell = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'U':
+                if (sscanf(optarg, "%lf:%lf:%lf", &xSweep.dUtilFrom, &dUtilTo, &xSweep.dUtilStep) != 3 ||
+                    xSweep.dUtilStep <= 0.0) {
+                    vPrintUsage();
+                    return 2;
+                }
+                break;
+            case 'p':
+                if (sscanf(optarg, "%u:%u", &xSweep.ulPeriodMin, &xSweep.ulPeriodMax) != 2) {
+                    vPrintUsage();
+                    return 2;
+                }
+                break;
+            case 'S': xSweep.bSimulate = true; break;
+            case 'j': ulThreads = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': xSweep.ullSeed = strtoull(optarg, NULL, 0); break;
+            case 'a': pcAcceptancePath = optarg; break;
+            case 'B': pcBreakdownPath = optarg; break;
+            default:
+                vPrintUsage();
+                return 2;
+        }
+    }
+    xSweep.ppcFiles = &argv[optind];
+    xSweep.ulFileCount = (uint32_t)(argc - optind);
+    xSweep.ulLevels = (uint32_t)floor((dUtilTo - xSweep.dUtilFrom) / xSweep.dUtilStep + 1e-9) + 1;
+
+    if (ulThreads == 0) {
+        ulThreads = ulPoolDefaultThreads();
+    }
+    for (uint32_t i = 0; i < xSweep.ulTaskCountCount; i++) {
+        if (xSweep.pulTaskCounts[i] > ulMaxTasks) {
+            ulMaxTasks = xSweep.pulTaskCounts[i];
+        }
+    }
+    ulCells = xSweep.ulTaskCountCount * xSweep.ulLevels;
+
+    /* Per-worker scratch */
+    xSweep.pxWorkers = calloc(ulThreads, sizeof(SweepWorker_t));
+    if (xSweep.pxWorkers == NULL) {
+        return 2;
+    }
+    for (uint32_t i = 0; i < ulThreads; i++) {
+        SweepWorker_t *pxWorker = &xSweep.pxWorkers[i];
+
+        if (!bTaskSetInit(&pxWorker->xSet, ulMaxTasks ? ulMaxTasks : 16)) {
+            return 2;
+        }
+        pxWorker->pulScaled = calloc(ulMaxTasks + 1, sizeof(uint32_t));
+        pxWorker->pulOrder = calloc(ulMaxTasks + 1, sizeof(uint32_t));
+        pxWorker->pullAccepted = calloc((size_t)ulCells * TEST_COUNT, sizeof(uint64_t));
+        pxWorker->pullGenerated = calloc(ulCells, sizeof(uint64_t));
+        if (!pxWorker->pulScaled || !pxWorker->pulOrder || !pxWorker->pullAccepted ||
+            !pxWorker->pullGenerated) {
+            return 2;
+        }
+    }
+
+    if (xSweep.ulFileCount > 0) {
+        /* File mode */
+        FILE *pxOut = pxOpenOutput(pcAcceptancePath);
+
+        xSweep.pdBreakdownRta = calloc(xSweep.ulFileCount, sizeof(double));
+        xSweep.pdBreakdownSim = calloc(xSweep.ulFileCount, sizeof(double));
+        xSweep.pbFileAccepted = calloc(xSweep.ulFileCount, sizeof(*xSweep.pbFileAccepted));
+        if (!pxOut || !xSweep.pdBreakdownRta || !xSweep.pdBreakdownSim || !xSweep.pbFileAccepted) {
+            return 2;
+        }
+
+        bPoolRun(ulThreads, xSweep.ulFileCount, vFileJob, &xSweep, &xStats);
+
+        fprintf(pxOut, "file,liu_layland,hyperbolic,rta%s,breakdown_rta%s\n",
+                xSweep.bSimulate ? ",sim" : "", xSweep.bSimulate ? ",breakdown_sim" : "");
+        for (uint32_t f = 0; f < xSweep.ulFileCount; f++) {
+            fprintf(pxOut, "%s,%d,%d,%d", xSweep.ppcFiles[f],
+                    xSweep.pbFileAccepted[f][TEST_LL], xSweep.pbFileAccepted[f][TEST_HYPERBOLIC],
+                    xSweep.pbFileAccepted[f][TEST_RTA]);
+            if (xSweep.bSimulate) {
+                fprintf(pxOut, ",%d", xSweep.pbFileAccepted[f][TEST_SIM]);
+            }
+            fprintf(pxOut, ",%.6f", xSweep.pdBreakdownRta[f]);
+            if (xSweep.bSimulate) {
+                fprintf(pxOut, ",%.6f", xSweep.pdBreakdownSim[f]);
+            }
+            fprintf(pxOut, "\n");
+        }
+        if (pxOut != stdout) {
+            fclose(pxOut);
+        }
+        fprintf(stderr, "rmsweep: %u file(s) on %u threads in %.3f s\n",
+                xSweep.ulFileCount, xStats.ulThreads, xStats.dSeconds);
+        return 0;
+    }
+
+    /* Acceptance ratio */
+    {
+        uint64_t ullJobs = (uint64_t)ulCells * xSweep.ulSetsPerCell;
+        FILE *pxOut;
+
+        if (ullJobs > UINT32_MAX) {
+            fprintf(stderr, "rmsweep: too many jobs\n");
+            return 2;
+        }
+        bPoolRun(ulThreads, (uint32_t)ullJobs, vAcceptanceJob, &xSweep, &xStats);
+        fprintf(stderr, "rmsweep: %llu acceptance sets on %u threads in %.3f s (%.0f sets/s, %llu steals)\n",
+                (unsigned long long)xStats.ullJobsRun, xStats.ulThreads, xStats.dSeconds,
+                xStats.dSeconds > 0.0 ? (double)xStats.ullJobsRun / xStats.dSeconds : 0.0,
+                (unsigned long long)xStats.ullSteals);
+
+        pxOut = pxOpenOutput(pcAcceptancePath);
+        if (pxOut == NULL) {
+            return 2;
+        }
+        fprintf(pxOut, "tasks,utilization,sets");
+        for (uint32_t t = 0; t < TEST_COUNT; t++) {
+            if (t != TEST_SIM || xSweep.bSimulate) {
+                fprintf(pxOut, ",%s", pcTestNames[t]);
+            }
+        }
+        fprintf(pxOut, "\n");
+
+        for (uint32_t c = 0; c < ulCells; c++) {
+            uint32_t ulCountIndex = c / xSweep.ulLevels;
+            uint32_t ulLevel = c % xSweep.ulLevels;
+            uint64_t ullGenerated = 0;
+
+            /* Sets the generator could not fit to the level are left out */
+            for (uint32_t w = 0; w < ulThreads; w++) {
+                ullGenerated += xSweep.pxWorkers[w].pullGenerated[c];
+            }
+            fprintf(pxOut, "%u,%.4f,%llu", xSweep.pulTaskCounts[ulCountIndex],
+                    xSweep.dUtilFrom + ulLevel * xSweep.dUtilStep, (unsigned long long)ullGenerated);
+            for (uint32_t t = 0; t < TEST_COUNT; t++) {
+                uint64_t ullAccepted = 0;
+
+                if (t == TEST_SIM && !xSweep.bSimulate) {
+                    continue;
+                }
+                for (uint32_t w = 0; w < ulThreads; w++) {
+                    ullAccepted += xSweep.pxWorkers[w].pullAccepted[(size_t)c * TEST_COUNT + t];
+                }
+                fprintf(pxOut, ",%.6f", ullGenerated ? (double)ullAccepted / (double)ullGenerated : 0.0);
+            }
+            fprintf(pxOut, "\n");
+        }
+        if (pxOut != stdout) {
+            fclose(pxOut);
+        }
+    }
+
+    /* Breakdown utilization */
+    {
+        uint32_t ulJobs = xSweep.ulTaskCountCount * xSweep.ulSetsPerCell;
+        FILE *pxOut;
+
+        xSweep.pdBreakdownRta = calloc(ulJobs, sizeof(double));
+        xSweep.pdBreakdownSim = calloc(ulJobs, sizeof(double));
+        if (!xSweep.pdBreakdownRta || !xSweep.pdBreakdownSim) {
+            return 2;
+        }
+        bPoolRun(ulThreads, ulJobs, vBreakdownJob, &xSweep, &xStats);
+        fprintf(stderr, "rmsweep: %llu breakdown sets on %u threads in %.3f s (%llu steals)\n",
+                (unsigned long long)xStats.ullJobsRun, xStats.ulThreads, xStats.dSeconds,
+                (unsigned long long)xStats.ullSteals);
+
+        pxOut = pxOpenOutput(pcBreakdownPath);
+        if (pxOut == NULL) {
+            return 2;
+        }
+        fprintf(pxOut, "tasks,sets,method,mean,min,p10,p50,p90,max\n");
+        for (uint32_t n = 0; n < xSweep.ulTaskCountCount; n++) {
+            for (uint32_t m = 0; m < (xSweep.bSimulate ? 2u : 1u); m++) {
+                double *pdValues = (m == 0 ? xSweep.pdBreakdownRta : xSweep.pdBreakdownSim) +
+                                   (size_t)n * xSweep.ulSetsPerCell;
+                uint32_t ulSets = xSweep.ulSetsPerCell;
+                double dSum = 0.0;
+
+                if (ulSets == 0) {
+                    continue;
+                }
+                qsort(pdValues, ulSets, sizeof(double), iCompareDouble);
+                for (uint32_t i = 0; i < ulSets; i++) {
+                    dSum += pdValues[i];
+                }
+                fprintf(pxOut, "%u,%u,%s,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+                        xSweep.pulTaskCounts[n], ulSets, m == 0 ? "rta" : "sim",
+                        dSum / ulSets, pdValues[0], pdValues[ulSets / 10],
+                        pdValues[ulSets / 2], pdValues[(ulSets * 9) / 10], pdValues[ulSets - 1]);
+            }
+        }
+        if (pxOut != stdout) {
+            fclose(pxOut);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief One acceptance sample: job = (cell, set)
+ */
+static void vAcceptanceJob(uint32_t ulJob, uint32_t ulWorker, void *pvContext)
+{
+    Sweep_t *pxSweep = pvContext;
+    SweepWorker_t *pxWorker = &pxSweep->pxWorkers[ulWorker];
+    uint32_t ulCell = ulJob / pxSweep->ulSetsPerCell;
+    uint32_t ulTasks = pxSweep->pulTaskCounts[ulCell / pxSweep->ulLevels];
+    double dUtilization = pxSweep->dUtilFrom + (ulCell % pxSweep->ulLevels) * pxSweep->dUtilStep;
+    uint64_t ullSeed = ullJobSeed(pxSweep->ullSeed, 0, ulJob);
+
+    if (!bTaskSetGenerate(&pxWorker->xSet, ulTasks, dUtilization, pxSweep->ulPeriodMin,
+                          pxSweep->ulPeriodMax, 1.0, &ullSeed)) {
+        return;
+    }
+    pxWorker->pullGenerated[ulCell]++;
+
+    for (uint32_t t = 0; t < TEST_COUNT; t++) {
+        if (t == TEST_SIM && !pxSweep->bSimulate) {
+            continue;
+        }
+        if (bSetSchedulable(&pxWorker->xSet, pxWorker, t)) {
+            pxWorker->pullAccepted[(size_t)ulCell * TEST_COUNT + t]++;
+        }
+    }
+}
+
+/**
+ * @brief Breakdown utilization of one random shape: job = (task count, set)
+ */
+static void vBreakdownJob(uint32_t ulJob, uint32_t ulWorker, void *pvContext)
+{
+    Sweep_t *pxSweep = pvContext;
+    SweepWorker_t *pxWorker = &pxSweep->pxWorkers[ulWorker];
+    uint32_t ulTasks = pxSweep->pulTaskCounts[ulJob / pxSweep->ulSetsPerCell];
+    uint64_t ullSeed = ullJobSeed(pxSweep->ullSeed, 1, ulJob);
+
+    /* Shape at utilization 1; dBreakdown() rescales it */
+    if (!bTaskSetGenerate(&pxWorker->xSet, ulTasks, 1.0, pxSweep->ulPeriodMin,
+                          pxSweep->ulPeriodMax, 1.0, &ullSeed)) {
+        return;
+    }
+    pxSweep->pdBreakdownRta[ulJob] = dBreakdown(&pxWorker->xSet, pxWorker, TEST_RTA);
+    if (pxSweep->bSimulate) {
+        pxSweep->pdBreakdownSim[ulJob] = dBreakdown(&pxWorker->xSet, pxWorker, TEST_SIM);
+    }
+}
+
+/**
+ * @brief Analyse one task set file
+ */
+static void vFileJob(uint32_t ulJob, uint32_t ulWorker, void *pvContext)
+{
+    Sweep_t *pxSweep = pvContext;
+    TaskSet_t xSet;
+
+    (void)ulWorker;
+
+    /* Files can be larger than the per-worker scratch */
+    if (!bTaskSetInit(&xSet, 16) || !bTaskSetLoad(&xSet, pxSweep->ppcFiles[ulJob]) || xSet.ulCount == 0) {
+        vTaskSetFree(&xSet);
+        return;
+    }
+
+    SweepWorker_t xScratch = { 0 };
+    xScratch.pulScaled = calloc(xSet.ulCount, sizeof(uint32_t));
+    xScratch.pulOrder = calloc(xSet.ulCount, sizeof(uint32_t));
+    if (xScratch.pulScaled && xScratch.pulOrder) {
+        for (uint32_t t = 0; t < TEST_COUNT; t++) {
+            if (t != TEST_SIM || pxSweep->bSimulate) {
+                pxSweep->pbFileAccepted[ulJob][t] = bSetSchedulable(&xSet, &xScratch, t);
+            }
+        }
+        pxSweep->pdBreakdownRta[ulJob] = dBreakdown(&xSet, &xScratch, TEST_RTA);
+        if (pxSweep->bSimulate) {
+            pxSweep->pdBreakdownSim[ulJob] = dBreakdown(&xSet, &xScratch, TEST_SIM);
+        }
+    }
+    free(xScratch.pulScaled);
+    free(xScratch.pulOrder);
+    vTaskSetFree(&xSet);
+}
+
+/**
+ * @brief Decide one test for a task set with the WCETs in pxSet->pulWcet
+ */
+static bool bSetSchedulable(const TaskSet_t *pxSet, SweepWorker_t *pxWorker, uint32_t ulTest)
+{
+    switch (ulTest) {
+        case TEST_LL:
+            return bRmLiuLaylandTest(pxSet->ulCount, pxSet->pulPeriod, pxSet->pulWcet);
+        case TEST_HYPERBOLIC:
+            return bRmHyperbolicTest(pxSet->ulCount, pxSet->pulPeriod, pxSet->pulWcet);
+        case TEST_RTA:
+            vRmPriorityOrder(pxSet->ulCount, pxSet->pulPeriod, pxWorker->pulOrder);
+            return bRmResponseTimeTest(pxSet->ulCount, pxSet->pulPeriod, pxSet->pulDeadline,
+                                       pxSet->pulWcet, pxWorker->pulOrder);
+        case TEST_SIM: {
+            /* Synchronous release is the critical instant: the first jobs decide */
+            SimConfig_t xConfig = { 0 };
+            SimResult_t xResult;
+            uint32_t ulHorizon = 0;
+            bool bOk;
+
+            for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+                uint32_t ulSpan = pxSet->pulDeadline[i] < pxSet->pulPeriod[i] ?
+                                  pxSet->pulDeadline[i] : pxSet->pulPeriod[i];
+                if (ulSpan > ulHorizon) {
+                    ulHorizon = ulSpan;
+                }
+            }
+            xConfig.ulHorizon = ulHorizon + 1;
+            if (!bSimRun(pxSet, &xConfig, &xResult)) {
+                return false;
+            }
+            bOk = (xResult.ullMisses == 0 && xResult.ullDropped == 0);
+            vSimResultFree(&xResult);
+            return bOk;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Largest utilization at which the set's shape passes ulTest
+ *
+ * Bisection on a common WCET scale factor; the test is monotone in it.
+ */
+static double dBreakdown(const TaskSet_t *pxSet, SweepWorker_t *pxWorker, uint32_t ulTest)
+{
+    TaskSet_t xScaled = *pxSet;
+    double dBase = dTaskSetUtilization(pxSet);
+    double dLow = 0.0;
+    double dHigh = 1.0;
+
+    if (dBase <= 0.0) {
+        return 0.0;
+    }
+
+    xScaled.pulWcet = pxWorker->pulScaled;
+    xScaled.pulBcet = pxWorker->pulScaled;
+
+    for (uint32_t ulStep = 0; ulStep < SWEEP_BREAKDOWN_STEPS; ulStep++) {
+        double dMid = 0.5 * (dLow + dHigh);
+        double dScale = dMid / dBase;
+
+        for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+            double dWcet = pxSet->pulWcet[i] * dScale;
+            pxWorker->pulScaled[i] = (dWcet < 1.0) ? 1 : (uint32_t)dWcet;
+        }
+        if (bSetSchedulable(&xScaled, pxWorker, ulTest)) {
+            dLow = dMid;
+        } else {
+            dHigh = dMid;
+        }
+    }
+    return dLow;
+}
+
+/**
+ * @brief Independent seed per (stream, job) so results don't depend on scheduling
+ */
+static uint64_t ullJobSeed(uint64_t ullBase, uint32_t ulStream, uint32_t ulJob)
+{
+    uint64_t ullState = ullBase ^ ((uint64_t)ulStream << 32 | ulJob) * 0xD1B54A32D192ED03ULL;
+
+    return ullRandomNext(&ullState);
+}
+
+static bool bParseList(const char *pcList, uint32_t *pulOut, uint32_t ulMax, uint32_t *pulCount)
+{
+    char *pcEnd;
+    uint32_t ulCount = 0;
+
+    while (*pcList != '\0') {
+        unsigned long ulValue = strtoul(pcList, &pcEnd, 0);
+
+        if (pcEnd == pcList || ulValue == 0 || ulCount == ulMax) {
+            return false;
+        }
+        pulOut[ulCount++] = (uint32_t)ulValue;
+        pcList = (*pcEnd == ',') ? pcEnd + 1 : pcEnd;
+        if (*pcEnd != ',' && *pcEnd != '\0') {
+            return false;
+        }
+    }
+    *pulCount = ulCount;
+    return ulCount > 0;
+}
+
+static int iCompareDouble(const void *pvA, const void *pvB)
+{
+    double dA = *(const double *)pvA;
+    double dB = *(const double *)pvB;
+
+    return (dA > dB) - (dA < dB);
+}
+
+static FILE *pxOpenOutput(const char *pcPath)
+{
+    FILE *pxFile;
+
+    if (pcPath == NULL || strcmp(pcPath, "-") == 0) {
+        return stdout;
+    }
+    pxFile = fopen(pcPath, "w");
+    if (pxFile == NULL) {
+        perror(pcPath);
+    }
+    return pxFile;
+}
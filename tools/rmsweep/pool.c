@@ -0,0 +1,202 @@
+/**
+ * @file pool.c
+ * @brief Work-stealing thread pool for embarrassingly parallel sweeps
+ *
+ * A worker's remaining slice [begin, end) is packed into one 64-bit atomic,
+ * so both taking a job and stealing half a slice are a single CAS and no
+ * lock is ever shared between workers. Slices live on separate cache lines.
+ */
+
+#include "pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define POOL_CACHE_LINE     64
+
+#define RANGE_PACK(b, e)    (((uint64_t)(e) << 32) | (uint32_t)(b))
+#define RANGE_BEGIN(r)      ((uint32_t)(r))
+#define RANGE_END(r)        ((uint32_t)((r) >> 32))
+
+typedef struct {
+    _Alignas(POOL_CACHE_LINE) _Atomic uint64_t ullRange;
+    uint64_t ullJobsRun;
+    uint64_t ullSteals;
+    uint32_t ulIndex;
+    pthread_t xThread;
+    struct Pool *pxPool;
+} PoolWorker_t;
+
+typedef struct Pool {
+    PoolWorker_t *pxWorkers;
+    uint32_t ulThreads;
+    PoolJob_t pxJob;
+    void *pvContext;
+} Pool_t;
+
+/* Internal function prototypes */
+static void *pvWorkerMain(void *pvArgument);
+static bool bTakeOwn(PoolWorker_t *pxWorker, uint32_t *pulJob);
+static bool bSteal(Pool_t *pxPool, PoolWorker_t *pxThief);
+
+/**
+ * @brief Number of online host CPUs
+ */
+uint32_t ulPoolDefaultThreads(void)
+{
+    long lCpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (lCpus > 0) ? (uint32_t)lCpus : 1;
+}
+
+/**
+ * @brief Run pxJob for every job index on ulThreads threads and wait
+ */
+bool bPoolRun(uint32_t ulThreads, uint32_t ulJobs, PoolJob_t pxJob, void *pvContext,
+              PoolStats_t *pxStats)
+{
+    Pool_t xPool;
+    struct timespec xStart, xEnd;
+    uint32_t ulStarted = 0;
+
+    if (ulThreads == 0) {
+        ulThreads = ulPoolDefaultThreads();
+    }
+
+    xPool.pxWorkers = aligned_alloc(POOL_CACHE_LINE, ulThreads * sizeof(PoolWorker_t));
+    if (xPool.pxWorkers == NULL) {
+        return false;
+    }
+    xPool.ulThreads = ulThreads;
+    xPool.pxJob = pxJob;
+    xPool.pvContext = pvContext;
+
+    /* Even initial split; stealing fixes any imbalance */
+    for (uint32_t i = 0; i < ulThreads; i++) {
+        PoolWorker_t *pxWorker = &xPool.pxWorkers[i];
+        uint32_t ulBegin = (uint32_t)(((uint64_t)ulJobs * i) / ulThreads);
+        uint32_t ulEnd = (uint32_t)(((uint64_t)ulJobs * (i + 1)) / ulThreads);
+
+        atomic_init(&pxWorker->ullRange, RANGE_PACK(ulBegin, ulEnd));
+        pxWorker->ullJobsRun = 0;
+        pxWorker->ullSteals = 0;
+        pxWorker->ulIndex = i;
+        pxWorker->pxPool = &xPool;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &xStart);
+
+    /* Worker 0 is the calling thread */
+    for (uint32_t i = 1; i < ulThreads; i++) {
+        if (pthread_create(&xPool.pxWorkers[i].xThread, NULL, pvWorkerMain, &xPool.pxWorkers[i]) != 0) {
+            break;
+        }
+        ulStarted = i;
+    }
+    pvWorkerMain(&xPool.pxWorkers[0]);
+    for (uint32_t i = 1; i <= ulStarted; i++) {
+        pthread_join(xPool.pxWorkers[i].xThread, NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &xEnd);
+
+    if (pxStats != NULL) {
+        pxStats->ulThreads = ulThreads;
+        pxStats->ullJobsRun = 0;
+        pxStats->ullSteals = 0;
+        for (uint32_t i = 0; i < ulThreads; i++) {
+            pxStats->ullJobsRun += xPool.pxWorkers[i].ullJobsRun;
+            pxStats->ullSteals += xPool.pxWorkers[i].ullSteals;
+        }
+        pxStats->dSeconds = (double)(xEnd.tv_sec - xStart.tv_sec) +
+                            (double)(xEnd.tv_nsec - xStart.tv_nsec) * 1e-9;
+    }
+
+    free(xPool.pxWorkers);
+    return true;
+}
+
+static void *pvWorkerMain(void *pvArgument)
+{
+    PoolWorker_t *pxWorker = pvArgument;
+    Pool_t *pxPool = pxWorker->pxPool;
+    uint32_t ulJob;
+
+    for (;;) {
+        while (bTakeOwn(pxWorker, &ulJob)) {
+            pxPool->pxJob(ulJob, pxWorker->ulIndex, pxPool->pvContext);
+            pxWorker->ullJobsRun++;
+        }
+        /* Slices only shrink, so once every one is empty the sweep is done */
+        if (!bSteal(pxPool, pxWorker)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Take the first job of the worker's own slice
+ */
+static bool bTakeOwn(PoolWorker_t *pxWorker, uint32_t *pulJob)
+{
+    uint64_t ullRange = atomic_load_explicit(&pxWorker->ullRange, memory_order_relaxed);
+
+    for (;;) {
+        uint32_t ulBegin = RANGE_BEGIN(ullRange);
+        uint32_t ulEnd = RANGE_END(ullRange);
+
+        if (ulBegin >= ulEnd) {
+            return false;
+        }
+        if (atomic_compare_exchange_weak_explicit(&pxWorker->ullRange, &ullRange,
+                                                  RANGE_PACK(ulBegin + 1, ulEnd),
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            *pulJob = ulBegin;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Move the back half of the fullest other slice into pxThief's (empty) slice
+ */
+static bool bSteal(Pool_t *pxPool, PoolWorker_t *pxThief)
+{
+    for (;;) {
+        PoolWorker_t *pxVictim = NULL;
+        uint64_t ullRange = 0;
+        uint32_t ulMost = 0;
+
+        for (uint32_t i = 1; i < pxPool->ulThreads; i++) {
+            PoolWorker_t *pxWorker = &pxPool->pxWorkers[(pxThief->ulIndex + i) % pxPool->ulThreads];
+            uint64_t ullCandidate = atomic_load_explicit(&pxWorker->ullRange, memory_order_relaxed);
+            uint32_t ulLeft = RANGE_END(ullCandidate) - RANGE_BEGIN(ullCandidate);
+
+            if (RANGE_BEGIN(ullCandidate) < RANGE_END(ullCandidate) && ulLeft > ulMost) {
+                pxVictim = pxWorker;
+                ullRange = ullCandidate;
+                ulMost = ulLeft;
+            }
+        }
+        if (pxVictim == NULL) {
+            return false;
+        }
+
+        uint32_t ulBegin = RANGE_BEGIN(ullRange);
+        uint32_t ulEnd = RANGE_END(ullRange);
+        uint32_t ulMid = ulBegin + (ulEnd - ulBegin) / 2;
+
+        if (atomic_compare_exchange_strong_explicit(&pxVictim->ullRange, &ullRange,
+                                                    RANGE_PACK(ulBegin, ulMid),
+                                                    memory_order_acq_rel, memory_order_relaxed)) {
+            /* Nobody else writes an empty slice, a plain store publishes it */
+            atomic_store_explicit(&pxThief->ullRange, RANGE_PACK(ulMid, ulEnd), memory_order_release);
+            pxThief->ullSteals++;
+            return true;
+        }
+        /* Lost a race; rescan */
+    }
+}
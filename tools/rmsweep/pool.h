@@ -0,0 +1,38 @@
+/**
+ * @file pool.h
+ * @brief Work-stealing thread pool for embarrassingly parallel sweeps
+ *
+ * Jobs are the integers [0, ulJobs). Each worker starts with a contiguous
+ * slice, takes jobs from its front and, once empty, steals the back half
+ * of another worker's remaining slice. Job results must depend only on the
+ * job index so output is identical for any thread count.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*PoolJob_t)(uint32_t ulJob, uint32_t ulWorker, void *pvContext);
+
+typedef struct {
+    uint32_t ulThreads;
+    uint64_t ullJobsRun;
+    uint64_t ullSteals;
+    double dSeconds;
+} PoolStats_t;
+
+uint32_t ulPoolDefaultThreads(void);
+bool bPoolRun(uint32_t ulThreads, uint32_t ulJobs, PoolJob_t pxJob, void *pvContext,
+              PoolStats_t *pxStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POOL_H */
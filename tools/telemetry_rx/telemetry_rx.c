@@ -0,0 +1,211 @@
+/**
+ * @file telemetry_rx.c
+ * @brief Host receiver for the periodRTOS telemetry transport
+ *
+ * Reads a raw byte stream (serial device, QEMU -serial file/pipe, capture
+ * file or stdin), splits it on 0x00 delimiters, COBS-decodes and CRC-checks
+ * each frame and prints it by channel.
+ *
+ * Usage: telemetry_rx [file|-]
+ */
+
+#include "periodRTOS.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+
+#define RX_FRAME_MAX   COBS_MAX_ENCODED_SIZE(TELEMETRY_MAX_PAYLOAD + TELEMETRY_FRAME_OVERHEAD)
+
+/* Q16 fraction to percent with one decimal */
+#define Q16_TO_PERCENT(x)   ((double)(x) * 100.0 / 65536.0)
+
+static const char *pcStateNames[] = { "READY", "RUNNING", "BLOCKED", "SUSPENDED", "DELETED", "DELAYED" };
+
+static uint32_t ulFramesOk = 0;
+static uint32_t ulFramesBad = 0;
+static int lLastSequence[TELEMETRY_CHANNEL_COUNT];
+
+/**
+ * @brief Print a decoded TelemetrySnapshot_t
+ */
+static void vPrintSnapshot(const uint8_t *pucPayload, uint32_t ulLength)
+{
+    TelemetrySnapshot_t xSnapshot;
+
+    if (ulLength < 32) {
+        printf("[telemetry] short record (%u bytes)\n", ulLength);
+        return;
+    }
+
+    memset(&xSnapshot, 0, sizeof(xSnapshot));
+    memcpy(&xSnapshot, pucPayload, ulLength < sizeof(xSnapshot) ? ulLength : sizeof(xSnapshot));
+
+    if (xSnapshot.ulMagic != TELEMETRY_SNAPSHOT_MAGIC) {
+        printf("[telemetry] bad magic 0x%08x\n", xSnapshot.ulMagic);
+        return;
+    }
+    if (xSnapshot.usVersion != TELEMETRY_SNAPSHOT_VERSION || xSnapshot.usSize != ulLength) {
+        printf("[telemetry] snapshot v%u (%u bytes), receiver expects v%u (%zu bytes)\n",
+               xSnapshot.usVersion, xSnapshot.usSize,
+               TELEMETRY_SNAPSHOT_VERSION, sizeof(TelemetrySnapshot_t));
+        return;
+    }
+
+    printf("[telemetry] seq=%u uptime=%ums switches=%u idle=%ums tasks=%u state=%u\n",
+           xSnapshot.ulSequence, xSnapshot.ulSystemUptime, xSnapshot.ulTotalContextSwitches,
+           xSnapshot.ulIdleTime, xSnapshot.ulTaskCount, xSnapshot.ucSchedulerState);
+    printf("  load %.1f%% (peak %.1f%%), hyperperiod %ums: %.1f%% (peak %.1f%%)\n",
+           Q16_TO_PERCENT(xSnapshot.ulSystemLoad), Q16_TO_PERCENT(xSnapshot.ulSystemLoadPeak),
+           xSnapshot.ulHyperperiod, Q16_TO_PERCENT(xSnapshot.ulHyperperiodLoad),
+           Q16_TO_PERCENT(xSnapshot.ulHyperperiodLoadPeak));
+    printf("  %-15s %4s %4s %6s %6s %-9s %10s %8s %6s %6s %6s\n",
+           "name", "id", "prio", "period", "dline", "state", "exec", "switches", "misses",
+           "load%", "peak%");
+
+    for (uint32_t i = 0; i < xSnapshot.ucTaskRecords && i < MAX_TASKS; i++) {
+        const TaskTelemetry_t *pxTask = &xSnapshot.xTasks[i];
+        const TaskLoadTelemetry_t *pxLoad = &xSnapshot.xTaskLoads[i];
+        char pcName[17];
+
+        if (!(pxTask->ucFlags & TASK_TELEMETRY_FLAG_IN_USE)) {
+            continue;
+        }
+        memcpy(pcName, pxTask->pcTaskName, 16);
+        pcName[16] = '\0';
+
+        printf("  %-15s %4u %4u %6u %6u %-9s %10u %8u %6u %6.1f %6.1f%s\n",
+               pcName, pxTask->ulTaskID, pxTask->ulPriority, pxTask->ulPeriod,
+               pxTask->ulDeadline,
+               pxTask->ucState < sizeof(pcStateNames) / sizeof(pcStateNames[0]) ? pcStateNames[pxTask->ucState] : "?",
+               pxTask->ulExecutionTime, pxTask->ulContextSwitchCount,
+               pxTask->ulDeadlineMissCount,
+               Q16_TO_PERCENT(pxLoad->ulLoad), Q16_TO_PERCENT(pxLoad->ulLoadPeak),
+               (pxTask->ucFlags & TASK_TELEMETRY_FLAG_DEADLINE_MISSED) ? " MISSED" : "");
+    }
+}
+
+/**
+ * @brief Summarize a profiler frame; tools/pcprof symbolizes the samples
+ */
+static void vPrintProfile(const uint8_t *pucPayload, uint32_t ulLength)
+{
+    ProfileFrameHeader_t xHeader;
+
+    if (ulLength < sizeof(xHeader)) {
+        printf("[profile] short frame (%u bytes)\n", ulLength);
+        return;
+    }
+    memcpy(&xHeader, pucPayload, sizeof(xHeader));
+
+    if (xHeader.ulMagic != PROFILE_FRAME_MAGIC || xHeader.usSampleSize != sizeof(ProfileSample_t) ||
+        sizeof(xHeader) + (uint32_t)xHeader.usCount * xHeader.usSampleSize != ulLength) {
+        printf("[profile] malformed frame (%u bytes)\n", ulLength);
+        return;
+    }
+
+    printf("[profile] %u samples at %u Hz, %u taken, %u dropped\n",
+           xHeader.usCount, xHeader.ulSampleHz, xHeader.ulSamples, xHeader.ulDropped);
+}
+
+/**
+ * @brief Validate and dispatch one COBS-encoded frame (delimiter stripped)
+ */
+static void vHandleFrame(const uint8_t *pucEncoded, uint32_t ulEncodedLength)
+{
+    uint8_t ucFrame[RX_FRAME_MAX];
+    uint32_t ulLength;
+    uint16_t usCrc;
+    uint8_t ucChannel;
+
+    if (ulEncodedLength == 0) {
+        return; /* Padding between frames */
+    }
+
+    ulLength = ulCobsDecode(pucEncoded, ulEncodedLength, ucFrame);
+    if (ulLength < TELEMETRY_FRAME_OVERHEAD) {
+        ulFramesBad++;
+        return;
+    }
+
+    usCrc = usCrc16Update(0xFFFF, ucFrame, ulLength - 2);
+    if (ucFrame[ulLength - 2] != (usCrc & 0xFF) || ucFrame[ulLength - 1] != (usCrc >> 8)) {
+        ulFramesBad++;
+        return;
+    }
+
+    ucChannel = ucFrame[0];
+    if (ucChannel >= TELEMETRY_CHANNEL_COUNT) {
+        ulFramesBad++;
+        return;
+    }
+
+    if (lLastSequence[ucChannel] >= 0 &&
+        (uint8_t)(lLastSequence[ucChannel] + 1) != ucFrame[1]) {
+        printf("[rx] channel %u: %u frame(s) lost\n", ucChannel,
+               (uint8_t)(ucFrame[1] - lLastSequence[ucChannel] - 1));
+    }
+    lLastSequence[ucChannel] = ucFrame[1];
+    ulFramesOk++;
+
+    switch (ucChannel) {
+        case TELEMETRY_CHANNEL_LOG:
+            fwrite(&ucFrame[2], 1, ulLength - TELEMETRY_FRAME_OVERHEAD, stdout);
+            break;
+        case TELEMETRY_CHANNEL_TELEMETRY:
+            vPrintSnapshot(&ucFrame[2], ulLength - TELEMETRY_FRAME_OVERHEAD);
+            break;
+        case TELEMETRY_CHANNEL_PROFILE:
+            vPrintProfile(&ucFrame[2], ulLength - TELEMETRY_FRAME_OVERHEAD);
+            break;
+        default:
+            printf("[trace]");
+            for (uint32_t i = 2; i < ulLength - 2; i++) {
+                printf(" %02x", ucFrame[i]);
+            }
+            printf("\n");
+            break;
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t ucEncoded[RX_FRAME_MAX];
+    uint32_t ulFill = 0;
+    bool bOverflow = false;
+    FILE *pxInput = stdin;
+    int lByte;
+
+    for (uint32_t i = 0; i < TELEMETRY_CHANNEL_COUNT; i++) {
+        lLastSequence[i] = -1;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "-") != 0) {
+        pxInput = fopen(argv[1], "rb");
+        if (pxInput == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    while ((lByte = fgetc(pxInput)) != EOF) {
+        if (lByte == 0x00) {
+            if (bOverflow) {
+                ulFramesBad++;
+            } else {
+                vHandleFrame(ucEncoded, ulFill);
+            }
+            ulFill = 0;
+            bOverflow = false;
+        } else if (ulFill < sizeof(ucEncoded)) {
+            ucEncoded[ulFill++] = (uint8_t)lByte;
+        } else {
+            bOverflow = true;
+        }
+    }
+
+    fprintf(stderr, "telemetry_rx: %u frame(s) ok, %u bad\n", ulFramesOk, ulFramesBad);
+
+    return ulFramesBad ? 2 : 0;
+}
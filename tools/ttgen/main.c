@@ -0,0 +1,131 @@
+/**
+ * @file main.c
+ * @brief ttgen - generate and check a time-triggered dispatch table
+ *
+ * Usage: ttgen [options] [taskset-file|-]
+ *   -a rm|edf     policy the table is laid out with (default rm)
+ *   -o FILE       write the table as C source (default stdout)
+ *   -n SYMBOL     name of the TtSchedule_t (default xTtSchedule)
+ *   -m TICKS      largest hyperperiod accepted (default 1000000)
+ *   -l            list the table on stderr
+ *   -q            no summary
+ *
+ * Task names in the task set must match the kernel tasks' names, which is
+ * how bTtScheduleInstall() binds the table. The table is checked before it
+ * is written; exits with status 1 if the set cannot be tabled or the check
+ * fails.
+ */
+
+#include "ttgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TTGEN_DEFAULT_MAX_HYPERPERIOD  1000000UL
+
+static void vPrintUsage(void)
+{
+    fprintf(stderr,
+            "usage: ttgen [-a rm|edf] [-o table.c] [-n SYMBOL] [-m TICKS] [-l] [-q] [taskset|-]\n");
+}
+
+static void vListTable(const TaskSet_t *pxSet, const TtTable_t *pxTable)
+{
+    fprintf(stderr, "  %8s  %-15s %s\n", "tick", "task", "flags");
+    for (uint32_t e = 0; e < pxTable->ulEntries; e++) {
+        const TtEntry_t *pxEntry = &pxTable->pxEntries[e];
+
+        fprintf(stderr, "  %8u  %-15s %s\n", pxEntry->ulOffset,
+                (pxEntry->ucTask == TT_IDLE) ? "idle" : pxSet->pcName[pxEntry->ucTask - 1],
+                (pxEntry->ucFlags & TT_FLAG_RELEASE) ? "release" : "");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    TaskSet_t xSet;
+    TtTable_t xTable;
+    TtGenPolicy_t ePolicy = TTGEN_POLICY_RM;
+    const char *pcOutput = NULL;
+    const char *pcSymbol = "xTtSchedule";
+    const char *pcSource;
+    uint32_t ulMaxHyperperiod = TTGEN_DEFAULT_MAX_HYPERPERIOD;
+    bool bList = false;
+    bool bQuiet = false;
+    FILE *pxOut = stdout;
+    int iOption;
+
+    while ((iOption = getopt(argc, argv, "a:o:n:m:lqh")) != -1) {
+        switch (iOption) {
+            case 'a':
+                if (strcmp(optarg, "rm") == 0) {
+                    ePolicy = TTGEN_POLICY_RM;
+                } else if (strcmp(optarg, "edf") == 0) {
+                    ePolicy = TTGEN_POLICY_EDF;
+                } else {
+                    vPrintUsage();
+                    return 2;
+                }
+                break;
+            case 'o': pcOutput = optarg; break;
+            case 'n': pcSymbol = optarg; break;
+            case 'm': ulMaxHyperperiod = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': bList = true; break;
+            case 'q': bQuiet = true; break;
+            default:
+                vPrintUsage();
+                return 2;
+        }
+    }
+    if (optind >= argc) {
+        vPrintUsage();
+        return 2;
+    }
+    pcSource = argv[optind];
+
+    if (!bTaskSetInit(&xSet, 0)) {
+        fprintf(stderr, "ttgen: out of memory\n");
+        return 2;
+    }
+    if (!bTaskSetLoad(&xSet, pcSource)) {
+        return 2;
+    }
+
+    if (!bTtGenerate(&xSet, ePolicy, ulMaxHyperperiod, &xTable)) {
+        vTaskSetFree(&xSet);
+        return 1;
+    }
+    if (!bTtVerify(&xSet, &xTable)) {
+        vTtTableFree(&xTable);
+        vTaskSetFree(&xSet);
+        return 1;
+    }
+
+    if (bList) {
+        vListTable(&xSet, &xTable);
+    }
+
+    if (pcOutput != NULL) {
+        pxOut = fopen(pcOutput, "w");
+        if (pxOut == NULL) {
+            perror(pcOutput);
+            return 2;
+        }
+    }
+    vTtWriteC(pxOut, &xSet, &xTable, pcSymbol, (strcmp(pcSource, "-") == 0) ? "stdin" : pcSource);
+    if (pxOut != stdout) {
+        fclose(pxOut);
+    }
+
+    if (!bQuiet) {
+        fprintf(stderr, "ttgen: %u tasks, hyperperiod %u ticks, %u entries (%zu bytes), %.1f%% busy, checked\n",
+                xSet.ulCount, xTable.ulHyperperiod, xTable.ulEntries,
+                (size_t)xTable.ulEntries * sizeof(TtEntry_t),
+                100.0 * xTable.ulBusyTicks / xTable.ulHyperperiod);
+    }
+
+    vTtTableFree(&xTable);
+    vTaskSetFree(&xSet);
+    return 0;
+}
@@ -0,0 +1,310 @@
+/**
+ * @file ttgen.c
+ * @brief Time-triggered table generation and checking
+ */
+
+#include "ttgen.h"
+#include "rm_policy.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Internal function prototypes */
+static uint32_t ulPickJob(const TaskSet_t *pxSet, TtGenPolicy_t ePolicy,
+                          const uint32_t *pulRemaining, const uint32_t *pulDeadline);
+
+/**
+ * @brief Slots a job needs: WCET rounded up to whole ticks, at least one
+ */
+uint32_t ulTtJobSlots(uint32_t ulWcetUs)
+{
+    uint32_t ulSlots = (uint32_t)(((uint64_t)ulWcetUs + TASKSET_TICK_US - 1) / TASKSET_TICK_US);
+
+    return (ulSlots == 0) ? 1 : ulSlots;
+}
+
+/**
+ * @brief Lay out one hyperperiod and compress it into dispatch entries
+ * @return false, with the reason on stderr, if the set cannot be tabled
+ *         or the policy misses a deadline
+ */
+bool bTtGenerate(const TaskSet_t *pxSet, TtGenPolicy_t ePolicy, uint32_t ulMaxHyperperiod,
+                 TtTable_t *pxTable)
+{
+    uint64_t ullHyperperiod = ullTaskSetHyperperiod(pxSet);
+    uint32_t *pulRemaining;
+    uint32_t *pulDeadline;
+    bool *pbFresh;
+    uint32_t ulPreviousOwner = UINT32_MAX;
+    uint32_t ulCapacity = 64;
+    bool bOk = true;
+
+    memset(pxTable, 0, sizeof(*pxTable));
+
+    if (pxSet->ulCount == 0 || pxSet->ulCount > UINT8_MAX) {
+        fprintf(stderr, "ttgen: need 1 to %u tasks\n", UINT8_MAX);
+        return false;
+    }
+    if (ullHyperperiod == 0 || ullHyperperiod > ulMaxHyperperiod) {
+        fprintf(stderr, "ttgen: hyperperiod exceeds %u ticks\n", ulMaxHyperperiod);
+        return false;
+    }
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        if (pxSet->pulDeadline[i] == 0 || pxSet->pulDeadline[i] > pxSet->pulPeriod[i]) {
+            fprintf(stderr, "ttgen: %s: deadline must be in 1..period\n", pxSet->pcName[i]);
+            return false;
+        }
+    }
+
+    pulRemaining = calloc(pxSet->ulCount, sizeof(uint32_t));
+    pulDeadline = calloc(pxSet->ulCount, sizeof(uint32_t));
+    pbFresh = calloc(pxSet->ulCount, sizeof(bool));
+    pxTable->pxEntries = malloc(ulCapacity * sizeof(TtEntry_t));
+    if (pulRemaining == NULL || pulDeadline == NULL || pbFresh == NULL || pxTable->pxEntries == NULL) {
+        fprintf(stderr, "ttgen: out of memory\n");
+        bOk = false;
+    }
+    pxTable->ulHyperperiod = (uint32_t)ullHyperperiod;
+
+    for (uint32_t ulTick = 0; bOk && ulTick < pxTable->ulHyperperiod; ulTick++) {
+        uint32_t ulTask;
+        uint8_t ucFlags = 0;
+
+        for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+            /* A job still owed slots at its deadline tick is late; as D <= T
+             * this also catches a job unfinished at its next release */
+            if (pulRemaining[i] > 0 && ulTick >= pulDeadline[i]) {
+                fprintf(stderr, "ttgen: %s misses its deadline at tick %u under %s\n",
+                        pxSet->pcName[i], pulDeadline[i], (ePolicy == TTGEN_POLICY_EDF) ? "EDF" : "RM");
+                bOk = false;
+                break;
+            }
+            if (ulTick % pxSet->pulPeriod[i] == 0) {
+                pulRemaining[i] = ulTtJobSlots(pxSet->pulWcet[i]);
+                pulDeadline[i] = ulRmAbsoluteDeadline(ulTick, pxSet->pulDeadline[i]);
+                pbFresh[i] = true;
+            }
+        }
+        if (!bOk) {
+            break;
+        }
+
+        ulTask = ulPickJob(pxSet, ePolicy, pulRemaining, pulDeadline);
+        if (ulTask != UINT32_MAX) {
+            if (pbFresh[ulTask]) {
+                ucFlags = TT_FLAG_RELEASE;
+                pbFresh[ulTask] = false;
+            }
+            pulRemaining[ulTask]--;
+            pxTable->ulBusyTicks++;
+        }
+
+        if (ulTask != ulPreviousOwner || ucFlags != 0) {
+            if (pxTable->ulEntries == ulCapacity) {
+                TtEntry_t *pxGrown = realloc(pxTable->pxEntries, 2 * ulCapacity * sizeof(TtEntry_t));
+
+                if (pxGrown == NULL) {
+                    fprintf(stderr, "ttgen: out of memory\n");
+                    bOk = false;
+                    break;
+                }
+                pxTable->pxEntries = pxGrown;
+                ulCapacity *= 2;
+            }
+            pxTable->pxEntries[pxTable->ulEntries].ulOffset = ulTick;
+            pxTable->pxEntries[pxTable->ulEntries].ucTask = (ulTask == UINT32_MAX) ? TT_IDLE : (uint8_t)(ulTask + 1);
+            pxTable->pxEntries[pxTable->ulEntries].ucFlags = ucFlags;
+            pxTable->pxEntries[pxTable->ulEntries].usReserved = 0;
+            pxTable->ulEntries++;
+            ulPreviousOwner = ulTask;
+        }
+    }
+
+    /* Deadlines are within the period, so every job ends inside the frame */
+    for (uint32_t i = 0; bOk && i < pxSet->ulCount; i++) {
+        if (pulRemaining[i] > 0) {
+            fprintf(stderr, "ttgen: %s misses its deadline at tick %u under %s\n",
+                    pxSet->pcName[i], pulDeadline[i], (ePolicy == TTGEN_POLICY_EDF) ? "EDF" : "RM");
+            bOk = false;
+        }
+    }
+
+    free(pulRemaining);
+    free(pulDeadline);
+    free(pbFresh);
+    if (!bOk) {
+        vTtTableFree(pxTable);
+    }
+    return bOk;
+}
+
+/**
+ * @brief Prove that a table serves every job of the set in time
+ * @return false, with the first violation on stderr
+ */
+bool bTtVerify(const TaskSet_t *pxSet, const TtTable_t *pxTable)
+{
+    uint32_t ulHyperperiod = pxTable->ulHyperperiod;
+    uint8_t *pucOwner;
+    uint8_t *pucFlags;
+    bool bOk = true;
+
+    if (pxTable->ulEntries == 0 || pxTable->pxEntries[0].ulOffset != 0) {
+        fprintf(stderr, "ttgen: check: table must start at tick 0\n");
+        return false;
+    }
+    if (ulHyperperiod == 0 || ullTaskSetHyperperiod(pxSet) != ulHyperperiod) {
+        fprintf(stderr, "ttgen: check: frame is not the task set's hyperperiod\n");
+        return false;
+    }
+
+    pucOwner = malloc(ulHyperperiod);
+    pucFlags = calloc(ulHyperperiod, 1);
+    if (pucOwner == NULL || pucFlags == NULL) {
+        fprintf(stderr, "ttgen: out of memory\n");
+        free(pucOwner);
+        free(pucFlags);
+        return false;
+    }
+
+    /* Expand: each entry owns the ticks up to the next one */
+    for (uint32_t e = 0; bOk && e < pxTable->ulEntries; e++) {
+        const TtEntry_t *pxEntry = &pxTable->pxEntries[e];
+        uint32_t ulEnd = (e + 1 < pxTable->ulEntries) ? pxTable->pxEntries[e + 1].ulOffset : ulHyperperiod;
+
+        if (ulEnd <= pxEntry->ulOffset || ulEnd > ulHyperperiod || pxEntry->ucTask > pxSet->ulCount) {
+            fprintf(stderr, "ttgen: check: entry %u is out of order or range\n", e);
+            bOk = false;
+            break;
+        }
+        if ((pxEntry->ucFlags & TT_FLAG_RELEASE) && pxEntry->ucTask == TT_IDLE) {
+            fprintf(stderr, "ttgen: check: entry %u releases the idle task\n", e);
+            bOk = false;
+            break;
+        }
+        memset(&pucOwner[pxEntry->ulOffset], pxEntry->ucTask, ulEnd - pxEntry->ulOffset);
+        pucFlags[pxEntry->ulOffset] = pxEntry->ucFlags;
+    }
+
+    /* Per job: one release within the period, enough slots before the deadline */
+    for (uint32_t i = 0; bOk && i < pxSet->ulCount; i++) {
+        uint8_t ucTask = (uint8_t)(i + 1);
+        uint32_t ulPeriod = pxSet->pulPeriod[i];
+        uint32_t ulSlots = ulTtJobSlots(pxSet->pulWcet[i]);
+
+        for (uint32_t ulRelease = 0; bOk && ulRelease < ulHyperperiod; ulRelease += ulPeriod) {
+            uint32_t ulDeadline = ulRmAbsoluteDeadline(ulRelease, pxSet->pulDeadline[i]);
+            uint32_t ulStart = 0;
+            uint32_t ulReleases = 0;
+            uint32_t ulServed = 0;
+            bool bEarly = false;
+
+            for (uint32_t t = ulRelease; t < ulRelease + ulPeriod; t++) {
+                if (pucOwner[t] != ucTask) {
+                    continue;
+                }
+                if (pucFlags[t] & TT_FLAG_RELEASE) {
+                    if (ulReleases++ == 0) {
+                        ulStart = t;
+                    }
+                } else if (ulReleases == 0) {
+                    /* A slot before the release would run nothing */
+                    bEarly = true;
+                }
+            }
+            if (ulReleases != 1 || bEarly) {
+                fprintf(stderr, "ttgen: check: %s job at tick %u needs exactly one release, first\n",
+                        pxSet->pcName[i], ulRelease);
+                bOk = false;
+                break;
+            }
+            for (uint32_t t = ulStart; t < ulDeadline && ulServed < ulSlots; t++) {
+                if (pucOwner[t] == ucTask) {
+                    ulServed++;
+                }
+            }
+            if (ulServed < ulSlots) {
+                fprintf(stderr, "ttgen: check: %s job at tick %u gets %u of %u slots by its deadline\n",
+                        pxSet->pcName[i], ulRelease, ulServed, ulSlots);
+                bOk = false;
+            }
+        }
+    }
+
+    free(pucOwner);
+    free(pucFlags);
+    return bOk;
+}
+
+void vTtTableFree(TtTable_t *pxTable)
+{
+    free(pxTable->pxEntries);
+    memset(pxTable, 0, sizeof(*pxTable));
+}
+
+/**
+ * @brief Emit the table as a C translation unit defining a TtSchedule_t
+ */
+void vTtWriteC(FILE *pxFile, const TaskSet_t *pxSet, const TtTable_t *pxTable,
+               const char *pcSymbol, const char *pcSource)
+{
+    fprintf(pxFile, "/* Generated by ttgen from %s - do not edit */\n\n", pcSource);
+    fprintf(pxFile, "#include \"tt_schedule.h\"\n\n");
+
+    fprintf(pxFile, "static const char * const pcTtTaskNames[%u] = {\n", pxSet->ulCount);
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        fprintf(pxFile, "    \"%s\",\n", pxSet->pcName[i]);
+    }
+    fprintf(pxFile, "};\n\n");
+
+    fprintf(pxFile, "static const uint32_t ulTtTaskPeriods[%u] = {\n", pxSet->ulCount);
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        fprintf(pxFile, "    %u,\n", pxSet->pulPeriod[i]);
+    }
+    fprintf(pxFile, "};\n\n");
+
+    fprintf(pxFile, "/* Tick, task (1-based, 0 = idle), flags */\n");
+    fprintf(pxFile, "static const TtEntry_t xTtEntries[%u] = {\n", pxTable->ulEntries);
+    for (uint32_t e = 0; e < pxTable->ulEntries; e++) {
+        const TtEntry_t *pxEntry = &pxTable->pxEntries[e];
+
+        fprintf(pxFile, "    { %7u, %3u, %-15s, 0 },  /* %s */\n", pxEntry->ulOffset, pxEntry->ucTask,
+                (pxEntry->ucFlags & TT_FLAG_RELEASE) ? "TT_FLAG_RELEASE" : "0",
+                (pxEntry->ucTask == TT_IDLE) ? "idle" : pxSet->pcName[pxEntry->ucTask - 1]);
+    }
+    fprintf(pxFile, "};\n\n");
+
+    fprintf(pxFile, "const TtSchedule_t %s = {\n", pcSymbol);
+    fprintf(pxFile, "    %u, %u, xTtEntries,\n", pxTable->ulHyperperiod, pxTable->ulEntries);
+    fprintf(pxFile, "    %u, pcTtTaskNames, ulTtTaskPeriods\n", pxSet->ulCount);
+    fprintf(pxFile, "};\n");
+}
+
+/**
+ * @brief Pending job to run in the next slot, UINT32_MAX for idle
+ */
+static uint32_t ulPickJob(const TaskSet_t *pxSet, TtGenPolicy_t ePolicy,
+                          const uint32_t *pulRemaining, const uint32_t *pulDeadline)
+{
+    uint32_t ulBest = UINT32_MAX;
+
+    for (uint32_t i = 0; i < pxSet->ulCount; i++) {
+        bool bBetter;
+
+        if (pulRemaining[i] == 0) {
+            continue;
+        }
+        if (ulBest == UINT32_MAX) {
+            ulBest = i;
+            continue;
+        }
+
+        bBetter = bRmPrecedes(pxSet->pulPeriod[i], i + 1, pxSet->pulPeriod[ulBest], ulBest + 1);
+        if (ePolicy == TTGEN_POLICY_EDF && pulDeadline[i] != pulDeadline[ulBest]) {
+            bBetter = pulDeadline[i] < pulDeadline[ulBest];
+        }
+        if (bBetter) {
+            ulBest = i;
+        }
+    }
+    return ulBest;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file ttgen.h
+ * @brief Offline generation and checking of time-triggered dispatch tables
+ *
+ * The generator lays out one hyperperiod tick by tick, the granularity at
+ * which the kernel dispatches. A job needs ceil(WCET / tick) slots, at least
+ * one, and takes them according to the chosen policy: Rate Monotonic order
+ * (rm_policy.h) or earliest deadline first. The result is compressed to the
+ * ticks at which the slot owner changes or a job starts.
+ *
+ * The checker is independent of the generator: it expands a table back to
+ * ticks and proves, job by job, that each release lies within its period
+ * and is followed by enough slots before the deadline.
+ */
+
+#ifndef TTGEN_H
+#define TTGEN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "taskset.h"
+#include "tt_schedule.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    TTGEN_POLICY_RM = 0,
+    TTGEN_POLICY_EDF
+} TtGenPolicy_t;
+
+typedef struct {
+    uint32_t ulHyperperiod;          /* Ticks */
+    uint32_t ulEntries;
+    TtEntry_t *pxEntries;
+    uint32_t ulBusyTicks;            /* Slots owned by a task */
+} TtTable_t;
+
+bool bTtGenerate(const TaskSet_t *pxSet, TtGenPolicy_t ePolicy, uint32_t ulMaxHyperperiod,
+                 TtTable_t *pxTable);
+bool bTtVerify(const TaskSet_t *pxSet, const TtTable_t *pxTable);
+void vTtTableFree(TtTable_t *pxTable);
+void vTtWriteC(FILE *pxFile, const TaskSet_t *pxSet, const TtTable_t *pxTable,
+               const char *pcSymbol, const char *pcSource);
+uint32_t ulTtJobSlots(uint32_t ulWcetUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TTGEN_H */